@@ -15,6 +15,9 @@
 #include <QVariant>
 #include <QAbstractListModel>
 #include <QMetaProperty>
+#include <QHash>
+#include <QSet>
+#include <qmath.h>
 
 // Marble
 #include "MarbleDebug.h"
@@ -46,6 +49,157 @@ const qreal boxComparisonFactor = 16.0;
 // Separator to separate the id of the item from the file type
 const QChar fileIdSeparator = QLatin1Char('_');
 
+// The number of items kept by default before items far outside of the viewport are removed
+const int defaultMaximumItemCount = 10000;
+
+// Size of the cells in screen pixels the bounding rects of displayed items are sorted into
+const int collisionCellSize = 64;
+
+namespace
+{
+
+/**
+ * The cells of a degree in longitude and latitude the items are sorted into
+ * by their coordinate.
+ */
+class CellRange
+{
+public:
+    /**
+     * The cells covering the @p box, extended by @p lonMargin and @p latMargin
+     * degrees to each side and a cell more for items near the border.
+     */
+    CellRange( const GeoDataLatLonBox &box, qreal lonMargin, qreal latMargin );
+
+    static int cell( const GeoDataCoordinates &coordinates );
+
+    bool contains( int cell ) const;
+
+    /** Returns the number of cells in the range */
+    int size() const;
+
+    /** Returns the cells in the range */
+    QVector<int> cells() const;
+
+    enum { Columns = 360, Rows = 180 };
+
+private:
+    int m_firstColumn;
+    int m_columns;
+    int m_firstRow;
+    int m_lastRow;
+};
+
+CellRange::CellRange( const GeoDataLatLonBox &box, qreal lonMargin, qreal latMargin )
+{
+    qreal const west = box.west( GeoDataCoordinates::Degree );
+    qreal east = box.east( GeoDataCoordinates::Degree );
+    if ( box.crossesDateLine() ) {
+        east += 360.0;
+    }
+    m_firstColumn = qFloor( west - lonMargin + 180.0 ) - 1;
+    m_columns = qMin<int>( Columns, qFloor( east + lonMargin + 180.0 ) + 1 - m_firstColumn + 1 );
+    m_firstRow = qMax( 0, qFloor( box.south( GeoDataCoordinates::Degree ) - latMargin + 90.0 ) - 1 );
+    m_lastRow = qMin<int>( Rows - 1, qFloor( box.north( GeoDataCoordinates::Degree ) + latMargin + 90.0 ) + 1 );
+}
+
+int CellRange::cell( const GeoDataCoordinates &coordinates )
+{
+    int const column = qBound<int>( 0, qFloor( coordinates.longitude( GeoDataCoordinates::Degree ) + 180.0 ), Columns - 1 );
+    int const row = qBound<int>( 0, qFloor( coordinates.latitude( GeoDataCoordinates::Degree ) + 90.0 ), Rows - 1 );
+    return row * Columns + column;
+}
+
+bool CellRange::contains( int cell ) const
+{
+    int const row = cell / Columns;
+    int const column = cell % Columns;
+    return row >= m_firstRow && row <= m_lastRow
+            && ( column - m_firstColumn + 2 * Columns ) % Columns < m_columns;
+}
+
+int CellRange::size() const
+{
+    return m_columns * ( m_lastRow - m_firstRow + 1 );
+}
+
+QVector<int> CellRange::cells() const
+{
+    QVector<int> result;
+    result.reserve( size() );
+    for ( int row = m_firstRow; row <= m_lastRow; ++row ) {
+        for ( int i = 0; i < m_columns; ++i ) {
+            int const column = ( m_firstColumn + i + Columns ) % Columns;
+            result << row * Columns + column;
+        }
+    }
+    return result;
+}
+
+/**
+ * The bounding rects of the items displayed so far, sorted into cells on
+ * the screen to test new items against the ones nearby only.
+ */
+class CollisionGrid
+{
+public:
+    bool intersects( const QVector<QRectF> &rects ) const;
+
+    void insert( const QVector<QRectF> &rects );
+
+private:
+    template<typename Function>
+    static void forEachCell( const QRectF &rect, Function function );
+
+    QHash<quint64, QVector<QRectF> > m_cells;
+};
+
+template<typename Function>
+void CollisionGrid::forEachCell( const QRectF &rect, Function function )
+{
+    int const left = qFloor( rect.left() / collisionCellSize );
+    int const right = qFloor( rect.right() / collisionCellSize );
+    int const top = qFloor( rect.top() / collisionCellSize );
+    int const bottom = qFloor( rect.bottom() / collisionCellSize );
+    for ( int y = top; y <= bottom; ++y ) {
+        for ( int x = left; x <= right; ++x ) {
+            function( ( quint64( quint32( x ) ) << 32 ) | quint32( y ) );
+        }
+    }
+}
+
+bool CollisionGrid::intersects( const QVector<QRectF> &rects ) const
+{
+    bool result = false;
+    for ( const QRectF &itemRect: rects ) {
+        forEachCell( itemRect, [&]( quint64 key ) {
+            const auto cell = m_cells.constFind( key );
+            if ( cell != m_cells.constEnd() ) {
+                for ( const QRectF &rect: *cell ) {
+                    if ( rect.intersects( itemRect ) ) {
+                        result = true;
+                    }
+                }
+            }
+        } );
+        if ( result ) {
+            break;
+        }
+    }
+    return result;
+}
+
+void CollisionGrid::insert( const QVector<QRectF> &rects )
+{
+    for ( const QRectF &rect: rects ) {
+        forEachCell( rect, [&]( quint64 key ) {
+            m_cells[key] << rect;
+        } );
+    }
+}
+
+}
+
 class FavoritesModel;
 
 class AbstractDataPluginModelPrivate
@@ -62,6 +216,25 @@ public:
 
     void updateFavoriteItems();
 
+    void insertIntoIndex( AbstractDataPluginItem *item );
+    void removeFromIndex( AbstractDataPluginItem *item );
+
+    /**
+     * Returns the items in the cells of the @p range in the order of m_itemSet
+     */
+    QList<AbstractDataPluginItem*> itemsIn( const CellRange &range ) const;
+
+    /**
+     * Removes items far outside of the last viewport if there are more than
+     * m_maximumItemCount items
+     */
+    void evictItems();
+
+    struct IndexEntry {
+        int cell;
+        QString id;
+    };
+
     AbstractDataPluginModel *m_parent;
     const QString m_name;
     const MarbleModel *const m_marbleModel;
@@ -71,6 +244,11 @@ public:
     qint32 m_downloadedNumber;
     QString m_currentPlanetId;
     QList<AbstractDataPluginItem*> m_itemSet;
+    // The cells and ids of the items in m_itemSet
+    QHash<AbstractDataPluginItem*, IndexEntry> m_itemIndex;
+    QHash<int, QVector<AbstractDataPluginItem*> > m_itemCells;
+    QHash<QString, AbstractDataPluginItem*> m_itemsById;
+    int m_maximumItemCount;
     QHash<QString, AbstractDataPluginItem*> m_downloadingItems;
     QList<AbstractDataPluginItem*> m_displayedItems;
     QTimer m_downloadTimer;
@@ -117,6 +295,7 @@ AbstractDataPluginModelPrivate::AbstractDataPluginModelPrivate( const QString& n
       m_lastNumber( 0 ),
       m_downloadedNumber( 0 ),
       m_currentPlanetId( marbleModel->planetId() ),
+      m_maximumItemCount( defaultMaximumItemCount ),
       m_downloadTimer( m_parent ),
       m_descriptionFileNumber( 0 ),
       m_itemSettings(),
@@ -184,6 +363,94 @@ static bool lessThanByPointer( const AbstractDataPluginItem *item1,
     }
 }
 
+void AbstractDataPluginModelPrivate::insertIntoIndex( AbstractDataPluginItem *item )
+{
+    IndexEntry entry;
+    entry.cell = CellRange::cell( item->coordinate() );
+    entry.id = item->id();
+    m_itemIndex.insert( item, entry );
+    m_itemCells[entry.cell] << item;
+    if ( !m_itemsById.contains( entry.id ) ) {
+        m_itemsById.insert( entry.id, item );
+    }
+}
+
+void AbstractDataPluginModelPrivate::removeFromIndex( AbstractDataPluginItem *item )
+{
+    // Does not access the item, which may be destroyed already
+    const auto entry = m_itemIndex.find( item );
+    if ( entry == m_itemIndex.end() ) {
+        return;
+    }
+
+    const auto cell = m_itemCells.find( entry->cell );
+    cell->removeOne( item );
+    if ( cell->isEmpty() ) {
+        m_itemCells.erase( cell );
+    }
+    if ( m_itemsById.value( entry->id ) == item ) {
+        m_itemsById.remove( entry->id );
+    }
+    m_itemIndex.erase( entry );
+}
+
+QList<AbstractDataPluginItem*> AbstractDataPluginModelPrivate::itemsIn( const CellRange &range ) const
+{
+    QList<AbstractDataPluginItem*> result;
+    if ( range.size() >= m_itemCells.size() ) {
+        // The range covers a large part of the items, so filtering the
+        // sorted item set is faster than sorting the items of the range
+        for ( AbstractDataPluginItem *item: m_itemSet ) {
+            if ( range.contains( m_itemIndex.value( item ).cell ) ) {
+                result << item;
+            }
+        }
+        return result;
+    }
+
+    for ( int cell: range.cells() ) {
+        const auto items = m_itemCells.constFind( cell );
+        if ( items != m_itemCells.constEnd() ) {
+            for ( AbstractDataPluginItem *item: *items ) {
+                result << item;
+            }
+        }
+    }
+    std::sort( result.begin(), result.end(), lessThanByPointer );
+    return result;
+}
+
+void AbstractDataPluginModelPrivate::evictItems()
+{
+    if ( m_itemSet.size() <= m_maximumItemCount || m_lastNumber == 0 ) {
+        return;
+    }
+
+    // Items in the viewport and as far around it as the viewport is large
+    // are kept, as well as the ones that are needed anyway
+    const CellRange range( m_lastBox, m_lastBox.width( GeoDataCoordinates::Degree ),
+                           m_lastBox.height( GeoDataCoordinates::Degree ) );
+    QSet<AbstractDataPluginItem*> keep( m_displayedItems.constBegin(), m_displayedItems.constEnd() );
+    for ( AbstractDataPluginItem *item: m_downloadingItems ) {
+        keep.insert( item );
+    }
+
+    QList<AbstractDataPluginItem*> itemSet;
+    itemSet.reserve( m_itemSet.size() );
+    for ( AbstractDataPluginItem *item: m_itemSet ) {
+        if ( item->isSticky() || item->isFavorite() || keep.contains( item )
+             || range.contains( m_itemIndex.value( item ).cell ) ) {
+            itemSet << item;
+        } else {
+            removeFromIndex( item );
+            item->deleteLater();
+        }
+    }
+
+    mDebug() << "Removed" << m_itemSet.size() - itemSet.size() << "items far outside of the viewport";
+    m_itemSet = itemSet;
+}
+
 FavoritesModel::FavoritesModel( AbstractDataPluginModelPrivate *_d, QObject* parent ) :
     QAbstractListModel( parent ), d(_d)
 {
@@ -283,7 +550,10 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
     Q_ASSERT( !d->m_displayedItems.contains( 0 ) && "Null item in m_displayedItems. Please report a bug to marble-devel@kde.org" );
     Q_ASSERT( !d->m_itemSet.contains( 0 ) && "Null item in m_itemSet. Please report a bug to marble-devel@kde.org" );
 
-    QList<AbstractDataPluginItem*> candidates = d->m_displayedItems + d->m_itemSet;
+    // Items that are already shown have the highest priority, followed by the
+    // ones in or near the viewport in the order of the item set
+    QList<AbstractDataPluginItem*> candidates = d->m_displayedItems;
+    candidates += d->itemsIn( CellRange( currentBox, 0.0, 0.0 ) );
 
     if ( d->m_needsSorting ) {
         // Both the candidates list and the list of all items need to be sorted
@@ -292,10 +562,14 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
         d->m_needsSorting =  false;
     }
 
+    QSet<AbstractDataPluginItem*> const displayedItems( d->m_displayedItems.constBegin(),
+                                                        d->m_displayedItems.constEnd() );
+    QSet<AbstractDataPluginItem*> listed;
+    CollisionGrid displayedRects;
+
     QList<AbstractDataPluginItem*>::const_iterator i = candidates.constBegin();
     QList<AbstractDataPluginItem*>::const_iterator end = candidates.constEnd();
 
-    // Items that are already shown have the highest priority
     for (; i != end && list.size() < number; ++i ) {
         // Only show items that are initialized
         if( !(*i)->initialized() ) {
@@ -306,33 +580,25 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
         if( d->m_favoriteItemsOnly && !(*i)->isFavorite() ) {
             continue;
         }
-        
-        (*i)->setProjection( viewport );
-        if( (*i)->positions().isEmpty() ) {
+
+        if ( listed.contains( *i ) ) {
             continue;
         }
 
-        if ( list.contains( *i ) ) {
+        (*i)->setProjection( viewport );
+        if( (*i)->positions().isEmpty() ) {
             continue;
         }
 
         // If the item was added initially at a nearer position, they don't have priority,
         // because we zoomed out since then.
-        bool const alreadyDisplayed = d->m_displayedItems.contains( *i );
+        bool const alreadyDisplayed = displayedItems.contains( *i );
         if ( !alreadyDisplayed || (*i)->addedAngularResolution() >= viewport->angularResolution() || (*i)->isSticky() ) {
-            bool collides = false;
-            int const length = list.length();
-            for ( int j=0; !collides && j<length; ++j ) {
-                for( const QRectF &rect: list[j]->boundingRects() ) {
-                    for( const QRectF &itemRect: (*i)->boundingRects() ) {
-                        if ( rect.intersects( itemRect ) )
-                            collides = true;
-                    }
-                }
-            }
-
-            if ( !collides ) {
+            const QVector<QRectF> rects = (*i)->boundingRects();
+            if ( !displayedRects.intersects( rects ) ) {
+                displayedRects.insert( rects );
                 list.append( *i );
+                listed.insert( *i );
                 (*i)->setSettings( d->m_itemSettings );
 
                 // We want to save the angular resolution of the first time the item got added.
@@ -341,7 +607,6 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
                 }
             }
         }
-        // TODO: Do we have to cleanup at some point? The list of all items keeps growing
     }
 
     d->m_lastBox = currentBox;
@@ -409,7 +674,7 @@ void AbstractDataPluginModel::addItemsToList( const QList<AbstractDataPluginItem
         }
 
         // If the item is already in our list, don't add it.
-        if ( d->m_itemSet.contains( item ) ) {
+        if ( d->m_itemIndex.contains( item ) ) {
             continue;
         }
 
@@ -427,9 +692,12 @@ void AbstractDataPluginModel::addItemsToList( const QList<AbstractDataPluginItem
                                                                   lessThanByPointer );
         // Insert the item on the right position in the list
         d->m_itemSet.insert( i, item );
+        d->insertIntoIndex( item );
 
         connect( item, SIGNAL(stickyChanged()), this, SLOT(scheduleItemSort()) );
         connect( item, SIGNAL(destroyed(QObject*)), this, SLOT(removeItem(QObject*)) );
+        connect( item, SIGNAL(updated()), this, SLOT(updateItemIndex()) );
+        connect( item, SIGNAL(idChanged()), this, SLOT(updateItemIndex()) );
         connect( item, SIGNAL(updated()), this, SIGNAL(itemsUpdated()) );
         connect( item, SIGNAL(favoriteChanged(QString,bool)), this,
                  SLOT(favoriteItemChanged(QString,bool)) );
@@ -513,6 +781,16 @@ void AbstractDataPluginModel::favoriteItemChanged( const QString& id, bool isFav
     scheduleItemSort();
 }
 
+void AbstractDataPluginModel::updateItemIndex()
+{
+    // Items changing their coordinate or id need to be sorted into the index again
+    AbstractDataPluginItem *item = static_cast<AbstractDataPluginItem*>( sender() );
+    if ( d->m_itemIndex.contains( item ) ) {
+        d->removeFromIndex( item );
+        d->insertIntoIndex( item );
+    }
+}
+
 void AbstractDataPluginModel::scheduleItemSort()
 {
     d->m_needsSorting = true;
@@ -535,13 +813,7 @@ QString AbstractDataPluginModelPrivate::generateFilepath( const QString& id, con
 
 AbstractDataPluginItem *AbstractDataPluginModel::findItem( const QString& id ) const
 {
-    for ( AbstractDataPluginItem *item: d->m_itemSet ) {
-        if( item->id() == id ) {
-            return item;
-        }
-    }
-    
-    return nullptr;
+    return d->m_itemsById.value( id, nullptr );
 }
 
 bool AbstractDataPluginModel::itemExists( const QString& id ) const
@@ -554,8 +826,20 @@ void AbstractDataPluginModel::setItemSettings(const QHash<QString, QVariant> &it
     d->m_itemSettings = itemSettings;
 }
 
+void AbstractDataPluginModel::setMaximumItemCount( int count )
+{
+    d->m_maximumItemCount = count;
+}
+
+int AbstractDataPluginModel::maximumItemCount() const
+{
+    return d->m_maximumItemCount;
+}
+
 void AbstractDataPluginModel::handleChangedViewport()
 {
+    d->evictItems();
+
     if( d->m_favoriteItemsOnly ) {
         return;
     }
@@ -632,8 +916,13 @@ void AbstractDataPluginModel::processFinishedJob( const QString& relativeUrlStri
 
 void AbstractDataPluginModel::removeItem( QObject *item )
 {
-    AbstractDataPluginItem * pluginItem = qobject_cast<AbstractDataPluginItem*>( item );
-    d->m_itemSet.removeAll( pluginItem );
+    // Called from the destructor of QObject, where qobject_cast does not work anymore
+    AbstractDataPluginItem * pluginItem = static_cast<AbstractDataPluginItem*>( item );
+    if ( d->m_itemIndex.contains( pluginItem ) ) {
+        d->removeFromIndex( pluginItem );
+        d->m_itemSet.removeAll( pluginItem );
+    }
+    d->m_displayedItems.removeAll( pluginItem );
     QHash<QString, AbstractDataPluginItem *>::iterator i;
     for( i = d->m_downloadingItems.begin(); i != d->m_downloadingItems.end(); ++i ) {
         if( *i == pluginItem ) {
@@ -651,6 +940,9 @@ void AbstractDataPluginModel::clear()
         (*iter)->deleteLater();
     }
     d->m_itemSet.clear();
+    d->m_itemIndex.clear();
+    d->m_itemCells.clear();
+    d->m_itemsById.clear();
     d->m_lastBox = GeoDataLatLonAltBox();
     d->m_downloadedBox = GeoDataLatLonAltBox();
     d->m_downloadedNumber = 0;
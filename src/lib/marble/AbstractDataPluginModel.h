@@ -72,6 +72,15 @@ class MARBLE_EXPORT AbstractDataPluginModel : public QObject
      */
     void setItemSettings(const QHash<QString, QVariant> &itemSettings);
 
+    /**
+     * @brief Sets the number of items kept in the model.
+     * If there are more items, the ones far outside of the viewport are removed,
+     * except for favorite, sticky and displayed items. Removed items are
+     * downloaded again when the viewport gets near to them.
+     */
+    void setMaximumItemCount( int count );
+    int maximumItemCount() const;
+
     virtual void setFavoriteItems( const QStringList& list );
     QStringList favoriteItems() const;
 
@@ -167,6 +176,8 @@ public Q_SLOTS:
 
     void favoriteItemChanged( const QString& id, bool isFavorite );
 
+    void updateItemIndex();
+
     void scheduleItemSort();
 
     void themeChanged();
@@ -0,0 +1,302 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+// Own
+#include "CacheIndex.h"
+
+// Qt
+#include <QSaveFile>
+
+// Marble
+#include "MarbleDebug.h"
+
+using namespace Marble;
+
+static const quint32 journalMagic = 0x4d434958; // "MCIX"
+static const qint32 journalVersion = 1;
+
+// The journal is rewritten once superseded records dominate it
+static const int minimumRecordsToCompact = 1024;
+
+CacheIndex::CacheIndex( const QString &journalFileName )
+    : m_oldest( nullptr ),
+      m_newest( nullptr ),
+      m_totalSize( 0 ),
+      m_journal( journalFileName ),
+      m_journalRecords( 0 )
+{
+}
+
+CacheIndex::~CacheIndex()
+{
+    flush();
+    m_stream.setDevice( nullptr );
+    m_journal.close();
+    deleteEntries();
+}
+
+bool CacheIndex::load()
+{
+    deleteEntries();
+    m_stream.setDevice( nullptr );
+    m_journal.close();
+
+    if ( !m_journal.exists() || !m_journal.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    QDataStream stream( &m_journal );
+    stream.setVersion( QDataStream::Qt_5_0 );
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    stream >> magic >> version;
+    if ( magic != journalMagic || version != journalVersion ) {
+        mDebug() << "Discarding cache index" << m_journal.fileName();
+        m_journal.close();
+        return false;
+    }
+
+    int records = 0;
+    bool truncated = false;
+    while ( !stream.atEnd() ) {
+        quint8 operation = 0;
+        QString fileName;
+        quint64 size = 0;
+        stream >> operation >> fileName;
+        if ( operation == Insert ) {
+            stream >> size;
+        }
+        if ( stream.status() != QDataStream::Ok ) {
+            // the last record has only been written partially
+            truncated = true;
+            break;
+        }
+
+        switch ( operation ) {
+        case Insert:
+            insertEntry( fileName, size );
+            break;
+        case Touch:
+            touchEntry( fileName );
+            break;
+        case Remove:
+            removeEntry( fileName );
+            break;
+        }
+        ++records;
+    }
+
+    m_journal.close();
+
+    m_journalRecords = records;
+    if ( truncated || m_journalRecords > 2 * count() + minimumRecordsToCompact ) {
+        compact();
+    } else {
+        openJournal( QIODevice::WriteOnly | QIODevice::Append );
+    }
+
+    return true;
+}
+
+void CacheIndex::insert( const QString &fileName, quint64 size )
+{
+    insertEntry( fileName, size );
+    appendRecord( Insert, fileName, size );
+}
+
+void CacheIndex::touch( const QString &fileName )
+{
+    Entry *const entry = m_entries.value( fileName, nullptr );
+    if ( !entry || entry == m_newest ) {
+        return;
+    }
+
+    touchEntry( fileName );
+    appendRecord( Touch, fileName );
+}
+
+void CacheIndex::remove( const QString &fileName )
+{
+    if ( !m_entries.contains( fileName ) ) {
+        return;
+    }
+
+    removeEntry( fileName );
+    appendRecord( Remove, fileName );
+}
+
+void CacheIndex::clear()
+{
+    deleteEntries();
+    openJournal( QIODevice::WriteOnly | QIODevice::Truncate );
+}
+
+bool CacheIndex::contains( const QString &fileName ) const
+{
+    return m_entries.contains( fileName );
+}
+
+quint64 CacheIndex::size( const QString &fileName ) const
+{
+    const Entry *const entry = m_entries.value( fileName, nullptr );
+    return entry ? entry->size : 0;
+}
+
+QString CacheIndex::oldest() const
+{
+    return m_oldest ? m_oldest->fileName : QString();
+}
+
+int CacheIndex::count() const
+{
+    return m_entries.count();
+}
+
+quint64 CacheIndex::totalSize() const
+{
+    return m_totalSize;
+}
+
+void CacheIndex::flush()
+{
+    if ( m_journal.isOpen() ) {
+        m_journal.flush();
+    }
+}
+
+void CacheIndex::compact()
+{
+    m_stream.setDevice( nullptr );
+    m_journal.close();
+
+    QSaveFile file( m_journal.fileName() );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << "Unable to write cache index" << file.fileName();
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_0 );
+    stream << journalMagic << journalVersion;
+    for ( const Entry *entry = m_oldest; entry; entry = entry->newer ) {
+        stream << quint8( Insert ) << entry->fileName << entry->size;
+    }
+
+    if ( !file.commit() ) {
+        mDebug() << "Unable to write cache index" << file.fileName();
+    }
+
+    m_journalRecords = count();
+    openJournal( QIODevice::WriteOnly | QIODevice::Append );
+}
+
+void CacheIndex::link( Entry *entry )
+{
+    entry->older = m_newest;
+    entry->newer = nullptr;
+    if ( m_newest ) {
+        m_newest->newer = entry;
+    } else {
+        m_oldest = entry;
+    }
+    m_newest = entry;
+}
+
+void CacheIndex::unlink( Entry *entry )
+{
+    if ( entry->older ) {
+        entry->older->newer = entry->newer;
+    } else {
+        m_oldest = entry->newer;
+    }
+    if ( entry->newer ) {
+        entry->newer->older = entry->older;
+    } else {
+        m_newest = entry->older;
+    }
+}
+
+void CacheIndex::deleteEntries()
+{
+    qDeleteAll( m_entries );
+    m_entries.clear();
+    m_oldest = nullptr;
+    m_newest = nullptr;
+    m_totalSize = 0;
+    m_journalRecords = 0;
+}
+
+void CacheIndex::insertEntry( const QString &fileName, quint64 size )
+{
+    Entry *entry = m_entries.value( fileName, nullptr );
+    if ( entry ) {
+        m_totalSize -= entry->size;
+        unlink( entry );
+    } else {
+        entry = new Entry;
+        entry->fileName = fileName;
+        m_entries.insert( fileName, entry );
+    }
+
+    entry->size = size;
+    m_totalSize += size;
+    link( entry );
+}
+
+void CacheIndex::touchEntry( const QString &fileName )
+{
+    Entry *const entry = m_entries.value( fileName, nullptr );
+    if ( entry ) {
+        unlink( entry );
+        link( entry );
+    }
+}
+
+void CacheIndex::removeEntry( const QString &fileName )
+{
+    Entry *const entry = m_entries.take( fileName );
+    if ( entry ) {
+        m_totalSize -= entry->size;
+        unlink( entry );
+        delete entry;
+    }
+}
+
+bool CacheIndex::openJournal( QIODevice::OpenMode mode )
+{
+    m_stream.setDevice( nullptr );
+    m_journal.close();
+
+    if ( !m_journal.open( mode ) ) {
+        mDebug() << "Unable to open cache index" << m_journal.fileName() << m_journal.errorString();
+        return false;
+    }
+
+    m_stream.setDevice( &m_journal );
+    m_stream.setVersion( QDataStream::Qt_5_0 );
+    if ( m_journal.size() == 0 ) {
+        m_stream << journalMagic << journalVersion;
+    }
+
+    return true;
+}
+
+void CacheIndex::appendRecord( Operation operation, const QString &fileName, quint64 size )
+{
+    if ( !m_journal.isOpen() ) {
+        return;
+    }
+
+    m_stream << quint8( operation ) << fileName;
+    if ( operation == Insert ) {
+        m_stream << size;
+    }
+
+    ++m_journalRecords;
+    if ( m_journalRecords > 2 * count() + minimumRecordsToCompact ) {
+        compact();
+    }
+}
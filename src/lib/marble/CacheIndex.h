@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_CACHEINDEX_H
+#define MARBLE_CACHEINDEX_H
+
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QString>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+/**
+ * @short Persistent index of the files in a disc cache.
+ *
+ * The index keeps the size of each cached file and orders the files by their
+ * last access, so the least recently used file can be found in constant time.
+ * Changes are appended to a journal file, which is replayed by load() and
+ * rewritten from time to time to drop superseded records.
+ *
+ * Changes are journaled once the journal has been loaded successfully or has
+ * been written by compact(), so an index which is rebuilt from scratch only
+ * becomes persistent when it is complete.
+ *
+ * File names are used as opaque keys, usually they are given relative to the
+ * cache directory. The class is not thread-safe.
+ */
+class MARBLE_EXPORT CacheIndex
+{
+ public:
+    explicit CacheIndex( const QString &journalFileName );
+    ~CacheIndex();
+
+    /**
+     * @brief Replays the journal.
+     * @return false if there is no valid journal, the index is empty then and
+     *         changes are not journaled until compact() is called.
+     */
+    bool load();
+
+    /**
+     * @brief Adds or updates @p fileName, which becomes the most recently used file.
+     */
+    void insert( const QString &fileName, quint64 size );
+
+    /**
+     * @brief Marks @p fileName as the most recently used file. Unknown files are ignored.
+     */
+    void touch( const QString &fileName );
+
+    void remove( const QString &fileName );
+
+    /**
+     * @brief Removes all entries and truncates the journal.
+     */
+    void clear();
+
+    bool contains( const QString &fileName ) const;
+
+    /**
+     * @brief Returns the size of @p fileName, or 0 if it is not indexed.
+     */
+    quint64 size( const QString &fileName ) const;
+
+    /**
+     * @brief Returns the least recently used file, or an empty string if the index is empty.
+     */
+    QString oldest() const;
+
+    int count() const;
+
+    /**
+     * @brief Returns the sum of the sizes of all indexed files.
+     */
+    quint64 totalSize() const;
+
+    /**
+     * @brief Writes buffered journal records to disc.
+     */
+    void flush();
+
+    /**
+     * @brief Rewrites the journal with one record per indexed file.
+     */
+    void compact();
+
+ private:
+    Q_DISABLE_COPY( CacheIndex )
+
+    enum Operation {
+        Insert = 1,
+        Touch,
+        Remove
+    };
+
+    struct Entry {
+        QString fileName;
+        quint64 size;
+        Entry *older;
+        Entry *newer;
+    };
+
+    void link( Entry *entry );
+    void unlink( Entry *entry );
+    void deleteEntries();
+
+    void insertEntry( const QString &fileName, quint64 size );
+    void touchEntry( const QString &fileName );
+    void removeEntry( const QString &fileName );
+
+    bool openJournal( QIODevice::OpenMode mode );
+    void appendRecord( Operation operation, const QString &fileName, quint64 size = 0 );
+
+    QHash<QString, Entry *> m_entries;
+    Entry *m_oldest;
+    Entry *m_newest;
+    quint64 m_totalSize;
+
+    QFile m_journal;
+    QDataStream m_stream;
+    int m_journalRecords;
+};
+
+}
+
+#endif
@@ -69,6 +69,23 @@ class ClipPainterPrivate
                                 const QPointF& point,
                                 bool isClosed ) const;
 
+    // The fast path: returns the polygon itself if it is inside the clip
+    // rect, the clipped polygon or nullptr if nothing of it is visible.
+    const QPolygonF * clipPolygon( const QPolygonF & polygon );
+
+    // Splits the polyline into the visible pieces which end at the
+    // indices of m_clipPieceEnds in the returned points.
+    const QPointF * clipPolyline( const QPolygonF & polyline );
+
+    template<class Edge>
+    static inline void clipPolygonEdge( const QPolygonF & source, QPolygonF & target,
+                                        const Edge & edge );
+    inline bool clipSegment( const QPointF & start, const QPointF & end,
+                             qreal & t0, qreal & t1 ) const;
+
+    void drawClippedPolygon( const QPolygonF & polygon, Qt::FillRule fillRule );
+    void drawClippedPolyline( const QPointF * points, int count );
+
 
     void labelPosition(const QPolygonF &polygon, QVector<QPointF> &labelNodes,
                                 LabelPositionFlags labelPositionFlags) const;
@@ -88,6 +105,12 @@ class ClipPainterPrivate
     int m_debugBrushBatchColor;
     int m_debugPolygonsLevel;
     bool m_debugBatchRender;
+
+    ClipPainter::ClipAlgorithm m_clipAlgorithm;
+
+    // Reused between the calls to avoid allocations while clipping
+    QPolygonF m_clipBuffer[2];
+    QVector<int> m_clipPieceEnds;
 };
 
 }
@@ -130,10 +153,29 @@ bool ClipPainter::hasScreenClip() const
 }
 
 
+void ClipPainter::setClipAlgorithm( ClipAlgorithm algorithm )
+{
+    d->m_clipAlgorithm = algorithm;
+}
+
+
+ClipPainter::ClipAlgorithm ClipPainter::clipAlgorithm() const
+{
+    return d->m_clipAlgorithm;
+}
+
+
 void ClipPainter::drawPolygon ( const QPolygonF & polygon,
                                 Qt::FillRule fillRule )
 {
-    if ( d->m_doClip ) {	
+    if ( d->m_doClip && d->m_clipAlgorithm == FastClipping ) {
+        d->initClipRect();
+        const QPolygonF * clippedPolygon = d->clipPolygon( polygon );
+        if ( clippedPolygon && clippedPolygon->size() > 2 ) {
+            d->drawClippedPolygon( *clippedPolygon, fillRule );
+        }
+    }
+    else if ( d->m_doClip ) {	
         d->initClipRect();
         QVector<QPolygonF> clippedPolyObjects;
 
@@ -185,7 +227,16 @@ void ClipPainter::drawPolygon ( const QPolygonF & polygon,
 
 void ClipPainter::drawPolyline( const QPolygonF & polygon )
 {
-    if ( d->m_doClip ) {
+    if ( d->m_doClip && d->m_clipAlgorithm == FastClipping ) {
+        d->initClipRect();
+        const QPointF * points = d->clipPolyline( polygon );
+        int start = 0;
+        for ( int end: d->m_clipPieceEnds ) {
+            d->drawClippedPolyline( points + start, end - start );
+            start = end;
+        }
+    }
+    else if ( d->m_doClip ) {
         d->initClipRect();
         QVector<QPolygonF> clippedPolyObjects;
 
@@ -237,7 +288,16 @@ void ClipPainter::drawPolyline( const QPolygonF & polygon )
 void ClipPainter::drawPolyline(const QPolygonF & polygon, QVector<QPointF>& labelNodes,
                                LabelPositionFlags positionFlags)
 {
-    if ( d->m_doClip ) {
+    if ( d->m_doClip && d->m_clipAlgorithm == FastClipping ) {
+        d->initClipRect();
+        const QPointF * points = d->clipPolyline( polygon );
+        int start = 0;
+        for ( int end: d->m_clipPieceEnds ) {
+            d->drawClippedPolyline( points + start, end - start );
+            start = end;
+        }
+    }
+    else if ( d->m_doClip ) {
         d->initClipRect();
         QVector<QPolygonF> clippedPolyObjects;
 
@@ -462,7 +522,8 @@ ClipPainterPrivate::ClipPainterPrivate( ClipPainter * parent )
       m_debugPenBatchColor(0),
       m_debugBrushBatchColor(0),
       m_debugPolygonsLevel(0),
-      m_debugBatchRender(false)
+      m_debugBatchRender(false),
+      m_clipAlgorithm(ClipPainter::FastClipping)
 {
     q = parent;
 }
@@ -1223,6 +1284,249 @@ void ClipPainterPrivate::clipOnce( QPolygonF & clippedPolyObject,
 
 }
 
+namespace
+{
+
+// One of the four edges of the clip rect for the Sutherland-Hodgman
+// algorithm: Vertical edges limit the x coordinate, horizontal ones the y
+// coordinate, from below (Minimum) or from above.
+template<bool Vertical, bool Minimum>
+class ClipEdge
+{
+ public:
+    explicit ClipEdge( qreal value ) : m_value( value ) {}
+
+    bool inside( const QPointF & point ) const
+    {
+        const qreal coordinate = Vertical ? point.x() : point.y();
+        return Minimum ? coordinate >= m_value : coordinate <= m_value;
+    }
+
+    // Only called for points on different sides of the edge
+    QPointF intersection( const QPointF & start, const QPointF & end ) const
+    {
+        if ( Vertical ) {
+            const qreal t = ( m_value - start.x() ) / ( end.x() - start.x() );
+            return QPointF( m_value, start.y() + t * ( end.y() - start.y() ) );
+        }
+        const qreal t = ( m_value - start.y() ) / ( end.y() - start.y() );
+        return QPointF( start.x() + t * ( end.x() - start.x() ), m_value );
+    }
+
+ private:
+    const qreal m_value;
+};
+
+}
+
+template<class Edge>
+void ClipPainterPrivate::clipPolygonEdge( const QPolygonF & source, QPolygonF & target,
+                                          const Edge & edge )
+{
+    // keeps the capacity of the buffer
+    target.clear();
+    if ( source.isEmpty() ) {
+        return;
+    }
+
+    const QPointF * const points = source.constData();
+    const int size = source.size();
+    QPointF previousPoint = points[size - 1];
+    bool previousInside = edge.inside( previousPoint );
+    for ( int i = 0; i < size; ++i ) {
+        const QPointF & currentPoint = points[i];
+        const bool currentInside = edge.inside( currentPoint );
+        if ( currentInside != previousInside ) {
+            target.append( edge.intersection( previousPoint, currentPoint ) );
+        }
+        if ( currentInside ) {
+            target.append( currentPoint );
+        }
+        previousPoint = currentPoint;
+        previousInside = currentInside;
+    }
+}
+
+const QPolygonF * ClipPainterPrivate::clipPolygon( const QPolygonF & polygon )
+{
+    const QRectF bounds = polygon.boundingRect();
+    if ( bounds.left() >= m_left && bounds.right() <= m_right
+         && bounds.top() >= m_top && bounds.bottom() <= m_bottom ) {
+        return &polygon;
+    }
+    if ( bounds.right() < m_left || bounds.left() > m_right
+         || bounds.bottom() < m_top || bounds.top() > m_bottom ) {
+        return nullptr;
+    }
+
+    // Clip against the edges the polygon crosses only. The edges alternate
+    // between the two buffers and each one adds at most a few nodes.
+    m_clipBuffer[0].reserve( polygon.size() + 8 );
+    m_clipBuffer[1].reserve( polygon.size() + 8 );
+    const QPolygonF * source = &polygon;
+    int target = 0;
+    if ( bounds.left() < m_left ) {
+        clipPolygonEdge( *source, m_clipBuffer[target], ClipEdge<true, true>( m_left ) );
+        source = &m_clipBuffer[target];
+        target = 1 - target;
+    }
+    if ( bounds.right() > m_right ) {
+        clipPolygonEdge( *source, m_clipBuffer[target], ClipEdge<true, false>( m_right ) );
+        source = &m_clipBuffer[target];
+        target = 1 - target;
+    }
+    if ( bounds.top() < m_top ) {
+        clipPolygonEdge( *source, m_clipBuffer[target], ClipEdge<false, true>( m_top ) );
+        source = &m_clipBuffer[target];
+        target = 1 - target;
+    }
+    if ( bounds.bottom() > m_bottom ) {
+        clipPolygonEdge( *source, m_clipBuffer[target], ClipEdge<false, false>( m_bottom ) );
+        source = &m_clipBuffer[target];
+    }
+
+    return source->isEmpty() ? nullptr : source;
+}
+
+bool ClipPainterPrivate::clipSegment( const QPointF & start, const QPointF & end,
+                                      qreal & t0, qreal & t1 ) const
+{
+    // Liang-Barsky: narrow the parameter range [t0, t1] of the segment
+    // by each of the four edges of the clip rect
+    const qreal dx = end.x() - start.x();
+    const qreal dy = end.y() - start.y();
+    const qreal p[4] = { -dx, dx, -dy, dy };
+    const qreal q[4] = { start.x() - m_left, m_right - start.x(),
+                         start.y() - m_top, m_bottom - start.y() };
+
+    t0 = 0.0;
+    t1 = 1.0;
+    for ( int i = 0; i < 4; ++i ) {
+        if ( p[i] == 0.0 ) {
+            // parallel to the edge
+            if ( q[i] < 0.0 ) {
+                return false;
+            }
+            continue;
+        }
+        const qreal r = q[i] / p[i];
+        if ( p[i] < 0.0 ) {
+            if ( r > t1 ) {
+                return false;
+            }
+            t0 = qMax( t0, r );
+        }
+        else {
+            if ( r < t0 ) {
+                return false;
+            }
+            t1 = qMin( t1, r );
+        }
+    }
+    return true;
+}
+
+const QPointF * ClipPainterPrivate::clipPolyline( const QPolygonF & polyline )
+{
+    m_clipPieceEnds.clear();
+    if ( polyline.size() < 2 ) {
+        return polyline.constData();
+    }
+
+    const QRectF bounds = polyline.boundingRect();
+    if ( bounds.left() >= m_left && bounds.right() <= m_right
+         && bounds.top() >= m_top && bounds.bottom() <= m_bottom ) {
+        m_clipPieceEnds.append( polyline.size() );
+        return polyline.constData();
+    }
+    if ( bounds.right() < m_left || bounds.left() > m_right
+         || bounds.bottom() < m_top || bounds.top() > m_bottom ) {
+        return polyline.constData();
+    }
+
+    QPolygonF & buffer = m_clipBuffer[0];
+    buffer.clear();
+    buffer.reserve( polyline.size() + 8 );
+
+    const QPointF * const points = polyline.constData();
+    const int size = polyline.size();
+    int pieceStart = 0;
+    for ( int i = 1; i < size; ++i ) {
+        const QPointF & start = points[i - 1];
+        const QPointF & end = points[i];
+        qreal t0;
+        qreal t1;
+        if ( !clipSegment( start, end, t0, t1 ) ) {
+            continue;
+        }
+
+        const QPointF direction = end - start;
+        if ( buffer.size() == pieceStart ) {
+            buffer.append( t0 > 0.0 ? start + t0 * direction : start );
+        }
+        buffer.append( t1 < 1.0 ? start + t1 * direction : end );
+
+        // the polyline leaves the clip rect: the next visible segment
+        // starts a new piece
+        if ( t1 < 1.0 ) {
+            m_clipPieceEnds.append( buffer.size() );
+            pieceStart = buffer.size();
+        }
+    }
+    if ( buffer.size() > pieceStart ) {
+        m_clipPieceEnds.append( buffer.size() );
+    }
+
+    return buffer.constData();
+}
+
+void ClipPainterPrivate::drawClippedPolygon( const QPolygonF & polygon, Qt::FillRule fillRule )
+{
+    if ( m_debugPolygonsLevel ) {
+        QBrush brush = q->brush();
+        QBrush originalBrush = brush;
+        QColor color = brush.color();
+        color.setAlpha(color.alpha()*0.75);
+        brush.setColor(color);
+        q->QPainter::setBrush(brush);
+
+        q->QPainter::drawPolygon( polygon, fillRule );
+
+        q->QPainter::setBrush(originalBrush);
+
+        debugDrawNodes( polygon );
+    }
+    else {
+        q->QPainter::drawPolygon( polygon, fillRule );
+    }
+}
+
+void ClipPainterPrivate::drawClippedPolyline( const QPointF * points, int count )
+{
+    if ( m_debugPolygonsLevel ) {
+        QPen pen = q->pen();
+        QPen originalPen = pen;
+        QColor color = pen.color();
+        color.setAlpha(color.alpha()*0.75);
+        pen.setColor(color);
+        q->QPainter::setPen(pen);
+
+        q->QPainter::drawPolyline( points, count );
+
+        q->QPainter::setPen(originalPen);
+
+        QPolygonF polyline;
+        polyline.reserve( count );
+        for ( int i = 0; i < count; ++i ) {
+            polyline << points[i];
+        }
+        debugDrawNodes( polyline );
+    }
+    else {
+        q->QPainter::drawPolyline( points, count );
+    }
+}
+
 void ClipPainter::setDebugPolygonsLevel( int level ) {
     d->m_debugPolygonsLevel = level;
 }
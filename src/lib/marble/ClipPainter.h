@@ -27,6 +27,11 @@ namespace Marble
  * To keep things fast each possible scenario of two subsequent 
  * points is implemented case by case in a specialized handler which
  * creates interpolated points and helper points.
+ *
+ * By default a faster path is used instead: polygons are clipped with
+ * the Sutherland-Hodgman algorithm and polylines with the Liang-Barsky
+ * algorithm. Objects that are completely on or off the screen are
+ * detected from their bounding rectangle and skip the clipping.
  */
 
 // The reason for this class is a terrible bug in some versions of the
@@ -45,6 +50,14 @@ class ClipPainterPrivate;
 class MARBLE_EXPORT ClipPainter : public QPainter 
 {
  public:
+    /**
+     * The algorithm used to clip polygons and polylines to the viewport.
+     */
+    enum ClipAlgorithm {
+        SectorClipping,  ///< The sector based clipping, kept for comparison
+        FastClipping     ///< Sutherland-Hodgman and Liang-Barsky clipping
+    };
+
     ClipPainter();
     ClipPainter(QPaintDevice*, bool);
 
@@ -53,6 +66,9 @@ class MARBLE_EXPORT ClipPainter : public QPainter
     void setScreenClip( bool enable );
     bool hasScreenClip() const;
 
+    void setClipAlgorithm( ClipAlgorithm algorithm );
+    ClipAlgorithm clipAlgorithm() const;
+
     void drawPolygon( const QPolygonF &, 
                       Qt::FillRule fillRule = Qt::OddEvenFill );
 
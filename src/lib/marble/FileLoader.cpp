@@ -7,11 +7,16 @@
 
 #include <QBuffer>
 #include <QDataStream>
+#include <QEventLoop>
 #include <QFile>
+#include <QMutex>
+#include <QSemaphore>
 
 #include "GeoDataParser.h"
 #include "GeoDataFolder.h"
 #include "GeoDataGroundOverlay.h"
+#include "GeoDataLinearRing.h"
+#include "GeoDataMultiGeometry.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataData.h"
 #include "GeoDataExtendedData.h"
@@ -40,7 +45,7 @@ public:
     FileLoaderPrivate( FileLoader* parent, const PluginManager *pluginManager, bool recenter,
                        const QString &file, const QString &property, const GeoDataStyle::Ptr &style, DocumentRole role, int renderOrder) :
         q(parent),
-        m_runner(pluginManager),
+        m_pluginManager(pluginManager),
         m_filepath (file),
         m_property(property),
         m_style(style),
@@ -48,7 +53,8 @@ public:
         m_document(nullptr),
         m_renderOrder(renderOrder),
         m_documentRole(role),
-        m_recenter(recenter)
+        m_recenter(recenter),
+        m_chunkCredits(MaximumPendingChunks)
     {
         if( m_style ) {
             m_styleMap->setId(QStringLiteral("default-map"));
@@ -59,13 +65,14 @@ public:
     FileLoaderPrivate( FileLoader* parent, const PluginManager *pluginManager,
                        const QString &contents, const QString &file, DocumentRole role) :
         q(parent),
-        m_runner(pluginManager),
+        m_pluginManager(pluginManager),
         m_filepath(file),
         m_contents(contents),
         m_styleMap(nullptr),
         m_document(nullptr),
         m_documentRole(role),
-        m_recenter(false)
+        m_recenter(false),
+        m_chunkCredits(MaximumPendingChunks)
     {
     }
 
@@ -75,14 +82,22 @@ public:
     }
 
     void createFilterProperties( GeoDataContainer *container );
+    static void updateSignificance( const GeoDataGeometry *geometry );
     static int cityPopIdx( qint64 population );
     static int spacePopIdx( qint64 population );
     static int areaPopIdx( qreal area );
 
     void documentParsed( GeoDataDocument *doc, const QString& error);
+    void featuresParsed( GeoDataDocument *chunk );
+    void processDocument( GeoDataDocument *document );
+
+    // Large KML files are streamed in chunks of this many top level features
+    static const int ChunkSize = 1000;
+    static const int MaximumPendingChunks = 4;
 
     FileLoader *q;
-    ParsingRunnerManager m_runner;
+    const PluginManager *const m_pluginManager;
+    QMutex m_parsingMutex;
     QString m_filepath;
     QString m_contents;
     QString m_property;
@@ -93,6 +108,8 @@ public:
     int m_renderOrder;
     DocumentRole m_documentRole;
     bool m_recenter;
+    QSemaphore m_chunkCredits;
+    QAtomicInt m_discardChunks;
 };
 
 FileLoader::FileLoader( QObject* parent, const PluginManager *pluginManager, bool recenter, const QString& file,
@@ -129,6 +146,18 @@ QString FileLoader::error() const
     return d->m_error;
 }
 
+void FileLoader::releaseChunk()
+{
+    d->m_chunkCredits.release();
+}
+
+void FileLoader::discardChunks()
+{
+    d->m_discardChunks.storeRelease( 1 );
+    // wake up a runner waiting for the file manager
+    d->m_chunkCredits.release();
+}
+
 void FileLoader::run()
 {
     if ( d->m_contents.isEmpty() ) {
@@ -166,13 +195,30 @@ void FileLoader::run()
             mDebug() << "No recent Default Placemark Cache File available!";
 
             // use runners: pnt, gpx, osm
-            connect( &d->m_runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
-                    this, SLOT(documentParsed(GeoDataDocument*,QString)) );
-            d->m_runner.parseFile( defaultSourceName, d->m_documentRole );
+            // The runner manager lives in this thread and the parsed document is
+            // post-processed here as well, so that neither the parsing results
+            // nor createFilterProperties() queue up on the GUI thread.
+            ParsingRunnerManager runner( d->m_pluginManager );
+            runner.setChunkSize( FileLoaderPrivate::ChunkSize );
+            QEventLoop localEventLoop;
+            connect( &runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
+                     this, SLOT(documentParsed(GeoDataDocument*,QString)), Qt::DirectConnection );
+            connect( &runner, SIGNAL(featuresParsed(GeoDataDocument*)),
+                     this, SLOT(featuresParsed(GeoDataDocument*)), Qt::DirectConnection );
+            connect( &runner, SIGNAL(parsingFinished()),
+                     &localEventLoop, SLOT(quit()), Qt::QueuedConnection );
+            runner.parseFile( defaultSourceName, d->m_documentRole );
+            localEventLoop.exec();
+
+            if ( d->m_document ) {
+                d->processDocument( d->m_document );
+                emit newGeoDataDocumentAdded( d->m_document );
+            }
         }
         else {
             mDebug() << "No Default Placemark Source File for " << name;
         }
+        emit loaderFinished( this );
     // content is not empty, we load from data
     } else {
         // Read the KML Data
@@ -212,27 +258,66 @@ bool FileLoader::recenter() const
 
 void FileLoaderPrivate::documentParsed( GeoDataDocument* doc, const QString& error )
 {
+    QMutexLocker locker( &m_parsingMutex );
     m_error = error;
     if ( doc ) {
         m_document = doc;
-        doc->setProperty( m_property );
-        if( m_style ) {
-            doc->addStyleMap( *m_styleMap );
-            doc->addStyle( m_style );
-        }
+    }
+}
 
-        if (m_renderOrder != 0) {
-            for (GeoDataPlacemark* placemark: doc->placemarkList()) {
-                if (GeoDataPolygon *polygon = geodata_cast<GeoDataPolygon>(placemark->geometry())) {
-                    polygon->setRenderOrder(m_renderOrder);
-                }
+void FileLoaderPrivate::featuresParsed( GeoDataDocument *chunk )
+{
+    // Called from the thread of the parsing runner, which pauses here
+    // while the file manager lags behind
+    if ( !m_discardChunks.loadAcquire() ) {
+        m_chunkCredits.acquire();
+    }
+    if ( m_discardChunks.loadAcquire() ) {
+        m_chunkCredits.release();
+        delete chunk;
+        return;
+    }
+
+    processDocument( chunk );
+    emit q->featuresLoaded( q, chunk );
+}
+
+void FileLoaderPrivate::processDocument( GeoDataDocument *document )
+{
+    document->setProperty( m_property );
+    if( m_style ) {
+        document->addStyleMap( *m_styleMap );
+        document->addStyle( m_style );
+    }
+
+    if (m_renderOrder != 0) {
+        for (GeoDataPlacemark* placemark: document->placemarkList()) {
+            if (GeoDataPolygon *polygon = geodata_cast<GeoDataPolygon>(placemark->geometry())) {
+                polygon->setRenderOrder(m_renderOrder);
             }
         }
+    }
+
+    createFilterProperties( document );
+}
 
-        createFilterProperties( doc );
-        emit q->newGeoDataDocumentAdded( m_document );
+void FileLoaderPrivate::updateSignificance( const GeoDataGeometry *geometry )
+{
+    // Simplify long line strings in the loader thread rather than when they are drawn first
+    if ( auto lineString = dynamic_cast<const GeoDataLineString *>( geometry ) ) {
+        lineString->updateSignificance();
+    } else if ( auto polygon = dynamic_cast<const GeoDataPolygon *>( geometry ) ) {
+        polygon->outerBoundary().updateSignificance();
+        for ( const GeoDataLinearRing &ring: polygon->innerBoundaries() ) {
+            ring.updateSignificance();
+        }
+    } else if ( auto track = geodata_cast<GeoDataTrack>( geometry ) ) {
+        track->lineString()->updateSignificance();
+    } else if ( auto multiGeometry = geodata_cast<GeoDataMultiGeometry>( geometry ) ) {
+        for ( int i = 0; i < multiGeometry->size(); ++i ) {
+            updateSignificance( &multiGeometry->at( i ) );
+        }
     }
-    emit q->loaderFinished( q );
 }
 
 void FileLoaderPrivate::createFilterProperties( GeoDataContainer *container )
@@ -253,6 +338,7 @@ void FileLoaderPrivate::createFilterProperties( GeoDataContainer *container )
         } else if (auto placemark = geodata_cast<GeoDataPlacemark>(*i)) {
             const QString placemarkRole = placemark->role();
             Q_ASSERT( placemark->geometry() );
+            updateSignificance( placemark->geometry() );
 
             bool hasPopularity = false;
 
@@ -33,12 +33,31 @@ class FileLoader : public QThread
         GeoDataDocument *document();
         QString error() const;
 
+        /**
+         * Tells the loader that a chunk of featuresLoaded() has been consumed.
+         * Parsing pauses while too many chunks are waiting to be consumed.
+         */
+        void releaseChunk();
+
+        /**
+         * Drops all further chunks, e.g. because the file is closed while loading.
+         */
+        void discardChunks();
+
     Q_SIGNALS:
         void loaderFinished( FileLoader* );
         void newGeoDataDocumentAdded( GeoDataDocument* );
 
+        /**
+         * Completed top level features of a large file that is still being
+         * loaded. The features are not part of document(). Ownership of
+         * @p chunk passes to the receiver, which has to call releaseChunk().
+         */
+        void featuresLoaded( FileLoader*, GeoDataDocument *chunk );
+
 private:
         Q_PRIVATE_SLOT ( d, void documentParsed( GeoDataDocument *, QString) )
+        Q_PRIVATE_SLOT ( d, void featuresParsed( GeoDataDocument * ) )
 
         friend class FileLoaderPrivate;
 
@@ -8,6 +8,8 @@
 
 #include <QFileInfo>
 #include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
 
 #include "FileLoader.h"
 #include "MarbleDebug.h"
@@ -15,7 +17,9 @@
 #include "GeoDataTreeModel.h"
 
 #include "GeoDataLatLonAltBox.h"
+#include "GeoDataSchema.h"
 #include "GeoDataStyle.h"
+#include "GeoDataStyleMap.h"
 
 
 using namespace Marble;
@@ -28,31 +32,52 @@ public:
     FileManagerPrivate( GeoDataTreeModel *treeModel, const PluginManager *pluginManager, FileManager* parent ) :
         q( parent ),
         m_treeModel( treeModel ),
-        m_pluginManager( pluginManager )
+        m_pluginManager( pluginManager ),
+        m_maximumLoaderCount( qMax( 1, QThread::idealThreadCount() ) )
     {
+        // Documents of loaders that finish within this interval are added
+        // to the tree model together
+        m_batchTimer.setSingleShot( true );
+        m_batchTimer.setInterval( 100 );
     }
 
     ~FileManagerPrivate()
     {
         for ( FileLoader *loader: m_loaderList ) {
             if ( loader ) {
+                loader->discardChunks();
                 loader->wait();
             }
         }
+        for ( FileLoader *loader: m_finishedLoaders ) {
+            delete loader->document();
+        }
     }
 
+    bool isLoading( const QString &path ) const;
     void appendLoader( FileLoader *loader );
+    void startLoaders();
     void closeFile( const QString &key );
     void cleanupLoader( FileLoader *loader );
+    void addFinishedDocuments();
+    void addLoadedFeatures( FileLoader *loader, GeoDataDocument *chunk );
+    void mergeDocument( GeoDataDocument *document, GeoDataDocument *other );
+    void mergeRootProperties( GeoDataDocument *document, const GeoDataDocument *root );
+    static void setDocumentName( GeoDataDocument *document );
 
     FileManager *const q;
     GeoDataTreeModel *const m_treeModel;
     const PluginManager *const m_pluginManager;
 
-    QList<FileLoader*> m_loaderList;
+    QList<FileLoader*> m_loaderList;      // running loaders
+    QList<FileLoader*> m_queuedLoaders;   // loaders waiting for a free slot
+    QList<FileLoader*> m_finishedLoaders; // loaders whose document waits for the next batch
+    QHash<FileLoader*, GeoDataDocument*> m_streamedDocuments; // documents of files still being loaded
     QHash < QString, GeoDataDocument* > m_fileItemHash;
     GeoDataLatLonBox m_latLonBox;
     QElapsedTimer m_timer;
+    QTimer m_batchTimer;
+    int m_maximumLoaderCount;
 };
 }
 
@@ -60,6 +85,8 @@ FileManager::FileManager( GeoDataTreeModel *treeModel, const PluginManager *plug
     : QObject( parent )
     , d( new FileManagerPrivate( treeModel, pluginManager, this ) )
 {
+    connect( &d->m_batchTimer, SIGNAL(timeout()),
+             this, SLOT(addFinishedDocuments()) );
 }
 
 
@@ -74,9 +101,8 @@ void FileManager::addFile( const QString& filepath, const QString& property, con
             return;  // already loaded
     }
 
-    for ( const FileLoader *loader: d->m_loaderList ) {
-        if ( loader->path() == filepath )
-            return;  // currently loading
+    if ( d->isLoading( filepath ) ) {
+        return;  // currently loading
     }
 
     mDebug() << "adding container:" << filepath;
@@ -92,23 +118,74 @@ void FileManager::addData( const QString &name, const QString &data, DocumentRol
     d->appendLoader( loader );
 }
 
+bool FileManagerPrivate::isLoading( const QString &path ) const
+{
+    for ( const QList<FileLoader*> *loaders: { &m_loaderList, &m_queuedLoaders, &m_finishedLoaders } ) {
+        for ( const FileLoader *loader: *loaders ) {
+            if ( loader->path() == path ) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 void FileManagerPrivate::appendLoader( FileLoader *loader )
 {
     QObject::connect( loader, SIGNAL(loaderFinished(FileLoader*)),
              q, SLOT(cleanupLoader(FileLoader*)) );
+    QObject::connect( loader, SIGNAL(featuresLoaded(FileLoader*,GeoDataDocument*)),
+             q, SLOT(addLoadedFeatures(FileLoader*,GeoDataDocument*)) );
 
-    m_loaderList.append( loader );
-    loader->start();
+    m_queuedLoaders.append( loader );
+    startLoaders();
+}
+
+void FileManagerPrivate::startLoaders()
+{
+    while ( !m_queuedLoaders.isEmpty() && m_loaderList.size() < m_maximumLoaderCount ) {
+        FileLoader *loader = m_queuedLoaders.takeFirst();
+        m_loaderList.append( loader );
+        loader->start();
+    }
 }
 
 void FileManager::removeFile( const QString& key )
 {
+    for ( FileLoader *loader: d->m_queuedLoaders ) {
+        if ( loader->path() == key ) {
+            d->m_queuedLoaders.removeAll( loader );
+            delete loader;
+            return;
+        }
+    }
+
     for ( FileLoader *loader: d->m_loaderList ) {
         if ( loader->path() == key ) {
             disconnect( loader, nullptr, this, nullptr );
+            loader->discardChunks();
             loader->wait();
             d->m_loaderList.removeAll( loader );
+            if ( GeoDataDocument *streamed = d->m_streamedDocuments.take( loader ) ) {
+                d->m_treeModel->removeDocument( streamed );
+                delete streamed;
+            }
+            delete loader->document();
+            delete loader;
+            d->startLoaders();
+            return;
+        }
+    }
+
+    for ( FileLoader *loader: d->m_finishedLoaders ) {
+        if ( loader->path() == key ) {
+            d->m_finishedLoaders.removeAll( loader );
+            if ( GeoDataDocument *streamed = d->m_streamedDocuments.take( loader ) ) {
+                d->m_treeModel->removeDocument( streamed );
+                delete streamed;
+            }
             delete loader->document();
+            delete loader;
             return;
         }
     }
@@ -158,22 +235,70 @@ GeoDataDocument * FileManager::at( const QString &key )
 }
 
 int FileManager::pendingFiles() const
+{
+    return d->m_loaderList.size() + d->m_queuedLoaders.size() + d->m_finishedLoaders.size();
+}
+
+int FileManager::runningLoaderCount() const
 {
     return d->m_loaderList.size();
 }
 
+void FileManager::setMaximumLoaderCount( int count )
+{
+    d->m_maximumLoaderCount = qMax( 1, count );
+    d->startLoaders();
+}
+
+int FileManager::maximumLoaderCount() const
+{
+    return d->m_maximumLoaderCount;
+}
+
 void FileManagerPrivate::cleanupLoader( FileLoader* loader )
 {
-    GeoDataDocument *doc = loader->document();
     m_loaderList.removeAll( loader );
-    if ( loader->isFinished() ) {
-        if ( doc ) {
-            if ( doc->name().isEmpty() && !doc->fileName().isEmpty() )
-            {
-                QFileInfo file( doc->fileName() );
-                doc->setName( file.baseName() );
+    // loaderFinished() is the last thing the loader emits in its thread
+    loader->wait();
+    m_finishedLoaders.append( loader );
+    startLoaders();
+
+    if ( m_loaderList.isEmpty() ) {
+        m_batchTimer.stop();
+        addFinishedDocuments();
+    } else if ( !m_batchTimer.isActive() ) {
+        m_batchTimer.start();
+    }
+}
+
+void FileManagerPrivate::addFinishedDocuments()
+{
+    const QList<FileLoader*> loaders = m_finishedLoaders;
+    m_finishedLoaders.clear();
+
+    QVector<GeoDataDocument*> documents;
+    QVector<GeoDataDocument*> newDocuments;
+    documents.reserve( loaders.size() );
+    for ( FileLoader *loader: loaders ) {
+        GeoDataDocument *doc = loader->document();
+        if ( GeoDataDocument *streamed = m_streamedDocuments.take( loader ) ) {
+            // the remainder of a streamed file
+            if ( doc ) {
+                mergeRootProperties( streamed, doc );
+                mergeDocument( streamed, doc );
             }
-            m_treeModel->addDocument( doc );
+            doc = streamed;
+        } else if ( doc ) {
+            setDocumentName( doc );
+            newDocuments << doc;
+        }
+        documents << doc;
+    }
+    m_treeModel->addDocuments( newDocuments );
+
+    for ( int i = 0; i < loaders.size(); ++i ) {
+        FileLoader *loader = loaders[i];
+        if ( GeoDataDocument *doc = documents[i] ) {
             m_fileItemHash.insert( loader->path(), doc );
             emit q->fileAdded( loader->path() );
             if( loader->recenter() ) {
@@ -186,7 +311,8 @@ void FileManagerPrivate::cleanupLoader( FileLoader* loader )
         }
         delete loader;
     }
-    if ( m_loaderList.isEmpty()  )
+
+    if ( m_loaderList.isEmpty() && m_finishedLoaders.isEmpty() )
     {
         mDebug() << "Finished loading all placemarks " << m_timer.elapsed();
 
@@ -197,4 +323,60 @@ void FileManagerPrivate::cleanupLoader( FileLoader* loader )
     }
 }
 
+void FileManagerPrivate::addLoadedFeatures( FileLoader *loader, GeoDataDocument *chunk )
+{
+    if ( !m_loaderList.contains( loader ) ) {
+        // the file was removed while loading
+        delete chunk;
+        return;
+    }
+
+    if ( GeoDataDocument *document = m_streamedDocuments.value( loader ) ) {
+        mergeDocument( document, chunk );
+    } else {
+        // The first chunk becomes the document of the file, so that its
+        // features show up while the rest of the file is being parsed
+        setDocumentName( chunk );
+        m_treeModel->addDocument( chunk );
+        m_streamedDocuments.insert( loader, chunk );
+    }
+    loader->releaseChunk();
+}
+
+void FileManagerPrivate::mergeDocument( GeoDataDocument *document, GeoDataDocument *other )
+{
+    for ( const GeoDataStyle::Ptr &style: other->styles() ) {
+        document->addStyle( style );
+    }
+    for ( const GeoDataStyleMap &styleMap: other->styleMaps() ) {
+        document->addStyleMap( styleMap );
+    }
+    for ( const GeoDataSchema &schema: other->schemas() ) {
+        document->addSchema( schema );
+    }
+
+    const QVector<GeoDataFeature*> features = other->featureList();
+    other->remove( 0, features.size() );
+    m_treeModel->addFeatures( document, features );
+    delete other;
+}
+
+void FileManagerPrivate::mergeRootProperties( GeoDataDocument *document, const GeoDataDocument *root )
+{
+    // The chunks only carried the name known so far. The description, view,
+    // region, extended data and the like are complete at the end of the file.
+    static_cast<GeoDataFeature &>( *document ) = *root;
+    setDocumentName( document );
+    m_treeModel->updateFeature( document );
+}
+
+void FileManagerPrivate::setDocumentName( GeoDataDocument *document )
+{
+    if ( document->name().isEmpty() && !document->fileName().isEmpty() )
+    {
+        QFileInfo file( document->fileName() );
+        document->setName( file.baseName() );
+    }
+}
+
 #include "moc_FileManager.cpp"
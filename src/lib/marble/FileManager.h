@@ -72,6 +72,17 @@ class MARBLE_EXPORT FileManager : public QObject
     /** Returns the number of files being opened at the moment */
     int pendingFiles() const;
 
+    /** Returns the number of files parsed at the moment, at most maximumLoaderCount() */
+    int runningLoaderCount() const;
+
+    /**
+     * Sets the maximum number of files that are loaded in parallel. Further
+     * files wait until one of the running loaders has finished.
+     * Defaults to QThread::idealThreadCount().
+     */
+    void setMaximumLoaderCount( int count );
+    int maximumLoaderCount() const;
+
  Q_SIGNALS:
     void fileAdded( const QString &key );
     void fileRemoved( const QString &key );
@@ -81,6 +92,8 @@ class MARBLE_EXPORT FileManager : public QObject
  private:
 
     Q_PRIVATE_SLOT( d, void cleanupLoader( FileLoader *loader ) )
+    Q_PRIVATE_SLOT( d, void addFinishedDocuments() )
+    Q_PRIVATE_SLOT( d, void addLoadedFeatures( FileLoader *loader, GeoDataDocument *chunk ) )
 
     Q_DISABLE_COPY( FileManager )
 
@@ -17,18 +17,30 @@
 #include "MarbleDebug.h"
 #include "MarbleGlobal.h"
 #include "MarbleDirs.h"
+#include "MbTilesStorage.h"
 
 using namespace Marble;
 
 FileStoragePolicy::FileStoragePolicy( const QString &dataDirectory, QObject *parent )
     : StoragePolicy( parent ),
-      m_dataDirectory( dataDirectory )
+      m_dataDirectory( dataDirectory ),
+      m_mbTilesStoragePolicy( dataDirectory )
 {
     if ( m_dataDirectory.isEmpty() )
         m_dataDirectory = MarbleDirs::localPath() + QLatin1String("/cache/");
 
     if ( !QDir( m_dataDirectory ).exists() ) 
         QDir::root().mkpath( m_dataDirectory );
+
+    connect( &m_mbTilesStoragePolicy, SIGNAL(sizeChanged(qint64)),
+             this, SIGNAL(sizeChanged(qint64)) );
+}
+
+static bool isMbTilesFileName( const QString &fileName )
+{
+    QString databaseFileName;
+    int zoomLevel, x, y;
+    return MbTilesStorage::parseTileFileName( fileName, databaseFileName, zoomLevel, x, y );
 }
 
 FileStoragePolicy::~FileStoragePolicy()
@@ -37,12 +49,24 @@ FileStoragePolicy::~FileStoragePolicy()
 
 bool FileStoragePolicy::fileExists( const QString &fileName ) const
 {
+    if ( isMbTilesFileName( fileName ) ) {
+        return m_mbTilesStoragePolicy.fileExists( fileName );
+    }
+
     const QString fullName = m_dataDirectory + QLatin1Char('/') + fileName;
     return QFile::exists( fullName );
 }
 
 bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &data )
 {
+    if ( isMbTilesFileName( fileName ) ) {
+        const bool stored = m_mbTilesStoragePolicy.updateFile( fileName, data );
+        if ( !stored ) {
+            m_errorMsg = m_mbTilesStoragePolicy.lastErrorMessage();
+        }
+        return stored;
+    }
+
     QFileInfo const dirInfo( fileName );
     QString const fullName = dirInfo.isAbsolute() ? fileName : m_dataDirectory + QLatin1Char('/') + fileName;
 
@@ -73,6 +97,9 @@ bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &d
     }
 
     emit sizeChanged( file.size() - oldSize );
+    if ( !dirInfo.isAbsolute() ) {
+        emit fileUpdated( fileName, file.size() );
+    }
     file.close();
 
     return true;
@@ -91,7 +118,10 @@ void FileStoragePolicy::clearCache()
         return;
     }
 
+    m_mbTilesStoragePolicy.clearCache();
+
     const QString cachedMapsDirectory = m_dataDirectory + QLatin1String("/maps");
+    const QDir dataDirectory( m_dataDirectory );
 
     QDirIterator it( cachedMapsDirectory, QDir::NoDotAndDotDot | QDir::Dirs );
     mDebug() << cachedMapsDirectory;
@@ -131,6 +161,7 @@ void FileStoragePolicy::clearCache()
                         QFile file( filePath );
                         emit sizeChanged( -file.size() );
                         file.remove();
+                        emit fileRemoved( dataDirectory.relativeFilePath( filePath ) );
                     }
                 }
             }
@@ -6,6 +6,7 @@
 #ifndef MARBLE_FILESTORAGEPOLICY_H
 #define MARBLE_FILESTORAGEPOLICY_H
 
+#include "MbTilesStoragePolicy.h"
 #include "StoragePolicy.h"
 
 namespace Marble
@@ -54,6 +55,9 @@ class FileStoragePolicy : public StoragePolicy
 	
         QString m_dataDirectory;
         QString m_errorMsg;
+
+        // tiles inside MBTiles databases are handed over to this policy
+        MbTilesStoragePolicy m_mbTilesStoragePolicy;
 };
 
 }
@@ -7,9 +7,12 @@
 #include "FileStorageWatcher.h"
 
 // Qt
+#include <QDateTime>
 #include <QDir>
 #include <QDirIterator>
 #include <QFileInfo>
+#include <QMultiMap>
+#include <QPair>
 #include <QTimer>
 
 // Marble
@@ -24,11 +27,41 @@ using namespace Marble;
 static const int maxFilesDelete = 20;
 static const int softLimitPercent = 5;
 
+// Tells whether @p fileName, relative to the data directory, is a tile that
+// may be deleted. Base tiles and anything else than images are kept.
+static bool isDeletableTile( const QString &fileName )
+{
+    const QStringList path = fileName.split(QLatin1Char('/'));
+
+    // at least maps/planet/theme/tilelevel/row/tile
+    if ( path.size() < 6 || path[0] != QLatin1String("maps") ) {
+        return false;
+    }
+
+    bool ok = false;
+    int tileLevel = path[3].toInt(&ok);
+    // internal theme layer case
+    // (e.g. "maps/earth/openseamap/seamarks/4")
+    if (!ok) tileLevel = path[4].toInt(&ok);
+    if ( !ok || tileLevel < maxBaseTileLevel ) {
+        return false;
+    }
+
+    const QString suffix = QFileInfo( path.last() ).suffix().toLower();
+    return suffix == QLatin1String("jpg") ||
+           suffix == QLatin1String("png") ||
+           suffix == QLatin1String("gif") ||
+           suffix == QLatin1String("svg") ||
+           suffix == QLatin1String("o5m");
+}
+
 
 // Methods of FileStorageWatcherThread
 FileStorageWatcherThread::FileStorageWatcherThread( const QString &dataDirectory, QObject *parent )
     : QObject( parent ),
       m_dataDirectory( dataDirectory ),
+      m_index( dataDirectory + QLatin1String("/tile_cache.journal") ),
+      m_currentCacheSize( 0 ),
       m_deleting( false ),
       m_willQuit( false )
 {
@@ -72,9 +105,35 @@ void FileStorageWatcherThread::addToCurrentSize( qint64 bytes )
 void FileStorageWatcherThread::resetCurrentSize()
 {
     m_currentCacheSize = 0;
+    m_index.clear();
     emit variableChanged();
 }
 
+void FileStorageWatcherThread::updateFile( const QString &fileName, qint64 size )
+{
+    if ( !isDeletableTile( fileName ) ) {
+        return;
+    }
+
+    addToCurrentSize( size - qint64( m_index.size( fileName ) ) );
+    m_index.insert( fileName, size );
+}
+
+void FileStorageWatcherThread::removeFile( const QString &fileName )
+{
+    if ( !m_index.contains( fileName ) ) {
+        return;
+    }
+
+    addToCurrentSize( -qint64( m_index.size( fileName ) ) );
+    m_index.remove( fileName );
+}
+
+void FileStorageWatcherThread::accessFile( const QString &fileName )
+{
+    m_index.touch( fileName );
+}
+
 void FileStorageWatcherThread::prepareQuit()
 {
     m_willQuit = true;
@@ -82,40 +141,42 @@ void FileStorageWatcherThread::prepareQuit()
 
 void FileStorageWatcherThread::getCurrentCacheSize()
 {
-    mDebug() << "FileStorageWatcher: Creating cache size";
-    quint64 dataSize = 0;
-    const QString basePath = m_dataDirectory + QLatin1String("/maps");
-    QDirIterator it( basePath,
+    if ( m_index.load() ) {
+        mDebug() << "FileStorageWatcher: Loaded cache index of" << m_index.count() << "files";
+        m_currentCacheSize = m_index.totalSize();
+        return;
+    }
+
+    // There is no index yet, so build it once from the files on disc.
+    // The files are indexed in the order of their last modification.
+    mDebug() << "FileStorageWatcher: Creating cache index";
+    QMultiMap<QDateTime, QPair<QString, qint64> > files;
+    const QDir dataDirectory( m_dataDirectory );
+    QDirIterator it( m_dataDirectory + QLatin1String("/maps"),
                      QDir::Files | QDir::Writable,
                      QDirIterator::Subdirectories );
     
-    const int basePathDepth = basePath.split(QLatin1Char('/')).size();
     while( it.hasNext() && !m_willQuit ) {
         it.next();
-        QFileInfo file = it.fileInfo();
+        const QString fileName = dataDirectory.relativeFilePath( it.filePath() );
         // We try to be very careful and just delete images
-        QString suffix = file.suffix().toLower();
-        const QStringList path = file.path().split(QLatin1Char('/'));
-
-        // planet/theme/tilelevel should be deeper than 4
-        if ( path.size() > basePathDepth + 3 ) {
-            bool ok = false;
-            int tileLevel = path[basePathDepth + 2].toInt(&ok);
-            // internal theme layer case
-            // (e.g. "earth/openseamap/seamarks/4")
-            if (!ok) tileLevel = path[basePathDepth + 3].toInt(&ok);
-            if ((ok && tileLevel >= maxBaseTileLevel ) &&
-              (suffix == QLatin1String("jpg") ||
-               suffix == QLatin1String("png") ||
-               suffix == QLatin1String("gif") ||
-               suffix == QLatin1String("svg") ||
-               suffix == QLatin1String("o5m"))) {
-                dataSize += file.size();
-                m_filesCache.insert(file.lastModified(), file.absoluteFilePath());
-            }
+        if ( isDeletableTile( fileName ) ) {
+            const QFileInfo file = it.fileInfo();
+            files.insert( file.lastModified(), qMakePair( fileName, file.size() ) );
         }
     }
-    m_currentCacheSize = dataSize;
+
+    if ( m_willQuit ) {
+        return;
+    }
+
+    QMultiMap<QDateTime, QPair<QString, qint64> >::const_iterator file = files.constBegin();
+    for (; file != files.constEnd(); ++file ) {
+        m_index.insert( file.value().first, file.value().second );
+    }
+    m_index.compact();
+
+    m_currentCacheSize = m_index.totalSize();
 }
 
 void FileStorageWatcherThread::ensureCacheSize()
@@ -137,17 +198,16 @@ void FileStorageWatcherThread::ensureCacheSize()
         // We have not reached our soft limit, yet.
         m_deleting = true;
 
-        // We iterate over the m_filesCache which is sorted by lastModified
+        // We take the least recently used files from the index
         // and remove a chunk of the oldest 20 (maxFilesDelete) files.
-        QMultiMap<QDateTime, QString>::iterator it= m_filesCache.begin();
-        while ( it != m_filesCache.end() &&
+        while ( m_index.count() > 0 &&
                 keepDeleting() ) {
-            QString filePath = it.value();
-            QFileInfo info( filePath );
+            const QString fileName = m_index.oldest();
+            const QString filePath = m_dataDirectory + QLatin1Char('/') + fileName;
 
             ++m_filesDeleted;
-            m_currentCacheSize -= info.size();
-            it = m_filesCache.erase(it);
+            m_currentCacheSize -= qMin( m_currentCacheSize, m_index.size( fileName ) );
+            m_index.remove( fileName );
             bool success = QFile::remove( filePath );
             if (!success) {
                 mDebug() << "Failed to remove:" << filePath;
@@ -160,7 +220,7 @@ void FileStorageWatcherThread::ensureCacheSize()
             return;
         }
         else {
-            // A partial chunk is reached at the end of m_filesCache.
+            // A partial chunk is reached at the end of the index.
             // At this point deletion is done.
             m_deleting = false;
         }
@@ -252,6 +312,21 @@ void FileStorageWatcher::resetCurrentSize()
     emit cleared();
 }
 
+void FileStorageWatcher::updateFile( const QString &fileName, qint64 size )
+{
+    emit fileUpdated( fileName, size );
+}
+
+void FileStorageWatcher::removeFile( const QString &fileName )
+{
+    emit fileRemoved( fileName );
+}
+
+void FileStorageWatcher::accessFile( const QString &fileName )
+{
+    emit fileAccessed( fileName );
+}
+
 void FileStorageWatcher::run()
 {
     m_thread = new FileStorageWatcherThread( m_dataDirectory );
@@ -267,6 +342,12 @@ void FileStorageWatcher::run()
                  m_thread, SLOT(addToCurrentSize(qint64)) );
         connect( this, SIGNAL(cleared()),
                  m_thread, SLOT(resetCurrentSize()) );
+        connect( this, SIGNAL(fileUpdated(QString,qint64)),
+                 m_thread, SLOT(updateFile(QString,qint64)) );
+        connect( this, SIGNAL(fileRemoved(QString)),
+                 m_thread, SLOT(removeFile(QString)) );
+        connect( this, SIGNAL(fileAccessed(QString)),
+                 m_thread, SLOT(accessFile(QString)) );
 
         // Make sure that we don't want to stop process.
         // The thread wouldn't exit from event loop.
@@ -8,8 +8,8 @@
 
 #include <QThread>
 #include <QMutex>
-#include <QMultiMap>
-#include <QDateTime>
+
+#include "CacheIndex.h"
 
 namespace Marble
 {
@@ -48,6 +48,22 @@ class FileStorageWatcherThread : public QObject
 	 * Setting current cache size to 0.
 	 */
 	void resetCurrentSize();
+
+	/**
+	 * Records that @p fileName, given relative to the data directory,
+	 * has been written with @p size bytes.
+	 */
+	void updateFile( const QString &fileName, qint64 size );
+
+	/**
+	 * Records that @p fileName has been removed from the data directory.
+	 */
+	void removeFile( const QString &fileName );
+
+	/**
+	 * Records that @p fileName has been read, so it is deleted later.
+	 */
+	void accessFile( const QString &fileName );
 	
 	/**
 	 * Stop doing things that take a long time to quit.
@@ -55,7 +71,8 @@ class FileStorageWatcherThread : public QObject
 	void prepareQuit();
 	
 	/**
-	 * Getting the current size of the data stored on the disc
+	 * Getting the current size of the data stored on the disc.
+	 * The data directory is only scanned if there is no cache index yet.
 	 */
 	void getCurrentCacheSize();
 
@@ -74,7 +91,7 @@ class FileStorageWatcherThread : public QObject
 	bool keepDeleting() const;
 	
 	QString m_dataDirectory;
-    QMultiMap<QDateTime,QString> m_filesCache;
+    CacheIndex m_index;
     quint64 m_cacheLimit;
 	quint64 m_cacheSoftLimit;
     quint64 m_currentCacheSize;
@@ -123,11 +140,30 @@ class FileStorageWatcher : public QThread
 	 * Setting current cache size to 0.
 	 */
 	void resetCurrentSize();
+
+	/**
+	 * Records that @p fileName, given relative to the data directory,
+	 * has been written with @p size bytes.
+	 */
+	void updateFile( const QString &fileName, qint64 size );
+
+	/**
+	 * Records that @p fileName has been removed from the data directory.
+	 */
+	void removeFile( const QString &fileName );
+
+	/**
+	 * Records that @p fileName has been read, so it is deleted later.
+	 */
+	void accessFile( const QString &fileName );
 	
 
     Q_SIGNALS:
 	void sizeChanged( qint64 bytes );
 	void cleared();
+	void fileUpdated( const QString &fileName, qint64 size );
+	void fileRemoved( const QString &fileName );
+	void fileAccessed( const QString &fileName );
 	
     protected:
 	/**
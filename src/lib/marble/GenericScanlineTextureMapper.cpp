@@ -17,6 +17,7 @@
 #include "GeoPainter.h"
 #include "MarbleDirs.h"
 #include "MarbleDebug.h"
+#include "ScanlineJobScheduler.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "TextureColorizer.h"
@@ -30,7 +31,7 @@ using namespace Marble;
 class GenericScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineJobScheduler *scheduler );
 
     void run() override;
 
@@ -40,18 +41,16 @@ private:
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    const int m_yTop;
-    const int m_yBottom;
+    ScanlineJobScheduler *const m_scheduler;
 };
 
-GenericScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+GenericScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineJobScheduler *scheduler )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yTop( yTop ),
-      m_yBottom( yBottom )
+      m_scheduler( scheduler )
 {
 }
 
@@ -103,6 +102,11 @@ void GenericScanlineTextureMapper::mapTexture( GeoPainter *painter,
     painter->drawImage( rect, m_canvasImage, rect );
 }
 
+QString GenericScanlineTextureMapper::runtimeTrace() const
+{
+    return m_scheduler.runtimeTrace();
+}
+
 void GenericScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
     // Reset backend
@@ -120,15 +124,14 @@ void GenericScanlineTextureMapper::mapTexture( const ViewportParams *viewport, i
                                       : yTop + radius + radius - skip;
 
     const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = qCeil(qreal( yBottom - yTop ) / qreal(numThreads));
+    m_scheduler.start( yTop, yBottom, numThreads );
     for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yTop +  i      * yStep;
-        const int yEnd   = qMin(yBottom, yTop + (i + 1) * yStep);
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &m_scheduler );
         m_threadPool.start( job );
     }
 
     m_threadPool.waitForDone();
+    m_scheduler.finish();
 
     m_tileLoader->cleanupTilehash();
 }
@@ -161,7 +164,9 @@ void GenericScanlineTextureMapper::RenderJob::run()
 
 
     // Paint the map.
-    for ( int y = m_yTop; y < m_yBottom; ++y ) {
+    // Fetch chunks of rows from the scheduler until all rows are done
+    int yEnd = 0;
+    for ( int y = 0; y < yEnd || m_scheduler->nextChunk( y, yEnd ); ++y ) {
 
         // rx is the radius component in x direction
         const int rx = (int)sqrt( (qreal)( clipRadius * clipRadius
@@ -254,7 +259,7 @@ void GenericScanlineTextureMapper::RenderJob::run()
         }
 
         // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yBottom ) {
+        if ( interlaced && y + 1 < yEnd ) {
 
             const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
@@ -7,6 +7,7 @@
 #define MARBLE_GENERICSCANLINETEXTUREMAPPER_H
 
 
+#include "ScanlineJobScheduler.h"
 #include "TextureMapperInterface.h"
 
 #include <QThreadPool>
@@ -31,6 +32,8 @@ class GenericScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer ) override;
 
+    QString runtimeTrace() const override;
+
  private:
     class RenderJob;
 
@@ -40,6 +43,7 @@ class GenericScanlineTextureMapper : public TextureMapperInterface
     int m_radius;
     QImage m_canvasImage;
     QThreadPool m_threadPool;
+    ScanlineJobScheduler m_scheduler;
 };
 
 }
@@ -732,6 +732,49 @@ int GeoDataTreeModel::addDocument( GeoDataDocument *document )
     return addFeature( d->m_rootDocument, document );
 }
 
+int GeoDataTreeModel::addDocuments( const QVector<GeoDataDocument*> &documents )
+{
+    QVector<GeoDataFeature*> features;
+    features.reserve( documents.size() );
+    for ( GeoDataDocument *document: documents ) {
+        features << document;
+    }
+    return addFeatures( d->m_rootDocument, features );
+}
+
+int GeoDataTreeModel::addFeatures( GeoDataContainer *parent, const QVector<GeoDataFeature*> &features )
+{
+    QVector<GeoDataFeature*> batch;
+    batch.reserve( features.size() );
+    for ( GeoDataFeature *feature: features ) {
+        if ( feature ) {
+            batch << feature;
+        }
+    }
+    if ( !parent || batch.isEmpty() ) {
+        return -1;
+    }
+
+    const QModelIndex modelindex = index( parent );
+    if ( parent != d->m_rootDocument && !modelindex.isValid() ) {
+        qWarning() << "GeoDataTreeModel::addFeatures (parent " << parent << ") : parent not found on the TreeModel";
+        return -1;
+    }
+
+    const int first = parent->size();
+    beginInsertRows( modelindex, first, first + batch.size() - 1 );
+    for ( GeoDataFeature *feature: batch ) {
+        parent->append( feature );
+    }
+    d->checkParenting( parent );
+    endInsertRows();
+
+    for ( GeoDataFeature *feature: batch ) {
+        emit added( feature );
+    }
+    return first;
+}
+
 bool GeoDataTreeModel::removeFeature( GeoDataContainer *parent, int row )
 {
     if ( row<parent->size() ) {
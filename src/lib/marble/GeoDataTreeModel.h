@@ -9,6 +9,7 @@
 #include "marble_export.h"
 
 #include <QAbstractItemModel>
+#include <QVector>
 
 class QItemSelectionModel;
 
@@ -82,6 +83,12 @@ public Q_SLOTS:
 
     int addFeature( GeoDataContainer *parent, GeoDataFeature *feature, int row = -1 );
 
+    /**
+      * Appends @p features to @p parent with a single row insertion.
+      * @return the row of the first feature or -1 if nothing was added.
+      */
+    int addFeatures( GeoDataContainer *parent, const QVector<GeoDataFeature*> &features );
+
     bool removeFeature( GeoDataContainer *parent, int index );
 
     int removeFeature(GeoDataFeature *feature);
@@ -90,6 +97,13 @@ public Q_SLOTS:
 
     int addDocument( GeoDataDocument *document );
 
+    /**
+      * Appends @p documents to the root document with a single row insertion,
+      * so that proxy models and views update once for the whole batch.
+      * @return the row of the first document or -1 if nothing was added.
+      */
+    int addDocuments( const QVector<GeoDataDocument*> &documents );
+
     void removeDocument( int index );
 
     void removeDocument( GeoDataDocument* document );
@@ -12,12 +12,12 @@
 #include "GeoDataPlacemark.h"
 #include "GeoDataDocument.h"
 #include "GeoGraphicsItem.h"
-#include "TileId.h"
-#include "TileCoordsPyramid.h"
 #include "MarbleDebug.h"
 
-#include <QMap>
-#include <QRect>
+#include <QHash>
+#include <QSet>
+
+#include <limits>
 
 namespace Marble
 {
@@ -25,20 +25,70 @@ namespace Marble
 class GeoGraphicsScenePrivate
 {
 public:
+    /**
+     * A node of a loose quadtree. The root cell covers the whole earth, the
+     * children split the cell of their parent into four quadrants. An item
+     * is stored in the deepest cell that is at least as large as its bounding
+     * box and contains the center of the box. The item is then contained in the
+     * cell grown by half its size in each direction, the loose bounds.
+     */
+    struct Node
+    {
+        Node( Node *parent_, int level_, int x_, int y_ ) :
+            parent( parent_ ),
+            level( level_ ),
+            x( x_ ),
+            y( y_ ),
+            itemCount( 0 ),
+            minZoomLevel( std::numeric_limits<int>::max() )
+        {
+            children[0] = children[1] = children[2] = children[3] = nullptr;
+        }
+
+        ~Node()
+        {
+            for ( Node *child: children ) {
+                delete child;
+            }
+        }
+
+        Node *parent;
+        Node *children[4];
+        QVector<GeoGraphicsItem*> items;
+        int level;
+        int x;
+        int y;
+        int itemCount;    // number of items in the subtree
+        int minZoomLevel; // smallest minZoomLevel() of the items in the subtree
+    };
+
+    struct Rect
+    {
+        qreal west;
+        qreal south;
+        qreal east;
+        qreal north;
+    };
+
     GeoGraphicsScene *q;
     explicit GeoGraphicsScenePrivate(GeoGraphicsScene *parent) :
-        q(parent)
+        q(parent),
+        m_root(new Node(nullptr, 0, 0, 0))
     {
     }
 
     ~GeoGraphicsScenePrivate()
     {
         q->clear();
+        delete m_root;
     }
 
-    typedef QHash<const GeoDataFeature*,GeoGraphicsItem*> FeatureItemMap;
-    QHash<TileId, FeatureItemMap> m_tiledItems;
-    QMultiHash<const GeoDataFeature*, TileId> m_features; // multi hash because multi track and multi geometry insert multiple items
+    // Items as small as a few meters do not need to be sorted any further
+    static const int maxLevel = 20;
+
+    Node *m_root;
+    QHash<GeoGraphicsItem*, Node*> m_itemNodes;
+    QMultiHash<const GeoDataFeature*, GeoGraphicsItem*> m_features; // multi hash because multi track and multi geometry insert multiple items
 
     // Stores the items which have been clicked;
     QList<GeoGraphicsItem*> m_selectedItems;
@@ -47,8 +97,156 @@ public:
 
     void selectItem( GeoGraphicsItem *item );
     static void applyHighlightStyle(GeoGraphicsItem *item, const GeoDataStyle::Ptr &style);
+
+    Node *insertItem( GeoGraphicsItem *item );
+    void removeItem( GeoGraphicsItem *item );
+    static void updateAggregates( Node *node );
+    static Rect looseBounds( const Node *node );
+    static void collectItems( const Node *node, const Rect *rects, int rectCount, bool contained,
+                              const GeoDataLatLonBox &box, int zoomLevel, QList<GeoGraphicsItem*> &result );
 };
 
+GeoGraphicsScenePrivate::Node *GeoGraphicsScenePrivate::insertItem( GeoGraphicsItem *item )
+{
+    qreal north, south, east, west;
+    item->latLonAltBox().boundaries( north, south, east, west );
+
+    // Boxes crossing the IDL have no single cell to fit in
+    int level = 0;
+    if ( west <= east ) {
+        const qreal width = east - west;
+        const qreal height = north - south;
+        while ( level < maxLevel
+                && width <= 2 * M_PI / ( 2 << level )
+                && height <= M_PI / ( 2 << level ) ) {
+            ++level;
+        }
+    }
+
+    const int cellCount = 1 << level;
+    const qreal centerLon = ( west + east ) / 2;
+    const qreal centerLat = ( north + south ) / 2;
+    const int x = qBound( 0, int( ( centerLon + M_PI ) / ( 2 * M_PI ) * cellCount ), cellCount - 1 );
+    const int y = qBound( 0, int( ( M_PI / 2 - centerLat ) / M_PI * cellCount ), cellCount - 1 );
+
+    Node *node = m_root;
+    for ( int childLevel = 1; childLevel <= level; ++childLevel ) {
+        const int childX = x >> ( level - childLevel );
+        const int childY = y >> ( level - childLevel );
+        Node *&child = node->children[( childX & 1 ) | ( ( childY & 1 ) << 1 )];
+        if ( !child ) {
+            child = new Node( node, childLevel, childX, childY );
+        }
+        node = child;
+    }
+
+    node->items.append( item );
+    m_itemNodes.insert( item, node );
+    m_features.insert( item->feature(), item );
+    return node;
+}
+
+void GeoGraphicsScenePrivate::removeItem( GeoGraphicsItem *item )
+{
+    Node *node = m_itemNodes.take( item );
+    if ( !node ) {
+        return;
+    }
+
+    const int index = node->items.indexOf( item );
+    node->items[index] = node->items.last();
+    node->items.removeLast();
+
+    for ( Node *ancestor = node; ancestor; ancestor = ancestor->parent ) {
+        updateAggregates( ancestor );
+    }
+
+    // Prune cells which became empty
+    while ( node != m_root && node->itemCount == 0 ) {
+        Node *const parent = node->parent;
+        for ( Node *&child: parent->children ) {
+            if ( child == node ) {
+                child = nullptr;
+            }
+        }
+        delete node;
+        node = parent;
+    }
+}
+
+void GeoGraphicsScenePrivate::updateAggregates( Node *node )
+{
+    node->itemCount = node->items.size();
+    node->minZoomLevel = std::numeric_limits<int>::max();
+    for ( const GeoGraphicsItem *item: node->items ) {
+        node->minZoomLevel = qMin( node->minZoomLevel, item->minZoomLevel() );
+    }
+    for ( const Node *child: node->children ) {
+        if ( child ) {
+            node->itemCount += child->itemCount;
+            node->minZoomLevel = qMin( node->minZoomLevel, child->minZoomLevel );
+        }
+    }
+}
+
+GeoGraphicsScenePrivate::Rect GeoGraphicsScenePrivate::looseBounds( const Node *node )
+{
+    if ( node->level == 0 ) {
+        // The root also holds the boxes crossing the IDL, so it has no useful bounds
+        const Rect world = { -2 * M_PI, -M_PI, 2 * M_PI, M_PI };
+        return world;
+    }
+
+    const qreal width = 2 * M_PI / ( 1 << node->level );
+    const qreal height = M_PI / ( 1 << node->level );
+    const qreal west = -M_PI + node->x * width;
+    const qreal north = M_PI / 2 - node->y * height;
+    const Rect bounds = { qMax<qreal>( -M_PI, west - width / 2 ),
+                          qMax<qreal>( -M_PI / 2, north - 1.5 * height ),
+                          qMin<qreal>( M_PI, west + 1.5 * width ),
+                          qMin<qreal>( M_PI / 2, north + height / 2 ) };
+    return bounds;
+}
+
+void GeoGraphicsScenePrivate::collectItems( const Node *node, const Rect *rects, int rectCount, bool contained,
+                                            const GeoDataLatLonBox &box, int zoomLevel, QList<GeoGraphicsItem*> &result )
+{
+    if ( node->itemCount == 0 || node->minZoomLevel > zoomLevel ) {
+        return;
+    }
+
+    if ( !contained ) {
+        const Rect bounds = looseBounds( node );
+        bool intersects = false;
+        for ( int i = 0; i < rectCount && !contained; ++i ) {
+            const Rect &rect = rects[i];
+            if ( bounds.west <= rect.east && bounds.east >= rect.west
+                 && bounds.south <= rect.north && bounds.north >= rect.south ) {
+                intersects = true;
+                contained = rect.west <= bounds.west && bounds.east <= rect.east
+                            && rect.south <= bounds.south && bounds.north <= rect.north;
+            }
+        }
+        if ( !intersects ) {
+            return;
+        }
+    }
+
+    for ( GeoGraphicsItem *item: node->items ) {
+        if ( item->minZoomLevel() <= zoomLevel && item->visible() ) {
+            if ( contained || item->latLonAltBox().intersects( box ) ) {
+                result.push_back( item );
+            }
+        }
+    }
+
+    for ( const Node *child: node->children ) {
+        if ( child ) {
+            collectItems( child, rects, rectCount, contained, box, zoomLevel, result );
+        }
+    }
+}
+
 GeoDataStyle::Ptr GeoGraphicsScenePrivate::highlightStyle( const GeoDataDocument *document,
                                                        const GeoDataStyleMap &styleMap )
 {
@@ -89,60 +287,24 @@ GeoGraphicsScene::~GeoGraphicsScene()
 
 QList< GeoGraphicsItem* > GeoGraphicsScene::items( const GeoDataLatLonBox &box, int zoomLevel ) const
 {
-    if ( box.west() > box.east() ) {
-        // Handle boxes crossing the IDL by splitting it into two separate boxes
-        GeoDataLatLonBox left;
-        left.setWest( -M_PI );
-        left.setEast( box.east() );
-        left.setNorth( box.north() );
-        left.setSouth( box.south() );
-
-        GeoDataLatLonBox right;
-        right.setWest( box.west() );
-        right.setEast( M_PI );
-        right.setNorth( box.north() );
-        right.setSouth( box.south() );
-
-        return items(left, zoomLevel) + items(right, zoomLevel);
-    }
-
-    QList< GeoGraphicsItem* > result;
-    QRect rect;
     qreal north, south, east, west;
     box.boundaries( north, south, east, west );
-    TileId key;
-
-    key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel );
-    rect.setLeft( key.x() );
-    rect.setTop( key.y() );
-
-    key = TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel );
-    rect.setRight( key.x() );
-    rect.setBottom( key.y() );
-    
-    TileCoordsPyramid pyramid( 0, zoomLevel );
-    pyramid.setBottomLevelCoords( rect );
-
-    for ( int level = pyramid.topLevel(); level <= pyramid.bottomLevel(); ++level ) {
-        QRect const coords = pyramid.coords( level );
-        int x1, y1, x2, y2;
-        coords.getCoords( &x1, &y1, &x2, &y2 );
-        for ( int x = x1; x <= x2; ++x ) {
-            bool const isBorderX = x == x1 || x == x2;
-            for ( int y = y1; y <= y2; ++y ) {
-                bool const isBorder = isBorderX || y == y1 || y == y2;
-                const TileId tileId = TileId( 0, level, x, y );
-                for(GeoGraphicsItem *object: d->m_tiledItems.value( tileId )) {
-                    if (object->minZoomLevel() <= zoomLevel && object->visible()) {
-                        if (!isBorder || object->latLonAltBox().intersects(box)) {
-                            result.push_back(object);
-                        }
-                    }
-                }
-            }
-        }
+
+    // Handle boxes crossing the IDL by splitting it into two separate boxes
+    GeoGraphicsScenePrivate::Rect rects[2];
+    int rectCount = 0;
+    if ( west > east ) {
+        const GeoGraphicsScenePrivate::Rect left = { -M_PI, south, east, north };
+        const GeoGraphicsScenePrivate::Rect right = { west, south, M_PI, north };
+        rects[rectCount++] = left;
+        rects[rectCount++] = right;
+    } else {
+        const GeoGraphicsScenePrivate::Rect rect = { west, south, east, north };
+        rects[rectCount++] = rect;
     }
 
+    QList< GeoGraphicsItem* > result;
+    GeoGraphicsScenePrivate::collectItems( d->m_root, rects, rectCount, false, box, zoomLevel, result );
     return result;
 }
 
@@ -153,10 +315,8 @@ QList< GeoGraphicsItem* > GeoGraphicsScene::selectedItems() const
 
 void GeoGraphicsScene::resetStyle()
 {
-    for (auto const & items: d->m_tiledItems) {
-        for (auto item: items) {
-            item->resetStyle();
-        }
+    for (auto iter = d->m_itemNodes.constBegin(), end = d->m_itemNodes.constEnd(); iter != end; ++iter) {
+        iter.key()->resetStyle();
     }
     emit repaintNeeded();
 }
@@ -180,42 +340,35 @@ void GeoGraphicsScene::applyHighlight( const QVector< GeoDataPlacemark* > &selec
      * items to use highlight style
      */
     for( const GeoDataPlacemark *placemark: selectedPlacemarks ) {
-        for (auto tileIter = d->m_features.find(placemark); tileIter != d->m_features.end() && tileIter.key() == placemark; ++tileIter) {
-            auto const & clickedItemsList = d->m_tiledItems.values(*tileIter);
-            for (auto const & clickedItems: clickedItemsList) { //iterate through FeatureItemMap clickedItems (QHash)
-                for (auto iter = clickedItems.find(placemark); iter != clickedItems.end(); ++iter) {
-                    if ( iter.key() == placemark ) {
-                const GeoDataObject *parent = placemark->parent();
-                if ( parent ) {
-                    auto item = *iter;
-                    if (const GeoDataDocument *doc = geodata_cast<GeoDataDocument>(parent)) {
-                        QString styleUrl = placemark->styleUrl();
-                        styleUrl.remove(QLatin1Char('#'));
-                        if ( !styleUrl.isEmpty() ) {
-                            GeoDataStyleMap const &styleMap = doc->styleMap( styleUrl );
+        for (auto iter = d->m_features.constFind(placemark); iter != d->m_features.constEnd() && iter.key() == placemark; ++iter) {
+            const GeoDataObject *parent = placemark->parent();
+            if ( parent ) {
+                auto item = *iter;
+                if (const GeoDataDocument *doc = geodata_cast<GeoDataDocument>(parent)) {
+                    QString styleUrl = placemark->styleUrl();
+                    styleUrl.remove(QLatin1Char('#'));
+                    if ( !styleUrl.isEmpty() ) {
+                        GeoDataStyleMap const &styleMap = doc->styleMap( styleUrl );
+                        GeoDataStyle::Ptr style = d->highlightStyle( doc, styleMap );
+                        if ( style ) {
+                            d->selectItem( item );
+                            d->applyHighlightStyle( item, style );
+                        }
+                    }
+
+                    /**
+                     * If a placemark is using an inline style instead of a shared
+                     * style ( e.g in case when theme file specifies the colorMap
+                     * attribute ) then highlight it if any of the style maps have a
+                     * highlight styleId
+                     */
+                    else {
+                        for ( const GeoDataStyleMap &styleMap: doc->styleMaps() ) {
                             GeoDataStyle::Ptr style = d->highlightStyle( doc, styleMap );
                             if ( style ) {
                                 d->selectItem( item );
                                 d->applyHighlightStyle( item, style );
-                            }
-                        }
-
-                        /**
-                            * If a placemark is using an inline style instead of a shared
-                            * style ( e.g in case when theme file specifies the colorMap
-                            * attribute ) then highlight it if any of the style maps have a
-                            * highlight styleId
-                            */
-                        else {
-                            for ( const GeoDataStyleMap &styleMap: doc->styleMaps() ) {
-                                GeoDataStyle::Ptr style = d->highlightStyle( doc, styleMap );
-                                if ( style ) {
-                                    d->selectItem( item );
-                                    d->applyHighlightStyle( item, style );
-                                    break;
-                                }
-                            }
-                        }
+                                break;
                             }
                         }
                     }
@@ -226,50 +379,66 @@ void GeoGraphicsScene::applyHighlight( const QVector< GeoDataPlacemark* > &selec
     emit repaintNeeded();
 }
 
+QList<GeoGraphicsItem*> GeoGraphicsScene::items( const GeoDataFeature *feature ) const
+{
+    return d->m_features.values( feature );
+}
+
 void GeoGraphicsScene::removeItem( const GeoDataFeature* feature )
 {
-    for (auto tileIter = d->m_features.find(feature), end = d->m_features.end(); tileIter != end && tileIter.key() == feature;) {
-        auto & tileList = d->m_tiledItems[*tileIter];
-        auto iter = tileList.find(feature);
-        if (iter != tileList.end()) {
-            auto item = iter.value();
-            tileIter = d->m_features.erase(tileIter);
-            tileList.erase(iter);
-            delete item;
-        } else {
-            ++tileIter;
-        }
+    for (auto iter = d->m_features.find(feature), end = d->m_features.end(); iter != end && iter.key() == feature;) {
+        auto item = *iter;
+        iter = d->m_features.erase(iter);
+        d->removeItem(item);
+        delete item;
     }
 }
 
 void GeoGraphicsScene::clear()
 {
-    for(auto const &list: d->m_tiledItems.values()) {
-        qDeleteAll(list.values());
-    }
-    d->m_tiledItems.clear();
+    qDeleteAll(d->m_itemNodes.keys());
+    d->m_itemNodes.clear();
     d->m_features.clear();
+    for (auto & child: d->m_root->children) {
+        delete child;
+        child = nullptr;
+    }
+    d->m_root->items.clear();
+    GeoGraphicsScenePrivate::updateAggregates(d->m_root);
 }
 
 void GeoGraphicsScene::addItem( GeoGraphicsItem* item )
 {
-    // Select zoom level so that the object fit in single tile
-    int zoomLevel;
-    qreal north, south, east, west;
-    item->latLonAltBox().boundaries( north, south, east, west );
-    for(zoomLevel = item->minZoomLevel(); zoomLevel >= 0; zoomLevel--)
-    {
-        if( TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ) ==
-            TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel ) )
-            break;
+    const int minZoomLevel = item->minZoomLevel();
+    for (auto node = d->insertItem(item); node; node = node->parent) {
+        ++node->itemCount;
+        node->minZoomLevel = qMin(node->minZoomLevel, minZoomLevel);
     }
+}
 
-    const TileId key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ); // same as GeoDataCoordinates(east, south, 0), see above
+void GeoGraphicsScene::addItems( const QVector<GeoGraphicsItem*> &items )
+{
+    // Insert all items first, then update each affected cell once, deepest cells first
+    QVector<QVector<GeoGraphicsScenePrivate::Node*> > dirtyNodes(GeoGraphicsScenePrivate::maxLevel + 1);
+    QSet<GeoGraphicsScenePrivate::Node*> dirty;
+    for (auto item: items) {
+        auto node = d->insertItem(item);
+        if (!dirty.contains(node)) {
+            dirty.insert(node);
+            dirtyNodes[node->level] << node;
+        }
+    }
 
-    auto & tileList = d->m_tiledItems[key];
-    auto feature = item->feature();
-    tileList.insertMulti(feature, item);
-    d->m_features.insert(feature, key );
+    for (int level = GeoGraphicsScenePrivate::maxLevel; level >= 0; --level) {
+        for (auto node: dirtyNodes[level]) {
+            GeoGraphicsScenePrivate::updateAggregates(node);
+            auto parent = node->parent;
+            if (parent && !dirty.contains(parent)) {
+                dirty.insert(parent);
+                dirtyNodes[parent->level] << parent;
+            }
+        }
+    }
 }
 
 }
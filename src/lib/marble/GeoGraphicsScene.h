@@ -12,6 +12,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QVector>
 
 namespace Marble
 {
@@ -43,6 +44,13 @@ public:
      */
     void addItem( GeoGraphicsItem *item );
 
+    /**
+     * @brief Add several items to the GeoGraphicsScene
+     * Equivalent to calling addItem() for each of the @p items, but updates
+     * the spatial index only once. Meant for loading whole documents.
+     */
+    void addItems( const QVector<GeoGraphicsItem *> &items );
+
     /**
      * @brief Remove all concerned items from the GeoGraphicsScene
      * Removes all items which are associated with @p object from the GeoGraphicsScene
@@ -63,6 +71,11 @@ public:
      */
     QList<GeoGraphicsItem *> items( const GeoDataLatLonBox &box, int maxZoomLevel ) const;
 
+    /**
+     * @brief Get the list of items which belong to @p feature
+     */
+    QList<GeoGraphicsItem *> items( const GeoDataFeature *feature ) const;
+
     /**
      * @brief Get the list of items which belong to a placemark
      * that has been clicked.
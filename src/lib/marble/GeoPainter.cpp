@@ -842,8 +842,6 @@ void GeoPainter::drawPolygon ( const GeoDataPolygon & polygon,
     QVector<QPolygonF*> innerPolygons;
     d->m_viewport->screenCoordinates( polygon.outerBoundary(), outerPolygons );
 
-    QPen const currentPen = pen();
-
     bool const hasInnerBoundaries = !polygon.innerBoundaries().isEmpty();
     bool innerBoundariesOnScreen = false;
 
@@ -871,24 +869,7 @@ void GeoPainter::drawPolygon ( const GeoDataPolygon & polygon,
                 }
             }
 
-            setPen(Qt::NoPen);
-            QVector<QPolygonF*> fillPolygons = createFillPolygons( outerPolygons,
-                                                                   innerPolygons );
-
-            for( const QPolygonF* fillPolygon: fillPolygons ) {
-                ClipPainter::drawPolygon(*fillPolygon, fillRule);
-            }
-
-            setPen(currentPen);
-
-            for( const QPolygonF* outerPolygon: outerPolygons ) {
-                ClipPainter::drawPolyline( *outerPolygon );
-            }
-            for( const QPolygonF* innerPolygon: innerPolygons ) {
-                ClipPainter::drawPolyline( *innerPolygon );
-            }
-
-            qDeleteAll(fillPolygons);
+            drawPolygonWithHoles( outerPolygons, innerPolygons, fillRule );
         }
     }
 
@@ -900,6 +881,33 @@ void GeoPainter::drawPolygon ( const GeoDataPolygon & polygon,
     qDeleteAll(innerPolygons);
 }
 
+
+void GeoPainter::drawPolygonWithHoles ( const QVector<QPolygonF*> & outerPolygons,
+                                        const QVector<QPolygonF*> & innerPolygons,
+                                        Qt::FillRule fillRule )
+{
+    QPen const currentPen = pen();
+
+    setPen(Qt::NoPen);
+    QVector<QPolygonF*> fillPolygons = createFillPolygons( outerPolygons,
+                                                           innerPolygons );
+
+    for( const QPolygonF* fillPolygon: fillPolygons ) {
+        ClipPainter::drawPolygon(*fillPolygon, fillRule);
+    }
+
+    setPen(currentPen);
+
+    for( const QPolygonF* outerPolygon: outerPolygons ) {
+        ClipPainter::drawPolyline( *outerPolygon );
+    }
+    for( const QPolygonF* innerPolygon: innerPolygons ) {
+        ClipPainter::drawPolyline( *innerPolygon );
+    }
+
+    qDeleteAll(fillPolygons);
+}
+
 QVector<QPolygonF*> GeoPainter::createFillPolygons( const QVector<QPolygonF*> & outerPolygons,
                                                     const QVector<QPolygonF*> & innerPolygons ) const
 {
@@ -427,6 +427,21 @@ class MARBLE_EXPORT GeoPainter : public ClipPainter
                        Qt::FillRule fillRule = Qt::OddEvenFill );
 
 
+/*!
+    \brief Draws a polygon with holes given by its screen polygons.
+
+    The \a outerPolygons and \a innerPolygons are the screen polygons of the
+    outer and inner boundaries as created by ViewportParams::screenCoordinates().
+    The area between them is painted using the current brush of the painter
+    and the \a fillRule, the boundaries are drawn using the current pen.
+
+    \see drawPolygon( const GeoDataPolygon &, Qt::FillRule )
+*/
+    void drawPolygonWithHoles ( const QVector<QPolygonF*> & outerPolygons,
+                                const QVector<QPolygonF*> & innerPolygons,
+                                Qt::FillRule fillRule = Qt::OddEvenFill );
+
+
     QVector<QPolygonF*> createFillPolygons( const QVector<QPolygonF*> & outerPolygons,
                                             const QVector<QPolygonF*> & innerPolygons ) const;
     
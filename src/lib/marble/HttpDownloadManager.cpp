@@ -152,6 +152,13 @@ void HttpDownloadManager::addJob( const QUrl& sourceUrl, const QString& destFile
     }
 }
 
+void HttpDownloadManager::reportFileAccess( const QString &fileName )
+{
+    if ( d->m_storagePolicy ) {
+        d->m_storagePolicy->reportAccess( fileName );
+    }
+}
+
 void HttpDownloadManager::Private::finishJob( const QByteArray& data, const QString& destinationFileName,
                                      const QString& id )
 {
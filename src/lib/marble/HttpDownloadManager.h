@@ -70,6 +70,11 @@ class MARBLE_EXPORT HttpDownloadManager : public QObject
     void addJob( const QUrl& sourceUrl, const QString& destFilename, const QString &id,
                  const DownloadUsage usage );
 
+    /**
+     * Reports a read of the downloaded file @p fileName to the storage policy.
+     */
+    void reportFileAccess( const QString &fileName );
+
 
  Q_SIGNALS:
     void downloadComplete( const QString&, const QString& );
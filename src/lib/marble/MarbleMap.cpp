@@ -135,6 +135,7 @@ public:
     bool             m_showFrameRate;
     bool             m_showDebugPolygons;
     bool             m_showDebugBatchRender;
+    bool             m_fastClipping;
     GeoDataRelation::RelationTypes m_visibleRelationTypes;
     StyleBuilder     m_styleBuilder;
 
@@ -163,6 +164,7 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
     m_showFrameRate( false ),
     m_showDebugPolygons( false ),
     m_showDebugBatchRender( false ),
+    m_fastClipping( true ),
     m_visibleRelationTypes(GeoDataRelation::RouteFerry),
     m_styleBuilder(),
     m_layerManager( parent ),
@@ -844,6 +846,7 @@ void MarbleMap::paint( GeoPainter &painter, const QRect &dirtyRect )
         }
     }
     painter.setDebugBatchRender(d->m_showDebugBatchRender);
+    painter.setClipAlgorithm( d->m_fastClipping ? ClipPainter::FastClipping : ClipPainter::SectorClipping );
 
     if ( !d->m_model->mapTheme() ) {
         mDebug() << "No theme yet!";
@@ -1288,6 +1291,19 @@ bool MarbleMap::showDebugBatchRender() const
     return d->m_showDebugBatchRender;
 }
 
+void MarbleMap::setFastClipping( bool enabled )
+{
+    if ( enabled != d->m_fastClipping ) {
+        d->m_fastClipping = enabled;
+        emit repaintNeeded();
+    }
+}
+
+bool MarbleMap::fastClipping() const
+{
+    return d->m_fastClipping;
+}
+
 void MarbleMap::setShowDebugPlacemarks( bool visible)
 {
     if (visible != d->m_placemarkLayer.isDebugModeEnabled()) {
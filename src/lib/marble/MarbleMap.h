@@ -664,6 +664,17 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     bool showDebugBatchRender() const;
 
+    /**
+     * @brief Set whether polygons and polylines are clipped to the viewport
+     * with the Sutherland-Hodgman and Liang-Barsky algorithms (the default)
+     * or with the sector based clipping
+     * @param enabled whether to use the faster clipping
+     * @see ClipPainter::ClipAlgorithm
+     */
+    void setFastClipping( bool enabled );
+
+    bool fastClipping() const;
+
 
     /**
      * @brief Set whether to enter the debug mode for
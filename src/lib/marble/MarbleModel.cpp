@@ -177,8 +177,12 @@ MarbleModel::MarbleModel( QObject *parent )
     // connect the StoragePolicy used by the download manager to the FileStorageWatcher
     connect( &d->m_storagePolicy, SIGNAL(cleared()),
              &d->m_storageWatcher, SLOT(resetCurrentSize()) );
-    connect( &d->m_storagePolicy, SIGNAL(sizeChanged(qint64)),
-             &d->m_storageWatcher, SLOT(addToCurrentSize(qint64)) );
+    connect( &d->m_storagePolicy, SIGNAL(fileUpdated(QString,qint64)),
+             &d->m_storageWatcher, SLOT(updateFile(QString,qint64)) );
+    connect( &d->m_storagePolicy, SIGNAL(fileRemoved(QString)),
+             &d->m_storageWatcher, SLOT(removeFile(QString)) );
+    connect( &d->m_storagePolicy, SIGNAL(fileAccessed(QString)),
+             &d->m_storageWatcher, SLOT(accessFile(QString)) );
 
     connect( &d->m_fileManager, SIGNAL(fileAdded(QString)),
              this, SLOT(assignFillColors(QString)) );
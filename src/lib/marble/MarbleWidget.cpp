@@ -39,6 +39,7 @@
 #include "SunLocator.h"
 #include "TileCreatorDialog.h"
 #include "ViewportParams.h"
+#include "layers/TextureLayer.h"
 #include "routing/RoutingLayer.h"
 #include "MarbleAbstractPresenter.h"
 #include "StyleBuilder.h"
@@ -179,6 +180,8 @@ void MarbleWidgetPrivate::construct()
     m_map.setSize( m_widget->width(), m_widget->height() );
     m_map.setShowFrameRate( false );  // never let the map draw the frame rate,
                                        // we do this differently here in the widget
+    // the widget repaints when the tiles decoded in the background are ready
+    m_map.textureLayer()->setAsynchronousDecoding( true );
 
     m_widget->connect( &m_presenter, SIGNAL(regionSelected(GeoDataLatLonBox)), m_widget, SIGNAL(regionSelected(GeoDataLatLonBox)) );
 
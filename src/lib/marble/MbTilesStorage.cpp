@@ -0,0 +1,287 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+// Own
+#include "MbTilesStorage.h"
+
+// Qt
+#include <QAtomicInt>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QThreadStorage>
+#include <QVariant>
+
+// Marble
+#include "MarbleDebug.h"
+
+using namespace Marble;
+
+static const QLatin1String databaseSuffix( ".mbtiles/" );
+
+namespace
+{
+
+// SQLite connections must only be used by the thread that created them, so
+// each thread keeps its own set, which is closed when the thread finishes.
+class ThreadConnections
+{
+public:
+    ~ThreadConnections()
+    {
+        for ( const QString &connectionName: m_connectionNames ) {
+            QSqlDatabase::removeDatabase( connectionName );
+        }
+    }
+
+    QHash<QString, QString> m_connectionNames; // database file name -> connection name
+    QSet<QString> m_writableDatabases;         // databases whose Marble specific tables exist
+};
+
+}
+
+static QThreadStorage<ThreadConnections *> s_threadConnections;
+static QAtomicInt s_connectionCount;
+
+MbTilesStorage::MbTilesStorage( const QString &databaseFileName )
+    : m_databaseFileName( databaseFileName )
+{
+}
+
+bool MbTilesStorage::parseTileFileName( const QString &tileFileName, QString &databaseFileName,
+                                        int &zoomLevel, int &x, int &y )
+{
+    const int index = tileFileName.lastIndexOf( databaseSuffix );
+    if ( index < 0 ) {
+        return false;
+    }
+
+    const QStringList position = tileFileName.mid( index + databaseSuffix.size() ).split( QLatin1Char('/') );
+    if ( position.size() != 3 ) {
+        return false;
+    }
+
+    bool okZoomLevel = false;
+    bool okX = false;
+    bool okY = false;
+    zoomLevel = position[0].toInt( &okZoomLevel );
+    x = position[1].toInt( &okX );
+    y = position[2].toInt( &okY );
+    if ( !okZoomLevel || !okX || !okY ) {
+        return false;
+    }
+
+    // without the trailing slash
+    databaseFileName = tileFileName.left( index + databaseSuffix.size() - 1 );
+    return true;
+}
+
+QString MbTilesStorage::databaseFileName() const
+{
+    return m_databaseFileName;
+}
+
+bool MbTilesStorage::hasTile( int zoomLevel, int x, int y, QDateTime *lastModified ) const
+{
+    const QString connectionName = open( false );
+    if ( connectionName.isEmpty() ) {
+        return false;
+    }
+
+    QSqlQuery query( QSqlDatabase::database( connectionName ) );
+    query.prepare( "SELECT EXISTS(SELECT 1 FROM tiles"
+                   " WHERE zoom_level=? AND tile_column=? AND tile_row=?);" );
+    query.addBindValue( zoomLevel );
+    query.addBindValue( x );
+    query.addBindValue( y );
+    if ( !query.exec() || !query.next() || !query.value( 0 ).toBool() ) {
+        return false;
+    }
+
+    if ( lastModified ) {
+        *lastModified = QDateTime();
+
+        // databases of other tools lack the table, their tiles never expire
+        QSqlQuery timeQuery( QSqlDatabase::database( connectionName ) );
+        timeQuery.prepare( "SELECT modified FROM marble_tile_times"
+                           " WHERE zoom_level=? AND tile_column=? AND tile_row=?;" );
+        timeQuery.addBindValue( zoomLevel );
+        timeQuery.addBindValue( x );
+        timeQuery.addBindValue( y );
+        if ( timeQuery.exec() && timeQuery.next() ) {
+            *lastModified = QDateTime::fromSecsSinceEpoch( timeQuery.value( 0 ).toLongLong() );
+        }
+    }
+
+    return true;
+}
+
+QByteArray MbTilesStorage::tileData( int zoomLevel, int x, int y ) const
+{
+    const QString connectionName = open( false );
+    if ( connectionName.isEmpty() ) {
+        return QByteArray();
+    }
+
+    QSqlQuery query( QSqlDatabase::database( connectionName ) );
+    query.prepare( "SELECT tile_data FROM tiles"
+                   " WHERE zoom_level=? AND tile_column=? AND tile_row=?;" );
+    query.addBindValue( zoomLevel );
+    query.addBindValue( x );
+    query.addBindValue( y );
+    if ( !query.exec() ) {
+        m_lastError = query.lastError().text();
+        return QByteArray();
+    }
+
+    return query.next() ? query.value( 0 ).toByteArray() : QByteArray();
+}
+
+bool MbTilesStorage::storeTile( int zoomLevel, int x, int y, const QByteArray &data )
+{
+    const QString connectionName = open( true );
+    if ( connectionName.isEmpty() ) {
+        return false;
+    }
+
+    QSqlDatabase database = QSqlDatabase::database( connectionName );
+    database.transaction();
+
+    QSqlQuery query( database );
+    query.prepare( "INSERT OR REPLACE INTO tiles"
+                   " (zoom_level, tile_column, tile_row, tile_data)"
+                   " VALUES (?, ?, ?, ?);" );
+    query.addBindValue( zoomLevel );
+    query.addBindValue( x );
+    query.addBindValue( y );
+    query.addBindValue( data );
+
+    QSqlQuery timeQuery( database );
+    timeQuery.prepare( "INSERT OR REPLACE INTO marble_tile_times"
+                       " (zoom_level, tile_column, tile_row, modified)"
+                       " VALUES (?, ?, ?, ?);" );
+    timeQuery.addBindValue( zoomLevel );
+    timeQuery.addBindValue( x );
+    timeQuery.addBindValue( y );
+    timeQuery.addBindValue( QDateTime::currentSecsSinceEpoch() );
+
+    if ( !query.exec() || !timeQuery.exec() ) {
+        m_lastError = query.lastError().isValid() ? query.lastError().text() : timeQuery.lastError().text();
+        database.rollback();
+        return false;
+    }
+
+    return database.commit();
+}
+
+qint64 MbTilesStorage::removeTiles( int minimumZoomLevel )
+{
+    const QString connectionName = open( false );
+    if ( connectionName.isEmpty() ) {
+        return 0;
+    }
+
+    QSqlDatabase database = QSqlDatabase::database( connectionName );
+
+    QSqlQuery sizeQuery( database );
+    sizeQuery.prepare( "SELECT TOTAL(LENGTH(tile_data)) FROM tiles WHERE zoom_level>=?;" );
+    sizeQuery.addBindValue( minimumZoomLevel );
+    const qint64 size = sizeQuery.exec() && sizeQuery.next() ? sizeQuery.value( 0 ).toLongLong() : 0;
+
+    QSqlQuery query( database );
+    query.prepare( "DELETE FROM tiles WHERE zoom_level>=?;" );
+    query.addBindValue( minimumZoomLevel );
+    if ( !query.exec() ) {
+        m_lastError = query.lastError().text();
+        return 0;
+    }
+
+    QSqlQuery timeQuery( database );
+    timeQuery.prepare( "DELETE FROM marble_tile_times WHERE zoom_level>=?;" );
+    timeQuery.addBindValue( minimumZoomLevel );
+    timeQuery.exec();
+
+    // give the space back to the file system
+    QSqlQuery( "VACUUM;", database );
+
+    return size;
+}
+
+QString MbTilesStorage::lastError() const
+{
+    return m_lastError;
+}
+
+QString MbTilesStorage::open( bool create ) const
+{
+    const bool exists = QFileInfo::exists( m_databaseFileName );
+    if ( !exists && !create ) {
+        return QString();
+    }
+
+    if ( !s_threadConnections.hasLocalData() ) {
+        s_threadConnections.setLocalData( new ThreadConnections );
+    }
+    ThreadConnections *const connections = s_threadConnections.localData();
+
+    QString connectionName = connections->m_connectionNames.value( m_databaseFileName );
+    if ( connectionName.isEmpty() || ( !exists && create ) ) {
+        if ( !connectionName.isEmpty() ) {
+            // the database has been deleted meanwhile
+            QSqlDatabase::removeDatabase( connectionName );
+        }
+
+        if ( !exists ) {
+            QDir::root().mkpath( QFileInfo( m_databaseFileName ).absolutePath() );
+        }
+
+        connectionName = QString( "marble-mbtiles-%1" ).arg( s_connectionCount.fetchAndAddRelaxed( 1 ) );
+        QSqlDatabase database = QSqlDatabase::addDatabase( "QSQLITE", connectionName );
+        database.setDatabaseName( m_databaseFileName );
+        if ( !database.open() ) {
+            m_lastError = database.lastError().text();
+            mDebug() << "Failed to open tile database" << m_databaseFileName << m_lastError;
+            database = QSqlDatabase();
+            QSqlDatabase::removeDatabase( connectionName );
+            connections->m_connectionNames.remove( m_databaseFileName );
+            connections->m_writableDatabases.remove( m_databaseFileName );
+            return QString();
+        }
+
+        if ( !exists ) {
+            QSqlQuery( "PRAGMA application_id = 0x4d504258;", database ); // MBTiles tileset
+        }
+        if ( create ) {
+            // same schema as written by mbtile-import
+            QSqlQuery( "CREATE TABLE IF NOT EXISTS tiles (zoom_level integer, tile_column integer, tile_row integer, tile_data blob);", database );
+            QSqlQuery( "CREATE UNIQUE INDEX IF NOT EXISTS tile_index ON tiles(zoom_level, tile_column, tile_row);", database );
+            QSqlQuery( "CREATE TABLE IF NOT EXISTS metadata (name text, value text);", database );
+            QSqlQuery( "CREATE TABLE IF NOT EXISTS marble_tile_times (zoom_level integer, tile_column integer, tile_row integer, modified integer);", database );
+            QSqlQuery( "CREATE UNIQUE INDEX IF NOT EXISTS marble_tile_times_index ON marble_tile_times(zoom_level, tile_column, tile_row);", database );
+        }
+
+        connections->m_connectionNames.insert( m_databaseFileName, connectionName );
+        if ( create ) {
+            connections->m_writableDatabases.insert( m_databaseFileName );
+        } else {
+            connections->m_writableDatabases.remove( m_databaseFileName );
+        }
+    }
+
+    if ( create && !connections->m_writableDatabases.contains( m_databaseFileName ) ) {
+        // connections opened for reading did not necessarily create the Marble specific tables
+        QSqlDatabase database = QSqlDatabase::database( connectionName );
+        QSqlQuery( "CREATE TABLE IF NOT EXISTS marble_tile_times (zoom_level integer, tile_column integer, tile_row integer, modified integer);", database );
+        QSqlQuery( "CREATE UNIQUE INDEX IF NOT EXISTS marble_tile_times_index ON marble_tile_times(zoom_level, tile_column, tile_row);", database );
+        connections->m_writableDatabases.insert( m_databaseFileName );
+    }
+
+    return connectionName;
+}
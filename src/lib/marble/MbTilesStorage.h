@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_MBTILESSTORAGE_H
+#define MARBLE_MBTILESSTORAGE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+/**
+ * @short Access to the tiles of an MBTiles database.
+ *
+ * The tiles are stored in the SQLite schema of the MBTiles specification,
+ * which is also written by the mbtile-import tool. Like there, tile rows are
+ * given top to bottom. The time a tile was stored is kept in an additional
+ * table to support expiration; tiles without time stamp never expire.
+ *
+ * Tiles are addressed by virtual file names of the form
+ * <tt>&lt;database&gt;.mbtiles/&lt;zoom level&gt;/&lt;x&gt;/&lt;y&gt;</tt>,
+ * see parseTileFileName().
+ *
+ * Instances are cheap to create. They may be used from any thread, each
+ * thread gets its own database connection. The connection is looked up on
+ * every access, so an instance may also be shared between threads.
+ */
+class MARBLE_EXPORT MbTilesStorage
+{
+ public:
+    explicit MbTilesStorage( const QString &databaseFileName );
+
+    /**
+     * @brief Splits a virtual tile file name into the database and the tile position.
+     * @return false if @p tileFileName does not refer to a tile in an MBTiles database
+     */
+    static bool parseTileFileName( const QString &tileFileName, QString &databaseFileName,
+                                   int &zoomLevel, int &x, int &y );
+
+    QString databaseFileName() const;
+
+    /**
+     * @brief Returns whether the tile is stored.
+     * @param lastModified set to the time the tile was stored, invalid for imported tiles
+     */
+    bool hasTile( int zoomLevel, int x, int y, QDateTime *lastModified = nullptr ) const;
+
+    /**
+     * @brief Returns the stored data of the tile, or an empty byte array.
+     */
+    QByteArray tileData( int zoomLevel, int x, int y ) const;
+
+    /**
+     * @brief Stores the tile, creating the database if needed.
+     */
+    bool storeTile( int zoomLevel, int x, int y, const QByteArray &data );
+
+    /**
+     * @brief Removes all tiles of @p minimumZoomLevel and above.
+     * @return the number of bytes removed
+     */
+    qint64 removeTiles( int minimumZoomLevel );
+
+    QString lastError() const;
+
+ private:
+    /**
+     * Returns the connection of the current thread to the database, or an
+     * empty name if it cannot be opened.
+     */
+    QString open( bool create ) const;
+
+    const QString m_databaseFileName;
+    mutable QString m_lastError;
+};
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+
+// Own
+#include "MbTilesStoragePolicy.h"
+
+// Qt
+#include <QDirIterator>
+#include <QFileInfo>
+
+// Marble
+#include "MarbleDebug.h"
+#include "MarbleGlobal.h"
+#include "MarbleDirs.h"
+#include "MbTilesStorage.h"
+
+using namespace Marble;
+
+MbTilesStoragePolicy::MbTilesStoragePolicy( const QString &dataDirectory, QObject *parent )
+    : StoragePolicy( parent ),
+      m_dataDirectory( dataDirectory )
+{
+    if ( m_dataDirectory.isEmpty() )
+        m_dataDirectory = MarbleDirs::localPath() + QLatin1String("/cache/");
+}
+
+MbTilesStoragePolicy::~MbTilesStoragePolicy()
+{
+}
+
+bool MbTilesStoragePolicy::fileExists( const QString &fileName ) const
+{
+    QString databaseFileName;
+    int zoomLevel, x, y;
+    if ( !MbTilesStorage::parseTileFileName( absoluteFileName( fileName ), databaseFileName, zoomLevel, x, y ) ) {
+        return false;
+    }
+
+    return MbTilesStorage( databaseFileName ).hasTile( zoomLevel, x, y );
+}
+
+bool MbTilesStoragePolicy::updateFile( const QString &fileName, const QByteArray &data )
+{
+    QString databaseFileName;
+    int zoomLevel, x, y;
+    if ( !MbTilesStorage::parseTileFileName( absoluteFileName( fileName ), databaseFileName, zoomLevel, x, y ) ) {
+        m_errorMsg = fileName + QLatin1String(": not a tile in an MBTiles database");
+        return false;
+    }
+
+    MbTilesStorage storage( databaseFileName );
+    if ( !storage.storeTile( zoomLevel, x, y, data ) ) {
+        m_errorMsg = databaseFileName + QLatin1String(": ") + storage.lastError();
+        qCritical() << "MbTilesStorage::storeTile" << m_errorMsg;
+        return false;
+    }
+
+    emit sizeChanged( data.size() );
+
+    return true;
+}
+
+void MbTilesStoragePolicy::clearCache()
+{
+    mDebug() << Q_FUNC_INFO;
+
+    const QString cachedMapsDirectory = m_dataDirectory + QLatin1String("/maps");
+    QDirIterator it( cachedMapsDirectory, QStringList() << QStringLiteral("*.mbtiles"),
+                     QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories );
+    while ( it.hasNext() ) {
+        it.next();
+
+        // Like for tile directories, the base tiles are kept
+        MbTilesStorage storage( it.filePath() );
+        emit sizeChanged( -storage.removeTiles( maxBaseTileLevel + 1 ) );
+    }
+}
+
+QString MbTilesStoragePolicy::lastErrorMessage() const
+{
+    return m_errorMsg;
+}
+
+QString MbTilesStoragePolicy::absoluteFileName( const QString &fileName ) const
+{
+    QFileInfo const dirInfo( fileName );
+    return dirInfo.isAbsolute() ? fileName : m_dataDirectory + QLatin1Char('/') + fileName;
+}
+
+#include "moc_MbTilesStoragePolicy.cpp"
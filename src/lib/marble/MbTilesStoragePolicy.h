@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_MBTILESSTORAGEPOLICY_H
+#define MARBLE_MBTILESSTORAGEPOLICY_H
+
+#include "StoragePolicy.h"
+#include "marble_export.h"
+
+namespace Marble
+{
+
+/**
+ * @short Storage policy which keeps tiles in MBTiles databases.
+ *
+ * The file names passed to this policy are the virtual tile file names
+ * described in MbTilesStorage, relative to the data directory.
+ */
+class MARBLE_EXPORT MbTilesStoragePolicy : public StoragePolicy
+{
+    Q_OBJECT
+    
+    public:
+        /**
+         * Creates a new MBTiles storage policy.
+         *
+         * @param dataDirectory The directory where the databases should go to.
+         * @param parent The parent object.
+         */
+        explicit MbTilesStoragePolicy( const QString &dataDirectory = QString(), QObject *parent = nullptr );
+
+        ~MbTilesStoragePolicy() override;
+
+        /**
+         * Returns whether the tile @p fileName is stored already.
+         */
+        bool fileExists( const QString &fileName ) const override;
+
+        /**
+         * Stores the tile @p fileName with the given @p data.
+         */
+        bool updateFile( const QString &fileName, const QByteArray &data ) override;
+
+        /**
+         * Removes all but the base tiles from the databases in the data directory.
+         */
+        void clearCache() override;
+
+        /**
+         * Returns the last error message.
+         */
+        QString lastErrorMessage() const override;
+
+    private:
+        Q_DISABLE_COPY( MbTilesStoragePolicy )
+
+        QString absoluteFileName( const QString &fileName ) const;
+
+        QString m_dataDirectory;
+        QString m_errorMsg;
+};
+
+}
+
+#endif
@@ -18,6 +18,7 @@
 // Marble
 #include "GeoPainter.h"
 #include "MarbleDebug.h"
+#include "ScanlineJobScheduler.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "TextureColorizer.h"
@@ -30,7 +31,7 @@ using namespace Marble;
 class MercatorScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int xLeft, int xRight, qreal leftLon, ScanlineJobScheduler *scheduler );
 
     void run() override;
 
@@ -40,18 +41,22 @@ private:
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    const int m_yPaintedTop;
-    const int m_yPaintedBottom;
+    const int m_xLeft;
+    const int m_xRight;
+    const qreal m_leftLon;
+    ScanlineJobScheduler *const m_scheduler;
 };
 
-MercatorScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+MercatorScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int xLeft, int xRight, qreal leftLon, ScanlineJobScheduler *scheduler )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yPaintedTop( yTop ),
-      m_yPaintedBottom( yBottom )
+      m_xLeft( xLeft ),
+      m_xRight( xRight ),
+      m_leftLon( leftLon ),
+      m_scheduler( scheduler )
 {
 }
 
@@ -59,10 +64,21 @@ MercatorScanlineTextureMapper::MercatorScanlineTextureMapper( StackedTileLoader
     : TextureMapperInterface(),
       m_tileLoader( tileLoader ),
       m_radius( 0 ),
-      m_oldYPaintedTop( 0 )
+      m_oldYPaintedTop( 0 ),
+      m_centerChanged( false ),
+      m_canvasTileLevel( -1 ),
+      m_canvasMapQuality( NormalQuality ),
+      m_canvasLeftLon( 0.0 ),
+      m_canvasYCenterOffset( 0 ),
+      m_canvasCoversHeight( false )
 {
 }
 
+void MercatorScanlineTextureMapper::setCenterChanged()
+{
+    m_centerChanged = true;
+}
+
 void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
                                                 const ViewportParams *viewport,
                                                 int tileZoomLevel,
@@ -84,6 +100,13 @@ void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
         m_repaintNeeded = true;
     }
 
+    if ( m_centerChanged && !m_repaintNeeded ) {
+        // The colorizer converts the whole canvas in place, so its result
+        // can't be scrolled.
+        m_repaintNeeded = texColorizer || !scrollTexture( viewport, tileZoomLevel, painter->mapQuality() );
+    }
+    m_centerChanged = false;
+
     if ( m_repaintNeeded ) {
         mapTexture( viewport, tileZoomLevel, painter->mapQuality() );
 
@@ -97,6 +120,11 @@ void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
     painter->drawImage( dirtyRect, m_canvasImage, dirtyRect );
 }
 
+QString MercatorScanlineTextureMapper::runtimeTrace() const
+{
+    return m_scheduler.runtimeTrace();
+}
+
 void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
     // Reset backend
@@ -104,6 +132,7 @@ void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
 
     // Initialize needed constants:
 
+    const int imageWidth  = m_canvasImage.width();
     const int imageHeight = m_canvasImage.height();
 
     // Calculate y-range the represented by the center point, yTop and
@@ -122,14 +151,8 @@ void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
     yPaintedTop = qBound(0, yPaintedTop, imageHeight);
     yPaintedBottom = qBound(0, yPaintedBottom, imageHeight);
 
-    const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = ( yPaintedBottom - yPaintedTop ) / numThreads;
-    for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yPaintedTop +  i      * yStep;
-        const int yEnd   = yPaintedTop + (i + 1) * yStep;
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
-        m_threadPool.start( job );
-    }
+    const qreal leftLon = leftLongitude( viewport, imageWidth );
+    startRenderJobs( viewport, tileZoomLevel, mapQuality, yPaintedTop, yPaintedBottom, 0, imageWidth, leftLon );
 
     // Remove unused lines
     const int clearStart = ( yPaintedTop - m_oldYPaintedTop <= 0 ) ? yPaintedBottom : 0;
@@ -143,12 +166,117 @@ void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
     }
 
     m_threadPool.waitForDone();
+    m_scheduler.finish();
 
     m_oldYPaintedTop = yPaintedTop;
 
+    m_canvasTileLevel = tileZoomLevel;
+    m_canvasMapQuality = mapQuality;
+    m_canvasLeftLon = leftLon;
+    m_canvasYCenterOffset = centerLatitudeOffset( viewport );
+    m_canvasCoversHeight = ( realYTop <= 0 && realYBottom >= imageHeight );
+
     m_tileLoader->cleanupTilehash();
 }
 
+bool MercatorScanlineTextureMapper::scrollTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
+{
+    if ( tileZoomLevel != m_canvasTileLevel || mapQuality != m_canvasMapQuality ) {
+        return false;
+    }
+
+    const int imageWidth  = m_canvasImage.width();
+    const int imageHeight = m_canvasImage.height();
+    const float rad2Pixel = (float)( 2 * viewport->radius() ) / M_PI;
+    const qreal pixel2Rad = 1.0/rad2Pixel;
+
+    // Only scroll while the map covers the canvas vertically, before and
+    // after the move, so that there are no rows to be cleared.
+    qreal realYTop, realYBottom, dummyX;
+    GeoDataCoordinates yNorth(0, viewport->currentProjection()->maxLat(), 0);
+    GeoDataCoordinates ySouth(0, viewport->currentProjection()->minLat(), 0);
+    viewport->screenCoordinates(yNorth, dummyX, realYTop );
+    viewport->screenCoordinates(ySouth, dummyX, realYBottom );
+
+    if ( !m_canvasCoversHeight || realYTop > 0 || realYBottom < imageHeight ) {
+        return false;
+    }
+
+    // Rows are placed at integer offsets already. Columns are scrolled by
+    // whole pixels, so the canvas may lag up to half a pixel behind the
+    // viewport until the next full mapping.
+    qreal deltaLon = m_canvasLeftLon - leftLongitude( viewport, imageWidth );
+    while ( deltaLon < -M_PI ) deltaLon += 2 * M_PI;
+    while ( deltaLon >  M_PI ) deltaLon -= 2 * M_PI;
+
+    const int centerOffset = centerLatitudeOffset( viewport );
+    const int dx = qRound( deltaLon / pixel2Rad );
+    const int dy = centerOffset - m_canvasYCenterOffset;
+
+    if ( qAbs( dx ) >= imageWidth || qAbs( dy ) >= imageHeight ) {
+        return false;
+    }
+
+    m_tileLoader->resetTilehash();
+
+    ScanlineTextureMapperContext::scrollCanvas( &m_canvasImage, dx, dy );
+    const qreal leftLon = m_canvasLeftLon - dx * pixel2Rad;
+
+    // Map the rows that got exposed ...
+    if ( dy != 0 ) {
+        const int yStart = ( dy > 0 ) ? 0  : imageHeight + dy;
+        const int yEnd   = ( dy > 0 ) ? dy : imageHeight;
+        startRenderJobs( viewport, tileZoomLevel, mapQuality, yStart, yEnd, 0, imageWidth, leftLon );
+        m_threadPool.waitForDone();
+        m_scheduler.finish();
+    }
+
+    // ... and the columns of the remaining rows
+    if ( dx != 0 ) {
+        const int yStart = ( dy > 0 ) ? dy : 0;
+        const int yEnd   = ( dy > 0 ) ? imageHeight : imageHeight + dy;
+        const int xLeft  = ( dx > 0 ) ? 0  : imageWidth + dx;
+        const int xRight = ( dx > 0 ) ? dx : imageWidth;
+        startRenderJobs( viewport, tileZoomLevel, mapQuality, yStart, yEnd, xLeft, xRight, leftLon );
+        m_threadPool.waitForDone();
+        m_scheduler.finish();
+    }
+
+    m_canvasLeftLon = leftLon;
+    m_canvasYCenterOffset = centerOffset;
+
+    m_tileLoader->cleanupTilehash();
+
+    return true;
+}
+
+void MercatorScanlineTextureMapper::startRenderJobs( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality,
+                                                     int yTop, int yBottom, int xLeft, int xRight, qreal leftLon )
+{
+    const int numThreads = m_threadPool.maxThreadCount();
+    m_scheduler.start( yTop, yBottom, numThreads );
+    for ( int i = 0; i < numThreads; ++i ) {
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality,
+                                              xLeft, xRight, leftLon, &m_scheduler );
+        m_threadPool.start( job );
+    }
+}
+
+qreal MercatorScanlineTextureMapper::leftLongitude( const ViewportParams *viewport, int imageWidth )
+{
+    const float rad2Pixel = (float)( 2 * viewport->radius() ) / M_PI;
+    const qreal pixel2Rad = 1.0/rad2Pixel;
+
+    return viewport->centerLongitude() - ( imageWidth / 2 * pixel2Rad );
+}
+
+int MercatorScanlineTextureMapper::centerLatitudeOffset( const ViewportParams *viewport )
+{
+    const float rad2Pixel = (float)( 2 * viewport->radius() ) / M_PI;
+
+    return (int)( asinh( tan( viewport->centerLatitude() ) ) * rad2Pixel );
+}
+
 
 void MercatorScanlineTextureMapper::RenderJob::run()
 {
@@ -170,16 +298,16 @@ void MercatorScanlineTextureMapper::RenderJob::run()
     const int n = ScanlineTextureMapperContext::interpolationStep( m_viewport, m_mapQuality );
 
     // Calculate translation of center point
-    const qreal centerLon = m_viewport->centerLongitude();
     const qreal centerLat = m_viewport->centerLatitude();
 
     const int yCenterOffset = (int)( asinh( tan( centerLat ) ) * rad2Pixel  );
 
-    qreal leftLon = + centerLon - ( imageWidth / 2 * pixel2Rad );
+    // Longitude of the first mapped column
+    qreal leftLon = m_leftLon + m_xLeft * pixel2Rad;
     while ( leftLon < -M_PI ) leftLon += 2 * M_PI;
     while ( leftLon >  M_PI ) leftLon -= 2 * M_PI;
 
-    const int maxInterpolationPointX = n * (int)( imageWidth / n - 1 ) + 1;
+    const int maxInterpolationPointX = m_xLeft + n * (int)( ( m_xRight - m_xLeft ) / n - 1 ) + 1;
 
 
     // initialize needed variables that are modified during texture mapping:
@@ -189,18 +317,20 @@ void MercatorScanlineTextureMapper::RenderJob::run()
 
     // Scanline based algorithm to do texture mapping
 
-    for ( int y = m_yPaintedTop; y < m_yPaintedBottom; ++y ) {
+    // Fetch chunks of rows from the scheduler until all rows are done
+    int yEnd = 0;
+    for ( int y = 0; y < yEnd || m_scheduler->nextChunk( y, yEnd ); ++y ) {
 
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) );
+        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + m_xLeft;
 
         qreal lon = leftLon;
         const qreal lat = gd ( ( (imageHeight / 2 + yCenterOffset) - y )
                     * pixel2Rad );
 
-        for ( int x = 0; x < imageWidth; ++x ) {
+        for ( int x = m_xLeft; x < m_xRight; ++x ) {
             // Prepare for interpolation
             bool interpolate = false;
-            if ( x > 0 && x <= maxInterpolationPointX ) {
+            if ( x > m_xLeft && x <= maxInterpolationPointX ) {
                 x += n - 1;
                 lon += (n - 1) * pixel2Rad;
                 interpolate = !printQuality;
@@ -221,7 +351,7 @@ void MercatorScanlineTextureMapper::RenderJob::run()
                 scanLine += ( n - 1 );
             }
 
-            if ( x < imageWidth ) {
+            if ( x < m_xRight ) {
                 if ( highQuality )
                     context.pixelValueF( lon, lat, scanLine );
                 else
@@ -233,13 +363,13 @@ void MercatorScanlineTextureMapper::RenderJob::run()
         }
 
         // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yPaintedBottom ) { 
+        if ( interlaced && y + 1 < yEnd ) { 
 
             const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
-            memcpy( m_canvasImage->scanLine( y + 1 ),
-                    m_canvasImage->scanLine( y     ),
-                    imageWidth * pixelByteSize );
+            memcpy( m_canvasImage->scanLine( y + 1 ) + m_xLeft * pixelByteSize,
+                    m_canvasImage->scanLine( y     ) + m_xLeft * pixelByteSize,
+                    ( m_xRight - m_xLeft ) * pixelByteSize );
             ++y;
         }
     }
@@ -9,6 +9,7 @@
 #define MARBLE_MERCATORSCANLINETEXTUREMAPPER_H
 
 
+#include "ScanlineJobScheduler.h"
 #include "TextureMapperInterface.h"
 
 #include "MarbleGlobal.h"
@@ -33,9 +34,26 @@ class MercatorScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer ) override;
 
+    QString runtimeTrace() const override;
+
+    void setCenterChanged() override;
+
  private:
     void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
 
+    /**
+     * Scrolls the previous canvas by the movement of the viewport and only
+     * maps the parts that got exposed. Returns false if the canvas needs to
+     * be mapped again completely, e.g. after a zoom or quality change.
+     */
+    bool scrollTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
+
+    void startRenderJobs( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality,
+                          int yTop, int yBottom, int xLeft, int xRight, qreal leftLon );
+
+    static qreal leftLongitude( const ViewportParams *viewport, int imageWidth );
+    static int centerLatitudeOffset( const ViewportParams *viewport );
+
  private:
     class RenderJob;
 
@@ -44,6 +62,15 @@ class MercatorScanlineTextureMapper : public TextureMapperInterface
     QImage m_canvasImage;
     int    m_oldYPaintedTop;
     QThreadPool m_threadPool;
+    ScanlineJobScheduler m_scheduler;
+
+    // State of the mapped canvas, needed for scrolling it
+    bool       m_centerChanged;
+    int        m_canvasTileLevel;
+    MapQuality m_canvasMapQuality;
+    qreal      m_canvasLeftLon;
+    int        m_canvasYCenterOffset;
+    bool       m_canvasCoversHeight;
 };
 
 }
@@ -10,6 +10,7 @@
 #include "blendings/Blending.h"
 #include "blendings/BlendingFactory.h"
 #include "SunLocator.h"
+#include "SunShading.h"
 #include "MarbleMath.h"
 #include "MarbleDebug.h"
 #include "GeoDataGroundOverlay.h"
@@ -23,6 +24,8 @@
 
 #include "GeoDataCoordinates.h"
 
+#include <QCache>
+#include <QMutex>
 #include <QPointer>
 #include <QPainter>
 #include <QPainterPath>
@@ -32,12 +35,31 @@ using namespace Marble;
 class Q_DECL_HIDDEN MergedLayerDecorator::Private
 {
 public:
-    Private( TileLoader *tileLoader, const SunLocator *sunLocator );
+    /**
+     * The image of a stacked tile before the sun dependent steps, so that only
+     * these get repeated after the sun moved. The tiles from @p nextTile on are
+     * blended after the image. The texture tiles are only reused once per
+     * sun position, other loads take the current images from the TileLoader.
+     */
+    struct UnshadedTile
+    {
+        QVector<QSharedPointer<TextureTile> > tiles;
+        QImage image;
+        int nextTile;
+        bool groundOverlaysRendered;
+        int sunPosition;
+    };
 
-    static int maxDivisor( int maximum, int fullLength );
+    Private( TileLoader *tileLoader, const SunLocator *sunLocator );
 
     StackedTile *createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const;
 
+    QVector<QSharedPointer<TextureTile> > takeUnshadedTextureTiles( const TileId &id ) const;
+    bool findUnshadedTile( const TileId &id, const QVector<QSharedPointer<TextureTile> > &tiles, UnshadedTile *result ) const;
+    void insertUnshadedTile( const TileId &id, const QVector<QSharedPointer<TextureTile> > &tiles,
+                             const QImage &image, int nextTile, bool groundOverlaysRendered ) const;
+    void clearUnshadedTiles();
+
     void renderGroundOverlays( QImage *tileImage, const QVector<QSharedPointer<TextureTile> > &tiles ) const;
     void paintSunShading( QImage *tileImage, const TileId &id ) const;
     void paintTileId( QImage *tileImage, const TileId &id ) const;
@@ -57,6 +79,10 @@ public:
     bool m_showSunShading;
     bool m_showCityLights;
     bool m_showTileId;
+    mutable QMutex m_unshadedTilesMutex;
+    mutable QCache<TileId, UnshadedTile> m_unshadedTiles;
+    // Counts the moves of the sun
+    int m_sunPosition;
 };
 
 MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator *sunLocator ) :
@@ -70,7 +96,10 @@ MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator
     m_levelZeroRows( 0 ),
     m_showSunShading( false ),
     m_showCityLights( false ),
-    m_showTileId( false )
+    m_showTileId( false ),
+    m_unshadedTilesMutex(),
+    m_unshadedTiles( 20000 ), // kilobytes, like the cache of the StackedTileLoader
+    m_sunPosition( 0 )
 {
 }
 
@@ -98,11 +127,37 @@ void MergedLayerDecorator::setTextureLayers( const QVector<const GeoSceneTexture
     d->m_textureLayers = textureLayers;
 
     d->detectMaxTileLevel();
+    d->clearUnshadedTiles();
 }
 
 void MergedLayerDecorator::updateGroundOverlays(const QList<const GeoDataGroundOverlay *> &groundOverlays )
 {
     d->m_groundOverlays = groundOverlays;
+    d->clearUnshadedTiles();
+}
+
+void MergedLayerDecorator::setUnshadedTileCacheLimit( quint64 kilobytes )
+{
+    QMutexLocker locker( &d->m_unshadedTilesMutex );
+    d->m_unshadedTiles.setMaxCost( kilobytes );
+}
+
+quint64 MergedLayerDecorator::unshadedTileCacheLimit() const
+{
+    QMutexLocker locker( &d->m_unshadedTilesMutex );
+    return d->m_unshadedTiles.maxCost();
+}
+
+void MergedLayerDecorator::updateSunPosition()
+{
+    QMutexLocker locker( &d->m_unshadedTilesMutex );
+    ++d->m_sunPosition;
+}
+
+void MergedLayerDecorator::removeUnshadedTile( const TileId &stackedTileId )
+{
+    QMutexLocker locker( &d->m_unshadedTilesMutex );
+    d->m_unshadedTiles.remove( stackedTileId );
 }
 
 
@@ -155,13 +210,19 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
     const TileId firstId = tiles.first()->id();
     const TileId id( 0, firstId.zoomLevel(), firstId.x(), firstId.y() );
 
+    // Continue with the unshaded image if only the sun moved since the tile was created
+    UnshadedTile unshadedTile;
+    const bool isUnshadedTileCached = findUnshadedTile( id, tiles, &unshadedTile );
+    const Blending *const sunLightBlending = m_blendingFactory.findBlending( QStringLiteral( "SunLightBlending" ) );
+
     // Image for blending all the texture tiles on it
-    QImage resultImage;
+    QImage resultImage = isUnshadedTileCached ? unshadedTile.image : QImage();
 
     // if there are more than one active texture layers, we have to convert the
     // result tile into QImage::Format_ARGB32_Premultiplied to make blending possible
     const bool withConversion = tiles.count() > 1 || m_showSunShading || m_showTileId || !m_groundOverlays.isEmpty();
-    for ( const QSharedPointer<TextureTile> &tile: tiles ) {
+    for ( int i = isUnshadedTileCached ? unshadedTile.nextTile : 0; i < tiles.count(); ++i ) {
+        const QSharedPointer<TextureTile> &tile = tiles[i];
 
         // Image blending. If there are several images in the same tile (like clouds
         // or hillshading images over the map) blend them all into only one image
@@ -175,6 +236,10 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
                 resultImage = QImage( tile->image()->size(), QImage::Format_ARGB32_Premultiplied );
             }
 
+            if ( blending == sunLightBlending && !isUnshadedTileCached ) {
+                insertUnshadedTile( id, tiles, resultImage, i, false );
+            }
+
             blending->blend( &resultImage, tile.data() );
         }
         else {
@@ -187,9 +252,14 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
         }
     }
 
-    renderGroundOverlays( &resultImage, tiles );
+    if ( !isUnshadedTileCached || !unshadedTile.groundOverlaysRendered ) {
+        renderGroundOverlays( &resultImage, tiles );
+    }
 
     if ( m_showSunShading && !m_showCityLights ) {
+        if ( !isUnshadedTileCached ) {
+            insertUnshadedTile( id, tiles, resultImage, tiles.count(), true );
+        }
         paintSunShading( &resultImage, id );
     }
 
@@ -286,10 +356,76 @@ void MergedLayerDecorator::Private::renderGroundOverlays( QImage *tileImage, con
     }
 }
 
+QVector<QSharedPointer<TextureTile> > MergedLayerDecorator::Private::takeUnshadedTextureTiles( const TileId &id ) const
+{
+    QMutexLocker locker( &m_unshadedTilesMutex );
+    UnshadedTile *const unshadedTile = m_unshadedTiles.object( id );
+    if ( !unshadedTile || unshadedTile->sunPosition == m_sunPosition ) {
+        return QVector<QSharedPointer<TextureTile> >();
+    }
+
+    unshadedTile->sunPosition = m_sunPosition;
+    return unshadedTile->tiles;
+}
+
+bool MergedLayerDecorator::Private::findUnshadedTile( const TileId &id, const QVector<QSharedPointer<TextureTile> > &tiles, UnshadedTile *result ) const
+{
+    QMutexLocker locker( &m_unshadedTilesMutex );
+    const UnshadedTile *const unshadedTile = m_unshadedTiles.object( id );
+
+    // an updated texture tile makes the unshaded image outdated
+    if ( !unshadedTile || unshadedTile->tiles != tiles ) {
+        return false;
+    }
+
+    *result = *unshadedTile;
+    return true;
+}
+
+void MergedLayerDecorator::Private::insertUnshadedTile( const TileId &id, const QVector<QSharedPointer<TextureTile> > &tiles,
+                                                        const QImage &image, int nextTile, bool groundOverlaysRendered ) const
+{
+    if ( image.isNull() ) {
+        return;
+    }
+
+    // The image is shared with the result tile until it gets shaded, the
+    // texture tiles are shared with the stacked tile until it gets removed.
+    qint64 cost = image.sizeInBytes();
+    for ( const QSharedPointer<TextureTile> &tile: tiles ) {
+        cost += tile->image()->sizeInBytes();
+    }
+
+    QMutexLocker locker( &m_unshadedTilesMutex );
+    if ( m_unshadedTiles.maxCost() == 0 ) {
+        return;
+    }
+
+    UnshadedTile *const unshadedTile = new UnshadedTile;
+    unshadedTile->tiles = tiles;
+    unshadedTile->image = image;
+    unshadedTile->nextTile = nextTile;
+    unshadedTile->groundOverlaysRendered = groundOverlaysRendered;
+    unshadedTile->sunPosition = m_sunPosition;
+
+    m_unshadedTiles.insert( id, unshadedTile, qMax<qint64>( 1, cost / 1024 ) );
+}
+
+void MergedLayerDecorator::Private::clearUnshadedTiles()
+{
+    QMutexLocker locker( &m_unshadedTilesMutex );
+    m_unshadedTiles.clear();
+}
+
 StackedTile *MergedLayerDecorator::loadTile( const TileId &stackedTileId )
 {
+    // Reloading after the sun moved reuses the texture tiles of the unshaded image
+    QVector<QSharedPointer<TextureTile> > tiles = d->takeUnshadedTextureTiles( stackedTileId );
+    if ( !tiles.isEmpty() ) {
+        return d->createTile( tiles );
+    }
+
     const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->findRelevantTextureLayers( stackedTileId );
-    QVector<QSharedPointer<TextureTile> > tiles;
     tiles.reserve(textureLayers.size());
 
     for ( const GeoSceneTextureTileDataset *layer: textureLayers ) {
@@ -384,6 +520,10 @@ void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage
 
 void MergedLayerDecorator::setShowSunShading( bool show )
 {
+    if ( d->m_showSunShading != show ) {
+        d->clearUnshadedTiles();
+    }
+
     d->m_showSunShading = show;
 }
 
@@ -394,6 +534,10 @@ bool MergedLayerDecorator::showSunShading() const
 
 void MergedLayerDecorator::setShowCityLights( bool show )
 {
+    if ( d->m_showCityLights != show ) {
+        d->clearUnshadedTiles();
+    }
+
     d->m_showCityLights = show;
 }
 
@@ -409,83 +553,8 @@ void MergedLayerDecorator::setShowTileId( bool visible )
 
 void MergedLayerDecorator::Private::paintSunShading( QImage *tileImage, const TileId &id ) const
 {
-    if ( tileImage->depth() != 32 )
-        return;
-
     // TODO add support for 8-bit maps?
-    // add sun shading
-    const qreal  global_width  = tileImage->width()
-            * TileLoaderHelper::levelToColumn( m_levelZeroColumns, id.zoomLevel() );
-    const qreal  global_height = tileImage->height()
-            * TileLoaderHelper::levelToRow( m_levelZeroRows, id.zoomLevel() );
-    const qreal lon_scale = 2*M_PI / global_width;
-    const qreal lat_scale = -M_PI / global_height;
-    const int tileHeight = tileImage->height();
-    const int tileWidth = tileImage->width();
-
-    // First we determine the supporting point interval for the interpolation.
-    const int n = maxDivisor( 30, tileWidth );
-    const int ipRight = n * (int)( tileWidth / n );
-
-    for ( int cur_y = 0; cur_y < tileHeight; ++cur_y ) {
-        const qreal lat = lat_scale * ( id.y() * tileHeight + cur_y ) - 0.5*M_PI;
-        const qreal a = sin( (lat+DEG2RAD * m_sunLocator->getLat() )/2.0 );
-        const qreal c = cos(lat)*cos( -DEG2RAD * m_sunLocator->getLat() );
-
-        QRgb* scanline = (QRgb*)tileImage->scanLine( cur_y );
-
-        qreal lastShade = -10.0;
-
-        int cur_x = 0;
-
-        while ( cur_x < tileWidth ) {
-
-            const bool interpolate = ( cur_x != 0 && cur_x < ipRight && cur_x + n < tileWidth );
-
-            qreal shade = 0;
-
-            if ( interpolate ) {
-                const int check = cur_x + n;
-                const qreal checklon   = lon_scale * ( id.x() * tileWidth + check );
-                shade = m_sunLocator->shading( checklon, a, c );
-
-                // if the shading didn't change across the interpolation
-                // interval move on and don't change anything.
-                if ( shade == lastShade && shade == 1.0 ) {
-                    scanline += n;
-                    cur_x += n;
-                    continue;
-                }
-                if ( shade == lastShade && shade == 0.0 ) {
-                    for ( int t = 0; t < n; ++t ) {
-                        SunLocator::shadePixel(*scanline, shade);
-                        ++scanline;
-                    }
-                    cur_x += n;
-                    continue;
-                }
-                for ( int t = 0; t < n ; ++t ) {
-                    const qreal lon   = lon_scale * ( id.x() * tileWidth + cur_x );
-                    shade = m_sunLocator->shading( lon, a, c );
-                    SunLocator::shadePixel(*scanline, shade);
-                    ++scanline;
-                    ++cur_x;
-                }
-            }
-
-            else {
-                // Make sure we don't exceed the image memory
-                if ( cur_x < tileWidth ) {
-                    const qreal lon   = lon_scale * ( id.x() * tileWidth + cur_x );
-                    shade = m_sunLocator->shading( lon, a, c );
-                    SunLocator::shadePixel(*scanline, shade);
-                    ++scanline;
-                    ++cur_x;
-                }
-            }
-            lastShade = shade;
-        }
-    }
+    SunShading::shadeTile( tileImage, nullptr, id, m_sunLocator, m_levelZeroColumns, m_levelZeroRows );
 }
 
 void MergedLayerDecorator::Private::paintTileId( QImage *tileImage, const TileId &id ) const
@@ -585,25 +654,3 @@ QVector<const GeoSceneTextureTileDataset *> MergedLayerDecorator::Private::findR
 
     return result;
 }
-
-// TODO: This should likely go into a math class in the future ...
-
-int MergedLayerDecorator::Private::maxDivisor( int maximum, int fullLength )
-{
-    // Find the optimal interpolation interval n for the
-    // current image canvas width
-    int best = 2;
-
-    int  nEvalMin = fullLength;
-    for ( int it = 1; it <= maximum; ++it ) {
-        // The optimum is the interval which results in the least amount
-        // supporting points taking into account the rest which can't
-        // get used for interpolation.
-        int nEval = fullLength / it + fullLength % it;
-        if ( nEval < nEvalMin ) {
-            nEvalMin = nEval;
-            best = it;
-        }
-    }
-    return best;
-}
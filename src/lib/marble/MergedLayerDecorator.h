@@ -9,6 +9,7 @@
 #include <QList>
 
 #include "MarbleGlobal.h"
+#include "marble_export.h"
 
 class QImage;
 class QString;
@@ -27,7 +28,7 @@ class TileId;
 class TileLoader;
 class RenderState;
 
-class MergedLayerDecorator
+class MARBLE_EXPORT MergedLayerDecorator
 {
  public:
     MergedLayerDecorator( TileLoader * const tileLoader, const SunLocator* sunLocator );
@@ -36,6 +37,25 @@ class MergedLayerDecorator
     void setTextureLayers( const QVector<const GeoSceneTextureTileDataset *> &textureLayers );
     void updateGroundOverlays( const QList<const GeoDataGroundOverlay *> &groundOverlays );
 
+    /**
+     * Sets the size of the cache of tiles before sun shading and city lights
+     * are applied, so that reloading the tiles after the sun moved only needs
+     * to shade them again. A limit of 0 disables the cache.
+     */
+    void setUnshadedTileCacheLimit( quint64 kilobytes );
+    quint64 unshadedTileCacheLimit() const;
+
+    /**
+     * Lets the next load of each cached tile shade its unshaded image again
+     * instead of loading its texture tiles.
+     */
+    void updateSunPosition();
+
+    /**
+     * Removes the unshaded image of a tile whose texture tiles got outdated.
+     */
+    void removeUnshadedTile( const TileId &stackedTileId );
+
     int textureLayersSize() const;
 
     /**
@@ -8,11 +8,22 @@ namespace Marble
 {
 
 ParsingRunner::ParsingRunner( QObject *parent )
-    : QObject( parent )
+    : QObject( parent ),
+      m_chunkSize( 0 )
 {
     // nothing to do
 }
 
+void ParsingRunner::setChunkSize( int chunkSize )
+{
+    m_chunkSize = qMax( 0, chunkSize );
+}
+
+int ParsingRunner::chunkSize() const
+{
+    return m_chunkSize;
+}
+
 }
 
 #include "moc_ParsingRunner.cpp"
@@ -28,6 +28,27 @@ public:
       * plugin capabilities, otherwise MarbleRunnerManager will ignore the plugin
       */
     virtual GeoDataDocument* parseFile( const QString &fileName, DocumentRole role, QString& error ) = 0;
+
+    /**
+      * Asks the runner to stream completed top level features in chunks of
+      * about @p chunkSize features with featuresParsed() while parseFile() is
+      * running. 0, the default, disables streaming. Runners that cannot stream
+      * ignore it and return everything from parseFile().
+      */
+    void setChunkSize( int chunkSize );
+    int chunkSize() const;
+
+Q_SIGNALS:
+    /**
+      * Emitted from within parseFile() by streaming runners. @p chunk holds
+      * completed top level features and the shared styles parsed so far.
+      * The features are not part of the document returned by parseFile().
+      * Ownership of @p chunk passes to the receiver.
+      */
+    void featuresParsed( GeoDataDocument *chunk );
+
+private:
+    int m_chunkSize;
 };
 
 }
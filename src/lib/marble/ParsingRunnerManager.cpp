@@ -10,6 +10,7 @@
 #include "MarbleDebug.h"
 #include "PluginManager.h"
 #include "ParseRunnerPlugin.h"
+#include "ParsingRunner.h"
 #include "RunnerTask.h"
 
 #include <QFileInfo>
@@ -37,6 +38,7 @@ public:
     const PluginManager *const m_pluginManager;
     QMutex m_parsingTasksMutex;
     int m_parsingTasks;
+    int m_chunkSize;
     GeoDataDocument *m_fileResult;
 };
 
@@ -44,6 +46,7 @@ ParsingRunnerManager::Private::Private( ParsingRunnerManager *parent, const Plug
     q( parent ),
     m_pluginManager( pluginManager ),
     m_parsingTasks(0),
+    m_chunkSize(0),
     m_fileResult( nullptr )
 {
     qRegisterMetaType<GeoDataDocument*>( "GeoDataDocument*" );
@@ -88,7 +91,11 @@ void ParsingRunnerManager::parseFile( const QString &fileName, DocumentRole role
     for( const ParseRunnerPlugin *plugin: plugins ) {
         QStringList const extensions = plugin->fileExtensions();
         if ( extensions.isEmpty() || extensions.contains( suffix ) || extensions.contains( completeSuffix ) ) {
-            ParsingTask *task = new ParsingTask( plugin->newRunner(), this, fileName, role );
+            ParsingRunner *runner = plugin->newRunner();
+            runner->setChunkSize( d->m_chunkSize );
+            connect( runner, SIGNAL(featuresParsed(GeoDataDocument*)),
+                     this, SIGNAL(featuresParsed(GeoDataDocument*)), Qt::DirectConnection );
+            ParsingTask *task = new ParsingTask( runner, this, fileName, role );
             connect( task, SIGNAL(finished()), this, SLOT(cleanupParsingTask()) );
             mDebug() << "parse task " << plugin->nameId() << " " << (quintptr)task;
             ++d->m_parsingTasks;
@@ -101,6 +108,16 @@ void ParsingRunnerManager::parseFile( const QString &fileName, DocumentRole role
     }
 }
 
+void ParsingRunnerManager::setChunkSize( int chunkSize )
+{
+    d->m_chunkSize = qMax( 0, chunkSize );
+}
+
+int ParsingRunnerManager::chunkSize() const
+{
+    return d->m_chunkSize;
+}
+
 GeoDataDocument *ParsingRunnerManager::openFile( const QString &fileName, DocumentRole role, int timeout )
 {
     d->m_fileResult = nullptr;
@@ -43,12 +43,29 @@ public:
     void parseFile( const QString &fileName, DocumentRole role = UserDocument );
     GeoDataDocument *openFile( const QString &fileName, DocumentRole role = UserDocument, int timeout = 30000 );
 
+    /**
+     * Makes runners that support streaming emit completed top level features
+     * in chunks of about @p chunkSize features with featuresParsed() while
+     * parsing. 0, the default, disables streaming.
+     * @see ParsingRunner::setChunkSize
+     */
+    void setChunkSize( int chunkSize );
+    int chunkSize() const;
+
 Q_SIGNALS:
     /**
      * The file was parsed and potential error message
      */
     void parsingFinished( GeoDataDocument *document, const QString &error = QString() );
 
+    /**
+     * A streaming runner parsed the top level features in @p chunk. The signal
+     * is emitted from the thread of the runner, which waits for the receivers,
+     * so a receiver with a direct connection can slow the runner down if it
+     * does not keep up. Ownership of @p chunk passes to the receiver.
+     */
+    void featuresParsed( GeoDataDocument *chunk );
+
     /**
      * Emitted whenever all runners are finished for the query
      */
@@ -8,6 +8,7 @@
 #include "PlacemarkLayout.h"
 
 #include <QAbstractItemModel>
+#include <QDateTime>
 #include <QList>
 #include <QPoint>
 #include <QVectorIterator>
@@ -16,6 +17,8 @@
 #include <QItemSelectionModel>
 #include <qmath.h>
 
+#include <algorithm>
+
 #include "GeoDataLatLonAltBox.h"
 #include "GeoDataLatLonBox.h"
 #include "GeoDataStyle.h"
@@ -37,19 +40,19 @@
 #include <StyleBuilder.h>
 
 namespace
-{   //Helper function that checks for available room for the label
-    bool hasRoomFor(const QVector<Marble::VisiblePlacemark*> & placemarks, const QRectF &boundingBox)
+{
+    // The placemarks of a tile which have not been laid out yet
+    struct PlacemarkRange
     {
-        // Check if there is another label or symbol that overlaps.
-        QVector<Marble::VisiblePlacemark*>::const_iterator beforeItEnd = placemarks.constEnd();
-        for ( QVector<Marble::VisiblePlacemark*>::ConstIterator beforeIt = placemarks.constBegin();
-              beforeIt != beforeItEnd; ++beforeIt )
-        {
-            if ( boundingBox.intersects( (*beforeIt)->boundingBox() ) ) {
-                return false;
-            }
-        }
-        return true;
+        QList<const Marble::GeoDataPlacemark*>::const_iterator current;
+        QList<const Marble::GeoDataPlacemark*>::const_iterator end;
+    };
+
+    // The heap functions keep the greatest element on top, so the
+    // layout order is inverted to get the first placemark from there
+    bool laterInLayoutOrder(const PlacemarkRange &left, const PlacemarkRange &right)
+    {
+        return Marble::GeoDataPlacemark::placemarkLayoutOrderCompare(*right.current, *left.current);
     }
 }
 
@@ -107,6 +110,10 @@ PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
       m_placemarkModel(placemarkModel),
       m_selectionModel( selectionModel ),
       m_clock( clock ),
+      m_gridColumns( 0 ),
+      m_gridRows( 0 ),
+      m_cellWidth( 1 ),
+      m_cellHeight( 1 ),
       m_acceptedVisualCategories( acceptedVisualCategories() ),
       m_showPlaces( false ),
       m_showCities( false ),
@@ -118,7 +125,11 @@ PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
       m_maxLabelHeight(maxLabelHeight()),
       m_styleResetRequested( true ),
       m_styleBuilder(styleBuilder),
-      m_lastPlacemarkAvailable(false)
+      m_lastPlacemarkAvailable(false),
+      m_incrementalLayout(true),
+      m_layoutProjection(Spherical),
+      m_layoutRadius(0),
+      m_layoutTileLevel(-1)
 {
     Q_ASSERT(m_placemarkModel);
 
@@ -176,6 +187,16 @@ void PlacemarkLayout::setShowMaria( bool show )
     m_showMaria = show;
 }
 
+void PlacemarkLayout::setIncrementalLayout( bool incremental )
+{
+    m_incrementalLayout = incremental;
+}
+
+bool PlacemarkLayout::isIncrementalLayout() const
+{
+    return m_incrementalLayout;
+}
+
 void PlacemarkLayout::requestStyleReset()
 {
     mDebug() << "Style reset requested.";
@@ -228,6 +249,7 @@ void PlacemarkLayout::addPlacemarks( const QModelIndex& parent, int first, int l
 {
     Q_ASSERT( first < m_placemarkModel->rowCount() );
     Q_ASSERT( last < m_placemarkModel->rowCount() );
+    QHash<TileId, int> firstAdded;
     for( int i=first; i<=last; ++i ) {
         QModelIndex index = m_placemarkModel->index( i, 0, parent );
         Q_ASSERT( index.isValid() );
@@ -250,9 +272,22 @@ void PlacemarkLayout::addPlacemarks( const QModelIndex& parent, int first, int l
 
             int zoomLevel = placemark->zoomLevel();
             TileId key = TileId::fromCoordinates( coordinates, zoomLevel );
-            m_placemarkCache[key].append( placemark );
+            QList<const GeoDataPlacemark*> &placemarks = m_placemarkCache[key];
+            if ( !firstAdded.contains( key ) ) {
+                firstAdded.insert( key, placemarks.size() );
+            }
+            placemarks.append( placemark );
         }
     }
+
+    // Keep the tiles sorted so that generateLayout() only needs to merge them
+    for ( auto it = firstAdded.constBegin(); it != firstAdded.constEnd(); ++it ) {
+        QList<const GeoDataPlacemark*> &placemarks = m_placemarkCache[it.key()];
+        auto const added = placemarks.begin() + it.value();
+        std::sort( added, placemarks.end(), GeoDataPlacemark::placemarkLayoutOrderCompare );
+        std::inplace_merge( placemarks.begin(), added, placemarks.end(), GeoDataPlacemark::placemarkLayoutOrderCompare );
+    }
+
     emit repaintNeeded();
 }
 
@@ -271,8 +306,9 @@ void PlacemarkLayout::removePlacemarks( const QModelIndex& parent, int first, in
 
         int zoomLevel = placemark->zoomLevel();
         TileId key = TileId::fromCoordinates( coordinates, zoomLevel );
-        delete m_visiblePlacemarks[placemark];
-        m_visiblePlacemarks.remove(placemark);
+        VisiblePlacemark *const mark = m_visiblePlacemarks.take(placemark);
+        m_paintOrder.removeOne(mark);
+        delete mark;
         m_placemarkCache[key].removeAll( placemark );
         if (placemark->hasOsmData()) {
             qint64 const osmId = placemark->osmData().id();
@@ -365,63 +401,142 @@ QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParam
         return QVector<VisiblePlacemark *>();
     }
 
-    QList<const GeoDataPlacemark*> placemarkList;
-    int currentMaxLabelHeight;
-    do {
-        currentMaxLabelHeight = m_maxLabelHeight;
-        const int secnumber = viewport->height() / m_maxLabelHeight + 1;
-        m_rowsection.clear();
-        m_rowsection.resize(secnumber);
+    resetGrid( viewport->size() );
 
-        m_paintOrder.clear();
-        m_lastPlacemarkAvailable = false;
-        m_lastPlacemarkLabelRect = QRectF();
-        m_lastPlacemarkSymbolRect = QRectF();
-        m_labelArea = 0;
+    const QVector<VisiblePlacemark*> previousPaintOrder = m_incrementalLayout && isLayoutCurrent( viewport, tileLevel )
+                                                        ? m_paintOrder : QVector<VisiblePlacemark*>();
+    m_layoutProjection = viewport->projection();
+    m_layoutRadius = viewport->radius();
+    m_layoutTileLevel = tileLevel;
+    m_layoutSize = viewport->size();
 
-        // First handle the selected placemarks as they have the highest priority.
+    m_paintOrder.clear();
+    m_lastPlacemarkAvailable = false;
+    m_lastPlacemarkLabelRect = QRectF();
+    m_lastPlacemarkSymbolRect = QRectF();
+    m_labelArea = 0;
 
-        const QModelIndexList selectedIndexes = m_selectionModel->selection().indexes();
-        auto const viewLatLonAltBox = viewport->viewLatLonAltBox();
+    // First handle the selected placemarks as they have the highest priority.
 
-        for ( int i = 0; i < selectedIndexes.count(); ++i ) {
-            const QModelIndex index = selectedIndexes.at( i );
-            const GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
-            const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
+    const QModelIndexList selectedIndexes = m_selectionModel->selection().indexes();
+    auto const viewLatLonAltBox = viewport->viewLatLonAltBox();
 
-            if ( !coordinates.isValid() ) {
+    QSet<const GeoDataPlacemark*> selectedPlacemarks;
+    selectedPlacemarks.reserve( selectedIndexes.count() );
+    for ( const QModelIndex &index: selectedIndexes ) {
+        selectedPlacemarks.insert( static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) )) );
+    }
+
+    for ( int i = 0; i < selectedIndexes.count(); ++i ) {
+        const QModelIndex index = selectedIndexes.at( i );
+        const GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
+        const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
+
+        if ( !coordinates.isValid() ) {
+            continue;
+        }
+
+        qreal x = 0;
+        qreal y = 0;
+
+        if ( !viewLatLonAltBox.contains( coordinates ) ||
+             ! viewport->screenCoordinates( coordinates, x, y ))
+            {
                 continue;
             }
 
-            qreal x = 0;
-            qreal y = 0;
+        if( layoutPlacemark( placemark, coordinates, x, y, true) ) {
+            // Make sure not to draw more placemarks on the screen than
+            // specified by placemarksOnScreenLimit().
+            if ( placemarksOnScreenLimit( viewport->size() ) )
+                break;
+        }
 
-            if ( !viewLatLonAltBox.contains( coordinates ) ||
-                 ! viewport->screenCoordinates( coordinates, x, y ))
-                {
-                    continue;
-                }
+    }
 
-            if( layoutPlacemark( placemark, coordinates, x, y, true) ) {
-                // Make sure not to draw more placemarks on the screen than
-                // specified by placemarksOnScreenLimit().
-                if ( placemarksOnScreenLimit( viewport->size() ) )
-                    break;
-            }
+    // Then keep the placemarks of the previous layout where they still fit,
+    // so labels do not jump around while the map is moved.
+
+    QSet<const GeoDataPlacemark*> keptPlacemarks;
+    const QDateTime dateTime = m_clock->dateTime();
+    QVector<VisiblePlacemark*> keptCandidates;
+    QVector<qreal> keptLon;
+    QVector<qreal> keptLat;
+    QVector<qreal> keptAltitude;
+    for ( VisiblePlacemark *mark: previousPaintOrder ) {
+        // Placemarks which lacked room for their label get another chance below
+        const GeoDataPlacemark *placemark = mark->placemark();
+        if ( selectedPlacemarks.contains( placemark ) || !placemark->isGloballyVisible()
+             || !isVisualCategoryShown( placemark->visualCategory() )
+             || ( mark->labelRect().isNull() && !placemark->displayName().isEmpty() ) ) {
+            continue;
+        }
+
+        const GeoDataCoordinates coordinates = placemark->coordinate( dateTime );
+        if ( !viewLatLonAltBox.contains( coordinates ) ) {
+            continue;
+        }
+
+        keptCandidates << mark;
+        keptLon << coordinates.longitude();
+        keptLat << coordinates.latitude();
+        keptAltitude << coordinates.altitude();
+    }
+
+    QVector<qreal> keptX( keptCandidates.size() );
+    QVector<qreal> keptY( keptCandidates.size() );
+    QVector<bool> keptVisible( keptCandidates.size() );
+    viewport->screenCoordinates( keptLon.constData(), keptLat.constData(), keptAltitude.constData(),
+                                 keptCandidates.size(), keptX.data(), keptY.data(), keptVisible.data() );
 
+    for ( int i = 0; i < keptCandidates.size(); ++i ) {
+        if ( placemarksOnScreenLimit( viewport->size() ) ) {
+            break;
         }
 
-        // Now handle all other placemarks...
+        if ( keptVisible[i] && keepPlacemark( keptCandidates[i], keptX[i], keptY[i] ) ) {
+            keptPlacemarks.insert( keptCandidates[i]->placemark() );
+        }
+    }
 
-        const QItemSelection selection = m_selectionModel->selection();
+    // Now handle all other placemarks in layout order. The placemarks
+    // of each tile are sorted already, so they just need to be merged.
 
-        placemarkList.clear();
-        for (const TileId &tileId: visibleTiles(*viewport, tileLevel)) {
-            placemarkList += m_placemarkCache.value( tileId );
+    int placemarkCount = 0;
+    QVector<PlacemarkRange> ranges;
+    for (const TileId &tileId: visibleTiles(*viewport, tileLevel)) {
+        auto const tile = m_placemarkCache.constFind( tileId );
+        if ( tile != m_placemarkCache.constEnd() && !tile->isEmpty() ) {
+            ranges.append( { tile->constBegin(), tile->constEnd() } );
+            placemarkCount += tile->size();
         }
-        std::sort(placemarkList.begin(), placemarkList.end(), GeoDataPlacemark::placemarkLayoutOrderCompare);
+    }
+    std::make_heap( ranges.begin(), ranges.end(), laterInLayoutOrder );
+
+    // The placemarks are taken from the tiles in blocks, which get projected at once
+    const int blockSize = 64;
+    const GeoDataPlacemark *blockPlacemarks[blockSize];
+    GeoDataCoordinates blockCoordinates[blockSize];
+    qreal blockLon[blockSize];
+    qreal blockLat[blockSize];
+    qreal blockAltitude[blockSize];
+    qreal blockX[blockSize];
+    qreal blockY[blockSize];
+    bool blockVisible[blockSize];
+
+    bool limitReached = false;
+    while ( !limitReached && !ranges.isEmpty() ) {
+        int count = 0;
+        while ( count < blockSize && !ranges.isEmpty() ) {
+            std::pop_heap( ranges.begin(), ranges.end(), laterInLayoutOrder );
+            PlacemarkRange &range = ranges.last();
+            const GeoDataPlacemark *placemark = *range.current;
+            if ( ++range.current == range.end ) {
+                ranges.removeLast();
+            } else {
+                std::push_heap( ranges.begin(), ranges.end(), laterInLayoutOrder );
+            }
 
-        for ( const GeoDataPlacemark *placemark: placemarkList ) {
             const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
             if ( !coordinates.isValid() ) {
                 continue;
@@ -429,99 +544,67 @@ QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParam
 
             int zoomLevel = placemark->zoomLevel();
             if ( zoomLevel > 20 ) {
+                // Later placemarks are even more detailed
+                ranges.clear();
                 break;
             }
 
-            qreal x = 0;
-            qreal y = 0;
-
-            if ( !viewLatLonAltBox.contains( coordinates ) ||
-                 ! viewport->screenCoordinates( coordinates, x, y )) {
-                    continue;
-                }
-
-            if ( !placemark->isGloballyVisible() ) {
+            if ( !viewLatLonAltBox.contains( coordinates ) ) {
                 continue;
             }
 
-            const GeoDataPlacemark::GeoDataVisualCategory visualCategory = placemark->visualCategory();
-
-            // Skip city marks if we're not showing cities.
-            if ( !m_showCities
-                 && visualCategory >= GeoDataPlacemark::SmallCity
-                 && visualCategory <= GeoDataPlacemark::Nation )
-                continue;
-
-            // Skip terrain marks if we're not showing terrain.
-            if ( !m_showTerrain
-                 && visualCategory >= GeoDataPlacemark::Mountain
-                 && visualCategory <= GeoDataPlacemark::OtherTerrain )
+            if ( !placemark->isGloballyVisible() ) {
                 continue;
+            }
 
-            // Skip other places if we're not showing other places.
-            if ( !m_showOtherPlaces
-                 && visualCategory >= GeoDataPlacemark::GeographicPole
-                 && visualCategory <= GeoDataPlacemark::Observatory )
+            if ( !isVisualCategoryShown( placemark->visualCategory() ) ) {
                 continue;
+            }
 
-            // Skip landing sites if we're not showing landing sites.
-            if ( !m_showLandingSites
-                 && visualCategory >= GeoDataPlacemark::MannedLandingSite
-                 && visualCategory <= GeoDataPlacemark::UnmannedHardLandingSite )
+            // We handled selected and kept placemarks already, so we skip them here...
+            if ( selectedPlacemarks.contains( placemark ) || keptPlacemarks.contains( placemark ) )
                 continue;
 
-            // Skip craters if we're not showing craters.
-            if ( !m_showCraters
-                 && visualCategory == GeoDataPlacemark::Crater )
-                continue;
+            blockPlacemarks[count] = placemark;
+            blockCoordinates[count] = coordinates;
+            blockLon[count] = coordinates.longitude();
+            blockLat[count] = coordinates.latitude();
+            blockAltitude[count] = coordinates.altitude();
+            ++count;
+        }
 
-            // Skip maria if we're not showing maria.
-            if ( !m_showMaria
-                 && visualCategory == GeoDataPlacemark::Mare )
-                continue;
+        viewport->screenCoordinates( blockLon, blockLat, blockAltitude, count, blockX, blockY, blockVisible );
 
-            if ( !m_showPlaces
-                 && visualCategory >= GeoDataPlacemark::GeographicPole
-                 && visualCategory <= GeoDataPlacemark::Observatory )
+        for ( int i = 0; i < count; ++i ) {
+            if ( !blockVisible[i] ) {
                 continue;
-
-            // We handled selected placemarks already, so we skip them here...
-            // Assuming that only a small amount of places is selected
-            // we check for the selected state after all other filters
-            bool isSelected = false;
-            for ( const QModelIndex &index: selection.indexes() ) {
-                const GeoDataPlacemark *mark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
-                if (mark == placemark ) {
-                    isSelected = true;
-                    break;
-                }
             }
-            if ( isSelected )
-                continue;
 
-            if( layoutPlacemark( placemark, coordinates, x, y, isSelected ) ) {
+            if( layoutPlacemark( blockPlacemarks[i], blockCoordinates[i], blockX[i], blockY[i], false ) ) {
                 // Make sure not to draw more placemarks on the screen than
                 // specified by placemarksOnScreenLimit().
-                if ( placemarksOnScreenLimit( viewport->size() ) )
+                if ( placemarksOnScreenLimit( viewport->size() ) ) {
+                    limitReached = true;
                     break;
+                }
             }
         }
+    }
 
-        if (m_visiblePlacemarks.size() > qMax(100, 4 * m_paintOrder.size())) {
-            auto const extendedBox = viewLatLonAltBox.scaled(2.0, 2.0);
-            QVector<VisiblePlacemark*> outdated;
-            for (auto placemark: m_visiblePlacemarks) {
-                if (!extendedBox.contains(placemark->coordinates())) {
-                    outdated << placemark;
-                }
-            }
-            for (auto placemark: outdated) {
-                delete m_visiblePlacemarks.take(placemark->placemark());
+    if (m_visiblePlacemarks.size() > qMax(100, 4 * m_paintOrder.size())) {
+        auto const extendedBox = viewLatLonAltBox.scaled(2.0, 2.0);
+        QVector<VisiblePlacemark*> outdated;
+        for (auto placemark: m_visiblePlacemarks) {
+            if (!extendedBox.contains(placemark->coordinates())) {
+                outdated << placemark;
             }
         }
-    } while (currentMaxLabelHeight != m_maxLabelHeight);
+        for (auto placemark: outdated) {
+            delete m_visiblePlacemarks.take(placemark->placemark());
+        }
+    }
 
-    m_runtimeTrace = QStringLiteral("Placemarks: %1 Drawn: %2").arg(placemarkList.count()).arg(m_paintOrder.size());
+    m_runtimeTrace = QStringLiteral("Placemarks: %1 Drawn: %2").arg(placemarkCount).arg(m_paintOrder.size());
     return m_paintOrder;
 }
 
@@ -593,28 +676,94 @@ bool PlacemarkLayout::layoutPlacemark( const GeoDataPlacemark *placemark, const
     if (labelRect.isEmpty() && mark->symbolPixmap().isNull()) {
         return false;
     }
-    if (!mark->symbolPixmap().isNull() && !hasRoomForPixmap(y, mark)) {
+    if (!mark->symbolPixmap().isNull() && !hasRoomForPixmap(mark)) {
         return false;
     }
 
     mark->setLabelRect( labelRect );
+    addToLayout( mark );
+    return true;
+}
 
-    // Add the current placemark to the matching row and its
-    // direct neighbors.
-    int idx = y / m_maxLabelHeight;
-    if ( idx - 1 >= 0 ) {
-        m_rowsection[ idx - 1 ].append( mark );
+bool PlacemarkLayout::keepPlacemark( VisiblePlacemark *mark, qreal x, qreal y )
+{
+    // Move the symbol and the label along with the map
+    const QPointF hotSpot = mark->hotSpot();
+    const QPointF symbolPosition( x - hotSpot.x(), y - hotSpot.y() );
+    const QPointF offset = symbolPosition - mark->symbolPosition();
+    mark->setSymbolPosition( symbolPosition );
+    if ( !mark->labelRect().isNull() ) {
+        mark->setLabelRect( mark->labelRect().translated( offset ) );
     }
-    m_rowsection[ idx ].append( mark );
-    if ( idx + 1 < m_rowsection.size() ) {
-        m_rowsection[ idx + 1 ].append( mark );
+
+    if ( !hasRoomFor( mark->boundingBox() ) ) {
+        return false;
     }
 
+    mark->setSelected( false );
+    addToLayout( mark );
+    return true;
+}
+
+void PlacemarkLayout::addToLayout( VisiblePlacemark *mark )
+{
+    addToGrid( mark );
+
     m_paintOrder.append( mark );
     QRectF const boundingBox = mark->boundingBox();
     Q_ASSERT(!boundingBox.isEmpty());
     m_labelArea += boundingBox.width() * boundingBox.height();
-    m_maxLabelHeight = qMax(m_maxLabelHeight, qCeil(boundingBox.height()));
+}
+
+bool PlacemarkLayout::isLayoutCurrent( const ViewportParams *viewport, int tileLevel ) const
+{
+    return m_layoutProjection == viewport->projection()
+        && m_layoutRadius == viewport->radius()
+        && m_layoutTileLevel == tileLevel
+        && m_layoutSize == viewport->size();
+}
+
+bool PlacemarkLayout::isVisualCategoryShown( GeoDataPlacemark::GeoDataVisualCategory visualCategory ) const
+{
+    // Skip city marks if we're not showing cities.
+    if ( !m_showCities
+         && visualCategory >= GeoDataPlacemark::SmallCity
+         && visualCategory <= GeoDataPlacemark::Nation )
+        return false;
+
+    // Skip terrain marks if we're not showing terrain.
+    if ( !m_showTerrain
+         && visualCategory >= GeoDataPlacemark::Mountain
+         && visualCategory <= GeoDataPlacemark::OtherTerrain )
+        return false;
+
+    // Skip other places if we're not showing other places.
+    if ( !m_showOtherPlaces
+         && visualCategory >= GeoDataPlacemark::GeographicPole
+         && visualCategory <= GeoDataPlacemark::Observatory )
+        return false;
+
+    // Skip landing sites if we're not showing landing sites.
+    if ( !m_showLandingSites
+         && visualCategory >= GeoDataPlacemark::MannedLandingSite
+         && visualCategory <= GeoDataPlacemark::UnmannedHardLandingSite )
+        return false;
+
+    // Skip craters if we're not showing craters.
+    if ( !m_showCraters
+         && visualCategory == GeoDataPlacemark::Crater )
+        return false;
+
+    // Skip maria if we're not showing maria.
+    if ( !m_showMaria
+         && visualCategory == GeoDataPlacemark::Mare )
+        return false;
+
+    if ( !m_showPlaces
+         && visualCategory >= GeoDataPlacemark::GeographicPole
+         && visualCategory <= GeoDataPlacemark::Observatory )
+        return false;
+
     return true;
 }
 
@@ -650,7 +799,6 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
         textWidth = ( QFontMetrics( labelFont ).horizontalAdvance( labelText ) );
     }
 
-    const QVector<VisiblePlacemark*> currentsec = m_rowsection.at( y / m_maxLabelHeight );
     QRectF const symbolRect = placemark->symbolRect();
 
     if ( style->labelStyle().alignment() == GeoDataLabelStyle::Corner ) {
@@ -664,7 +812,7 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
                                               y - textHeight;
             const QRectF labelRect = QRectF( xPos, yPos, textWidth, textHeight );
 
-            if (hasRoomFor(currentsec, labelRect.united(symbolRect))) {
+            if (hasRoomFor(labelRect.united(symbolRect))) {
                 // claim the place immediately if it hasn't been used yet
                 return labelRect;
             }
@@ -675,7 +823,7 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
         QRectF  labelRect = QRectF( x - textWidth / 2, y - offsetY - textHeight,
                           textWidth, textHeight );
 
-        if (hasRoomFor(currentsec, labelRect.united(symbolRect))) {
+        if (hasRoomFor(labelRect.united(symbolRect))) {
             // claim the place immediately if it hasn't been used yet 
             return labelRect;
         }
@@ -695,7 +843,7 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
 
             const QRectF labelRect = QRectF(xPos, yPos, textWidth, textHeight);
 
-            if (hasRoomFor(currentsec, labelRect.united(symbolRect)))
+            if (hasRoomFor(labelRect.united(symbolRect)))
             {
                 return labelRect;
             }
@@ -706,10 +854,68 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
     return QRectF();
 }
 
-bool PlacemarkLayout::hasRoomForPixmap(const qreal y, const VisiblePlacemark *placemark) const
+bool PlacemarkLayout::hasRoomForPixmap(const VisiblePlacemark *placemark) const
+{
+    return hasRoomFor(placemark->symbolRect());
+}
+
+void PlacemarkLayout::resetGrid(const QSize &screenSize)
+{
+    // Most labels span a few cells, so a label usually gets compared
+    // with its close neighbors only
+    m_cellHeight = m_maxLabelHeight;
+    m_cellWidth = 4 * m_maxLabelHeight;
+
+    const int columns = screenSize.width() / m_cellWidth + 1;
+    const int rows = screenSize.height() / m_cellHeight + 1;
+    if (columns != m_gridColumns || rows != m_gridRows) {
+        m_gridColumns = columns;
+        m_gridRows = rows;
+        m_grid.clear();
+        m_grid.resize(columns * rows);
+    } else {
+        // keeps the capacity of the cells
+        for (QVector<VisiblePlacemark*> &cell: m_grid) {
+            cell.clear();
+        }
+    }
+}
+
+QRect PlacemarkLayout::gridCells(const QRectF &rect) const
+{
+    // Rectangles reaching beyond the screen are clamped to the border
+    // cells, which only makes the collision test more conservative
+    const int left = qBound(0, qFloor(rect.left() / m_cellWidth), m_gridColumns - 1);
+    const int right = qBound(0, qFloor(rect.right() / m_cellWidth), m_gridColumns - 1);
+    const int top = qBound(0, qFloor(rect.top() / m_cellHeight), m_gridRows - 1);
+    const int bottom = qBound(0, qFloor(rect.bottom() / m_cellHeight), m_gridRows - 1);
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+bool PlacemarkLayout::hasRoomFor(const QRectF &boundingBox) const
+{
+    // Check if there is another label or symbol that overlaps.
+    const QRect cells = gridCells(boundingBox);
+    for (int row = cells.top(); row <= cells.bottom(); ++row) {
+        for (int column = cells.left(); column <= cells.right(); ++column) {
+            for (const VisiblePlacemark *placemark: m_grid.at(row * m_gridColumns + column)) {
+                if (boundingBox.intersects(placemark->boundingBox())) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void PlacemarkLayout::addToGrid(VisiblePlacemark *placemark)
 {
-    const QVector<VisiblePlacemark*> currentsec = m_rowsection.at(y / m_maxLabelHeight);
-    return hasRoomFor(currentsec, placemark->symbolRect());
+    const QRect cells = gridCells(placemark->boundingBox());
+    for (int row = cells.top(); row <= cells.bottom(); ++row) {
+        for (int column = cells.left(); column <= cells.right(); ++column) {
+            m_grid[row * m_gridColumns + column].append(placemark);
+        }
+    }
 }
 
 bool PlacemarkLayout::placemarksOnScreenLimit( const QSize &screenSize ) const
@@ -20,6 +20,8 @@
 #include <QPointer>
 
 #include "GeoDataPlacemark.h"
+#include "MarbleGlobal.h"
+#include "marble_export.h"
 #include <GeoDataStyle.h>
 
 class QAbstractItemModel;
@@ -46,7 +48,7 @@ class StyleBuilder;
 
 
 
-class PlacemarkLayout : public QObject
+class MARBLE_EXPORT PlacemarkLayout : public QObject
 {
     Q_OBJECT
 
@@ -81,6 +83,16 @@ class PlacemarkLayout : public QObject
 
     bool hasPlacemarkAt(const QPoint &pos);
 
+    /**
+     * In the incremental layout mode, which is the default, placemarks of the
+     * previous layout keep their place as long as the viewport is only moved.
+     * They are dropped only if they left the view or collide with a placemark
+     * of higher priority after the move. Changes of the zoom, the projection,
+     * the tile level or the viewport size cause a full layout.
+     */
+    void setIncrementalLayout( bool incremental );
+    bool isIncrementalLayout() const;
+
  public Q_SLOTS:
     // earth
     void setShowPlaces( bool show );
@@ -116,6 +128,10 @@ class PlacemarkLayout : public QObject
 
     static QSet<TileId> visibleTiles(const ViewportParams &viewport, int tileLevel);
     bool layoutPlacemark(const GeoDataPlacemark *placemark, const GeoDataCoordinates &coordinates, qreal x, qreal y, bool selected );
+    bool keepPlacemark(VisiblePlacemark *mark, qreal x, qreal y);
+    void addToLayout(VisiblePlacemark *mark);
+    bool isLayoutCurrent(const ViewportParams *viewport, int tileLevel) const;
+    bool isVisualCategoryShown(GeoDataPlacemark::GeoDataVisualCategory visualCategory) const;
 
     /**
      * Returns the coordinates at which an icon should be drawn for the @p placemark.
@@ -127,7 +143,16 @@ class PlacemarkLayout : public QObject
     QRectF  roomForLabel(const GeoDataStyle::ConstPtr &style,
                          const qreal x, const qreal y,
                          const QString &labelText , const VisiblePlacemark *placemark) const;
-    bool    hasRoomForPixmap(const qreal y, const VisiblePlacemark *placemark) const;
+    bool    hasRoomForPixmap(const VisiblePlacemark *placemark) const;
+
+    /**
+     * Label collision grid: each cell lists the placemarks laid out so far
+     * whose bounding box overlaps it.
+     */
+    void    resetGrid(const QSize &screenSize);
+    QRect   gridCells(const QRectF &rect) const;
+    bool    hasRoomFor(const QRectF &boundingBox) const;
+    void    addToGrid(VisiblePlacemark *placemark);
 
     bool    placemarksOnScreenLimit( const QSize &screenSize ) const;
 
@@ -141,9 +166,14 @@ class PlacemarkLayout : public QObject
     QString m_runtimeTrace;
     int m_labelArea;
     QHash<const GeoDataPlacemark*, VisiblePlacemark*> m_visiblePlacemarks;
-    QVector< QVector< VisiblePlacemark* > >  m_rowsection;
-
-    /// map providing the list of placemark belonging in TileId as key
+    QVector< QVector< VisiblePlacemark* > >  m_grid; // row major
+    int m_gridColumns;
+    int m_gridRows;
+    int m_cellWidth;
+    int m_cellHeight;
+
+    /// map providing the list of placemark belonging in TileId as key,
+    /// each list is sorted by GeoDataPlacemark::placemarkLayoutOrderCompare()
     QMap<TileId, QList<const GeoDataPlacemark*> > m_placemarkCache;
     QSet<qint64> m_osmIds;
 
@@ -168,6 +198,13 @@ class PlacemarkLayout : public QObject
     bool m_lastPlacemarkAvailable;
     QRectF m_lastPlacemarkLabelRect;
     QRectF m_lastPlacemarkSymbolRect;
+
+    // the viewport of m_paintOrder for the incremental layout
+    bool m_incrementalLayout;
+    Projection m_layoutProjection;
+    int m_layoutRadius;
+    int m_layoutTileLevel;
+    QSize m_layoutSize;
 };
 
 }
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "ScanlineJobScheduler.h"
+
+#include <QtGlobal>
+
+using namespace Marble;
+
+ScanlineJobScheduler::ScanlineJobScheduler()
+    : m_nextRow( 0 ),
+      m_yBottom( 0 ),
+      m_chunkHeight( 2 ),
+      m_workerCount( 0 ),
+      m_frameTimer(),
+      m_pendingChunkCount( 0 ),
+      m_finishedNSecs( 0 ),
+      m_chunkCount( 0 ),
+      m_idleTime( 0.0 )
+{
+}
+
+void ScanlineJobScheduler::start( int yTop, int yBottom, int workerCount )
+{
+    // Aim at several chunks per worker so that the load evens out, but keep
+    // them large enough for the tile lookups of a job to stay coherent.
+    const int rowCount = qMax( 0, yBottom - yTop );
+    m_workerCount = qMax( 1, workerCount );
+    m_chunkHeight = qBound( 2, rowCount / ( m_workerCount * 8 ), 32 );
+    m_chunkHeight += m_chunkHeight % 2;
+
+    m_nextRow.storeRelaxed( yTop );
+    m_yBottom = yBottom;
+    m_pendingChunkCount.storeRelaxed( 0 );
+    m_finishedNSecs.storeRelaxed( 0 );
+    m_frameTimer.start();
+}
+
+bool ScanlineJobScheduler::nextChunk( int &yStart, int &yEnd )
+{
+    const int row = m_nextRow.fetchAndAddRelaxed( m_chunkHeight );
+    if ( row >= m_yBottom ) {
+        // This worker is done, remember when for the idle time statistics
+        m_finishedNSecs.fetchAndAddRelaxed( m_frameTimer.nsecsElapsed() );
+        return false;
+    }
+
+    yStart = row;
+    yEnd = qMin( row + m_chunkHeight, m_yBottom );
+    m_pendingChunkCount.ref();
+
+    return true;
+}
+
+void ScanlineJobScheduler::finish()
+{
+    const qint64 frameNSecs = m_frameTimer.nsecsElapsed();
+    const qint64 idleNSecs = m_workerCount * frameNSecs - m_finishedNSecs.loadRelaxed();
+
+    m_chunkCount = m_pendingChunkCount.loadRelaxed();
+    m_idleTime = qMax<qint64>( 0, idleNSecs ) / 1000000.0;
+}
+
+int ScanlineJobScheduler::chunkCount() const
+{
+    return m_chunkCount;
+}
+
+qreal ScanlineJobScheduler::idleTime() const
+{
+    return m_idleTime;
+}
+
+QString ScanlineJobScheduler::runtimeTrace() const
+{
+    return QStringLiteral( "Texture Mapping: %1 chunks, %2 ms idle " )
+            .arg( m_chunkCount )
+            .arg( m_idleTime, 0, 'f', 1 );
+}
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_SCANLINEJOBSCHEDULER_H
+#define MARBLE_SCANLINEJOBSCHEDULER_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QString>
+
+namespace Marble
+{
+
+/**
+ * @short Hands out the rows of a canvas to the render jobs of a texture mapper.
+ *
+ * Instead of assigning a fixed band of the canvas to each render job, the
+ * rows are split into small chunks which the jobs fetch one after another
+ * until all rows are done. Jobs working on cheap rows (e.g. off-globe or
+ * near the poles) thereby help out with the expensive ones.
+ *
+ * The scheduler also keeps some statistics of the last frame: the number of
+ * chunks and the accumulated time the workers spent waiting for the last
+ * chunk to finish.
+ */
+class ScanlineJobScheduler
+{
+ public:
+    ScanlineJobScheduler();
+
+    /**
+     * @brief Prepares handing out the rows [@p yTop, @p yBottom) to @p workerCount jobs.
+     *
+     * Chunks always start at an even offset from @p yTop, so that interlaced
+     * rendering (which copies each row to the next one) does not cross chunks.
+     */
+    void start( int yTop, int yBottom, int workerCount );
+
+    /**
+     * @brief Fetches the next chunk of rows [@p yStart, @p yEnd).
+     *
+     * This method is thread-safe.
+     *
+     * @return false if all rows have been handed out already.
+     */
+    bool nextChunk( int &yStart, int &yEnd );
+
+    /**
+     * @brief Updates the statistics after all jobs have finished.
+     */
+    void finish();
+
+    int chunkCount() const;
+
+    /**
+     * @brief Returns the time in milliseconds the workers were idle during the last frame.
+     */
+    qreal idleTime() const;
+
+    QString runtimeTrace() const;
+
+ private:
+    Q_DISABLE_COPY( ScanlineJobScheduler )
+
+    QAtomicInt m_nextRow;
+    int m_yBottom;
+    int m_chunkHeight;
+    int m_workerCount;
+
+    QElapsedTimer m_frameTimer;
+    QAtomicInt m_pendingChunkCount;
+    QAtomicInteger<qint64> m_finishedNSecs;
+
+    int m_chunkCount;
+    qreal m_idleTime;
+};
+
+}
+
+#endif
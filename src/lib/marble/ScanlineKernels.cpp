@@ -0,0 +1,335 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "ScanlineKernels.h"
+
+#include <QAtomicInt>
+
+#if ( defined(__GNUC__) || defined(__clang__) ) && ( defined(__x86_64__) || defined(__i386__) ) && defined(__SSE2__)
+#define MARBLE_SCANLINEKERNELS_X86
+#include <immintrin.h>
+#endif
+
+using namespace Marble;
+
+namespace
+{
+
+QAtomicInt s_kind( -1 );
+
+ScanlineKernels::Kind detectKind()
+{
+#ifdef MARBLE_SCANLINEKERNELS_X86
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx2" ) ) {
+        return ScanlineKernels::Avx2;
+    }
+    return ScanlineKernels::Sse2;
+#else
+    return ScanlineKernels::Scalar;
+#endif
+}
+
+inline int blend( int a, int b, int fraction )
+{
+    return ( a * ( 256 - fraction ) + b * fraction ) >> 8;
+}
+
+// Same arithmetic as the vectorized kernels, so that the tail of a run
+// does not differ from its beginning.
+inline QRgb bilinearPixel( const QRgb *bits, int wordsPerLine, int posX, int posY )
+{
+    const QRgb *const topLeft = bits + ( posY >> 8 ) * wordsPerLine + ( posX >> 8 );
+    const int fX = posX & 0xff;
+    const int fY = posY & 0xff;
+
+    const QRgb tl = topLeft[ 0 ];
+    const QRgb tr = topLeft[ 1 ];
+    const QRgb bl = topLeft[ wordsPerLine ];
+    const QRgb br = topLeft[ wordsPerLine + 1 ];
+
+    const int red   = blend( blend( qRed  ( tl ), qRed  ( bl ), fY ), blend( qRed  ( tr ), qRed  ( br ), fY ), fX );
+    const int green = blend( blend( qGreen( tl ), qGreen( bl ), fY ), blend( qGreen( tr ), qGreen( br ), fY ), fX );
+    const int blue  = blend( blend( qBlue ( tl ), qBlue ( bl ), fY ), blend( qBlue ( tr ), qBlue ( br ), fY ), fX );
+
+    return qRgb( red, green, blue );
+}
+
+void fetchNearestScalar( const QRgb *bits, int wordsPerLine,
+                         int posX, int posY, int stepX, int stepY,
+                         QRgb *scanLine, int count )
+{
+    for ( int j = 0; j < count; ++j ) {
+        posX += stepX;
+        posY += stepY;
+        scanLine[ j ] = bits[ ( posY >> 7 ) * wordsPerLine + ( posX >> 7 ) ];
+    }
+}
+
+void fetchBilinearScalar( const QRgb *bits, int wordsPerLine,
+                          int posX, int posY, int stepX, int stepY,
+                          QRgb *scanLine, int count )
+{
+    for ( int j = 0; j < count; ++j ) {
+        posX += stepX;
+        posY += stepY;
+        scanLine[ j ] = bilinearPixel( bits, wordsPerLine, posX, posY );
+    }
+}
+
+#ifdef MARBLE_SCANLINEKERNELS_X86
+
+void fetchNearestSse2( const QRgb *bits, int wordsPerLine,
+                       int posX, int posY, int stepX, int stepY,
+                       QRgb *scanLine, int count )
+{
+    __m128i x = _mm_add_epi32( _mm_set1_epi32( posX ), _mm_setr_epi32( stepX, 2 * stepX, 3 * stepX, 4 * stepX ) );
+    __m128i y = _mm_add_epi32( _mm_set1_epi32( posY ), _mm_setr_epi32( stepY, 2 * stepY, 3 * stepY, 4 * stepY ) );
+    const __m128i deltaX = _mm_set1_epi32( 4 * stepX );
+    const __m128i deltaY = _mm_set1_epi32( 4 * stepY );
+
+    alignas(16) int iX[ 4 ];
+    alignas(16) int iY[ 4 ];
+
+    int j = 0;
+    for ( ; j + 4 <= count; j += 4 ) {
+        _mm_store_si128( reinterpret_cast<__m128i *>( iX ), _mm_srai_epi32( x, 7 ) );
+        _mm_store_si128( reinterpret_cast<__m128i *>( iY ), _mm_srai_epi32( y, 7 ) );
+
+        // SSE2 has neither a 32 bit multiplication nor a gather instruction
+        const __m128i pixels = _mm_setr_epi32( int( bits[ iY[ 0 ] * wordsPerLine + iX[ 0 ] ] ),
+                                               int( bits[ iY[ 1 ] * wordsPerLine + iX[ 1 ] ] ),
+                                               int( bits[ iY[ 2 ] * wordsPerLine + iX[ 2 ] ] ),
+                                               int( bits[ iY[ 3 ] * wordsPerLine + iX[ 3 ] ] ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( scanLine + j ), pixels );
+
+        x = _mm_add_epi32( x, deltaX );
+        y = _mm_add_epi32( y, deltaY );
+    }
+
+    fetchNearestScalar( bits, wordsPerLine, posX + j * stepX, posY + j * stepY, stepX, stepY, scanLine + j, count - j );
+}
+
+// Blends the pixels a and b with the weights ( 256 - fraction ) and fraction.
+// Each pixel is unpacked to four 16 bit channels. The intermediate result
+// fits into 16 bit unsigned as the weights add up to 256.
+inline __m128i blendSse2( __m128i a, __m128i b, __m128i fraction )
+{
+    const __m128i weightA = _mm_sub_epi16( _mm_set1_epi16( 256 ), fraction );
+    return _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( a, weightA ),
+                                          _mm_mullo_epi16( b, fraction ) ), 8 );
+}
+
+void fetchBilinearSse2( const QRgb *bits, int wordsPerLine,
+                        int posX, int posY, int stepX, int stepY,
+                        QRgb *scanLine, int count )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fractionMask = _mm_set1_epi32( 0xff );
+    const __m128i opaque = _mm_set1_epi32( int( 0xff000000u ) );
+
+    __m128i x = _mm_add_epi32( _mm_set1_epi32( posX ), _mm_setr_epi32( stepX, 2 * stepX, 3 * stepX, 4 * stepX ) );
+    __m128i y = _mm_add_epi32( _mm_set1_epi32( posY ), _mm_setr_epi32( stepY, 2 * stepY, 3 * stepY, 4 * stepY ) );
+    const __m128i deltaX = _mm_set1_epi32( 4 * stepX );
+    const __m128i deltaY = _mm_set1_epi32( 4 * stepY );
+
+    alignas(16) int iX[ 4 ];
+    alignas(16) int iY[ 4 ];
+
+    int j = 0;
+    for ( ; j + 4 <= count; j += 4 ) {
+        _mm_store_si128( reinterpret_cast<__m128i *>( iX ), _mm_srai_epi32( x, 8 ) );
+        _mm_store_si128( reinterpret_cast<__m128i *>( iY ), _mm_srai_epi32( y, 8 ) );
+
+        const QRgb *const p0 = bits + iY[ 0 ] * wordsPerLine + iX[ 0 ];
+        const QRgb *const p1 = bits + iY[ 1 ] * wordsPerLine + iX[ 1 ];
+        const QRgb *const p2 = bits + iY[ 2 ] * wordsPerLine + iX[ 2 ];
+        const QRgb *const p3 = bits + iY[ 3 ] * wordsPerLine + iX[ 3 ];
+
+        const __m128i tl = _mm_setr_epi32( int( p0[ 0 ] ), int( p1[ 0 ] ), int( p2[ 0 ] ), int( p3[ 0 ] ) );
+        const __m128i tr = _mm_setr_epi32( int( p0[ 1 ] ), int( p1[ 1 ] ), int( p2[ 1 ] ), int( p3[ 1 ] ) );
+        const __m128i bl = _mm_setr_epi32( int( p0[ wordsPerLine ] ), int( p1[ wordsPerLine ] ),
+                                           int( p2[ wordsPerLine ] ), int( p3[ wordsPerLine ] ) );
+        const __m128i br = _mm_setr_epi32( int( p0[ wordsPerLine + 1 ] ), int( p1[ wordsPerLine + 1 ] ),
+                                           int( p2[ wordsPerLine + 1 ] ), int( p3[ wordsPerLine + 1 ] ) );
+
+        // Replicate the fractions of each pixel to its four 16 bit channels
+        const __m128i fX32 = _mm_and_si128( x, fractionMask );
+        const __m128i fY32 = _mm_and_si128( y, fractionMask );
+        const __m128i fX = _mm_or_si128( fX32, _mm_slli_epi32( fX32, 16 ) );
+        const __m128i fY = _mm_or_si128( fY32, _mm_slli_epi32( fY32, 16 ) );
+        const __m128i fXLow  = _mm_unpacklo_epi32( fX, fX );
+        const __m128i fXHigh = _mm_unpackhi_epi32( fX, fX );
+        const __m128i fYLow  = _mm_unpacklo_epi32( fY, fY );
+        const __m128i fYHigh = _mm_unpackhi_epi32( fY, fY );
+
+        const __m128i leftLow   = blendSse2( _mm_unpacklo_epi8( tl, zero ), _mm_unpacklo_epi8( bl, zero ), fYLow );
+        const __m128i leftHigh  = blendSse2( _mm_unpackhi_epi8( tl, zero ), _mm_unpackhi_epi8( bl, zero ), fYHigh );
+        const __m128i rightLow  = blendSse2( _mm_unpacklo_epi8( tr, zero ), _mm_unpacklo_epi8( br, zero ), fYLow );
+        const __m128i rightHigh = blendSse2( _mm_unpackhi_epi8( tr, zero ), _mm_unpackhi_epi8( br, zero ), fYHigh );
+
+        const __m128i resultLow  = blendSse2( leftLow, rightLow, fXLow );
+        const __m128i resultHigh = blendSse2( leftHigh, rightHigh, fXHigh );
+
+        const __m128i pixels = _mm_or_si128( _mm_packus_epi16( resultLow, resultHigh ), opaque );
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( scanLine + j ), pixels );
+
+        x = _mm_add_epi32( x, deltaX );
+        y = _mm_add_epi32( y, deltaY );
+    }
+
+    fetchBilinearScalar( bits, wordsPerLine, posX + j * stepX, posY + j * stepY, stepX, stepY, scanLine + j, count - j );
+}
+
+__attribute__((target("avx2")))
+void fetchNearestAvx2( const QRgb *bits, int wordsPerLine,
+                       int posX, int posY, int stepX, int stepY,
+                       QRgb *scanLine, int count )
+{
+    const __m256i lanes = _mm256_setr_epi32( 1, 2, 3, 4, 5, 6, 7, 8 );
+    __m256i x = _mm256_add_epi32( _mm256_set1_epi32( posX ), _mm256_mullo_epi32( lanes, _mm256_set1_epi32( stepX ) ) );
+    __m256i y = _mm256_add_epi32( _mm256_set1_epi32( posY ), _mm256_mullo_epi32( lanes, _mm256_set1_epi32( stepY ) ) );
+    const __m256i deltaX = _mm256_set1_epi32( 8 * stepX );
+    const __m256i deltaY = _mm256_set1_epi32( 8 * stepY );
+    const __m256i stride = _mm256_set1_epi32( wordsPerLine );
+    const int *const base = reinterpret_cast<const int *>( bits );
+
+    int j = 0;
+    for ( ; j + 8 <= count; j += 8 ) {
+        const __m256i offsets = _mm256_add_epi32( _mm256_mullo_epi32( _mm256_srai_epi32( y, 7 ), stride ),
+                                                  _mm256_srai_epi32( x, 7 ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( scanLine + j ), _mm256_i32gather_epi32( base, offsets, 4 ) );
+
+        x = _mm256_add_epi32( x, deltaX );
+        y = _mm256_add_epi32( y, deltaY );
+    }
+
+    fetchNearestScalar( bits, wordsPerLine, posX + j * stepX, posY + j * stepY, stepX, stepY, scanLine + j, count - j );
+}
+
+__attribute__((target("avx2")))
+inline __m256i blendAvx2( __m256i a, __m256i b, __m256i fraction )
+{
+    const __m256i weightA = _mm256_sub_epi16( _mm256_set1_epi16( 256 ), fraction );
+    return _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( a, weightA ),
+                                                _mm256_mullo_epi16( b, fraction ) ), 8 );
+}
+
+__attribute__((target("avx2")))
+void fetchBilinearAvx2( const QRgb *bits, int wordsPerLine,
+                        int posX, int posY, int stepX, int stepY,
+                        QRgb *scanLine, int count )
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i fractionMask = _mm256_set1_epi32( 0xff );
+    const __m256i opaque = _mm256_set1_epi32( int( 0xff000000u ) );
+
+    const __m256i lanes = _mm256_setr_epi32( 1, 2, 3, 4, 5, 6, 7, 8 );
+    __m256i x = _mm256_add_epi32( _mm256_set1_epi32( posX ), _mm256_mullo_epi32( lanes, _mm256_set1_epi32( stepX ) ) );
+    __m256i y = _mm256_add_epi32( _mm256_set1_epi32( posY ), _mm256_mullo_epi32( lanes, _mm256_set1_epi32( stepY ) ) );
+    const __m256i deltaX = _mm256_set1_epi32( 8 * stepX );
+    const __m256i deltaY = _mm256_set1_epi32( 8 * stepY );
+    const __m256i stride = _mm256_set1_epi32( wordsPerLine );
+    const int *const top = reinterpret_cast<const int *>( bits );
+    const int *const bottom = reinterpret_cast<const int *>( bits + wordsPerLine );
+
+    int j = 0;
+    for ( ; j + 8 <= count; j += 8 ) {
+        const __m256i offsets = _mm256_add_epi32( _mm256_mullo_epi32( _mm256_srai_epi32( y, 8 ), stride ),
+                                                  _mm256_srai_epi32( x, 8 ) );
+        const __m256i tl = _mm256_i32gather_epi32( top, offsets, 4 );
+        const __m256i tr = _mm256_i32gather_epi32( top + 1, offsets, 4 );
+        const __m256i bl = _mm256_i32gather_epi32( bottom, offsets, 4 );
+        const __m256i br = _mm256_i32gather_epi32( bottom + 1, offsets, 4 );
+
+        // Unpacking works within 128 bit lanes, as does packing the result
+        // below, so the pixel order is preserved.
+        const __m256i fX32 = _mm256_and_si256( x, fractionMask );
+        const __m256i fY32 = _mm256_and_si256( y, fractionMask );
+        const __m256i fX = _mm256_or_si256( fX32, _mm256_slli_epi32( fX32, 16 ) );
+        const __m256i fY = _mm256_or_si256( fY32, _mm256_slli_epi32( fY32, 16 ) );
+        const __m256i fXLow  = _mm256_unpacklo_epi32( fX, fX );
+        const __m256i fXHigh = _mm256_unpackhi_epi32( fX, fX );
+        const __m256i fYLow  = _mm256_unpacklo_epi32( fY, fY );
+        const __m256i fYHigh = _mm256_unpackhi_epi32( fY, fY );
+
+        const __m256i leftLow   = blendAvx2( _mm256_unpacklo_epi8( tl, zero ), _mm256_unpacklo_epi8( bl, zero ), fYLow );
+        const __m256i leftHigh  = blendAvx2( _mm256_unpackhi_epi8( tl, zero ), _mm256_unpackhi_epi8( bl, zero ), fYHigh );
+        const __m256i rightLow  = blendAvx2( _mm256_unpacklo_epi8( tr, zero ), _mm256_unpacklo_epi8( br, zero ), fYLow );
+        const __m256i rightHigh = blendAvx2( _mm256_unpackhi_epi8( tr, zero ), _mm256_unpackhi_epi8( br, zero ), fYHigh );
+
+        const __m256i resultLow  = blendAvx2( leftLow, rightLow, fXLow );
+        const __m256i resultHigh = blendAvx2( leftHigh, rightHigh, fXHigh );
+
+        const __m256i pixels = _mm256_or_si256( _mm256_packus_epi16( resultLow, resultHigh ), opaque );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( scanLine + j ), pixels );
+
+        x = _mm256_add_epi32( x, deltaX );
+        y = _mm256_add_epi32( y, deltaY );
+    }
+
+    fetchBilinearScalar( bits, wordsPerLine, posX + j * stepX, posY + j * stepY, stepX, stepY, scanLine + j, count - j );
+}
+
+#endif
+
+}
+
+ScanlineKernels::Kind ScanlineKernels::bestKind()
+{
+    static const Kind best = detectKind();
+    return best;
+}
+
+ScanlineKernels::Kind ScanlineKernels::kind()
+{
+    const int current = s_kind.loadRelaxed();
+    if ( current < 0 ) {
+        return bestKind();
+    }
+
+    return Kind( current );
+}
+
+void ScanlineKernels::setKind( Kind kind )
+{
+    s_kind.storeRelaxed( qMin<int>( kind, bestKind() ) );
+}
+
+void ScanlineKernels::fetchNearest( const QRgb *bits, int wordsPerLine,
+                                    int posX, int posY, int stepX, int stepY,
+                                    QRgb *scanLine, int count )
+{
+    switch ( kind() ) {
+#ifdef MARBLE_SCANLINEKERNELS_X86
+    case Avx2:
+        fetchNearestAvx2( bits, wordsPerLine, posX, posY, stepX, stepY, scanLine, count );
+        return;
+    case Sse2:
+        fetchNearestSse2( bits, wordsPerLine, posX, posY, stepX, stepY, scanLine, count );
+        return;
+#endif
+    default:
+        fetchNearestScalar( bits, wordsPerLine, posX, posY, stepX, stepY, scanLine, count );
+    }
+}
+
+void ScanlineKernels::fetchBilinear( const QRgb *bits, int wordsPerLine,
+                                     int posX, int posY, int stepX, int stepY,
+                                     QRgb *scanLine, int count )
+{
+    switch ( kind() ) {
+#ifdef MARBLE_SCANLINEKERNELS_X86
+    case Avx2:
+        fetchBilinearAvx2( bits, wordsPerLine, posX, posY, stepX, stepY, scanLine, count );
+        return;
+    case Sse2:
+        fetchBilinearSse2( bits, wordsPerLine, posX, posY, stepX, stepY, scanLine, count );
+        return;
+#endif
+    default:
+        fetchBilinearScalar( bits, wordsPerLine, posX, posY, stepX, stepY, scanLine, count );
+    }
+}
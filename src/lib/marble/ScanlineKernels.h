@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_SCANLINEKERNELS_H
+#define MARBLE_SCANLINEKERNELS_H
+
+#include <QColor>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+/**
+ * @short Vectorized pixel fetch loops for the scanline texture mappers.
+ *
+ * The scanline texture mappers calculate the exact texture position only
+ * for every n-th pixel of a scanline and approximate the positions in
+ * between linearly (see ScanlineTextureMapperContext::pixelValueApprox()).
+ * The kernels in this class fetch such a run of approximated pixels from a
+ * single 32 bit tile image in one go, processing 4 (SSE2) or 8 (AVX2) pixels
+ * per step. The instruction set is detected at runtime, other CPUs use a
+ * scalar implementation.
+ */
+class MARBLE_EXPORT ScanlineKernels
+{
+ public:
+    enum Kind {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    /**
+     * @brief Returns the fastest kernel supported by the CPU.
+     */
+    static Kind bestKind();
+
+    /**
+     * @brief Returns the kernel that is currently used by the texture mappers.
+     */
+    static Kind kind();
+
+    /**
+     * @brief Selects the kernel used by the texture mappers.
+     *
+     * This is meant for comparing the implementations. Kinds that are not
+     * supported by the CPU fall back to bestKind(). Selecting Scalar makes
+     * the texture mappers use their original interpolation code.
+     */
+    static void setKind( Kind kind );
+
+    /**
+     * @brief Fetches @p count pixels by nearest neighbour lookup.
+     *
+     * Positions are given in 25.7 fixed point tile coordinates. The first
+     * fetched pixel is located at ( @p posX + @p stepX, @p posY + @p stepY ),
+     * each further one is advanced by another step. All positions need to
+     * be located inside the tile.
+     */
+    static void fetchNearest( const QRgb *bits, int wordsPerLine,
+                              int posX, int posY, int stepX, int stepY,
+                              QRgb *scanLine, int count );
+
+    /**
+     * @brief Fetches @p count bilinearly interpolated pixels.
+     *
+     * Positions are given in 24.8 fixed point tile coordinates and advance
+     * like in fetchNearest(). As the right and bottom neighbours are always
+     * read, the integer part of all positions needs to be located inside
+     * [0, width - 1) x [0, height - 1). The alpha channel of the result is opaque.
+     */
+    static void fetchBilinear( const QRgb *bits, int wordsPerLine,
+                               int posX, int posY, int stepX, int stepY,
+                               QRgb *scanLine, int count );
+};
+
+}
+
+#endif
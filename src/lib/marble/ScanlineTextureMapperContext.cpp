@@ -6,8 +6,11 @@
 
 #include "ScanlineTextureMapperContext.h"
 
+#include <cstring>
+
 #include "GeoSceneAbstractTileProjection.h"
 #include "MarbleDebug.h"
+#include "ScanlineKernels.h"
 #include "StackedTile.h"
 #include "StackedTileLoader.h"
 #include "TileId.h"
@@ -162,7 +165,27 @@ void ScanlineTextureMapperContext::pixelValueApproxF( const qreal lon, const qre
 
         const bool alwaysCheckTileRange =
                 isOutOfTileRangeF( itLon, itLat, itStepLon, itStepLat, n );
-        
+
+        // Let the vectorized kernel interpolate the whole run if it stays
+        // on the current 32 bit tile.
+        if ( !alwaysCheckTileRange && ScanlineKernels::kind() != ScanlineKernels::Scalar
+             && m_tile->resultImage()->depth() == 32 ) {
+            const int fixLon = (int)( itLon * 256.0 );
+            const int fixLat = (int)( itLat * 256.0 );
+            const int fixStepLon = qRound( itStepLon * 256.0 );
+            const int fixStepLat = qRound( itStepLat * 256.0 );
+
+            if ( isInsideBilinearRange( fixLon + fixStepLon, fixLat + fixStepLat )
+                 && isInsideBilinearRange( fixLon + fixStepLon * ( n - 1 ), fixLat + fixStepLat * ( n - 1 ) ) ) {
+                const QImage *const image = m_tile->resultImage();
+                ScanlineKernels::fetchBilinear( reinterpret_cast<const QRgb *>( image->constBits() ),
+                                                image->bytesPerLine() / 4,
+                                                fixLon, fixLat, fixStepLon, fixStepLat,
+                                                scanLine, n - 1 );
+                return;
+            }
+        }
+
         for ( int j=1; j < n; ++j ) {
             qreal posX = itLon + itStepLon * j;
             qreal posY = itLat + itStepLat * j;
@@ -262,6 +285,14 @@ bool ScanlineTextureMapperContext::isOutOfTileRangeF( const qreal itLon, const q
 }
 
 
+bool ScanlineTextureMapperContext::isInsideBilinearRange( const int fixPosX, const int fixPosY ) const
+{
+    // The bilinear kernel also reads the right and the bottom neighbour
+    return (    fixPosX >= 0 && ( fixPosX >> 8 ) < m_tileSize.width() - 1
+             && fixPosY >= 0 && ( fixPosY >> 8 ) < m_tileSize.height() - 1 );
+}
+
+
 void ScanlineTextureMapperContext::pixelValueApprox( const qreal lon, const qreal lat,
                                                      QRgb *scanLine, const int n )
 {
@@ -292,7 +323,15 @@ void ScanlineTextureMapperContext::pixelValueApprox( const qreal lon, const qrea
         const bool alwaysCheckTileRange =
                 isOutOfTileRange( itLon, itLat, itStepLon, itStepLat, n );
                                   
-        if ( !alwaysCheckTileRange ) {
+        if ( !alwaysCheckTileRange && ScanlineKernels::kind() != ScanlineKernels::Scalar
+             && m_tile->resultImage()->depth() == 32 ) {
+            const QImage *const image = m_tile->resultImage();
+            ScanlineKernels::fetchNearest( reinterpret_cast<const QRgb *>( image->constBits() ),
+                                           image->bytesPerLine() / 4,
+                                           itLon, itLat, itStepLon, itStepLat,
+                                           scanLine, n - 1 );
+        }
+        else if ( !alwaysCheckTileRange ) {
             int iPosXf = itLon;
             int iPosYf = itLat;
             for ( int j = 1; j < n; ++j ) {
@@ -422,6 +461,38 @@ QImage::Format ScanlineTextureMapperContext::optimalCanvasImageFormat( const Vie
 }
 
 
+void ScanlineTextureMapperContext::scrollCanvas( QImage *canvasImage, int dx, int dy )
+{
+    const int width = canvasImage->width();
+    const int height = canvasImage->height();
+    if ( qAbs( dx ) >= width || qAbs( dy ) >= height ) {
+        return;
+    }
+
+    const int pixelByteSize = canvasImage->depth() / 8;
+    const int rowByteCount = ( width - qAbs( dx ) ) * pixelByteSize;
+    const int sourceOffset = ( dx > 0 ) ? 0 : -dx * pixelByteSize;
+    const int targetOffset = ( dx > 0 ) ? dx * pixelByteSize : 0;
+
+    // Walk against the scroll direction so that no row is overwritten
+    // before it has been moved.
+    if ( dy > 0 ) {
+        for ( int y = height - 1; y >= dy; --y ) {
+            memmove( canvasImage->scanLine( y ) + targetOffset,
+                     canvasImage->scanLine( y - dy ) + sourceOffset,
+                     rowByteCount );
+        }
+    }
+    else {
+        for ( int y = 0; y < height + dy; ++y ) {
+            memmove( canvasImage->scanLine( y ) + targetOffset,
+                     canvasImage->scanLine( y - dy ) + sourceOffset,
+                     rowByteCount );
+        }
+    }
+}
+
+
 void ScanlineTextureMapperContext::nextTile( int &posX, int &posY )
 {
     // Move from tile coordinates to global texture coordinates 
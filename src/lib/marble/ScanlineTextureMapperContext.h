@@ -41,6 +41,10 @@ public:
 
     static QImage::Format optimalCanvasImageFormat( const ViewportParams *viewport );
 
+    // Moves the content of the canvas by ( dx, dy ) pixels. The parts that
+    // got exposed keep their previous content and need to be mapped again.
+    static void scrollCanvas( QImage *canvasImage, int dx, int dy );
+
     int globalWidth() const;
     int globalHeight() const;
 
@@ -66,6 +70,10 @@ private:
                             const qreal itStepLon, const qreal itStepLat,
                             const int n ) const;
 
+    // Checks whether the vectorized bilinear interpolation can sample the
+    // given 24.8 fixed point position without leaving the current tile
+    bool isInsideBilinearRange( const int fixPosX, const int fixPosY ) const;
+
 private:
     StackedTileLoader *const m_tileLoader;
     GeoSceneAbstractTileProjection::Type const m_textureProjection;
@@ -16,6 +16,7 @@
 #include "GeoDataPolygon.h"
 #include "MarbleDebug.h"
 #include "Quaternion.h"
+#include "ScanlineJobScheduler.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "StackedTile.h"
@@ -29,7 +30,7 @@ using namespace Marble;
 class SphericalScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineJobScheduler *scheduler );
 
     void run() override;
 
@@ -39,18 +40,16 @@ private:
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    int const m_yTop;
-    int const m_yBottom;
+    ScanlineJobScheduler *const m_scheduler;
 };
 
-SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineJobScheduler *scheduler )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yTop( yTop ),
-      m_yBottom( yBottom )
+      m_scheduler( scheduler )
 {
 }
 
@@ -101,6 +100,11 @@ void SphericalScanlineTextureMapper::mapTexture( GeoPainter *painter,
     painter->drawImage( rect, m_canvasImage, rect );
 }
 
+QString SphericalScanlineTextureMapper::runtimeTrace() const
+{
+    return m_scheduler.runtimeTrace();
+}
+
 void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
     // Reset backend
@@ -120,15 +124,14 @@ void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
                                       : yTop + radius + radius - skip;
 
     const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = qCeil(qreal( yBottom - yTop ) / qreal(numThreads));
+    m_scheduler.start( yTop, yBottom, numThreads );
     for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yTop +  i      * yStep;
-        const int yEnd   = qMin(yBottom, yTop + (i + 1) * yStep);
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &m_scheduler );
         m_threadPool.start( job );
     }
 
     m_threadPool.waitForDone();
+    m_scheduler.finish();
 
     m_tileLoader->cleanupTilehash();
 }
@@ -165,7 +168,9 @@ void SphericalScanlineTextureMapper::RenderJob::run()
     qreal  lat = 0.0;
 
     // Scanline based algorithm to texture map a sphere
-    for ( int y = m_yTop; y < m_yBottom ; ++y ) {
+    // Fetch chunks of rows from the scheduler until all rows are done
+    int yEnd = 0;
+    for ( int y = 0; y < yEnd || m_scheduler->nextChunk( y, yEnd ); ++y ) {
 
         // Evaluate coordinates for the 3D position vector of the current pixel
         const qreal qy = inverseRadius * (qreal)( imageHeight / 2 - y );
@@ -280,7 +285,7 @@ void SphericalScanlineTextureMapper::RenderJob::run()
         }
 
         // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yBottom ) { 
+        if ( interlaced && y + 1 < yEnd ) { 
 
             const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
@@ -8,6 +8,7 @@
 #define MARBLE_SPHERICALSCANLINETEXTUREMAPPER_H
 
 
+#include "ScanlineJobScheduler.h"
 #include "TextureMapperInterface.h"
 
 #include "MarbleGlobal.h"
@@ -42,6 +43,8 @@ class SphericalScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer ) override;
 
+    QString runtimeTrace() const override;
+
  private:
     void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
 
@@ -51,6 +54,7 @@ class SphericalScanlineTextureMapper : public TextureMapperInterface
     int m_radius;
     QImage m_canvasImage;
     QThreadPool m_threadPool;
+    ScanlineJobScheduler m_scheduler;
 };
 
 }
@@ -14,6 +14,7 @@
 #include <QImage>
 
 #include "Tile.h"
+#include "marble_export.h"
 
 namespace Marble
 {
@@ -47,7 +48,7 @@ class TextureTile;
     the very same projection.
 */
 
-class StackedTile : public Tile
+class MARBLE_EXPORT StackedTile : public Tile
 {
  public:
     explicit StackedTile( TileId const &id, QImage const &resultImage, QVector<QSharedPointer<TextureTile> > const &tiles );
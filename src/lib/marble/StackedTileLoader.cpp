@@ -16,10 +16,13 @@
 #include "TileLoaderHelper.h"
 #include "MarbleGlobal.h"
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QCache>
 #include <QHash>
-#include <QReadWriteLock>
+#include <QMutex>
 #include <QImage>
+#include <QVector>
 
 
 namespace Marble
@@ -28,18 +31,80 @@ namespace Marble
 class StackedTileLoaderPrivate
 {
 public:
+    typedef QHash<TileId, StackedTile*> TileHash;
+
     explicit StackedTileLoaderPrivate( MergedLayerDecorator *mergedLayerDecorator )
-        : m_layerDecorator( mergedLayerDecorator )
+        : m_layerDecorator( mergedLayerDecorator ),
+          m_displayedTiles( new TileHash ),
+          m_unpublishedTiles( 0 )
     {
         m_tileCache.setMaxCost( 20000 * 1024 ); // Cache size measured in bytes
     }
 
+    ~StackedTileLoaderPrivate()
+    {
+        delete m_displayedTiles.loadRelaxed();
+        deleteRetiredTiles();
+    }
+
+    /**
+     * Makes the current state of m_tilesOnDisplay visible to lock-free lookups.
+     *
+     * The previous snapshot may still be read by render threads, so it is only
+     * retired here and deleted by deleteRetiredTiles().
+     */
+    void publishTilesOnDisplay();
+
+    /**
+     * Adds a tile loaded during rendering to m_tilesOnDisplay.
+     *
+     * Copying the hash for every loaded tile would make a frame full of new
+     * tiles quadratic, so the loaded tiles are published in batches. Until
+     * then render threads find them in m_tilesOnDisplay under m_cacheLock.
+     */
+    void addTileOnDisplay( const TileId &stackedTileId, StackedTile *stackedTile );
+
+    /**
+     * Deletes the snapshots replaced by publishTilesOnDisplay(). Must not be
+     * called while texture mapping is in progress.
+     */
+    void deleteRetiredTiles();
+
     MergedLayerDecorator *const m_layerDecorator;
-    QHash <TileId, StackedTile*>  m_tilesOnDisplay;
+    TileHash  m_tilesOnDisplay;
     QCache <TileId, StackedTile>  m_tileCache;
-    QReadWriteLock m_cacheLock;
+    QMutex m_cacheLock;
+
+    // read-only copy of m_tilesOnDisplay; copying is cheap as QHash is implicitly shared
+    QAtomicPointer<const TileHash> m_displayedTiles;
+    QVector<const TileHash *> m_retiredTiles;
+    int m_unpublishedTiles;
+    QAtomicInt m_contentionCount;
+
+    static const int PublishBatchSize = 16;
 };
 
+void StackedTileLoaderPrivate::publishTilesOnDisplay()
+{
+    const TileHash *const retiredTiles = m_displayedTiles.fetchAndStoreOrdered( new TileHash( m_tilesOnDisplay ) );
+    m_retiredTiles.append( retiredTiles );
+    m_unpublishedTiles = 0;
+}
+
+void StackedTileLoaderPrivate::addTileOnDisplay( const TileId &stackedTileId, StackedTile *stackedTile )
+{
+    m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+    if ( ++m_unpublishedTiles >= PublishBatchSize ) {
+        publishTilesOnDisplay();
+    }
+}
+
+void StackedTileLoaderPrivate::deleteRetiredTiles()
+{
+    qDeleteAll( m_retiredTiles );
+    m_retiredTiles.clear();
+}
+
 StackedTileLoader::StackedTileLoader( MergedLayerDecorator *mergedLayerDecorator, QObject *parent )
     : QObject( parent ),
       d( new StackedTileLoaderPrivate( mergedLayerDecorator ) )
@@ -74,6 +139,10 @@ QSize StackedTileLoader::tileSize() const
 
 void StackedTileLoader::resetTilehash()
 {
+    // no render thread is running here, so older snapshots are not accessed anymore
+    d->deleteRetiredTiles();
+    d->m_contentionCount.storeRelaxed( 0 );
+
     QHash<TileId, StackedTile*>::const_iterator it = d->m_tilesOnDisplay.constBegin();
     QHash<TileId, StackedTile*>::const_iterator const end = d->m_tilesOnDisplay.constEnd();
     for (; it != end; ++it ) {
@@ -87,6 +156,7 @@ void StackedTileLoader::cleanupTilehash()
     // Make sure that tiles which haven't been used during the last
     // rendering of the map at all get removed from the tile hash.
 
+    bool changed = d->m_unpublishedTiles > 0;
     QHashIterator<TileId, StackedTile*> it( d->m_tilesOnDisplay );
     while ( it.hasNext() ) {
         it.next();
@@ -96,23 +166,32 @@ void StackedTileLoader::cleanupTilehash()
             // doesn't get set to zero (so don't delete it in this case or it will crash!)
             d->m_tileCache.insert( it.key(), it.value(), it.value()->byteCount() );
             d->m_tilesOnDisplay.remove( it.key() );
+            changed = true;
         }
     }
+
+    // the tiles of the next frame are mostly the ones of this frame, so a
+    // steady view keeps its snapshot instead of copying the hash every frame
+    if ( changed ) {
+        d->publishTilesOnDisplay();
+    }
+    d->deleteRetiredTiles();
 }
 
 const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
 {
     // check if the tile is in the hash
-    d->m_cacheLock.lockForRead();
-    StackedTile * stackedTile = d->m_tilesOnDisplay.value( stackedTileId, 0 );
-    d->m_cacheLock.unlock();
+    StackedTile * stackedTile = d->m_displayedTiles.loadAcquire()->value( stackedTileId, 0 );
     if ( stackedTile ) {
         stackedTile->setUsed( true );
         return stackedTile;
     }
     // here ends the performance critical section of this method
 
-    d->m_cacheLock.lockForWrite();
+    if ( !d->m_cacheLock.tryLock() ) {
+        d->m_contentionCount.ref();
+        d->m_cacheLock.lock();
+    }
 
     // has another thread loaded our tile due to a race condition?
     stackedTile = d->m_tilesOnDisplay.value( stackedTileId, 0 );
@@ -127,7 +206,7 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
     if ( stackedTile ) {
         Q_ASSERT( !stackedTile->used() && "tiles in m_tileCache are invisible and should thus be marked as unused" );
         stackedTile->setUsed( true );
-        d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+        d->addTileOnDisplay( stackedTileId, stackedTile );
         d->m_cacheLock.unlock();
         return stackedTile;
     }
@@ -141,7 +220,7 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
     Q_ASSERT( stackedTile );
     stackedTile->setUsed( true );
 
-    d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+    d->addTileOnDisplay( stackedTileId, stackedTile );
     d->m_cacheLock.unlock();
 
     emit tileLoaded( stackedTileId );
@@ -164,6 +243,11 @@ int StackedTileLoader::tileCount() const
     return d->m_tileCache.count() + d->m_tilesOnDisplay.count();
 }
 
+int StackedTileLoader::contentionCount() const
+{
+    return d->m_contentionCount.loadRelaxed();
+}
+
 void StackedTileLoader::setVolatileCacheLimit( quint64 kiloBytes )
 {
     mDebug() << QString("Setting tile cache to %1 kilobytes.").arg( kiloBytes );
@@ -181,13 +265,22 @@ void StackedTileLoader::updateTile( TileId const &tileId, QImage const &tileImag
         StackedTile *const stackedTile = d->m_layerDecorator->updateTile( *displayedTile, tileId, tileImage );
         stackedTile->setUsed( true );
         d->m_tilesOnDisplay.insert( stackedTileId, stackedTile );
+        // updates arrive between frames, so the snapshot still pointing to
+        // the replaced tile is not read anymore
+        d->publishTilesOnDisplay();
+        d->deleteRetiredTiles();
 
         delete displayedTile;
         displayedTile = nullptr;
 
         emit tileLoaded( stackedTileId );
+    } else if ( StackedTile *const cachedTile = d->m_tileCache.take( stackedTileId ) ) {
+        // keep the update, like a decoded tile which left the screen meanwhile
+        StackedTile *const stackedTile = d->m_layerDecorator->updateTile( *cachedTile, tileId, tileImage );
+        d->m_tileCache.insert( stackedTileId, stackedTile, stackedTile->byteCount() );
+        delete cachedTile;
     } else {
-        d->m_tileCache.remove( stackedTileId );
+        d->m_layerDecorator->removeUnshadedTile( stackedTileId );
     }
 }
 
@@ -206,6 +299,8 @@ void StackedTileLoader::clear()
 {
     qDeleteAll( d->m_tilesOnDisplay );
     d->m_tilesOnDisplay.clear();
+    d->publishTilesOnDisplay();
+    d->deleteRetiredTiles();
     d->m_tileCache.clear(); // clear the tile cache in physical memory
 
     emit cleared();
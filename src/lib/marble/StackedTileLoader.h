@@ -67,6 +67,10 @@ class StackedTileLoader : public QObject
         /**
          * Loads a tile and returns it.
          *
+         * This method is safe to be called from the render threads of the
+         * texture mappers. Tiles that are already on display are looked up
+         * without taking any lock.
+         *
          * @param stackedTileId The Id of the requested tile, containing the x and y coordinate
          *                      and the zoom level.
          */
@@ -101,6 +105,12 @@ class StackedTileLoader : public QObject
          */
         int tileCount() const;
 
+        /**
+         * @brief Returns how often loadTile() had to wait for another thread
+         *        since the last call of resetTilehash().
+         */
+        int contentionCount() const;
+
         /**
          * @brief Set the limit of the volatile (in RAM) cache.
          * @param kiloBytes The limit in kilobytes.
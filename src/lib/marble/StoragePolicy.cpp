@@ -12,4 +12,9 @@ StoragePolicy::StoragePolicy( QObject *parent )
     : QObject( parent )
 {}
 
+void StoragePolicy::reportAccess( const QString &fileName )
+{
+    emit fileAccessed( fileName );
+}
+
 #include "moc_StoragePolicy.cpp"
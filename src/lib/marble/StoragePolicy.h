@@ -35,10 +35,31 @@ class StoragePolicy : public QObject
 	virtual void clearCache() = 0;
 
         virtual QString lastErrorMessage() const = 0;
+
+    public Q_SLOTS:
+        /**
+         * Reports a read of the stored @p fileName, see fileAccessed().
+         */
+        void reportAccess( const QString &fileName );
 	
     Q_SIGNALS:
 	void cleared();
 	void sizeChanged( qint64 );
+
+        /**
+         * Is emitted when the stored @p fileName has been written with @p size bytes.
+         */
+        void fileUpdated( const QString &fileName, qint64 size );
+
+        /**
+         * Is emitted when the stored @p fileName has been removed.
+         */
+        void fileRemoved( const QString &fileName );
+
+        /**
+         * Is emitted when the stored @p fileName has been read.
+         */
+        void fileAccessed( const QString &fileName );
 	
     private:
 	Q_DISABLE_COPY( StoragePolicy )
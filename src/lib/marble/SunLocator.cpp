@@ -172,6 +172,11 @@ qreal SunLocator::getLat() const
     return d->m_lat * RAD2DEG;
 }
 
+qreal SunLocator::twilightZone() const
+{
+    return d->m_twilightZone;
+}
+
 }
 
 #include "moc_SunLocator.cpp"
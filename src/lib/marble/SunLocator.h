@@ -35,6 +35,12 @@ class MARBLE_EXPORT SunLocator : public QObject
     qreal getLon() const;
     qreal getLat() const;
 
+    /**
+     * Returns the width of the twilight zone of the planet, in the unit of
+     * the haversine used by shading().
+     */
+    qreal twilightZone() const;
+
  public Q_SLOTS:
     void update();
 
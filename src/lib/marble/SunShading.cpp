@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "SunShading.h"
+
+#include "MarbleGlobal.h"
+#include "SunLocator.h"
+#include "TileId.h"
+#include "TileLoaderHelper.h"
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QVector>
+
+#include <cmath>
+
+#if ( defined(__GNUC__) || defined(__clang__) ) && ( defined(__x86_64__) || defined(__i386__) )
+#define MARBLE_SUNSHADING_X86
+#include <immintrin.h>
+#endif
+
+using namespace Marble;
+
+namespace
+{
+
+QAtomicInt s_kind( -1 );
+
+SunShading::Kind detectKind()
+{
+#ifdef MARBLE_SUNSHADING_X86
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "sse2" ) ) {
+        return SunShading::Sse2;
+    }
+    return SunShading::Scalar;
+#else
+    return SunShading::Scalar;
+#endif
+}
+
+// Same arithmetic as the vectorized kernels, so that the tail of a row
+// does not differ from its beginning.
+inline float brightness( float columnTerm, float rowTerm, float rowFactor, float scale, float offset )
+{
+    const float h = rowTerm + rowFactor * columnTerm;
+    return qMin( qMax( offset - h * scale, 0.0f ), 1.0f );
+}
+
+inline QRgb shadePixel( QRgb pixel, float brightness )
+{
+    // daylight - no change
+    if ( brightness > 0.99999f ) {
+        return pixel;
+    }
+
+    const float d = 0.65f * brightness + 0.35f;
+    return qRgb( int( d * qRed( pixel ) ), int( d * qGreen( pixel ) ), int( d * qBlue( pixel ) ) );
+}
+
+inline QRgb shadePixelComposite( QRgb pixel, QRgb nightPixel, float brightness )
+{
+    if ( brightness > 0.99999f ) {
+        return pixel;
+    }
+    if ( brightness < 0.00001f ) {
+        return nightPixel;
+    }
+
+    const float night = 1.0f - brightness;
+    return qRgb( int( brightness * qRed( pixel ) + night * qRed( nightPixel ) ),
+                 int( brightness * qGreen( pixel ) + night * qGreen( nightPixel ) ),
+                 int( brightness * qBlue( pixel ) + night * qBlue( nightPixel ) ) );
+}
+
+void shadeRowScalar( QRgb *scanLine, const float *columnTerms,
+                     float rowTerm, float rowFactor, float scale, float offset, int count )
+{
+    for ( int x = 0; x < count; ++x ) {
+        scanLine[ x ] = shadePixel( scanLine[ x ], brightness( columnTerms[ x ], rowTerm, rowFactor, scale, offset ) );
+    }
+}
+
+void shadeRowCompositeScalar( QRgb *scanLine, const QRgb *nightScanLine, const float *columnTerms,
+                              float rowTerm, float rowFactor, float scale, float offset, int count )
+{
+    for ( int x = 0; x < count; ++x ) {
+        scanLine[ x ] = shadePixelComposite( scanLine[ x ], nightScanLine[ x ],
+                                             brightness( columnTerms[ x ], rowTerm, rowFactor, scale, offset ) );
+    }
+}
+
+#ifdef MARBLE_SUNSHADING_X86
+
+__attribute__((target("sse2")))
+inline __m128 brightnessSse2( const float *columnTerms, __m128 rowTerm, __m128 rowFactor, __m128 scale, __m128 offset )
+{
+    const __m128 h = _mm_add_ps( rowTerm, _mm_mul_ps( rowFactor, _mm_loadu_ps( columnTerms ) ) );
+    return _mm_min_ps( _mm_max_ps( _mm_sub_ps( offset, _mm_mul_ps( h, scale ) ), _mm_setzero_ps() ), _mm_set1_ps( 1.0f ) );
+}
+
+// Returns the channel at bit @p shift of the four pixels as floats
+__attribute__((target("sse2")))
+inline __m128 channelSse2( __m128i pixels, int shift )
+{
+    return _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( pixels, shift ), _mm_set1_epi32( 0xff ) ) );
+}
+
+// Packs the truncated channels into opaque pixels
+__attribute__((target("sse2")))
+inline __m128i packSse2( __m128 red, __m128 green, __m128 blue )
+{
+    return _mm_or_si128( _mm_or_si128( _mm_set1_epi32( int( 0xff000000 ) ),
+                                       _mm_slli_epi32( _mm_cvttps_epi32( red ), 16 ) ),
+                         _mm_or_si128( _mm_slli_epi32( _mm_cvttps_epi32( green ), 8 ),
+                                       _mm_cvttps_epi32( blue ) ) );
+}
+
+__attribute__((target("sse2")))
+inline __m128i selectSse2( __m128 mask, __m128i a, __m128i b )
+{
+    const __m128i m = _mm_castps_si128( mask );
+    return _mm_or_si128( _mm_and_si128( m, a ), _mm_andnot_si128( m, b ) );
+}
+
+__attribute__((target("sse2")))
+void shadeRowSse2( QRgb *scanLine, const float *columnTerms,
+                   float rowTerm, float rowFactor, float scale, float offset, int count )
+{
+    const __m128 vRowTerm = _mm_set1_ps( rowTerm );
+    const __m128 vRowFactor = _mm_set1_ps( rowFactor );
+    const __m128 vScale = _mm_set1_ps( scale );
+    const __m128 vOffset = _mm_set1_ps( offset );
+    const __m128 daylight = _mm_set1_ps( 0.99999f );
+
+    int x = 0;
+    for ( ; x + 4 <= count; x += 4 ) {
+        const __m128 b = brightnessSse2( columnTerms + x, vRowTerm, vRowFactor, vScale, vOffset );
+        const __m128 isDay = _mm_cmpgt_ps( b, daylight );
+        if ( _mm_movemask_ps( isDay ) == 0xf ) {
+            continue;
+        }
+
+        __m128i *const pixelsPointer = reinterpret_cast<__m128i *>( scanLine + x );
+        const __m128i pixels = _mm_loadu_si128( pixelsPointer );
+        const __m128 d = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( 0.65f ), b ), _mm_set1_ps( 0.35f ) );
+        const __m128i shaded = packSse2( _mm_mul_ps( d, channelSse2( pixels, 16 ) ),
+                                         _mm_mul_ps( d, channelSse2( pixels, 8 ) ),
+                                         _mm_mul_ps( d, channelSse2( pixels, 0 ) ) );
+        _mm_storeu_si128( pixelsPointer, selectSse2( isDay, pixels, shaded ) );
+    }
+
+    shadeRowScalar( scanLine + x, columnTerms + x, rowTerm, rowFactor, scale, offset, count - x );
+}
+
+__attribute__((target("sse2")))
+void shadeRowCompositeSse2( QRgb *scanLine, const QRgb *nightScanLine, const float *columnTerms,
+                            float rowTerm, float rowFactor, float scale, float offset, int count )
+{
+    const __m128 vRowTerm = _mm_set1_ps( rowTerm );
+    const __m128 vRowFactor = _mm_set1_ps( rowFactor );
+    const __m128 vScale = _mm_set1_ps( scale );
+    const __m128 vOffset = _mm_set1_ps( offset );
+    const __m128 daylight = _mm_set1_ps( 0.99999f );
+    const __m128 darkness = _mm_set1_ps( 0.00001f );
+
+    int x = 0;
+    for ( ; x + 4 <= count; x += 4 ) {
+        const __m128 b = brightnessSse2( columnTerms + x, vRowTerm, vRowFactor, vScale, vOffset );
+        const __m128 isDay = _mm_cmpgt_ps( b, daylight );
+        if ( _mm_movemask_ps( isDay ) == 0xf ) {
+            continue;
+        }
+
+        __m128i *const pixelsPointer = reinterpret_cast<__m128i *>( scanLine + x );
+        const __m128i pixels = _mm_loadu_si128( pixelsPointer );
+        const __m128i nightPixels = _mm_loadu_si128( reinterpret_cast<const __m128i *>( nightScanLine + x ) );
+        const __m128 night = _mm_sub_ps( _mm_set1_ps( 1.0f ), b );
+        const __m128i blended = packSse2( _mm_add_ps( _mm_mul_ps( b, channelSse2( pixels, 16 ) ),
+                                                      _mm_mul_ps( night, channelSse2( nightPixels, 16 ) ) ),
+                                          _mm_add_ps( _mm_mul_ps( b, channelSse2( pixels, 8 ) ),
+                                                      _mm_mul_ps( night, channelSse2( nightPixels, 8 ) ) ),
+                                          _mm_add_ps( _mm_mul_ps( b, channelSse2( pixels, 0 ) ),
+                                                      _mm_mul_ps( night, channelSse2( nightPixels, 0 ) ) ) );
+        const __m128i shaded = selectSse2( _mm_cmplt_ps( b, darkness ), nightPixels, blended );
+        _mm_storeu_si128( pixelsPointer, selectSse2( isDay, pixels, shaded ) );
+    }
+
+    shadeRowCompositeScalar( scanLine + x, nightScanLine + x, columnTerms + x,
+                             rowTerm, rowFactor, scale, offset, count - x );
+}
+
+#endif
+
+// The brightness falls linearly from 1 to 0 across the twilight zone:
+//   ( 0.5 + twilightZone / 2 - h ) / twilightZone = offset - h * scale
+inline float scale( float twilightZone )
+{
+    return 1.0f / qMax( twilightZone, 1e-6f );
+}
+
+inline float offset( float twilightZone )
+{
+    return 0.5f * scale( twilightZone ) + 0.5f;
+}
+
+}
+
+SunShading::Kind SunShading::bestKind()
+{
+    static const Kind best = detectKind();
+    return best;
+}
+
+SunShading::Kind SunShading::kind()
+{
+    const int current = s_kind.loadRelaxed();
+    if ( current < 0 ) {
+        return bestKind();
+    }
+
+    return Kind( current );
+}
+
+void SunShading::setKind( Kind kind )
+{
+    s_kind.storeRelaxed( qMin<int>( kind, bestKind() ) );
+}
+
+void SunShading::shadeRow( QRgb *scanLine, const float *columnTerms,
+                           float rowTerm, float rowFactor, float twilightZone, int count )
+{
+    switch ( kind() ) {
+#ifdef MARBLE_SUNSHADING_X86
+    case Sse2:
+        shadeRowSse2( scanLine, columnTerms, rowTerm, rowFactor, scale( twilightZone ), offset( twilightZone ), count );
+        return;
+#endif
+    default:
+        shadeRowScalar( scanLine, columnTerms, rowTerm, rowFactor, scale( twilightZone ), offset( twilightZone ), count );
+    }
+}
+
+void SunShading::shadeRowComposite( QRgb *scanLine, const QRgb *nightScanLine, const float *columnTerms,
+                                    float rowTerm, float rowFactor, float twilightZone, int count )
+{
+    switch ( kind() ) {
+#ifdef MARBLE_SUNSHADING_X86
+    case Sse2:
+        shadeRowCompositeSse2( scanLine, nightScanLine, columnTerms, rowTerm, rowFactor,
+                               scale( twilightZone ), offset( twilightZone ), count );
+        return;
+#endif
+    default:
+        shadeRowCompositeScalar( scanLine, nightScanLine, columnTerms, rowTerm, rowFactor,
+                                 scale( twilightZone ), offset( twilightZone ), count );
+    }
+}
+
+void SunShading::shadeTile( QImage *tileImage, const QImage *nightImage, const TileId &id,
+                            const SunLocator *sunLocator, int levelZeroColumns, int levelZeroRows )
+{
+    if ( tileImage->depth() != 32 ) {
+        return;
+    }
+    QImage convertedNightImage;
+    if ( nightImage ) {
+        if ( nightImage->size() != tileImage->size() ) {
+            return;
+        }
+        if ( nightImage->depth() != 32 ) {
+            convertedNightImage = nightImage->convertToFormat( QImage::Format_ARGB32 );
+            nightImage = &convertedNightImage;
+        }
+    }
+
+    const int tileHeight = tileImage->height();
+    const int tileWidth = tileImage->width();
+    const qreal globalWidth = tileWidth * TileLoaderHelper::levelToColumn( levelZeroColumns, id.zoomLevel() );
+    const qreal globalHeight = tileHeight * TileLoaderHelper::levelToRow( levelZeroRows, id.zoomLevel() );
+    const qreal lonScale = 2 * M_PI / globalWidth;
+    const qreal latScale = -M_PI / globalHeight;
+    const qreal sunLon = DEG2RAD * sunLocator->getLon();
+    const qreal sunLat = DEG2RAD * sunLocator->getLat();
+    const float twilightZone = sunLocator->twilightZone();
+
+    // The haversine of the distance to the point beneath the sun is
+    // h = a² + c * b², see SunLocator::shading(). a and c only depend on
+    // the row, b = sin( ( lon - sunLon ) / 2 ) only on the column.
+    QVector<float> columnTerms( tileWidth );
+    for ( int x = 0; x < tileWidth; ++x ) {
+        const qreal b = std::sin( ( lonScale * ( id.x() * tileWidth + x ) - sunLon ) / 2.0 );
+        columnTerms[ x ] = b * b;
+    }
+
+    for ( int y = 0; y < tileHeight; ++y ) {
+        const qreal lat = latScale * ( id.y() * tileHeight + y ) - 0.5 * M_PI;
+        const qreal a = std::sin( ( lat + sunLat ) / 2.0 );
+        const qreal c = std::cos( lat ) * std::cos( -sunLat );
+
+        QRgb *const scanLine = reinterpret_cast<QRgb *>( tileImage->scanLine( y ) );
+        if ( nightImage ) {
+            const QRgb *const nightScanLine = reinterpret_cast<const QRgb *>( nightImage->constScanLine( y ) );
+            shadeRowComposite( scanLine, nightScanLine, columnTerms.constData(), a * a, c, twilightZone, tileWidth );
+        } else {
+            shadeRow( scanLine, columnTerms.constData(), a * a, c, twilightZone, tileWidth );
+        }
+    }
+}
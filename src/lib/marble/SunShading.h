@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_SUNSHADING_H
+#define MARBLE_SUNSHADING_H
+
+#include <QColor>
+
+#include "marble_export.h"
+
+class QImage;
+
+namespace Marble
+{
+
+class SunLocator;
+class TileId;
+
+/**
+ * @short Vectorized day and night shading of texture tiles.
+ *
+ * The brightness of a pixel depends on the haversine of its distance to the
+ * point beneath the sun (see SunLocator::shading()), which splits into a term
+ * per tile row and a term per tile column. Both are calculated once per tile,
+ * so that shading a pixel needs no trigonometric functions. The rows are
+ * shaded 4 pixels at a time with SSE2 where the CPU supports it, other CPUs
+ * use a scalar implementation.
+ */
+class MARBLE_EXPORT SunShading
+{
+ public:
+    enum Kind {
+        Scalar,
+        Sse2
+    };
+
+    /**
+     * @brief Returns the fastest kernel supported by the CPU.
+     */
+    static Kind bestKind();
+
+    /**
+     * @brief Returns the kernel that is currently used.
+     */
+    static Kind kind();
+
+    /**
+     * @brief Selects the kernel, meant for comparing the implementations.
+     * Kinds that are not supported by the CPU fall back to bestKind().
+     */
+    static void setKind( Kind kind );
+
+    /**
+     * @brief Shades the 32 bit @p tileImage at the current sun position.
+     *
+     * Without @p nightImage, the night side gets darkened like by
+     * SunLocator::shadePixel(). Otherwise the pixels of the night side are
+     * taken from the night image like by SunLocator::shadePixelComposite().
+     * The tiles are expected to be in an equirectangular layout of
+     * @p levelZeroColumns by @p levelZeroRows tiles at level zero.
+     */
+    static void shadeTile( QImage *tileImage, const QImage *nightImage, const TileId &id,
+                           const SunLocator *sunLocator, int levelZeroColumns, int levelZeroRows );
+
+    /**
+     * @brief Darkens @p count pixels of a row.
+     *
+     * The haversine of a pixel is @p rowTerm + @p rowFactor * @p columnTerms[x],
+     * its brightness falls from 1 to 0 across the @p twilightZone around 0.5.
+     */
+    static void shadeRow( QRgb *scanLine, const float *columnTerms,
+                          float rowTerm, float rowFactor, float twilightZone, int count );
+
+    /**
+     * @brief Blends @p count pixels of a row with the ones of the night row.
+     *
+     * The brightness of the pixels is calculated like in shadeRow().
+     */
+    static void shadeRowComposite( QRgb *scanLine, const QRgb *nightScanLine, const float *columnTerms,
+                                   float rowTerm, float rowFactor, float twilightZone, int count );
+};
+
+}
+
+#endif
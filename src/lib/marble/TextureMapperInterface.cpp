@@ -22,3 +22,13 @@ void TextureMapperInterface::setRepaintNeeded()
 {
     m_repaintNeeded = true;
 }
+
+void TextureMapperInterface::setCenterChanged()
+{
+    m_repaintNeeded = true;
+}
+
+QString TextureMapperInterface::runtimeTrace() const
+{
+    return QString();
+}
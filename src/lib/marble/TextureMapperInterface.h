@@ -7,6 +7,8 @@
 #ifndef MARBLE_TEXTUREMAPPERINTERFACE_H
 #define MARBLE_TEXTUREMAPPERINTERFACE_H
 
+#include <QString>
+
 class QRect;
 
 namespace Marble
@@ -31,6 +33,19 @@ public:
 
     void setRepaintNeeded();
 
+    /**
+     * @brief Notifies the mapper that only the center of the viewport changed.
+     *
+     * By default this schedules a full repaint. Mappers which are able to
+     * reuse their previous canvas override it.
+     */
+    virtual void setCenterChanged();
+
+    /**
+     * @brief Returns statistics of the last mapped frame, empty by default.
+     */
+    virtual QString runtimeTrace() const;
+
 protected:
     bool m_repaintNeeded;
 };
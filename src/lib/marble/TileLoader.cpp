@@ -8,9 +8,11 @@
 #include "TileLoader.h"
 
 #include <QDateTime>
+#include <QDir>
 #include <QFileInfo>
 #include <QMetaType>
 #include <QImage>
+#include <QRunnable>
 #include <QUrl>
 
 #include "GeoSceneTextureTileDataset.h"
@@ -21,6 +23,7 @@
 #include "HttpDownloadManager.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "MbTilesStorage.h"
 #include "TileId.h"
 #include "TileLoaderHelper.h"
 #include "ParseRunnerPlugin.h"
@@ -31,21 +34,76 @@ Q_DECLARE_METATYPE( Marble::DownloadUsage )
 namespace Marble
 {
 
+class TileLoader::DecodeJob : public QRunnable
+{
+public:
+    DecodeJob( TileLoader *tileLoader, const TileId &tileId, const QString &fileName );
+
+    void run() override;
+
+private:
+    TileLoader *const m_tileLoader;
+    const TileId m_tileId;
+    const QString m_fileName;
+};
+
+TileLoader::DecodeJob::DecodeJob( TileLoader *tileLoader, const TileId &tileId, const QString &fileName ) :
+    m_tileLoader( tileLoader ),
+    m_tileId( tileId ),
+    m_fileName( fileName )
+{
+}
+
+void TileLoader::DecodeJob::run()
+{
+    QImage const image = TileLoader::readTileImage( m_fileName );
+
+    {
+        QMutexLocker locker( &m_tileLoader->m_pendingDecodesLock );
+        m_tileLoader->m_pendingDecodes.remove( m_tileId );
+    }
+
+    if ( image.isNull() ) {
+        mDebug() << Q_FUNC_INFO << "could not decode" << m_fileName;
+        return;
+    }
+
+    m_tileLoader->insertDecodedTile( m_tileId, image );
+
+    // queued to the receivers, which live in the main thread
+    emit m_tileLoader->tileCompleted( m_tileId, image );
+}
+
 TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const PluginManager *pluginManager) :
-    m_pluginManager(pluginManager)
+    m_pluginManager(pluginManager),
+    m_asynchronousDecoding( false ),
+    m_decodedTiles( 16384 ) // kilobytes
 {
     qRegisterMetaType<DownloadUsage>( "DownloadUsage" );
+    qRegisterMetaType<TileId>( "TileId" );
     connect( this, SIGNAL(downloadTile(QUrl,QString,QString,DownloadUsage)),
              downloadManager, SLOT(addJob(QUrl,QString,QString,DownloadUsage)));
     connect( downloadManager, SIGNAL(downloadComplete(QString,QString)),
              SLOT(updateTile(QString,QString)));
     connect( downloadManager, SIGNAL(downloadComplete(QByteArray,QString)),
              SLOT(updateTile(QByteArray,QString)));
+    connect( this, SIGNAL(fileAccessed(QString)),
+             downloadManager, SLOT(reportFileAccess(QString)) );
 }
 
 TileLoader::~TileLoader()
 {
-    // nothing to do
+    m_decodePool.waitForDone();
+}
+
+void TileLoader::setAsynchronousDecoding( bool enabled )
+{
+    m_asynchronousDecoding = enabled;
+}
+
+bool TileLoader::asynchronousDecoding() const
+{
+    return m_asynchronousDecoding;
 }
 
 // If the tile image file is locally available:
@@ -67,7 +125,29 @@ QImage TileLoader::loadTileImage( GeoSceneTextureTileDataset const *textureLayer
             triggerDownload( textureLayer, tileId, usage );
         }
 
-        QImage const image( fileName );
+        emit fileAccessed( textureLayer->relativeTileFileName( tileId ) );
+
+        // Level zero tiles are their own replacement, so there is nothing to gain
+        if ( m_asynchronousDecoding && tileId.zoomLevel() > 0 ) {
+            {
+                // like tiles that completed after leaving the screen
+                QMutexLocker locker( &m_decodedTilesLock );
+                if ( const QImage *const image = m_decodedTiles.object( tileId ) ) {
+                    return *image;
+                }
+            }
+
+            QMutexLocker locker( &m_pendingDecodesLock );
+            if ( !m_pendingDecodes.contains( tileId ) ) {
+                m_pendingDecodes.insert( tileId );
+                m_decodePool.start( new DecodeJob( this, tileId, fileName ) );
+            }
+            locker.unlock();
+
+            return scaledLowerLevelTile( textureLayer, tileId );
+        }
+
+        QImage const image = readTileImage( fileName );
         if ( !image.isNull() ) {
             // file is there, so create and return a tile object in any case
             return image;
@@ -104,6 +184,8 @@ GeoDataDocument *TileLoader::loadTileVectorData( GeoSceneVectorTileDataset const
             triggerDownload( textureLayer, tileId, usage );
         }
 
+        emit fileAccessed( textureLayer->relativeTileFileName( tileId ) );
+
         QFile file ( fileName );
         if ( file.exists() ) {
 
@@ -174,8 +256,7 @@ bool TileLoader::baseTilesAvailable( GeoSceneTileDataset const & tileData )
     for ( int column = 0; result && column < levelZeroColumns; ++column ) {
         for ( int row = 0; result && row < levelZeroRows; ++row ) {
             const TileId id( 0, 0, column, row );
-            const QString tilepath = tileFileName( &tileData, id );
-            result &= QFile::exists( tilepath );
+            result &= tileStatus( &tileData, id ) != Missing;
             if (!result) {
                 mDebug() << "Base tile " << tileData.relativeTileFileName( id ) << " is missing for source dir " << tileData.sourceDir();
             }
@@ -188,12 +269,26 @@ bool TileLoader::baseTilesAvailable( GeoSceneTileDataset const & tileData )
 TileLoader::TileStatus TileLoader::tileStatus( GeoSceneTileDataset const *tileData, const TileId &tileId )
 {
     QString const fileName = tileFileName( tileData, tileId );
-    QFileInfo fileInfo( fileName );
-    if ( !fileInfo.exists() ) {
-        return Missing;
+    QDateTime lastModified;
+
+    QString databaseFileName;
+    int zoomLevel, x, y;
+    if ( MbTilesStorage::parseTileFileName( fileName, databaseFileName, zoomLevel, x, y ) ) {
+        if ( !MbTilesStorage( databaseFileName ).hasTile( zoomLevel, x, y, &lastModified ) ) {
+            return Missing;
+        }
+        if ( !lastModified.isValid() ) {
+            // imported tiles have no time stamp and never expire
+            return Available;
+        }
+    } else {
+        QFileInfo fileInfo( fileName );
+        if ( !fileInfo.exists() ) {
+            return Missing;
+        }
+        lastModified = fileInfo.lastModified();
     }
 
-    const QDateTime lastModified = fileInfo.lastModified();
     const int expireSecs = tileData->expire();
     const bool isExpired = lastModified.secsTo( QDateTime::currentDateTime() ) >= expireSecs;
     return isExpired ? Expired : Available;
@@ -217,6 +312,7 @@ void TileLoader::updateTile( QByteArray const & data, QString const & idStr )
         if ( tileImage.isNull() )
             return;
 
+        insertDecodedTile( id, tileImage );
         emit tileCompleted( id, tileImage );
     }
 }
@@ -244,10 +340,44 @@ void TileLoader::updateTile(const QString &fileName, const QString &idStr)
 QString TileLoader::tileFileName( GeoSceneTileDataset const * tileData, TileId const & tileId )
 {
     QString const fileName = tileData->relativeTileFileName( tileId );
+
+    if ( tileData->storageFormat() == GeoSceneTileDataset::MBTiles ) {
+        // the tile is inside the database, so look up where the database is installed
+        QString const databaseName = tileData->mbTilesFileName();
+        QString const tileName = fileName.mid( databaseName.size() );
+        if ( QFileInfo( databaseName ).isAbsolute() ) {
+            return databaseName + tileName;
+        }
+
+        // Downloaded tiles go to the local database, while the system database
+        // may hold installed tiles missing locally, e.g. the base tiles.
+        // Therefore the local database only hides the system one per tile.
+        QString const localDatabase = QDir( MarbleDirs::localPath() + QLatin1Char('/') + databaseName ).canonicalPath();
+        QString const systemDatabase = QDir( MarbleDirs::systemPath() + QLatin1Char('/') + databaseName ).canonicalPath();
+        if ( !localDatabase.isEmpty() && !systemDatabase.isEmpty()
+             && !MbTilesStorage( localDatabase ).hasTile( tileId.zoomLevel(), tileId.x(), tileId.y() ) ) {
+            return systemDatabase + tileName;
+        }
+
+        QString const databasePath = localDatabase.isEmpty() ? systemDatabase : localDatabase;
+        return databasePath.isEmpty() ? QString() : databasePath + tileName;
+    }
+
     QFileInfo const dirInfo( fileName );
     return dirInfo.isAbsolute() ? fileName : MarbleDirs::path( fileName );
 }
 
+QImage TileLoader::readTileImage( QString const & fileName )
+{
+    QString databaseFileName;
+    int zoomLevel, x, y;
+    if ( MbTilesStorage::parseTileFileName( fileName, databaseFileName, zoomLevel, x, y ) ) {
+        return QImage::fromData( MbTilesStorage( databaseFileName ).tileData( zoomLevel, x, y ) );
+    }
+
+    return ( !fileName.isEmpty() && QFile::exists( fileName ) ) ? QImage( fileName ) : QImage();
+}
+
 void TileLoader::triggerDownload( GeoSceneTileDataset const *tileData, TileId const &id, DownloadUsage const usage )
 {
     if (id.zoomLevel() > 0) {
@@ -264,48 +394,77 @@ void TileLoader::triggerDownload( GeoSceneTileDataset const *tileData, TileId co
     emit downloadTile( sourceUrl, destFileName, idStr, usage );
 }
 
+void TileLoader::insertDecodedTile( TileId const &tileId, QImage const &image )
+{
+    QMutexLocker locker( &m_decodedTilesLock );
+    m_decodedTiles.insert( tileId, new QImage( image ), qMax<qint64>( 1, image.sizeInBytes() / 1024 ) );
+}
+
 QImage TileLoader::scaledLowerLevelTile( const GeoSceneTextureTileDataset * textureData, TileId const & id )
 {
     mDebug() << Q_FUNC_INFO << id;
 
     int const minimumLevel = textureData->minimumTileLevel();
-    for ( int level = qMax<int>( 0, id.zoomLevel() - 1 ); level >= 0; --level ) {
-        if (level > 0 && level < minimumLevel) {
-            continue;
-        }
+    int const firstLevel = qMax<int>( 0, id.zoomLevel() - 1 );
+    auto const isReplacementLevel = [minimumLevel]( int level ) {
+        return level == 0 || level >= minimumLevel;
+    };
+    auto const replacementTileId = [&id]( int level ) {
         int const deltaLevel = id.zoomLevel() - level;
-
-        TileId const replacementTileId( id.mapThemeIdHash(), level,
-                                        id.x() >> deltaLevel, id.y() >> deltaLevel );
-        QString const fileName = tileFileName( textureData, replacementTileId );
-        mDebug() << "TileLoader::scaledLowerLevelTile" << "trying" << fileName;
-        QImage toScale = (!fileName.isEmpty() && QFile::exists(fileName)) ? QImage(fileName) : QImage();
-
-        if ( level == 0 && toScale.isNull() ) {
-            mDebug() << "No level zero tile installed in map theme dir. Falling back to a transparent image for now.";
-            QSize tileSize = textureData->tileSize();
-            Q_ASSERT( !tileSize.isEmpty() ); // assured by textureLayer
-            toScale = QImage( tileSize, QImage::Format_ARGB32_Premultiplied );
-            toScale.fill( qRgba( 0, 0, 0, 0 ) );
+        return TileId( id.mapThemeIdHash(), level, id.x() >> deltaLevel, id.y() >> deltaLevel );
+    };
+
+    // Any decoded lower level tile is preferred over decoding one on the calling thread
+    QImage toScale;
+    int level = firstLevel;
+    {
+        QMutexLocker locker( &m_decodedTilesLock );
+        for ( ; level >= 0; --level ) {
+            const QImage *const image = m_decodedTiles.object( replacementTileId( level ) );
+            if ( image && isReplacementLevel( level ) ) {
+                toScale = *image;
+                break;
+            }
         }
+    }
+
+    if ( toScale.isNull() ) {
+        for ( level = firstLevel; level >= 0; --level ) {
+            if ( !isReplacementLevel( level ) ) {
+                continue;
+            }
 
-        if ( !toScale.isNull() ) {
-            // which rect to scale?
-            int const restTileX = id.x() % ( 1 << deltaLevel );
-            int const restTileY = id.y() % ( 1 << deltaLevel );
-            int const partWidth = qMax(1, toScale.width() >> deltaLevel);
-            int const partHeight = qMax(1, toScale.height() >> deltaLevel);
-            int const startX = restTileX * partWidth;
-            int const startY = restTileY * partHeight;
-            mDebug() << "QImage::copy:" << startX << startY << partWidth << partHeight;
-            QImage const part = toScale.copy( startX, startY, partWidth, partHeight );
-            mDebug() << "QImage::scaled:" << toScale.size();
-            return part.scaled( toScale.size() );
+            QString const fileName = tileFileName( textureData, replacementTileId( level ) );
+            mDebug() << "TileLoader::scaledLowerLevelTile" << "trying" << fileName;
+            toScale = readTileImage( fileName );
+            if ( !toScale.isNull() ) {
+                insertDecodedTile( replacementTileId( level ), toScale );
+                break;
+            }
         }
     }
 
-    Q_ASSERT_X( false, "scaled image", "level zero image missing" ); // not reached
-    return QImage();
+    if ( toScale.isNull() ) {
+        mDebug() << "No level zero tile installed in map theme dir. Falling back to a transparent image for now.";
+        QSize tileSize = textureData->tileSize();
+        Q_ASSERT( !tileSize.isEmpty() ); // assured by textureLayer
+        toScale = QImage( tileSize, QImage::Format_ARGB32_Premultiplied );
+        toScale.fill( qRgba( 0, 0, 0, 0 ) );
+        level = 0;
+    }
+
+    // which rect to scale?
+    int const deltaLevel = id.zoomLevel() - level;
+    int const restTileX = id.x() % ( 1 << deltaLevel );
+    int const restTileY = id.y() % ( 1 << deltaLevel );
+    int const partWidth = qMax(1, toScale.width() >> deltaLevel);
+    int const partHeight = qMax(1, toScale.height() >> deltaLevel);
+    int const startX = restTileX * partWidth;
+    int const startY = restTileY * partHeight;
+    mDebug() << "QImage::copy:" << startX << startY << partWidth << partHeight;
+    QImage const part = toScale.copy( startX, startY, partWidth, partHeight );
+    mDebug() << "QImage::scaled:" << toScale.size();
+    return part.scaled( toScale.size() );
 }
 
 GeoDataDocument *TileLoader::openVectorFile(const QString &fileName) const
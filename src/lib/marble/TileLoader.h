@@ -6,26 +6,31 @@
 #ifndef MARBLE_TILELOADER_H
 #define MARBLE_TILELOADER_H
 
+#include <QCache>
+#include <QImage>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
+#include <QThreadPool>
 
 #include "PluginManager.h"
 #include "MarbleGlobal.h"
+#include "TileId.h"
+#include "marble_export.h"
 
 class QByteArray;
-class QImage;
 class QUrl;
 class QString;
 
 namespace Marble
 {
-class TileId;
 class HttpDownloadManager;
 class GeoDataDocument;
 class GeoSceneTileDataset;
 class GeoSceneTextureTileDataset;
 class GeoSceneVectorTileDataset;
 
-class TileLoader: public QObject
+class MARBLE_EXPORT TileLoader: public QObject
 {
     Q_OBJECT
 
@@ -39,10 +44,25 @@ class TileLoader: public QObject
     explicit TileLoader(HttpDownloadManager * const, const PluginManager * );
     ~TileLoader() override;
 
+    /**
+     * Returns the image of the given tile.
+     *
+     * If asynchronous decoding is enabled, a scaled part of a lower level tile
+     * is returned instead while the tile image is decoded in the background.
+     * The decoded image is delivered through tileCompleted() afterwards, and
+     * kept for a while to be returned right away by the next calls.
+     */
     QImage loadTileImage( GeoSceneTextureTileDataset const *textureData, TileId const & tileId, DownloadUsage const );
     GeoDataDocument* loadTileVectorData( GeoSceneVectorTileDataset const *vectorData, TileId const & tileId, DownloadUsage const usage );
     void downloadTile( GeoSceneTileDataset const *tileData, TileId const &, DownloadUsage const );
 
+    /**
+     * Enables decoding tile images in a background thread pool, see loadTileImage().
+     * Disabled by default, as it is only useful for maps that get repainted.
+     */
+    void setAsynchronousDecoding( bool enabled );
+    bool asynchronousDecoding() const;
+
     static int maximumTileLevel( GeoSceneTileDataset const & tileData );
 
     /**
@@ -71,14 +91,33 @@ class TileLoader: public QObject
 
     void tileCompleted( TileId const & tileId, GeoDataDocument * document );
 
+    /**
+     * Is emitted when a tile file has been read, @p fileName is given relative
+     * to the download directory.
+     */
+    void fileAccessed( QString const & fileName );
+
  private:
+    class DecodeJob;
+
     static QString tileFileName( GeoSceneTileDataset const * tileData, TileId const & );
+    static QImage readTileImage( QString const & fileName );
     void triggerDownload( GeoSceneTileDataset const *tileData, TileId const &, DownloadUsage const );
-    static QImage scaledLowerLevelTile( GeoSceneTextureTileDataset const * textureData, TileId const & );
+    QImage scaledLowerLevelTile( GeoSceneTextureTileDataset const * textureData, TileId const & );
+    void insertDecodedTile( TileId const &tileId, QImage const &image );
     GeoDataDocument* openVectorFile(const QString &filename) const;
 
     // For vectorTile parsing
     PluginManager const * m_pluginManager;
+
+    bool m_asynchronousDecoding;
+    QThreadPool m_decodePool;
+    QMutex m_pendingDecodesLock;
+    QSet<TileId> m_pendingDecodes;
+    // Recently decoded and downloaded tiles, also used as lower level tiles
+    // for scaling, so that these are rarely decoded on the calling thread
+    QMutex m_decodedTilesLock;
+    QCache<TileId, QImage> m_decodedTiles;
 };
 
 }
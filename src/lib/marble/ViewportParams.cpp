@@ -431,6 +431,12 @@ bool ViewportParams::screenCoordinates( const GeoDataLineString &lineString,
     return d->m_currentProjection->screenCoordinates( lineString, this, polygons );
 }
 
+void ViewportParams::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude, int count,
+                        qreal *x, qreal *y, bool *visible, bool *globeHidesPoint ) const
+{
+    d->m_currentProjection->screenCoordinates( lon, lat, altitude, count, this, x, y, visible, globeHidesPoint );
+}
+
 bool ViewportParams::geoCoordinates( const int x, const int y,
                      qreal &lon, qreal &lat,
                      GeoDataCoordinates::Unit unit ) const
@@ -169,6 +169,17 @@ class MARBLE_EXPORT ViewportParams
     bool screenCoordinates( const GeoDataLineString &lineString,
                             QVector<QPolygonF*> &polygons ) const;
 
+    /**
+     * @brief Get the screen coordinates of many points in the map at once.
+     *
+     * The longitudes and latitudes are in radian, the altitudes in meters
+     * or @c nullptr for zero.
+     *
+     * @see AbstractProjection::screenCoordinates()
+     */
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude, int count,
+                            qreal *x, qreal *y, bool *visible, bool *globeHidesPoint = nullptr ) const;
+
     /**
      * @brief Get the earth coordinates corresponding to a pixel in the map.
      * @param x      the x coordinate of the pixel
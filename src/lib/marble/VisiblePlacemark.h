@@ -18,6 +18,7 @@
 
 #include <GeoDataStyle.h>
 #include <GeoDataCoordinates.h>
+#include "marble_export.h"
 
 namespace Marble
 {
@@ -32,7 +33,7 @@ static const qreal s_labelOutlineWidth = 2.5;
  * This class is used by PlacemarkLayout to pass the visible place marks
  * to the PlacemarkPainter.
  */
-class VisiblePlacemark : public QObject
+class MARBLE_EXPORT VisiblePlacemark : public QObject
 {
  Q_OBJECT
 
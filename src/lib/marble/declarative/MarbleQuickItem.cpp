@@ -13,6 +13,7 @@
 
 #include <MarbleModel.h>
 #include <MarbleMap.h>
+#include <layers/TextureLayer.h>
 #include <ViewportParams.h>
 #include <GeoPainter.h>
 #include <GeoDataLookAt.h>
@@ -242,6 +243,8 @@ namespace Marble
         setOpaquePainting(true);
         qRegisterMetaType<Placemark*>("Placemark*");
         d->m_map.setMapQualityForViewContext(NormalQuality, Animation);
+        // the item repaints when the tiles decoded in the background are ready
+        d->m_map.textureLayer()->setAsynchronousDecoding(true);
 
         for (AbstractFloatItem *item: d->m_map.floatItems()) {
             if (item->nameId() == QLatin1String("license")) {
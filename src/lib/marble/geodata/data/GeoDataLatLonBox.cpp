@@ -633,8 +633,8 @@ GeoDataLatLonBox GeoDataLatLonBox::fromLineString(  const GeoDataLineString& lin
         return GeoDataLatLonBox();
     }
 
-    qreal lon, lat;
-    lineString.first().geoCoordinates( lon, lat );
+    qreal lon = lineString.longitudeAt( 0 );
+    qreal lat = lineString.latitudeAt( 0 );
     GeoDataCoordinates::normalizeLonLat( lon, lat );
 
     qreal north = lat;
@@ -669,14 +669,16 @@ GeoDataLatLonBox GeoDataLatLonBox::fromLineString(  const GeoDataLineString& lin
     int currentSign = ( lon < 0 ) ? -1 : +1;
     int previousSign = currentSign;
 
-    QVector<GeoDataCoordinates>::ConstIterator it( lineString.constBegin() );
-    QVector<GeoDataCoordinates>::ConstIterator itEnd( lineString.constEnd() );
+    // Index based access keeps packed line strings packed
+    const int size = lineString.size();
+    int index = 0;
 
     bool processingLastNode = false;
 
-    while( it != itEnd ) {
+    while( index < size ) {
         // Get coordinates and normalize them to the desired range.
-        (it)->geoCoordinates( lon, lat );
+        lon = lineString.longitudeAt( index );
+        lat = lineString.latitudeAt( index );
         GeoDataCoordinates::normalizeLonLat( lon, lat );
 
         // Determining the maximum and minimum latitude
@@ -737,10 +739,10 @@ GeoDataLatLonBox GeoDataLatLonBox::fromLineString(  const GeoDataLineString& lin
         if ( processingLastNode ) {
             break;
         }
-        ++it;
+        ++index;
 
-        if( lineString.isClosed() && it == itEnd ) {
-                it = lineString.constBegin();
+        if( lineString.isClosed() && index == size ) {
+                index = 0;
                 processingLastNode = true;
         }
     }
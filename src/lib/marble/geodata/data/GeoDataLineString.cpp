@@ -14,6 +14,10 @@
 #include "MarbleDebug.h"
 
 #include <QDataStream>
+#include <QMutexLocker>
+#include <qmath.h>
+
+#include <limits>
 
 
 namespace Marble
@@ -250,16 +254,97 @@ void GeoDataLineStringPrivate::optimize (GeoDataLineString& lineString) const
     lineString.last().setDetail(startLevel);
 }
 
+void GeoDataLineStringPrivate::updateSignificanceSlow() const
+{
+    QMutexLocker locker( &m_unpackLock );
+    const int size = packedSize();
+    if ( m_significanceSize.loadRelaxed() == size ) {
+        return;
+    }
+
+    QVector<quint8> levels( size, 1 );
+    if ( size < 3 ) {
+        m_significance.swap( levels );
+        m_significanceSize.storeRelease( size );
+        return;
+    }
+
+    // Douglas-Peucker works on a local planar approximation of the nodes
+    QVector<qreal> x( size );
+    QVector<qreal> y( size );
+    for ( int i = 0; i < size; ++i ) {
+        const qreal lat = latitudeAt( i );
+        x[i] = longitudeAt( i ) * qCos( lat );
+        y[i] = lat;
+    }
+
+    // Each node is significant up to its distance from the simplified line it
+    // splits, but never more than the nodes simplified before. The end nodes
+    // are always significant.
+    struct Range {
+        int first;
+        int last;
+        qreal significance;
+    };
+    QVector<Range> ranges;
+    ranges.append( { 0, size - 1, std::numeric_limits<qreal>::max() } );
+
+    while ( !ranges.isEmpty() ) {
+        const Range range = ranges.takeLast();
+        if ( range.last - range.first < 2 ) {
+            continue;
+        }
+
+        const qreal ax = x[range.first];
+        const qreal ay = y[range.first];
+        const qreal dx = x[range.last] - ax;
+        const qreal dy = y[range.last] - ay;
+        const qreal length2 = dx * dx + dy * dy;
+
+        int farthest = range.first + 1;
+        qreal maximumDistance2 = -1.0;
+        for ( int i = range.first + 1; i < range.last; ++i ) {
+            qreal px = x[i] - ax;
+            qreal py = y[i] - ay;
+            if ( length2 > 0.0 ) {
+                const qreal t = qBound( 0.0, ( px * dx + py * dy ) / length2, 1.0 );
+                px -= t * dx;
+                py -= t * dy;
+            }
+            const qreal distance2 = px * px + py * py;
+            if ( distance2 > maximumDistance2 ) {
+                maximumDistance2 = distance2;
+                farthest = i;
+            }
+        }
+
+        const qreal significance = qMin( range.significance, qSqrt( maximumDistance2 ) );
+
+        // The first level whose resolution is finer than the distance, see levelForResolution()
+        quint8 level = 1;
+        while ( level < 17 && significance < resolutionForLevel( level + 1 ) ) {
+            ++level;
+        }
+        levels[farthest] = level;
+
+        ranges.append( { range.first, farthest, significance } );
+        ranges.append( { farthest, range.last, significance } );
+    }
+
+    m_significance.swap( levels );
+    m_significanceSize.storeRelease( size );
+}
+
 bool GeoDataLineString::isEmpty() const
 {
     Q_D(const GeoDataLineString);
-    return d->m_vector.isEmpty();
+    return d->packedSize() == 0;
 }
 
 int GeoDataLineString::size() const
 {
     Q_D(const GeoDataLineString);
-    return d->m_vector.size();
+    return d->packedSize();
 }
 
 GeoDataCoordinates& GeoDataLineString::at( int pos )
@@ -267,14 +352,17 @@ GeoDataCoordinates& GeoDataLineString::at( int pos )
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     return d->m_vector[pos];
 }
 
 const GeoDataCoordinates& GeoDataLineString::at( int pos ) const
 {
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     return d->m_vector.at(pos);
 }
 
@@ -283,8 +371,10 @@ GeoDataCoordinates& GeoDataLineString::operator[]( int pos )
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     return d->m_vector[pos];
 }
 
@@ -292,6 +382,7 @@ GeoDataLineString GeoDataLineString::mid(int pos, int length) const
 {
     GeoDataLineString substring;
     auto d = substring.d_func();
+    d_func()->unpackCoordinates();
     d->m_vector = d_func()->m_vector.mid(pos, length);
     d->m_dirtyBox = true;
     d->m_dirtyRange = true;
@@ -303,6 +394,7 @@ GeoDataLineString GeoDataLineString::mid(int pos, int length) const
 const GeoDataCoordinates& GeoDataLineString::operator[]( int pos ) const
 {
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     return d->m_vector[pos];
 }
 
@@ -311,8 +403,10 @@ GeoDataCoordinates& GeoDataLineString::last()
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     return d->m_vector.last();
 }
 
@@ -321,18 +415,21 @@ GeoDataCoordinates& GeoDataLineString::first()
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     return d->m_vector.first();
 }
 
 const GeoDataCoordinates& GeoDataLineString::last() const
 {
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     return d->m_vector.last();
 }
 
 const GeoDataCoordinates& GeoDataLineString::first() const
 {
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     return d->m_vector.first();
 }
 
@@ -341,12 +438,14 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::begin()
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     return d->m_vector.begin();
 }
 
 QVector<GeoDataCoordinates>::ConstIterator GeoDataLineString::begin() const
 {
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     return d->m_vector.constBegin();
 }
 
@@ -355,24 +454,28 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::end()
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     return d->m_vector.end();
 }
 
 QVector<GeoDataCoordinates>::ConstIterator GeoDataLineString::end() const
 {
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     return d->m_vector.constEnd();
 }
 
 QVector<GeoDataCoordinates>::ConstIterator GeoDataLineString::constBegin() const
 {
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     return d->m_vector.constBegin();
 }
 
 QVector<GeoDataCoordinates>::ConstIterator GeoDataLineString::constEnd() const
 {
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     return d->m_vector.constEnd();
 }
 
@@ -381,10 +484,12 @@ void GeoDataLineString::insert( int index, const GeoDataCoordinates& value )
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     d->m_vector.insert( index, value );
 }
 
@@ -393,16 +498,21 @@ void GeoDataLineString::append ( const GeoDataCoordinates& value )
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     d->m_vector.append( value );
 }
 
 void GeoDataLineString::reserve(int size)
 {
+    detach();
+
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     d->m_vector.reserve(size);
 }
 
@@ -411,10 +521,12 @@ void GeoDataLineString::append(const QVector<GeoDataCoordinates>& values)
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
 
     d->m_vector.append(values);
 }
@@ -424,10 +536,12 @@ GeoDataLineString& GeoDataLineString::operator << ( const GeoDataCoordinates& va
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     d->m_vector.append( value );
     return *this;
 }
@@ -437,10 +551,12 @@ GeoDataLineString& GeoDataLineString::operator << ( const GeoDataLineString& val
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
 
     QVector<GeoDataCoordinates>::const_iterator itCoords = value.constBegin();
     QVector<GeoDataCoordinates>::const_iterator itEnd = value.constEnd();
@@ -463,6 +579,8 @@ bool GeoDataLineString::operator==( const GeoDataLineString &other ) const
 
     Q_D(const GeoDataLineString);
     const GeoDataLineStringPrivate* other_d = other.d_func();
+    d->unpackCoordinates();
+    other_d->unpackCoordinates();
 
     QVector<GeoDataCoordinates>::const_iterator itCoords = d->m_vector.constBegin();
     QVector<GeoDataCoordinates>::const_iterator otherItCoords = other_d->m_vector.constBegin();
@@ -489,10 +607,12 @@ void GeoDataLineString::clear()
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
 
     d->m_vector.clear();
 }
@@ -539,15 +659,181 @@ void GeoDataLineString::setTessellationFlags( TessellationFlags f )
     d->m_tessellationFlags = f;
 }
 
+GeoDataLineString::Storage GeoDataLineString::storage() const
+{
+    Q_D(const GeoDataLineString);
+    return d->m_storage;
+}
+
+void GeoDataLineString::setStorage( Storage storage )
+{
+    Q_D(const GeoDataLineString);
+    if ( storage == d->m_storage ) {
+        return;
+    }
+
+    detach();
+
+    Q_D(GeoDataLineString);
+    d->convertToCoordinates();
+    if ( storage != CoordinatesStorage ) {
+        d->packCoordinates( storage );
+    }
+}
+
+qreal GeoDataLineString::longitudeAt( int pos ) const
+{
+    Q_D(const GeoDataLineString);
+    return d->longitudeAt( pos );
+}
+
+qreal GeoDataLineString::latitudeAt( int pos ) const
+{
+    Q_D(const GeoDataLineString);
+    return d->latitudeAt( pos );
+}
+
+qreal GeoDataLineString::altitudeAt( int pos ) const
+{
+    Q_D(const GeoDataLineString);
+    return d->altitudeAt( pos );
+}
+
+int GeoDataLineString::detailAt( int pos ) const
+{
+    Q_D(const GeoDataLineString);
+    return d->detailAt( pos );
+}
+
+int GeoDataLineString::significanceAt( int pos ) const
+{
+    Q_D(const GeoDataLineString);
+    d->updateSignificance();
+    return d->m_significance[pos];
+}
+
+bool GeoDataLineString::usesSignificance() const
+{
+    Q_D(const GeoDataLineString);
+    return d->packedSize() >= GeoDataLineStringPrivate::minimumSignificanceSize && d->detailAt( 0 ) == 0;
+}
+
+void GeoDataLineString::updateSignificance() const
+{
+    Q_D(const GeoDataLineString);
+    if ( usesSignificance() ) {
+        d->updateSignificance();
+    }
+}
+
+void GeoDataLineString::readCoordinates( int pos, GeoDataCoordinates &coordinates ) const
+{
+    Q_D(const GeoDataLineString);
+    if ( d->m_storage == CoordinatesStorage ) {
+        coordinates = d->m_vector[pos];
+        return;
+    }
+
+    coordinates.set( d->longitudeAt( pos ), d->latitudeAt( pos ), d->altitudeAt( pos ) );
+    coordinates.setDetail( d->detailAt( pos ) );
+}
+
+void GeoDataLineStringPrivate::packCoordinates( GeoDataLineString::Storage storage )
+{
+    Q_ASSERT( m_storage == GeoDataLineString::CoordinatesStorage );
+
+    const int size = m_vector.size();
+    if ( storage == GeoDataLineString::PackedStorage ) {
+        m_longitudes.resize( size );
+        m_latitudes.resize( size );
+    } else {
+        m_fixedLongitudes.resize( size );
+        m_fixedLatitudes.resize( size );
+    }
+
+    bool hasAltitude = false;
+    bool hasDetail = false;
+    for ( int i = 0; i < size; ++i ) {
+        const GeoDataCoordinates &coordinates = m_vector[i];
+        if ( storage == GeoDataLineString::PackedStorage ) {
+            m_longitudes[i] = coordinates.longitude();
+            m_latitudes[i] = coordinates.latitude();
+        } else {
+            m_fixedLongitudes[i] = qRound( coordinates.longitude() / fixedPointToRadian );
+            m_fixedLatitudes[i] = qRound( coordinates.latitude() / fixedPointToRadian );
+        }
+        hasAltitude = hasAltitude || coordinates.altitude() != 0.0;
+        hasDetail = hasDetail || coordinates.detail() != 0;
+    }
+
+    if ( hasAltitude ) {
+        m_altitudes.resize( size );
+        for ( int i = 0; i < size; ++i ) {
+            m_altitudes[i] = m_vector[i].altitude();
+        }
+    }
+    if ( hasDetail ) {
+        m_details.resize( size );
+        for ( int i = 0; i < size; ++i ) {
+            m_details[i] = m_vector[i].detail();
+        }
+    }
+
+    m_vector = QVector<GeoDataCoordinates>();
+    m_storage = storage;
+}
+
+void GeoDataLineStringPrivate::unpackCoordinatesSlow() const
+{
+    QMutexLocker locker( &m_unpackLock );
+    if ( m_unpacked.loadRelaxed() ) {
+        return;
+    }
+
+    const int size = packedSize();
+    QVector<GeoDataCoordinates> vector;
+    vector.reserve( size );
+    for ( int i = 0; i < size; ++i ) {
+        GeoDataCoordinates coordinates( longitudeAt( i ), latitudeAt( i ), altitudeAt( i ) );
+        coordinates.setDetail( detailAt( i ) );
+        vector.append( coordinates );
+    }
+
+    m_vector.swap( vector );
+    m_unpacked.storeRelease( 1 );
+}
+
+void GeoDataLineStringPrivate::convertToCoordinates()
+{
+    // modified nodes need new significance levels
+    m_significanceSize.storeRelaxed( -1 );
+
+    if ( m_storage == GeoDataLineString::CoordinatesStorage ) {
+        return;
+    }
+
+    unpackCoordinates();
+    m_longitudes = QVector<qreal>();
+    m_latitudes = QVector<qreal>();
+    m_fixedLongitudes = QVector<qint32>();
+    m_fixedLatitudes = QVector<qint32>();
+    m_altitudes = QVector<qreal>();
+    m_details = QVector<quint8>();
+    m_unpacked.storeRelaxed( 0 );
+    m_storage = GeoDataLineString::CoordinatesStorage;
+}
+
 void GeoDataLineString::reverse()
 {
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     std::reverse(begin(), end());
 }
 
@@ -564,6 +850,7 @@ GeoDataLineString GeoDataLineString::toNormalized() const
 
     // FIXME: Think about how we can avoid unnecessary copies
     //        if the linestring stays the same.
+    d->unpackCoordinates();
     QVector<GeoDataCoordinates>::const_iterator end = d->m_vector.constEnd();
     for( QVector<GeoDataCoordinates>::const_iterator itCoords
           = d->m_vector.constBegin();
@@ -630,6 +917,7 @@ GeoDataLineString GeoDataLineString::toPoleCorrected() const
 void GeoDataLineStringPrivate::toPoleCorrected( const GeoDataLineString& q, GeoDataLineString& poleCorrected ) const
 {
     poleCorrected.setTessellationFlags( q.tessellationFlags() );
+    unpackCoordinates();
 
     GeoDataCoordinates previousCoords;
     GeoDataCoordinates currentCoords;
@@ -814,6 +1102,7 @@ qreal GeoDataLineString::length( qreal planetRadius, int offset ) const
     }
 
     Q_D(const GeoDataLineString);
+    d->unpackCoordinates();
     qreal length = 0.0;
     QVector<GeoDataCoordinates> const & vector = d->m_vector;
     int const start = qMax(offset+1, 1);
@@ -831,10 +1120,12 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::erase ( const QVector<G
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     return d->m_vector.erase( pos );
 }
 
@@ -844,10 +1135,12 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::erase ( const QVector<G
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     return d->m_vector.erase( begin, end );
 }
 
@@ -856,8 +1149,10 @@ void GeoDataLineString::remove ( int i )
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
     d->m_dirtyRange = true;
     d->m_dirtyBox = true;
+    d->m_significance.clear();
     d->m_vector.remove( i );
 }
 
@@ -881,19 +1176,20 @@ QVariantList GeoDataLineString::toVariantList() const
     Q_D(const GeoDataLineString);
 
     QVariantList variantList;
-    for( const GeoDataCoordinates & itCoords : qAsConst(d->m_vector) ) {
+    const int size = d->packedSize();
+    for( int i = 0; i < size; ++i ) {
         QVariantMap map;
-        map.insert("lon", itCoords.longitude(GeoDataCoordinates::Degree));
-        map.insert("lat", itCoords.latitude(GeoDataCoordinates::Degree));
-        map.insert("alt", itCoords.altitude());
+        map.insert("lon", d->longitudeAt(i) * RAD2DEG);
+        map.insert("lat", d->latitudeAt(i) * RAD2DEG);
+        map.insert("alt", d->altitudeAt(i));
         variantList << map;
     }
 
-    if (isClosed()) {
+    if (isClosed() && size > 0) {
         QVariantMap map;
-        map.insert("lon", d->m_vector.first().longitude(GeoDataCoordinates::Degree));
-        map.insert("lat", d->m_vector.first().latitude(GeoDataCoordinates::Degree));
-        map.insert("alt", d->m_vector.first().altitude());
+        map.insert("lon", d->longitudeAt(0) * RAD2DEG);
+        map.insert("lat", d->latitudeAt(0) * RAD2DEG);
+        map.insert("alt", d->altitudeAt(0));
         variantList << map;
     }
 
@@ -905,6 +1201,7 @@ void GeoDataLineString::pack( QDataStream& stream ) const
     Q_D(const GeoDataLineString);
 
     GeoDataGeometry::pack( stream );
+    d->unpackCoordinates();
 
     stream << size();
     stream << (qint32)(d->m_tessellationFlags);
@@ -925,6 +1222,7 @@ void GeoDataLineString::unpack( QDataStream& stream )
     detach();
 
     Q_D(GeoDataLineString);
+    d->convertToCoordinates();
 
     GeoDataGeometry::unpack( stream );
     qint32 size;
@@ -72,6 +72,15 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
     using ConstIterator = QVector<GeoDataCoordinates>::ConstIterator;
     using const_iterator = QVector<GeoDataCoordinates>::const_iterator;
 
+    /**
+     * @brief How the nodes of a LineString are kept in memory.
+     */
+    enum Storage {
+        CoordinatesStorage, ///< one GeoDataCoordinates object per node (default)
+        PackedStorage,      ///< contiguous longitude and latitude arrays
+        FixedPointStorage   ///< like PackedStorage, but with 32 bit integers of 1e-7 degree precision
+    };
+
 
 /*!
     \brief Creates a new LineString.
@@ -135,6 +144,98 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
 */
     void setTessellationFlags( TessellationFlags f );
 
+/*!
+    \brief Returns how the nodes of the LineString are stored.
+*/
+    Storage storage() const;
+
+
+/*!
+    \brief Changes how the nodes of the LineString are stored.
+
+    The packed storages need a fraction of the memory of GeoDataCoordinates
+    objects and allow projections to read the nodes sequentially. They are
+    meant for large line strings which are not changed anymore. Altitudes and
+    detail levels are only kept if any node uses them.
+
+    Modifying methods, including the non-const methods which return
+    references to nodes or iterators, convert the nodes back to
+    CoordinatesStorage. The const ones keep the storage, but create
+    GeoDataCoordinates objects for all nodes once, in addition to the packed
+    arrays. Use longitudeAt(), latitudeAt(), altitudeAt(), detailAt() and
+    readCoordinates() to access the nodes without either.
+*/
+    void setStorage( Storage storage );
+
+
+/*!
+    \brief Returns the longitude of the node at the given position in radian.
+    This method does not change the storage.
+*/
+    qreal longitudeAt( int pos ) const;
+
+
+/*!
+    \brief Returns the latitude of the node at the given position in radian.
+    This method does not change the storage.
+*/
+    qreal latitudeAt( int pos ) const;
+
+
+/*!
+    \brief Returns the altitude of the node at the given position.
+    This method does not change the storage.
+*/
+    qreal altitudeAt( int pos ) const;
+
+
+/*!
+    \brief Returns the detail level of the node at the given position.
+    This method does not change the storage.
+*/
+    int detailAt( int pos ) const;
+
+
+/*!
+    \brief Returns the detail level from which on the node at the given
+    position is significant for the shape of the LineString.
+
+    The levels are derived from a Douglas-Peucker simplification of the nodes
+    which is computed on first use and kept until the nodes change. The
+    projections filter long line strings without detail levels, like GPS
+    tracks, with them.
+    This method does not change the storage.
+    @see usesSignificance()
+*/
+    int significanceAt( int pos ) const;
+
+
+/*!
+    \brief Returns whether the projections filter the nodes with significanceAt().
+
+    This is the case for LineStrings of many nodes without detail levels.
+*/
+    bool usesSignificance() const;
+
+
+/*!
+    \brief Computes the significance of the nodes unless it is known already.
+
+    File loaders call this for LineStrings which use significance, which
+    keeps the simplification out of the thread that draws them.
+*/
+    void updateSignificance() const;
+
+
+/*!
+    \brief Assigns the node at the given position to \a coordinates.
+
+    For packed line strings the node is decoded into \a coordinates; reusing
+    the same object for subsequent nodes avoids allocations.
+    This method does not change the storage.
+*/
+    void readCoordinates( int pos, GeoDataCoordinates &coordinates ) const;
+
 /*!
     \brief Reverses the LineString.
     @since 0.26.0
@@ -7,9 +7,14 @@
 #define MARBLE_GEODATALINESTRINGPRIVATE_H
 
 #include "GeoDataGeometry_p.h"
+#include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
 
 #include "GeoDataTypes.h"
 
+#include <QAtomicInt>
+#include <QMutex>
+
 namespace Marble
 {
 
@@ -22,14 +27,18 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
            m_dirtyBox( true ),
            m_tessellationFlags( f ),
            m_previousResolution( -1 ),
-           m_level( -1 )
+           m_level( -1 ),
+           m_storage( GeoDataLineString::CoordinatesStorage ),
+           m_significanceSize( -1 )
     {
     }
 
     GeoDataLineStringPrivate()
          : m_rangeCorrected( nullptr ),
            m_dirtyRange( true ),
-           m_dirtyBox( true )
+           m_dirtyBox( true ),
+           m_storage( GeoDataLineString::CoordinatesStorage ),
+           m_significanceSize( -1 )
     {
     }
 
@@ -41,7 +50,20 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
     GeoDataLineStringPrivate& operator=( const GeoDataLineStringPrivate &other)
     {
         GeoDataGeometryPrivate::operator=( other );
-        m_vector = other.m_vector;
+        const bool unpacked = other.m_storage == GeoDataLineString::CoordinatesStorage
+                              || other.m_unpacked.loadAcquire();
+        m_vector = unpacked ? other.m_vector : QVector<GeoDataCoordinates>();
+        m_unpacked.storeRelaxed( unpacked && other.m_storage != GeoDataLineString::CoordinatesStorage );
+        m_storage = other.m_storage;
+        m_longitudes = other.m_longitudes;
+        m_latitudes = other.m_latitudes;
+        m_fixedLongitudes = other.m_fixedLongitudes;
+        m_fixedLatitudes = other.m_fixedLatitudes;
+        m_altitudes = other.m_altitudes;
+        m_details = other.m_details;
+        const int significanceSize = other.m_significanceSize.loadAcquire();
+        m_significance = significanceSize >= 0 ? other.m_significance : QVector<quint8>();
+        m_significanceSize.storeRelaxed( significanceSize );
         m_rangeCorrected = nullptr;
         m_dirtyRange = true;
         m_dirtyBox = other.m_dirtyBox;
@@ -76,7 +98,119 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
     static qreal resolutionForLevel(int level);
     void optimize(GeoDataLineString& lineString) const;
 
-    QVector<GeoDataCoordinates> m_vector;
+    /**
+     * Assigns each node the detail level from which on it is significant,
+     * using the Douglas-Peucker algorithm, unless already done for the
+     * current nodes. Safe to call from concurrent readers.
+     */
+    void updateSignificance() const
+    {
+        if ( m_significanceSize.loadAcquire() != packedSize() ) {
+            updateSignificanceSlow();
+        }
+    }
+
+    void updateSignificanceSlow() const;
+
+    /**
+     * Moves the nodes from m_vector into the arrays of the given storage.
+     * Only for detached instances.
+     */
+    void packCoordinates( GeoDataLineString::Storage storage );
+
+    /**
+     * Builds m_vector from the packed arrays, which stay unchanged, so that
+     * concurrent readers of a shared instance are safe. Needs to be called by
+     * every const method which hands out references or iterators.
+     */
+    void unpackCoordinates() const
+    {
+        if ( m_storage != GeoDataLineString::CoordinatesStorage && !m_unpacked.loadAcquire() ) {
+            unpackCoordinatesSlow();
+        }
+    }
+
+    void unpackCoordinatesSlow() const;
+
+    /**
+     * Converts the nodes back to CoordinatesStorage and releases the packed
+     * arrays. Needs to be called by every modifying method after detaching.
+     */
+    void convertToCoordinates();
+
+    qreal longitudeAt( int pos ) const
+    {
+        switch ( m_storage ) {
+        case GeoDataLineString::PackedStorage:
+            return m_longitudes[pos];
+        case GeoDataLineString::FixedPointStorage:
+            return m_fixedLongitudes[pos] * fixedPointToRadian;
+        default:
+            return m_vector[pos].longitude();
+        }
+    }
+
+    qreal latitudeAt( int pos ) const
+    {
+        switch ( m_storage ) {
+        case GeoDataLineString::PackedStorage:
+            return m_latitudes[pos];
+        case GeoDataLineString::FixedPointStorage:
+            return m_fixedLatitudes[pos] * fixedPointToRadian;
+        default:
+            return m_vector[pos].latitude();
+        }
+    }
+
+    qreal altitudeAt( int pos ) const
+    {
+        if ( m_storage == GeoDataLineString::CoordinatesStorage ) {
+            return m_vector[pos].altitude();
+        }
+        return m_altitudes.isEmpty() ? 0.0 : m_altitudes[pos];
+    }
+
+    int detailAt( int pos ) const
+    {
+        if ( m_storage == GeoDataLineString::CoordinatesStorage ) {
+            return m_vector[pos].detail();
+        }
+        return m_details.isEmpty() ? 0 : m_details[pos];
+    }
+
+    int packedSize() const
+    {
+        switch ( m_storage ) {
+        case GeoDataLineString::PackedStorage:
+            return m_longitudes.size();
+        case GeoDataLineString::FixedPointStorage:
+            return m_fixedLongitudes.size();
+        default:
+            return m_vector.size();
+        }
+    }
+
+    // Shorter line strings are filtered by the distance of their nodes
+    static constexpr int minimumSignificanceSize = 1000;
+
+    // OSM precision: 1e-7 degree, about 1 cm at the equator
+    static constexpr qreal fixedPointToRadian = 1e-7 * M_PI / 180.0;
+
+    // The packed arrays are only changed by non-const methods. Const methods
+    // which need GeoDataCoordinates objects build m_vector once, guarded by
+    // m_unpackLock, and publish it through m_unpacked.
+    mutable QVector<GeoDataCoordinates> m_vector;
+    GeoDataLineString::Storage m_storage;
+    QVector<qreal>  m_longitudes;       // PackedStorage, radian
+    QVector<qreal>  m_latitudes;
+    QVector<qint32> m_fixedLongitudes;  // FixedPointStorage
+    QVector<qint32> m_fixedLatitudes;
+    QVector<qreal>  m_altitudes;        // empty if all nodes are at altitude 0
+    QVector<quint8> m_details;          // empty if no node has a detail level
+    mutable QAtomicInt m_unpacked;
+    mutable QVector<quint8> m_significance;     // see updateSignificance()
+    mutable QAtomicInt m_significanceSize;      // node count m_significance is valid for, or -1
+    mutable QMutex m_unpackLock;                // guards building m_vector and m_significance
 
     mutable GeoDataLineString*  m_rangeCorrected;
     mutable bool                m_dirtyRange;
@@ -54,6 +54,7 @@ AbstractGeoPolygonGraphicsItem::AbstractGeoPolygonGraphicsItem(const GeoDataPlac
 
 AbstractGeoPolygonGraphicsItem::~AbstractGeoPolygonGraphicsItem()
 {
+    qDeleteAll(m_innerPolygons);
 }
 
 const GeoDataLatLonAltBox& AbstractGeoPolygonGraphicsItem::latLonAltBox() const
@@ -70,7 +71,6 @@ const GeoDataLatLonAltBox& AbstractGeoPolygonGraphicsItem::latLonAltBox() const
 void AbstractGeoPolygonGraphicsItem::paint( GeoPainter* painter, const ViewportParams* viewport, const QString &layer, int tileZoomLevel)
 {
     Q_UNUSED(layer);
-    Q_UNUSED(tileZoomLevel);
 
     bool isValid = true;
     if (s_previousStyle != style().data()) {
@@ -90,14 +90,34 @@ void AbstractGeoPolygonGraphicsItem::paint( GeoPainter* painter, const ViewportP
             }
         }
 
+        // The screen polygons are kept across repaints, panning the map
+        // just moves them in the cylindrical projections
+        const QVector<QPolygonF*> &outerPolygons = m_outerPolygons.update(m_polygon->outerBoundary(), viewport, tileZoomLevel);
+        if (outerPolygons.isEmpty()) {
+            return;
+        }
+
         if (innerResolved) {
-            painter->drawPolygon(*m_polygon);
+            const QVector<GeoDataLinearRing> &innerBoundaries = m_polygon->innerBoundaries();
+            while (m_innerPolygons.size() < innerBoundaries.size()) {
+                m_innerPolygons << new ScreenPolygonCache;
+            }
+
+            QVector<QPolygonF*> innerPolygons;
+            for (int i = 0; i < innerBoundaries.size(); ++i) {
+                innerPolygons << m_innerPolygons[i]->update(innerBoundaries[i], viewport, tileZoomLevel);
+            }
+            painter->drawPolygonWithHoles(outerPolygons, innerPolygons);
         }
         else {
-            painter->drawPolygon(m_polygon->outerBoundary());
+            for (const QPolygonF *outerPolygon: outerPolygons) {
+                painter->drawPolygon(*outerPolygon, Qt::OddEvenFill);
+            }
         }
     } else if ( m_ring ) {
-        painter->drawPolygon( *m_ring );
+        for (const QPolygonF *polygon: m_outerPolygons.update(*m_ring, viewport, tileZoomLevel)) {
+            painter->drawPolygon(*polygon, Qt::OddEvenFill);
+        }
     }
 }
 
@@ -222,6 +242,7 @@ void AbstractGeoPolygonGraphicsItem::setLinearRing(GeoDataLinearRing *ring)
     Q_ASSERT(m_building);
     Q_ASSERT(!m_polygon);
     m_ring = ring;
+    clearScreenPolygons();
 }
 
 void AbstractGeoPolygonGraphicsItem::setPolygon(GeoDataPolygon *polygon)
@@ -229,6 +250,19 @@ void AbstractGeoPolygonGraphicsItem::setPolygon(GeoDataPolygon *polygon)
     Q_ASSERT(m_building);
     Q_ASSERT(!m_ring);
     m_polygon = polygon;
+    clearScreenPolygons();
+}
+
+void AbstractGeoPolygonGraphicsItem::releaseScreenCache()
+{
+    clearScreenPolygons();
+}
+
+void AbstractGeoPolygonGraphicsItem::clearScreenPolygons()
+{
+    m_outerPolygons.clear();
+    qDeleteAll(m_innerPolygons);
+    m_innerPolygons.clear();
 }
 
 }
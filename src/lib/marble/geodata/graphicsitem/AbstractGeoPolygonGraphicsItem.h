@@ -7,6 +7,7 @@
 #define MARBLE_ABSTRACTGEOPOLYGONGRAPHICSITEM_H
 
 #include "GeoGraphicsItem.h"
+#include "ScreenPolygonCache.h"
 #include "marble_export.h"
 
 #include <QImage>
@@ -32,6 +33,7 @@ public:
     const GeoDataLatLonAltBox& latLonAltBox() const override;
     void paint(GeoPainter* painter, const ViewportParams *viewport, const QString &layer, int tileZoomLevel) override;
     bool contains(const QPoint &screenPosition, const ViewportParams *viewport) const override;
+    void releaseScreenCache() override;
 
     void setLinearRing(GeoDataLinearRing* ring);
     void setPolygon(GeoDataPolygon* polygon);
@@ -51,10 +53,13 @@ protected:
 
 private:
     QPixmap texture(const QString &path, const QColor &color) const;
+    void clearScreenPolygons();
 
     const GeoDataPolygon * m_polygon;
     const GeoDataLinearRing * m_ring;
     const GeoDataBuilding *const m_building;
+    ScreenPolygonCache m_outerPolygons;
+    QVector<ScreenPolygonCache*> m_innerPolygons;
 };
 
 }
@@ -48,7 +48,6 @@ GeoLineStringGraphicsItem::GeoLineStringGraphicsItem(const GeoDataPlacemark *pla
 
 GeoLineStringGraphicsItem::~GeoLineStringGraphicsItem()
 {
-    qDeleteAll(m_cachedPolygons);
 }
 
 
@@ -119,6 +118,7 @@ void GeoLineStringGraphicsItem::setMergedLineString(const GeoDataLineString &mer
 {
     m_mergedLineString = mergedLineString;
     m_renderLineString = mergedLineString.isEmpty() ? m_lineString : &m_mergedLineString;
+    m_cachedPolygons.clear();
 }
 
 const GeoDataLatLonAltBox& GeoLineStringGraphicsItem::latLonAltBox() const
@@ -131,36 +131,30 @@ void GeoLineStringGraphicsItem::paint(GeoPainter* painter, const ViewportParams*
     setRenderContext(RenderContext(tileLevel));
 
     if (layer.endsWith(QLatin1String("/outline"))) {
-        qDeleteAll(m_cachedPolygons);
-        m_cachedPolygons.clear();
         m_cachedRegion = QRegion();
-        painter->polygonsFromLineString(*m_renderLineString, m_cachedPolygons);
-        if (m_cachedPolygons.empty()) {
+        if (m_cachedPolygons.update(*m_renderLineString, viewport, tileLevel).isEmpty()) {
             return;
         }
         if (painter->mapQuality() == HighQuality || painter->mapQuality() == PrintQuality) {
             paintOutline(painter, viewport);
         }
     } else if (layer.endsWith(QLatin1String("/inline"))) {
-        if (m_cachedPolygons.empty()) {
+        if (m_cachedPolygons.polygons().isEmpty()) {
             return;
         }
         paintInline(painter, viewport);
     } else if (layer.endsWith(QLatin1String("/label"))) {
-        if (!m_cachedPolygons.empty()) {
+        if (!m_cachedPolygons.polygons().isEmpty()) {
             if (m_renderLabel) {
                 paintLabel(painter, viewport);
             }
         }
     } else {
-        qDeleteAll(m_cachedPolygons);
-        m_cachedPolygons.clear();
         m_cachedRegion = QRegion();
-        painter->polygonsFromLineString(*m_renderLineString, m_cachedPolygons);
-        if (m_cachedPolygons.empty()) {
+        if (m_cachedPolygons.update(*m_renderLineString, viewport, tileLevel).isEmpty()) {
             return;
         }
-        for(const QPolygonF* itPolygon: m_cachedPolygons) {
+        for(const QPolygonF* itPolygon: m_cachedPolygons.polygons()) {
             painter->drawPolyline(*itPolygon);
         }
     }
@@ -174,7 +168,7 @@ bool GeoLineStringGraphicsItem::contains(const QPoint &screenPosition, const Vie
 
     if (m_cachedRegion.isNull()) {
         QPainterPath painterPath;
-        for (auto polygon: m_cachedPolygons) {
+        for (auto polygon: m_cachedPolygons.polygons()) {
             painterPath.addPolygon(*polygon);
         }
         QPainterPathStroker stroker;
@@ -186,6 +180,12 @@ bool GeoLineStringGraphicsItem::contains(const QPoint &screenPosition, const Vie
     return m_cachedRegion.contains(screenPosition);
 }
 
+void GeoLineStringGraphicsItem::releaseScreenCache()
+{
+    m_cachedPolygons.clear();
+    m_cachedRegion = QRegion();
+}
+
 void GeoLineStringGraphicsItem::handleRelationUpdate(const QVector<const GeoDataRelation *> &relations)
 {
     QHash<GeoDataRelation::RelationType, QStringList> names;
@@ -253,7 +253,7 @@ void GeoLineStringGraphicsItem::paintInline(GeoPainter* painter, const ViewportP
     if (s_paintInline) {
       m_renderLabel = painter->pen().widthF() >= 6.0f;
       m_penWidth = painter->pen().widthF();
-      for(const QPolygonF* itPolygon: m_cachedPolygons) {
+      for(const QPolygonF* itPolygon: m_cachedPolygons.polygons()) {
           painter->drawPolyline(*itPolygon);
       }
     }
@@ -271,7 +271,7 @@ void GeoLineStringGraphicsItem::paintOutline(GeoPainter *painter, const Viewport
     s_previousStyle = style().data();
 
     if (s_paintOutline) {
-        for(const QPolygonF* itPolygon: m_cachedPolygons) {
+        for(const QPolygonF* itPolygon: m_cachedPolygons.polygons()) {
             painter->drawPolyline(*itPolygon);
         }
     }
@@ -298,7 +298,7 @@ void GeoLineStringGraphicsItem::paintLabel(GeoPainter *painter, const ViewportPa
         //painter->setBackgroundMode(Qt::OpaqueMode);
 
         const GeoDataLabelStyle& labelStyle = style->labelStyle();
-        painter->drawLabelsForPolygons(m_cachedPolygons, m_name, FollowLine,
+        painter->drawLabelsForPolygons(m_cachedPolygons.polygons(), m_name, FollowLine,
                                labelStyle.paintedColor());
     }
 }
@@ -10,6 +10,7 @@
 #include "GeoDataCoordinates.h"
 #include "GeoDataLineString.h"
 #include "MarbleGlobal.h"
+#include "ScreenPolygonCache.h"
 #include "marble_export.h"
 
 #include <QRegion>
@@ -36,6 +37,7 @@ public:
 
     void paint(GeoPainter* painter, const ViewportParams *viewport, const QString &layer, int tileZoomLevel) override;
     bool contains(const QPoint &screenPosition, const ViewportParams *viewport) const override;
+    void releaseScreenCache() override;
 
     static const GeoDataStyle *s_previousStyle;
     static bool s_paintInline;
@@ -57,7 +59,7 @@ private:
     const GeoDataLineString *m_lineString;
     const GeoDataLineString *m_renderLineString;
     GeoDataLineString m_mergedLineString;
-    QVector<QPolygonF*> m_cachedPolygons;
+    ScreenPolygonCache m_cachedPolygons;
     bool m_renderLabel;
     qreal m_penWidth;
     mutable QRegion m_cachedRegion;
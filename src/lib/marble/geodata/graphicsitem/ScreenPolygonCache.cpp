@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "ScreenPolygonCache.h"
+
+#include "GeoDataLineString.h"
+#include "ViewportParams.h"
+
+#include <QPolygonF>
+#include <qmath.h>
+
+namespace Marble
+{
+
+ScreenPolygonCache::ScreenPolygonCache() :
+    m_visible(false),
+    m_translatable(false),
+    m_translated(false),
+    m_projection(Spherical),
+    m_radius(0),
+    m_tileLevel(-1),
+    m_lineString(nullptr),
+    m_size(0)
+{
+}
+
+ScreenPolygonCache::~ScreenPolygonCache()
+{
+    qDeleteAll(m_polygons);
+}
+
+const QVector<QPolygonF*> &ScreenPolygonCache::update(const GeoDataLineString &lineString, const ViewportParams *viewport, int tileLevel)
+{
+    m_translated = false;
+
+    // Same visibility rules as GeoPainter::polygonsFromLineString(). The
+    // polygons of a line string that left the viewport are not kept, as most
+    // never come back before the projection epoch changes.
+    const GeoDataLatLonAltBox &box = lineString.latLonAltBox();
+    if (!viewport->viewLatLonAltBox().intersects(box) || !viewport->resolves(box)) {
+        clear();
+        return polygons();
+    }
+    m_visible = true;
+
+    qreal originX = 0.0;
+    qreal originY = 0.0;
+    viewport->screenCoordinates(0.0, 0.0, originX, originY);
+
+    if (isCurrent(lineString, viewport, tileLevel)) {
+        const qreal dx = originX - m_origin.x();
+        const qreal dy = originY - m_origin.y();
+        if (dx != 0.0 || dy != 0.0) {
+            for (QPolygonF *polygon: m_polygons) {
+                polygon->translate(dx, dy);
+            }
+        }
+        m_translated = true;
+    } else {
+        qDeleteAll(m_polygons);
+        m_polygons.clear();
+        viewport->screenCoordinates(lineString, m_polygons);
+
+        m_translatable = isTranslatable(viewport);
+        m_projection = viewport->projection();
+        m_radius = viewport->radius();
+        m_tileLevel = tileLevel;
+        m_lineString = &lineString;
+        m_size = lineString.size();
+        m_latLonAltBox = box;
+    }
+    m_origin = QPointF(originX, originY);
+
+    return m_polygons;
+}
+
+const QVector<QPolygonF*> &ScreenPolygonCache::polygons() const
+{
+    static const QVector<QPolygonF*> noPolygons;
+    return m_visible ? m_polygons : noPolygons;
+}
+
+bool ScreenPolygonCache::isTranslated() const
+{
+    return m_translated;
+}
+
+void ScreenPolygonCache::clear()
+{
+    qDeleteAll(m_polygons);
+    m_polygons.clear();
+    m_visible = false;
+    m_translatable = false;
+    m_translated = false;
+    m_lineString = nullptr;
+}
+
+bool ScreenPolygonCache::isTranslatable(const ViewportParams *viewport)
+{
+    if (viewport->projection() != Equirectangular && viewport->projection() != Mercator) {
+        return false;
+    }
+
+    // The cylindrical projections repeat the polygons horizontally once the
+    // map is narrower than the viewport, which is no translation.
+    qreal xWest = 0.0;
+    qreal xEast = 0.0;
+    qreal y = 0.0;
+    viewport->screenCoordinates(-M_PI, 0.0, xWest, y);
+    viewport->screenCoordinates(+M_PI, 0.0, xEast, y);
+    return xWest <= 0 && xEast >= viewport->width() - 1;
+}
+
+bool ScreenPolygonCache::isCurrent(const GeoDataLineString &lineString, const ViewportParams *viewport, int tileLevel) const
+{
+    return m_translatable
+        && !m_polygons.isEmpty()
+        && m_projection == viewport->projection()
+        && m_radius == viewport->radius()
+        && m_tileLevel == tileLevel
+        && m_lineString == &lineString
+        && m_size == lineString.size()
+        && m_latLonAltBox == lineString.latLonAltBox()
+        && isTranslatable(viewport);
+}
+
+}
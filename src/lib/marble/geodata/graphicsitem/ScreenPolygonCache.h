@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_SCREENPOLYGONCACHE_H
+#define MARBLE_SCREENPOLYGONCACHE_H
+
+#include "GeoDataLatLonAltBox.h"
+#include "MarbleGlobal.h"
+#include "marble_export.h"
+
+#include <QPointF>
+#include <QVector>
+
+class QPolygonF;
+
+namespace Marble
+{
+
+class GeoDataLineString;
+class ViewportParams;
+
+/**
+ * @brief Keeps the screen polygons of a line string across repaints.
+ *
+ * The screen polygons of a line string only change by a translation while the
+ * map is panned in a cylindrical projection. The cache remembers the projection
+ * epoch (projection, radius and tile level) the polygons were created for and,
+ * as long as it does not change, moves the polygons by the offset of the map
+ * origin on the screen instead of projecting and tessellating the line string
+ * again.
+ *
+ * Azimuthal projections rotate the globe when the map is panned, so their
+ * polygons get recreated on each update.
+ */
+class MARBLE_EXPORT ScreenPolygonCache
+{
+public:
+    ScreenPolygonCache();
+    ~ScreenPolygonCache();
+
+    /**
+     * @brief Updates the screen polygons of @p lineString for @p viewport.
+     *
+     * Like GeoPainter::polygonsFromLineString() no polygons are returned if the
+     * line string is not visible in the viewport or too small to be resolved,
+     * and the cached ones are released. The returned polygons are owned by the cache.
+     */
+    const QVector<QPolygonF*> &update(const GeoDataLineString &lineString, const ViewportParams *viewport, int tileLevel);
+
+    /**
+     * @brief The polygons of the last update(), empty if the line string was not visible.
+     */
+    const QVector<QPolygonF*> &polygons() const;
+
+    /**
+     * @brief Returns whether the last update() moved the polygons instead of recreating them.
+     */
+    bool isTranslated() const;
+
+    void clear();
+
+private:
+    Q_DISABLE_COPY(ScreenPolygonCache)
+
+    static bool isTranslatable(const ViewportParams *viewport);
+    bool isCurrent(const GeoDataLineString &lineString, const ViewportParams *viewport, int tileLevel) const;
+
+    QVector<QPolygonF*> m_polygons;
+    bool m_visible;
+    bool m_translatable;
+    bool m_translated;
+
+    // the projection epoch of m_polygons
+    Projection m_projection;
+    int m_radius;
+    int m_tileLevel;
+    const GeoDataLineString *m_lineString;
+    int m_size;
+    GeoDataLatLonAltBox m_latLonAltBox;
+    QPointF m_origin;
+};
+
+}
+
+#endif
@@ -52,6 +52,7 @@ const char dgmlAttr_radius[]           = "radius";
 const char dgmlAttr_role[]             = "role";
 const char dgmlAttr_short[]            = "short";
 const char dgmlAttr_spacing[]          = "spacing";
+const char dgmlAttr_storage[]          = "storage";
 const char dgmlAttr_style[]            = "style";
 const char dgmlAttr_text[]             = "text";
 const char dgmlAttr_tileLevels[]       = "tileLevels";
@@ -54,6 +54,7 @@ namespace dgml
     extern const char dgmlAttr_role[];
     extern const char dgmlAttr_short[];
     extern const char dgmlAttr_spacing[];
+    extern const char dgmlAttr_storage[];
     extern const char dgmlAttr_style[];
     extern const char dgmlAttr_text[];
     extern const char dgmlAttr_tileLevels[];
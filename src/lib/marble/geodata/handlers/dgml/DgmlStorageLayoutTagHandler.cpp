@@ -93,6 +93,14 @@ GeoNode* DgmlStorageLayoutTagHandler::parse(GeoParser& parser) const
         texture->setTileLevels( tileLevels );
         texture->setStorageLayout( storageLayout );
         texture->setServerLayout( serverLayout );
+
+        // Attribute storage, MBTiles databases are supported for textures only
+        const QString storageStr = parser.attribute( dgmlAttr_storage ).trimmed();
+        if ( storageStr == QLatin1String("MBTiles") && parentItem.represents( dgmlTag_Texture ) ) {
+            texture->setStorageFormat( GeoSceneTileDataset::MBTiles );
+        } else if ( !storageStr.isEmpty() && storageStr != QLatin1String("Directory") ) {
+            mDebug() << "Unsupported tile storage " << storageStr << ", falling back to a directory.";
+        }
     }
 
     return nullptr;
@@ -155,10 +155,11 @@ void GeoParser::parseDocument()
         while ( !atEnd() ) {
             readNext();
             if ( isEndElement() ) {
-                m_nodeStack.pop();
+                const GeoStackItem parsedItem = m_nodeStack.pop();
 #if DUMP_PARENT_STACK > 0
                 dumpParentStack( name().toString(), m_nodeStack.size(), true );
 #endif
+                elementParsed( parsedItem );
                 break;
             }
 
@@ -179,6 +180,11 @@ void GeoParser::parseDocument()
 #endif
 }
 
+void GeoParser::elementParsed( const GeoStackItem& item )
+{
+    Q_UNUSED( item );
+}
+
 void GeoParser::raiseWarning( const QString& warning )
 {
     // TODO: Maybe introduce a strict parsing mode where we feed the warning to
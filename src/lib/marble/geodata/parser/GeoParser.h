@@ -69,6 +69,14 @@ protected:
 
     virtual GeoDocument* createDocument() const = 0;
 
+    /**
+     * Called when the element of @p item is closed after its children have
+     * been parsed. Elements that a tag handler reads completely by itself are
+     * not reported. Streaming parsers reimplement it to hand out completed
+     * nodes before the whole document has been read. Does nothing by default.
+     */
+    virtual void elementParsed( const GeoStackItem& item );
+
 protected:
     GeoDocument* m_document;
     GeoDataGenericSourceType m_source;
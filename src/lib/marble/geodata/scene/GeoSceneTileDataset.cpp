@@ -28,6 +28,7 @@ GeoSceneTileDataset::GeoSceneTileDataset( const QString& name )
       m_sourceDir(),
       m_installMap(),
       m_storageLayoutMode(Marble),
+      m_storageFormat(Directory),
       m_serverLayout( new MarbleServerLayout( this ) ),
       m_levelZeroColumns( defaultLevelZeroColumns ),
       m_levelZeroRows( defaultLevelZeroRows ),
@@ -84,6 +85,21 @@ void GeoSceneTileDataset::setStorageLayout( const StorageLayout layout )
     m_storageLayoutMode = layout;
 }
 
+GeoSceneTileDataset::StorageFormat GeoSceneTileDataset::storageFormat() const
+{
+    return m_storageFormat;
+}
+
+void GeoSceneTileDataset::setStorageFormat( const StorageFormat format )
+{
+    m_storageFormat = format;
+}
+
+QString GeoSceneTileDataset::mbTilesFileName() const
+{
+    return themeStr() + QLatin1String(".mbtiles");
+}
+
 void GeoSceneTileDataset::setServerLayout( const ServerLayout *layout )
 {
     delete m_serverLayout;
@@ -281,6 +297,15 @@ QString GeoSceneTileDataset::relativeTileFileName( const TileId &id ) const
 
     QString relFileName;
 
+    if ( m_storageFormat == MBTiles ) {
+        // virtual file name inside the database, see MbTilesStorage
+        return QString( "%1/%2/%3/%4" )
+            .arg( mbTilesFileName() )
+            .arg( id.zoomLevel() )
+            .arg( id.x() )
+            .arg( id.y() );
+    }
+
     switch ( m_storageLayoutMode ) {
     case GeoSceneTileDataset::Marble:
         relFileName = QString( "%1/%2/%3/%3_%4.%5" )
@@ -40,6 +40,7 @@ class GEODATA_EXPORT GeoSceneTileDataset : public GeoSceneAbstractDataset
 {
  public:
     enum StorageLayout { Marble, OpenStreetMap, TileMapService };
+    enum StorageFormat { Directory, MBTiles };
 
     explicit GeoSceneTileDataset( const QString& name );
     ~GeoSceneTileDataset() override;
@@ -54,6 +55,20 @@ class GEODATA_EXPORT GeoSceneTileDataset : public GeoSceneAbstractDataset
     StorageLayout storageLayout() const;
     void setStorageLayout( const StorageLayout );
 
+    /**
+     * @brief Whether tiles are stored as one file per tile or in a single MBTiles database.
+     *
+     * The tiles of MBTiles datasets are addressed by virtual file names inside
+     * the database, see mbTilesFileName() and relativeTileFileName().
+     */
+    StorageFormat storageFormat() const;
+    void setStorageFormat( const StorageFormat );
+
+    /**
+     * @brief The MBTiles database of this dataset, relative like themeStr().
+     */
+    QString mbTilesFileName() const;
+
     void setServerLayout( const ServerLayout * );
     const ServerLayout *serverLayout() const;
 
@@ -116,6 +131,7 @@ class GEODATA_EXPORT GeoSceneTileDataset : public GeoSceneAbstractDataset
     QString m_sourceDir;
     QString m_installMap;
     StorageLayout m_storageLayoutMode;
+    StorageFormat m_storageFormat;
     const ServerLayout *m_serverLayout;
     int m_levelZeroColumns;
     int m_levelZeroRows;
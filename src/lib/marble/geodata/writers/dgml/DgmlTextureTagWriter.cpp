@@ -44,6 +44,9 @@ bool DgmlTextureTagWriter::write(const GeoNode *node, GeoWriter& writer) const
         writer.writeAttribute( "levelZeroRows", QString::number( texture->levelZeroRows() ) );
         writer.writeAttribute( "mode", texture->serverLayout()->name() );
     }
+    if ( texture->storageFormat() == GeoSceneTileDataset::MBTiles ) {
+        writer.writeAttribute( "storage", "MBTiles" );
+    }
     writer.writeEndElement();
     
     if ( texture->downloadUrls().size() > 0 )
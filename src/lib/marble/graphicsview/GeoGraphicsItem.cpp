@@ -170,6 +170,11 @@ void GeoGraphicsItem::handleRelationUpdate(const QVector<const GeoDataRelation *
     // does nothing
 }
 
+void GeoGraphicsItem::releaseScreenCache()
+{
+    // does nothing
+}
+
 int GeoGraphicsItem::minZoomLevel() const
 {
     return d->m_minZoomLevel;
@@ -156,6 +156,13 @@ class MARBLE_EXPORT GeoGraphicsItem
      */
     virtual bool contains(const QPoint &screenPosition, const ViewportParams *viewport) const;
 
+    /**
+     * @brief Frees what the item keeps from painting to be painted faster next time
+     *
+     * Called for items that left the view.
+     */
+    virtual void releaseScreenCache();
+
     void setRelations(const QSet<const GeoDataRelation *> &relations);
 
  protected:
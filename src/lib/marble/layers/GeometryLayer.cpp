@@ -51,6 +51,7 @@
 #include <qmath.h>
 #include <QAbstractItemModel>
 #include <QModelIndex>
+#include <QtConcurrentMap>
 
 namespace Marble
 {
@@ -78,9 +79,17 @@ public:
     void createGraphicsItemFromGeometry(const GeoDataGeometry *object, const GeoDataPlacemark *placemark, const Relations &relations);
     void createGraphicsItemFromOverlay(const GeoDataOverlay *overlay);
     void removeGraphicsItems(const GeoDataFeature *feature);
+    void removeSceneItems(const GeoDataFeature *feature);
+    void collectGraphicsItems(const GeoDataFeature *feature, QSet<GeoGraphicsItem*> &items) const;
+    void removeCachedItems(const QSet<GeoGraphicsItem*> &items);
     void updateTiledLineStrings(const GeoDataPlacemark *placemark, GeoLineStringGraphicsItem* lineStringItem);
     static void updateTiledLineStrings(OsmLineStringItems &lineStringItems);
     void clearCache();
+    void updatePaintFragments(const GeoDataLatLonBox &box, int zoomLevel);
+    void sortUnsortedItems();
+    void removePaintFragments(const QSet<GeoGraphicsItem*> &items);
+    void insertPaintFragments(const GeoGraphicItems &items);
+    void updateCachedPaintFragments();
     bool showRelation(const GeoDataRelation* relation) const;
     void updateRelationVisibility();
 
@@ -89,6 +98,7 @@ public:
     GeoGraphicsScene m_scene;
     QString m_runtimeTrace;
     QList<ScreenOverlayGraphicsItem*> m_screenOverlays;
+    GeoGraphicItems m_pendingItems; // created, but not yet added to the scene
 
     QHash<qint64, OsmLineStringItems> m_osmLineStringItems;
     int m_tileLevel;
@@ -96,10 +106,19 @@ public:
 
     bool m_dirty;
     int m_cachedItemCount;
+    int m_cachedZoomLevel;
+    QSet<GeoGraphicsItem*> m_cachedItems;
+    // Sorted per layer, updated as items enter and leave the viewport
+    QHash<QString, PaintFragments> m_paintFragments;
+    // Items sorted by the style they had before being painted the first time
+    GeoGraphicItems m_unsortedItems;
+    // Styles of sorted items changed, they are resolved again by the next paint
+    bool m_stylesChanged;
+    // The paint fragments need a full sort rather than a merge
+    bool m_resortPaintFragments;
     QHash<QString, GeoGraphicItems> m_cachedPaintFragments;
     typedef QPair<QString, GeoGraphicsItem*> LayerItem;
     QList<LayerItem> m_cachedDefaultLayer;
-    QDateTime m_cachedDateTime;
     GeoDataLatLonBox m_cachedLatLonBox;
     QSet<qint64> m_highlightedRouteRelations;
     GeoDataRelation::RelationTypes m_visibleRelationTypes;
@@ -114,6 +133,9 @@ GeometryLayerPrivate::GeometryLayerPrivate(const QAbstractItemModel *model, cons
     m_lastFeatureAt(nullptr),
     m_dirty(true),
     m_cachedItemCount(0),
+    m_cachedZoomLevel(-1),
+    m_stylesChanged(false),
+    m_resortPaintFragments(false),
     m_visibleRelationTypes(GeoDataRelation::RouteFerry),
     m_levelTagDebugModeEnabled(false),
     m_debugLevelTag(0)
@@ -124,6 +146,8 @@ void GeometryLayerPrivate::createGraphicsItems(const GeoDataObject *object)
 {
     FeatureRelationHash noRelations;
     createGraphicsItems(object, noRelations);
+    m_scene.addItems(m_pendingItems);
+    m_pendingItems.clear();
 }
 
 GeometryLayer::GeometryLayer(const QAbstractItemModel *model, const StyleBuilder *styleBuilder) :
@@ -170,75 +194,17 @@ bool GeometryLayer::render(GeoPainter *painter, ViewportParams *viewport,
     auto const & box = viewport->viewLatLonAltBox();
     bool isEqual = GeoDataLatLonBox::fuzzyCompare(d->m_cachedLatLonBox, box, 0.05);
 
-    if (d->m_cachedLatLonBox.isEmpty() || !isEqual) {
+    // Even small pans need an update, the items of the exposed strip are missing
+    if (d->m_cachedLatLonBox.isEmpty() || !isEqual || !d->m_cachedLatLonBox.contains(box)) {
         d->m_dirty = true;
     }
 
-    // update the items cache at least every second since the last request
-    auto const now = QDateTime::currentDateTime();
-    if (!d->m_cachedDateTime.isValid() || d->m_cachedDateTime.msecsTo(now) > 1000) {
-        d->m_dirty = true;
-    }
-
-    if (d->m_dirty) {
+    const int maxZoomLevel = qMin(d->m_tileLevel, d->m_styleBuilder->maximumZoomLevel());
+    if (d->m_dirty || maxZoomLevel != d->m_cachedZoomLevel) {
         d->m_dirty = false;
-
-        const int maxZoomLevel = qMin(d->m_tileLevel, d->m_styleBuilder->maximumZoomLevel());
-        auto const items = d->m_scene.items(box, maxZoomLevel);
-        d->m_cachedLatLonBox = box;
-        d->m_cachedDateTime = now;
-
-        d->m_cachedItemCount = items.size();
-        d->m_cachedDefaultLayer.clear();
-        d->m_cachedPaintFragments.clear();
-        QHash<QString, GeometryLayerPrivate::PaintFragments> paintFragments;
-        const QStringList &renderOrder = d->m_styleBuilder->renderOrder();
-        QSet<QString> const knownLayers(renderOrder.constBegin(), renderOrder.constEnd());
-        for (GeoGraphicsItem* item: items) {
-            QStringList paintLayers = item->paintLayers();
-            if (paintLayers.isEmpty()) {
-                mDebug() << item << " provides no paint layers, so I force one onto it.";
-                paintLayers << QString();
-            }
-            for (const auto &layer: paintLayers) {
-                if (knownLayers.contains(layer)) {
-                    GeometryLayerPrivate::PaintFragments &fragments = paintFragments[layer];
-                    double const zValue = item->zValue();
-                    // assign subway stations
-                    if (zValue == 0.0) {
-                        fragments.null << item;
-                        // assign areas and streets
-                    } else if (zValue < 0.0) {
-                        fragments.negative << item;
-                        // assign buildings
-                    } else {
-                        fragments.positive << item;
-                    }
-                } else {
-                    // assign symbols
-                    d->m_cachedDefaultLayer << GeometryLayerPrivate::LayerItem(layer, item);
-                    static QSet<QString> missingLayers;
-                    if (!missingLayers.contains(layer)) {
-                        mDebug() << "Missing layer " << layer << ", in render order, will render it on top";
-                        missingLayers << layer;
-                    }
-                }
-            }
-        }
-        // Sort each fragment by z-level
-        for (const QString &layer: d->m_styleBuilder->renderOrder()) {
-            GeometryLayerPrivate::PaintFragments & layerItems = paintFragments[layer];
-            std::sort(layerItems.negative.begin(), layerItems.negative.end(), GeoGraphicsItem::zValueLessThan);
-            // The idea here is that layerItems.null has most items and does not need to be sorted by z-value
-            // since they are all equal (=0). We do sort them by style pointer though for batch rendering
-            std::sort(layerItems.null.begin(), layerItems.null.end(), GeoGraphicsItem::styleLessThan);
-            std::sort(layerItems.positive.begin(), layerItems.positive.end(), GeoGraphicsItem::zValueAndStyleLessThan);
-            auto const count = layerItems.negative.size() + layerItems.null.size() + layerItems.positive.size();
-            d->m_cachedPaintFragments[layer].reserve(count);
-            d->m_cachedPaintFragments[layer] << layerItems.negative;
-            d->m_cachedPaintFragments[layer] << layerItems.null;
-            d->m_cachedPaintFragments[layer] << layerItems.positive;
-        }
+        d->updatePaintFragments(box, maxZoomLevel);
+    } else if (!d->m_unsortedItems.isEmpty() || d->m_resortPaintFragments) {
+        d->sortUnsortedItems();
     }
 
     for (const QString &layer: d->m_styleBuilder->renderOrder()) {
@@ -271,6 +237,12 @@ bool GeometryLayer::render(GeoPainter *painter, ViewportParams *viewport,
         item->paintEvent(painter, viewport);
     }
 
+    if (d->m_stylesChanged) {
+        // the items painted above resolved their new styles
+        d->m_stylesChanged = false;
+        d->m_resortPaintFragments = true;
+    }
+
     painter->restore();
     d->m_runtimeTrace = QStringLiteral("Geometries: %1 Zoom: %2")
                         .arg(d->m_cachedItemCount)
@@ -310,7 +282,8 @@ bool GeometryLayer::hasFeatureAt(const QPoint &curpos, const ViewportParams *vie
 
 void GeometryLayerPrivate::createGraphicsItems(const GeoDataObject *object, FeatureRelationHash &relations)
 {
-    clearCache();
+    // the next update adds the new items to the paint fragments as entering items
+    m_dirty = true;
     if (auto document = geodata_cast<GeoDataDocument>(object)) {
         for (auto feature: document->featureList()) {
             if (auto relation = geodata_cast<GeoDataRelation>(feature)) {
@@ -377,13 +350,202 @@ void GeometryLayerPrivate::clearCache()
 {
     m_lastFeatureAt = nullptr;
     m_dirty = true;
-    m_cachedDateTime = QDateTime();
     m_cachedItemCount = 0;
+    m_cachedZoomLevel = -1;
+    m_cachedItems.clear();
+    m_paintFragments.clear();
+    m_unsortedItems.clear();
+    m_resortPaintFragments = false;
     m_cachedPaintFragments.clear();
     m_cachedDefaultLayer.clear();
     m_cachedLatLonBox = GeoDataLatLonBox();
 }
 
+void GeometryLayerPrivate::updatePaintFragments(const GeoDataLatLonBox &box, int zoomLevel)
+{
+    const QSet<GeoGraphicsItem*> previousItems = m_cachedItems;
+    if (zoomLevel != m_cachedZoomLevel) {
+        // Styles depend on the zoom level, so all items need to be sorted again
+        clearCache();
+        m_dirty = false;
+        m_cachedZoomLevel = zoomLevel;
+    }
+
+    auto const items = m_scene.items(box, zoomLevel);
+    m_cachedLatLonBox = box;
+    m_cachedItemCount = items.size();
+
+    QSet<GeoGraphicsItem*> visibleItems;
+    visibleItems.reserve(items.size());
+    GeoGraphicItems entering;
+    for (auto item: items) {
+        visibleItems.insert(item);
+        if (!m_cachedItems.contains(item)) {
+            entering << item;
+        }
+    }
+
+    QSet<GeoGraphicsItem*> leaving;
+    for (auto item: m_cachedItems) {
+        if (!visibleItems.contains(item)) {
+            leaving.insert(item);
+        }
+    }
+
+    // Items painted since the last update have their final style now
+    GeoGraphicItems styled;
+    for (auto item: m_unsortedItems) {
+        if (visibleItems.contains(item)) {
+            leaving.insert(item);
+            styled << item;
+        }
+    }
+
+    // Items out of view are not painted, which would update their screen polygons
+    for (auto item: previousItems) {
+        if (!visibleItems.contains(item)) {
+            item->releaseScreenCache();
+        }
+    }
+
+    removePaintFragments(leaving);
+    insertPaintFragments(styled + entering);
+    m_cachedItems.swap(visibleItems);
+    m_unsortedItems = entering;
+    updateCachedPaintFragments();
+}
+
+void GeometryLayerPrivate::sortUnsortedItems()
+{
+    removePaintFragments(QSet<GeoGraphicsItem*>(m_unsortedItems.constBegin(), m_unsortedItems.constEnd()));
+    insertPaintFragments(m_unsortedItems);
+    m_unsortedItems.clear();
+    updateCachedPaintFragments();
+}
+
+void GeometryLayerPrivate::removePaintFragments(const QSet<GeoGraphicsItem*> &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+
+    auto const isRemoved = [&items](GeoGraphicsItem *item) { return items.contains(item); };
+    for (auto & fragments: m_paintFragments) {
+        fragments.negative.erase(std::remove_if(fragments.negative.begin(), fragments.negative.end(), isRemoved), fragments.negative.end());
+        fragments.null.erase(std::remove_if(fragments.null.begin(), fragments.null.end(), isRemoved), fragments.null.end());
+        fragments.positive.erase(std::remove_if(fragments.positive.begin(), fragments.positive.end(), isRemoved), fragments.positive.end());
+    }
+
+    auto const isRemovedLayerItem = [&items](const LayerItem &layerItem) { return items.contains(layerItem.second); };
+    m_cachedDefaultLayer.erase(std::remove_if(m_cachedDefaultLayer.begin(), m_cachedDefaultLayer.end(), isRemovedLayerItem),
+                               m_cachedDefaultLayer.end());
+}
+
+void GeometryLayerPrivate::insertPaintFragments(const GeoGraphicItems &items)
+{
+    if (items.isEmpty() && !m_resortPaintFragments) {
+        return;
+    }
+
+    QHash<QString, PaintFragments> paintFragments;
+    const QStringList &renderOrder = m_styleBuilder->renderOrder();
+    QSet<QString> const knownLayers(renderOrder.constBegin(), renderOrder.constEnd());
+    for (GeoGraphicsItem* item: items) {
+        QStringList paintLayers = item->paintLayers();
+        if (paintLayers.isEmpty()) {
+            mDebug() << item << " provides no paint layers, so I force one onto it.";
+            paintLayers << QString();
+        }
+        for (const auto &layer: paintLayers) {
+            if (knownLayers.contains(layer)) {
+                PaintFragments &fragments = paintFragments[layer];
+                double const zValue = item->zValue();
+                // assign subway stations
+                if (zValue == 0.0) {
+                    fragments.null << item;
+                    // assign areas and streets
+                } else if (zValue < 0.0) {
+                    fragments.negative << item;
+                    // assign buildings
+                } else {
+                    fragments.positive << item;
+                }
+            } else {
+                // assign symbols
+                m_cachedDefaultLayer << LayerItem(layer, item);
+                static QSet<QString> missingLayers;
+                if (!missingLayers.contains(layer)) {
+                    mDebug() << "Missing layer " << layer << ", in render order, will render it on top";
+                    missingLayers << layer;
+                }
+            }
+        }
+    }
+
+    // Sort the new items of each fragment by z-level, then merge them into the sorted fragments.
+    // The idea here is that the null fragment has most items and does not need to be sorted by z-value
+    // since they are all equal (=0). We do sort them by style pointer though for batch rendering
+    struct Merge {
+        GeoGraphicItems *sorted;
+        GeoGraphicItems *items;
+        bool (*lessThan)(GeoGraphicsItem*, GeoGraphicsItem*);
+    };
+    // Add missing layers first, so the pointers collected below are not invalidated by a detach
+    for (auto iter = paintFragments.constBegin(); iter != paintFragments.constEnd(); ++iter) {
+        m_paintFragments[iter.key()];
+    }
+    // Changed styles break the order of the sorted fragments, so all of them are sorted again
+    const bool resort = m_resortPaintFragments;
+    m_resortPaintFragments = false;
+    if (resort) {
+        for (auto iter = m_paintFragments.constBegin(); iter != m_paintFragments.constEnd(); ++iter) {
+            paintFragments[iter.key()];
+        }
+    }
+    QVector<Merge> merges;
+    for (auto iter = paintFragments.begin(); iter != paintFragments.end(); ++iter) {
+        PaintFragments &sorted = m_paintFragments[iter.key()];
+        merges << Merge{&sorted.negative, &iter->negative, GeoGraphicsItem::zValueLessThan};
+        merges << Merge{&sorted.null, &iter->null, GeoGraphicsItem::styleLessThan};
+        merges << Merge{&sorted.positive, &iter->positive, GeoGraphicsItem::zValueAndStyleLessThan};
+    }
+
+    auto const merge = [resort](const Merge &job) {
+        if (resort) {
+            *job.sorted << *job.items;
+            std::sort(job.sorted->begin(), job.sorted->end(), job.lessThan);
+            return;
+        }
+        if (job.items->isEmpty()) {
+            return;
+        }
+        std::sort(job.items->begin(), job.items->end(), job.lessThan);
+        auto const size = job.sorted->size();
+        *job.sorted << *job.items;
+        std::inplace_merge(job.sorted->begin(), job.sorted->begin() + size, job.sorted->end(), job.lessThan);
+    };
+
+    // Small updates while panning are not worth the thread synchronization
+    if (items.size() < 1000 && !resort) {
+        std::for_each(merges.constBegin(), merges.constEnd(), merge);
+    } else {
+        QtConcurrent::blockingMap(merges, merge);
+    }
+}
+
+void GeometryLayerPrivate::updateCachedPaintFragments()
+{
+    m_cachedPaintFragments.clear();
+    for (const QString &layer: m_styleBuilder->renderOrder()) {
+        const PaintFragments &layerItems = m_paintFragments[layer];
+        auto const count = layerItems.negative.size() + layerItems.null.size() + layerItems.positive.size();
+        m_cachedPaintFragments[layer].reserve(count);
+        m_cachedPaintFragments[layer] << layerItems.negative;
+        m_cachedPaintFragments[layer] << layerItems.null;
+        m_cachedPaintFragments[layer] << layerItems.positive;
+    }
+}
+
 inline bool GeometryLayerPrivate::showRelation(const GeoDataRelation *relation) const
 {
     return (m_visibleRelationTypes.testFlag(relation->relationType())
@@ -403,7 +565,10 @@ void GeometryLayerPrivate::updateRelationVisibility()
             }
         }
     }
+    // the styles determine the order of the paint fragments
+    clearCache();
     m_scene.resetStyle();
+    m_stylesChanged = true;
 }
 
 void GeometryLayerPrivate::createGraphicsItemFromGeometry(const GeoDataGeometry* object, const GeoDataPlacemark *placemark, const Relations &relations)
@@ -446,7 +611,7 @@ void GeometryLayerPrivate::createGraphicsItemFromGeometry(const GeoDataGeometry*
     item->setStyleBuilder(m_styleBuilder);
     item->setVisible(item->visible() && placemark->isGloballyVisible());
     item->setMinZoomLevel(m_styleBuilder->minimumZoomLevel(*placemark));
-    m_scene.addItem(item);
+    m_pendingItems << item;
 }
 
 void GeometryLayerPrivate::createGraphicsItemFromOverlay(const GeoDataOverlay *overlay)
@@ -468,13 +633,51 @@ void GeometryLayerPrivate::createGraphicsItemFromOverlay(const GeoDataOverlay *o
     if (item) {
         item->setStyleBuilder(m_styleBuilder);
         item->setVisible(overlay->isGloballyVisible());
-        m_scene.addItem(item);
+        m_pendingItems << item;
     }
 }
 
 void GeometryLayerPrivate::removeGraphicsItems(const GeoDataFeature *feature)
 {
-    clearCache();
+    // The paint fragments must not refer to the items deleted by the scene
+    QSet<GeoGraphicsItem*> items;
+    collectGraphicsItems(feature, items);
+    removeCachedItems(items);
+    removeSceneItems(feature);
+}
+
+void GeometryLayerPrivate::collectGraphicsItems(const GeoDataFeature *feature, QSet<GeoGraphicsItem*> &items) const
+{
+    if (geodata_cast<GeoDataPlacemark>(feature)) {
+        for (auto item: m_scene.items(feature)) {
+            items.insert(item);
+        }
+    } else if (const auto container = dynamic_cast<const GeoDataContainer*>(feature)) {
+        for (const GeoDataFeature *child: container->featureList()) {
+            collectGraphicsItems(child, items);
+        }
+    }
+}
+
+void GeometryLayerPrivate::removeCachedItems(const QSet<GeoGraphicsItem*> &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+
+    if (items.contains(m_lastFeatureAt)) {
+        m_lastFeatureAt = nullptr;
+    }
+    removePaintFragments(items);
+    m_cachedItems.subtract(items);
+    auto const isRemoved = [&items](GeoGraphicsItem *item) { return items.contains(item); };
+    m_unsortedItems.erase(std::remove_if(m_unsortedItems.begin(), m_unsortedItems.end(), isRemoved), m_unsortedItems.end());
+    updateCachedPaintFragments();
+    m_dirty = true;
+}
+
+void GeometryLayerPrivate::removeSceneItems(const GeoDataFeature *feature)
+{
     if (const auto placemark = geodata_cast<GeoDataPlacemark>(feature)) {
         if (placemark->isGloballyVisible() &&
             geodata_cast<GeoDataLineString>(placemark->geometry()) &&
@@ -495,7 +698,7 @@ void GeometryLayerPrivate::removeGraphicsItems(const GeoDataFeature *feature)
         m_scene.removeItem(feature);
     } else if (const auto container = dynamic_cast<const GeoDataContainer*>(feature)) {
         for (const GeoDataFeature *child: container->featureList()) {
-            removeGraphicsItems(child);
+            removeSceneItems(child);
         }
     } else if (geodata_cast<GeoDataScreenOverlay>(feature)) {
         for (ScreenOverlayGraphicsItem  *item: m_screenOverlays) {
@@ -558,6 +761,10 @@ void GeometryLayer::resetCacheData()
 
 void GeometryLayer::setTileLevel(int tileLevel)
 {
+    if (tileLevel != d->m_tileLevel) {
+        // the items resolve their styles for the new tile level
+        d->m_stylesChanged = true;
+    }
     d->m_tileLevel = tileLevel;
 }
 
@@ -675,6 +882,7 @@ void GeometryLayer::handleHighlight(qreal lon, qreal lat, GeoDataCoordinates::Un
         }
     }
 
+    d->m_stylesChanged = true;
     emit highlightedPlacemarksChanged(selectedPlacemarks);
 }
 
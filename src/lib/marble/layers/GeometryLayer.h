@@ -12,6 +12,7 @@
 #include "LayerInterface.h"
 #include "GeoDataCoordinates.h"
 #include "GeoDataRelation.h"
+#include "marble_export.h"
 
 class QAbstractItemModel;
 class QModelIndex;
@@ -28,7 +29,7 @@ class ViewportParams;
 
 class GeometryLayerPrivate;
 
-class GeometryLayer : public QObject, public LayerInterface
+class MARBLE_EXPORT GeometryLayer : public QObject, public LayerInterface
 {
     Q_OBJECT
 public:
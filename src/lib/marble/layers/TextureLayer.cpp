@@ -50,6 +50,7 @@ public:
     void requestDelayedRepaint();
     void updateTextureLayers();
     void updateTile( const TileId &tileId, const QImage &tileImage );
+    void updateSunPosition();
 
     void addGroundOverlays( const QModelIndex& parent, int first, int last );
     void removeGroundOverlays( const QModelIndex& parent, int first, int last );
@@ -166,6 +167,13 @@ void TextureLayer::Private::updateTile( const TileId &tileId, const QImage &tile
     requestDelayedRepaint();
 }
 
+void TextureLayer::Private::updateSunPosition()
+{
+    // only the shading changes, the next loads reuse the unshaded tiles
+    m_layerDecorator.updateSunPosition();
+    m_parent->reset();
+}
+
 bool TextureLayer::Private::drawOrderLessThan( const GeoDataGroundOverlay* o1, const GeoDataGroundOverlay* o2 )
 {
     return o1->drawOrder() < o2->drawOrder();
@@ -242,6 +250,7 @@ TextureLayer::TextureLayer( HttpDownloadManager *downloadManager,
     : TileLayer()
     , d( new Private( downloadManager, pluginManager, sunLocator, groundOverlayModel, this ) )
 {
+    // asynchronously decoded tiles replace the preliminary ones, see setAsynchronousDecoding()
     connect( &d->m_loader, SIGNAL(tileCompleted(TileId,QImage)),
              this, SLOT(updateTile(TileId,QImage)) );
 
@@ -320,7 +329,7 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
          d->m_centerCoordinates.latitude() != viewport->centerLatitude() ) {
         d->m_centerCoordinates.setLongitude( viewport->centerLongitude() );
         d->m_centerCoordinates.setLatitude( viewport->centerLatitude() );
-        d->m_texmapper->setRepaintNeeded();
+        d->m_texmapper->setCenterChanged();
     }
 
     // choose the smaller dimension for selecting the tile level, leading to higher-resolution results
@@ -346,6 +355,8 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
 
     const QRect dirtyRect = QRect( QPoint( 0, 0), viewport->size() );
     d->m_texmapper->mapTexture( painter, viewport, d->m_tileZoomLevel, dirtyRect, d->m_texcolorizer );
+    d->m_runtimeTrace += d->m_texmapper->runtimeTrace();
+    d->m_runtimeTrace += QStringLiteral("Tile Lookups: %1 contended ").arg(d->m_tileLoader.contentionCount());
     d->m_renderState.addChild( d->m_tileLoader.renderState() );
     return true;
 }
@@ -365,11 +376,11 @@ void TextureLayer::setShowRelief( bool show )
 void TextureLayer::setShowSunShading( bool show )
 {
     disconnect( d->m_sunLocator, SIGNAL(positionChanged(qreal,qreal)),
-                this, SLOT(reset()) );
+                this, SLOT(updateSunPosition()) );
 
     if ( show ) {
         connect( d->m_sunLocator, SIGNAL(positionChanged(qreal,qreal)),
-                 this,       SLOT(reset()) );
+                 this,       SLOT(updateSunPosition()) );
     }
 
     d->m_layerDecorator.setShowSunShading( show );
@@ -436,9 +447,15 @@ void TextureLayer::setNeedsUpdate()
     emit repaintNeeded();
 }
 
+void TextureLayer::setAsynchronousDecoding( bool enabled )
+{
+    d->m_loader.setAsynchronousDecoding( enabled );
+}
+
 void TextureLayer::setVolatileCacheLimit( quint64 kilobytes )
 {
     d->m_tileLoader.setVolatileCacheLimit( kilobytes );
+    d->m_layerDecorator.setUnshadedTileCacheLimit( kilobytes );
 }
 
 void TextureLayer::reset()
@@ -109,6 +109,13 @@ public Q_SLOTS:
 
     void setMapTheme( const QVector<const GeoSceneTextureTileDataset *> &textures, const GeoSceneGroup *textureLayerSettings, const QString &seaFile, const QString &landFile );
 
+    /**
+     * @brief Decodes tiles in the background and paints scaled lower level
+     * tiles meanwhile, for maps that get repainted once the tiles are ready.
+     * Disabled by default, so that single renderings are complete.
+     */
+    void setAsynchronousDecoding( bool enabled );
+
     void setVolatileCacheLimit( quint64 kilobytes );
 
     void reset();
@@ -125,6 +132,7 @@ public Q_SLOTS:
     Q_PRIVATE_SLOT( d, void requestDelayedRepaint() )
     Q_PRIVATE_SLOT( d, void updateTextureLayers() )
     Q_PRIVATE_SLOT( d, void updateTile( const TileId &tileId, const QImage &tileImage ) )
+    Q_PRIVATE_SLOT( d, void updateSunPosition() )
     Q_PRIVATE_SLOT( d, void addGroundOverlays( const QModelIndex& parent, int first, int last ) )
     Q_PRIVATE_SLOT( d, void removeGroundOverlays( const QModelIndex& parent, int first, int last ) )
     Q_PRIVATE_SLOT( d, void resetGroundOverlaysCache() )
@@ -13,6 +13,7 @@
 #include "MarbleDebug.h"
 #include <QRegion>
 #include <QPainterPath>
+#include <QThreadStorage>
 
 // Marble
 #include "GeoDataLineString.h"
@@ -45,6 +46,50 @@ AbstractProjectionPrivate::AbstractProjectionPrivate( AbstractProjection * paren
 {
 }
 
+static QThreadStorage<ProjectedNodes::Buffers> s_projectedNodes;
+
+bool ProjectedNodes::project( const AbstractProjection *projection, const GeoDataLineString &lineString,
+                              const ViewportParams *viewport, bool filter )
+{
+    const int size = lineString.size();
+    if ( size < MinimumSize ) {
+        return false;
+    }
+
+    m_buffers = &s_projectedNodes.localData();
+    Buffers &buffers = *m_buffers;
+    if ( buffers.indices.size() < size ) {
+        buffers.indices.resize( size );
+        buffers.lon.resize( size );
+        buffers.lat.resize( size );
+        buffers.altitude.resize( size );
+        buffers.x.resize( size );
+        buffers.y.resize( size );
+        buffers.visible.resize( size );
+        buffers.globeHidesPoint.resize( size );
+    }
+
+    // The same node filter as the one of lineStringToPolygon(), comparing to the last kept node
+    LineStringNodes nodes( lineString );
+    for ( int index = 0; index < size; ++index ) {
+        const GeoDataCoordinates &coords = nodes.at( index );
+        if ( filter && index != 0 && !viewport->resolves( nodes.previous(), coords ) ) {
+            continue;
+        }
+        nodes.keepAsPrevious();
+        buffers.indices[m_count] = index;
+        buffers.lon[m_count] = coords.longitude();
+        buffers.lat[m_count] = coords.latitude();
+        buffers.altitude[m_count] = coords.altitude();
+        ++m_count;
+    }
+
+    projection->screenCoordinates( buffers.lon.constData(), buffers.lat.constData(), buffers.altitude.constData(),
+                                   m_count, viewport, buffers.x.data(), buffers.y.data(),
+                                   buffers.visible.data(), buffers.globeHidesPoint.data() );
+    return true;
+}
+
 int AbstractProjectionPrivate::levelForResolution(qreal resolution) const {
     if (m_previousResolution == resolution) return m_level;
 
@@ -169,6 +214,23 @@ bool AbstractProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
     return screenCoordinates( geopoint, viewport, x, y, globeHidesPoint );
 }
 
+void AbstractProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                            int count, const ViewportParams *viewport,
+                                            qreal *x, qreal *y, bool *visible,
+                                            bool *globeHidesPoint ) const
+{
+    bool hidden;
+    GeoDataCoordinates geopoint;
+
+    for ( int i = 0; i < count; ++i ) {
+        geopoint.set( lon[i], lat[i], altitude ? altitude[i] : 0.0 );
+        visible[i] = screenCoordinates( geopoint, viewport, x[i], y[i], hidden );
+        if ( globeHidesPoint ) {
+            globeHidesPoint[i] = hidden;
+        }
+    }
+}
+
 GeoDataLatLonAltBox AbstractProjection::latLonAltBox( const QRect& screenRect,
                                                       const ViewportParams *viewport ) const
 {
@@ -223,6 +223,28 @@ class MARBLE_EXPORT AbstractProjection
                             const ViewportParams *viewport,
                             QVector<QPolygonF*> &polygons ) const = 0;
 
+    /**
+     * @brief Get the screen coordinates of many points in the map at once.
+     * @param lon       the longitudes of the points in radian
+     * @param lat       the latitudes of the points in radian
+     * @param altitude  the altitudes of the points in meters or @c nullptr for zero
+     * @param count     the number of points
+     * @param x         receives the x coordinates of the points on the screen
+     * @param y         receives the y coordinates of the points on the screen
+     * @param visible   receives whether the points are visible on the screen
+     * @param globeHidesPoint  receives whether the globe hides the points
+     *                  regardless of the screen area, or @c nullptr if not needed
+     *
+     * The results agree with the ones of the single point version, but the
+     * projections work on whole arrays without any per point object, so that
+     * the compiler can vectorize them. The coordinates of a point are only
+     * defined where @p visible is @c true.
+     */
+    virtual void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                    int count, const ViewportParams *viewport,
+                                    qreal *x, qreal *y, bool *visible,
+                                    bool *globeHidesPoint = nullptr ) const;
+
     /**
      * @brief Get the earth coordinates corresponding to a pixel in the map.
      * @param x      the x coordinate of the pixel
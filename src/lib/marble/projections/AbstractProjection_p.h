@@ -6,11 +6,14 @@
 #ifndef MARBLE_ABSTRACTPROJECTIONPRIVATE_H
 #define MARBLE_ABSTRACTPROJECTIONPRIVATE_H
 
+#include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
 
 namespace Marble
 {
 
 class AbstractProjection;
+class ViewportParams;
 
 class AbstractProjectionPrivate
 {
@@ -30,6 +33,135 @@ class AbstractProjectionPrivate
     Q_DECLARE_PUBLIC( AbstractProjection )
 };
 
+/**
+ * Sequential read access to the nodes of a line string for lineStringToPolygon().
+ *
+ * Nodes of line strings in CoordinatesStorage are referenced in place, so their
+ * cached quaternions get reused. Packed line strings are decoded on the fly into
+ * two alternating buffers without being unpacked: the node marked by
+ * keepAsPrevious() stays valid while the following nodes are read.
+ */
+class LineStringNodes
+{
+  public:
+    explicit LineStringNodes( const GeoDataLineString &lineString )
+        : m_lineString( lineString ),
+          m_nodes( lineString.storage() == GeoDataLineString::CoordinatesStorage && !lineString.isEmpty()
+                   ? &lineString.at( 0 ) : nullptr ),
+          m_current( nullptr ),
+          m_previous( nullptr ),
+          m_currentPos( -1 )
+    {
+    }
+
+    const GeoDataCoordinates &at( int pos )
+    {
+        if ( pos == m_currentPos ) {
+            return *m_current;
+        }
+
+        m_currentPos = pos;
+        if ( m_nodes ) {
+            m_current = m_nodes + pos;
+        } else {
+            GeoDataCoordinates *const buffer = m_previous == &m_buffers[0] ? &m_buffers[1] : &m_buffers[0];
+            m_lineString.readCoordinates( pos, *buffer );
+            m_current = buffer;
+        }
+        return *m_current;
+    }
+
+    void keepAsPrevious()
+    {
+        m_previous = m_current;
+    }
+
+    const GeoDataCoordinates &previous() const
+    {
+        return *m_previous;
+    }
+
+  private:
+    const GeoDataLineString &m_lineString;
+    const GeoDataCoordinates *const m_nodes;
+    const GeoDataCoordinates *m_current;
+    const GeoDataCoordinates *m_previous;
+    int m_currentPos;
+    GeoDataCoordinates m_buffers[2];
+};
+
+/**
+ * The screen positions of the nodes of a line string that lineStringToPolygon() draws.
+ *
+ * Long line strings without detail levels or significance draw most of their
+ * nodes. The nodes that pass the node filter of lineStringToPolygon() get
+ * collected first and projected with one call of the batch screenCoordinates().
+ * The buffers are kept per thread and reused, as the projections are shared,
+ * so only one line string at a time can be projected by a thread.
+ * Shorter line strings are left to the single point projection.
+ */
+class ProjectedNodes
+{
+  public:
+    enum { MinimumSize = 64 };
+
+    ProjectedNodes()
+        : m_buffers( nullptr ),
+          m_count( 0 ),
+          m_next( 1 ),
+          m_selected( 0 )
+    {
+    }
+
+    /**
+     * Projects the nodes of @p lineString if it has at least MinimumSize nodes.
+     * With @p filter only the nodes resolved by the viewport are projected.
+     * Returns whether the nodes got projected, otherwise the node filter and
+     * the projection are up to lineStringToPolygon().
+     */
+    bool project( const AbstractProjection *projection, const GeoDataLineString &lineString,
+                  const ViewportParams *viewport, bool filter );
+
+    /**
+     * Selects the node at @p index if it passed the filter. The nodes have to be
+     * asked for in order, the first node again to close a ring.
+     */
+    bool select( int index )
+    {
+        if ( index == 0 ) {
+            m_selected = 0;
+            return true;
+        }
+        if ( m_next < m_count && m_buffers->indices[m_next] == index ) {
+            m_selected = m_next++;
+            return true;
+        }
+        return false;
+    }
+
+    qreal x() const { return m_buffers->x[m_selected]; }
+    qreal y() const { return m_buffers->y[m_selected]; }
+    bool globeHidesPoint() const { return m_buffers->globeHidesPoint[m_selected]; }
+
+    struct Buffers
+    {
+        QVector<int> indices;
+        QVector<qreal> lon;
+        QVector<qreal> lat;
+        QVector<qreal> altitude;
+        QVector<qreal> x;
+        QVector<qreal> y;
+        QVector<bool> visible;
+        QVector<bool> globeHidesPoint;
+    };
+
+  private:
+    Buffers *m_buffers;
+    int m_count;
+    int m_next;
+    int m_selected;
+};
+
 } // namespace Marble
 
 #endif
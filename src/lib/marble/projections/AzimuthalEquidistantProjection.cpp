@@ -119,6 +119,37 @@ bool AzimuthalEquidistantProjection::screenCoordinates( const GeoDataCoordinates
     return !(x < 0 || x >= viewport->width() || y < 0 || y >= viewport->height());
 }
 
+void AzimuthalEquidistantProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                        int count, const ViewportParams *viewport,
+                                                        qreal *x, qreal *y, bool *visible,
+                                                        bool *globeHidesPoint ) const
+{
+    Q_UNUSED( altitude );
+
+    const qreal scale = 2 * viewport->radius() / M_PI;
+    qreal cosC[BatchSize];
+
+    for ( int first = 0; first < count; first += BatchSize ) {
+        const int size = qMin<int>( BatchSize, count - first );
+        qreal *const blockX = x + first;
+        qreal *const blockY = y + first;
+        bool *const blockVisible = visible + first;
+
+        orthographicCoordinates( lon + first, lat + first, size, viewport, blockX, blockY, cosC );
+
+        for ( int i = 0; i < size; ++i ) {
+            const qreal c = qAcos( cosC[i] );
+            const qreal k = cosC[i] == 1 ? 1 : c / qSin( c );
+            blockX[i] *= k * scale;
+            blockY[i] *= k * scale;
+            blockVisible[i] = cosC[i] > 0;
+        }
+
+        clipToScreen( size, viewport, blockX, blockY, blockVisible,
+                      globeHidesPoint ? globeHidesPoint + first : nullptr );
+    }
+}
+
 bool AzimuthalEquidistantProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                              const ViewportParams *viewport,
                                              qreal *x, qreal &y,
@@ -71,6 +71,11 @@ class AzimuthalEquidistantProjection : public AzimuthalProjection
                             const QSizeF& size,
                             bool &globeHidesPoint ) const override;
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count, const ViewportParams *viewport,
+                            qreal *x, qreal *y, bool *visible,
+                            bool *globeHidesPoint = nullptr ) const override;
+
     using AbstractProjection::screenCoordinates;
 
     /**
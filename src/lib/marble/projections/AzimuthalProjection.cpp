@@ -16,6 +16,7 @@
 #include "ViewportParams.h"
 
 #include <QPainterPath>
+#include <qmath.h>
 
 
 namespace Marble {
@@ -165,6 +166,60 @@ AzimuthalProjection::~AzimuthalProjection()
 {
 }
 
+void AzimuthalProjection::orthographicCoordinates( const qreal *lon, const qreal *lat, int count,
+                                                   const ViewportParams *viewport,
+                                                   qreal *x, qreal *y, qreal *cosC )
+{
+    const qreal lambdaPrime = viewport->centerLongitude();
+    const qreal sinPhi1 = qSin( viewport->centerLatitude() );
+    const qreal cosPhi1 = qCos( viewport->centerLatitude() );
+
+    for ( int i = 0; i < count; ++i ) {
+        const qreal sinPhi = qSin( lat[i] );
+        const qreal cosPhi = qCos( lat[i] );
+        const qreal sinLambda = qSin( lon[i] - lambdaPrime );
+        const qreal cosLambda = qCos( lon[i] - lambdaPrime );
+
+        cosC[i] = sinPhi1 * sinPhi + cosPhi1 * cosPhi * cosLambda;
+        x[i] = cosPhi * sinLambda;
+        y[i] = cosPhi1 * sinPhi - sinPhi1 * cosPhi * cosLambda;
+    }
+}
+
+void AzimuthalProjection::clipToScreen( int count, const ViewportParams *viewport,
+                                        qreal *x, qreal *y, bool *visible, bool *globeHidesPoint ) const
+{
+    const qint64 radius = clippingRadius() * viewport->radius();
+    const qreal radius2 = radius * radius;
+
+    for ( int i = 0; i < count; ++i ) {
+        visible[i] = visible[i] & ( x[i] * x[i] + y[i] * y[i] <= radius2 );
+    }
+
+    moveToScreen( count, viewport, x, y, visible, globeHidesPoint );
+}
+
+void AzimuthalProjection::moveToScreen( int count, const ViewportParams *viewport,
+                                        qreal *x, qreal *y, bool *visible, bool *globeHidesPoint )
+{
+    const int width = viewport->width();
+    const int height = viewport->height();
+    const qreal centerX = width / 2;
+    const qreal centerY = height / 2;
+
+    if ( globeHidesPoint ) {
+        for ( int i = 0; i < count; ++i ) {
+            globeHidesPoint[i] = !visible[i];
+        }
+    }
+
+    for ( int i = 0; i < count; ++i ) {
+        x[i] += centerX;
+        y[i] = centerY - y[i];
+        visible[i] = visible[i] & ( x[i] >= 0 ) & ( x[i] < width ) & ( y[i] >= 0 ) & ( y[i] < height );
+    }
+}
+
 void AzimuthalProjectionPrivate::tessellateLineSegment( const GeoDataCoordinates &aCoords,
                                                 qreal ax, qreal ay,
                                                 const GeoDataCoordinates &bCoords,
@@ -342,8 +397,14 @@ bool AzimuthalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
     }
     polygons.append( polygon );
 
-    GeoDataLineString::ConstIterator itCoords = lineString.constBegin();
-    GeoDataLineString::ConstIterator itPreviousCoords = lineString.constBegin();
+    // Index based access lets packed line strings stay packed
+    LineStringNodes nodes( lineString );
+    const int size = lineString.size();
+    int index = 0;
+    if ( size > 0 ) {
+        nodes.at( 0 );
+        nodes.keepAsPrevious();
+    }
 
     // Some projections display the earth in a way so that there is a
     // foreside and a backside.
@@ -366,9 +427,6 @@ bool AzimuthalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
     bool horizonOrphan = false;
     GeoDataCoordinates horizonOrphanCoords;
 
-    GeoDataLineString::ConstIterator itBegin = lineString.constBegin();
-    GeoDataLineString::ConstIterator itEnd = lineString.constEnd();
-
     bool processingLastNode = false;
 
     // We use a while loop to be able to cover linestrings as well as linear rings:
@@ -378,23 +436,39 @@ bool AzimuthalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
     const bool isLong = lineString.size() > 10;
     const int maximumDetail = levelForResolution(viewport->angularResolution());
     // The first node of optimized linestrings has a non-zero detail value.
-    const bool hasDetail = itBegin->detail() != 0;
+    const bool hasDetail = size > 0 && lineString.detailAt( 0 ) != 0;
+    // Long line strings without detail values use the ones of their simplification.
+    const bool hasSignificance = !hasDetail && lineString.usesSignificance();
+
+    // Without detail levels or significance most nodes get drawn, so project them at once
+    ProjectedNodes projected;
+    const bool isProjected = !hasDetail && !hasSignificance
+                             && projected.project( q, lineString, viewport, isLong && !noFilter );
 
-    while ( itCoords != itEnd )
+    while ( index < size )
     {
         // Optimization for line strings with a big amount of nodes
-        bool skipNode = (hasDetail ? itCoords->detail() > maximumDetail
-                : itCoords != itBegin && isLong && !processingLastNode &&
-                !viewport->resolves( *itPreviousCoords, *itCoords ) );
+        bool skipNode = (hasDetail ? lineString.detailAt( index ) > maximumDetail
+                : hasSignificance ? lineString.significanceAt( index ) > maximumDetail
+                : isProjected ? !projected.select( index )
+                : index != 0 && isLong && !processingLastNode &&
+                !viewport->resolves( nodes.previous(), nodes.at( index ) ) );
 
         if ( !skipNode || noFilter) {
+            const GeoDataCoordinates &coords = nodes.at( index );
 
-            q->screenCoordinates( *itCoords, viewport, x, y, globeHidesPoint );
+            if ( isProjected ) {
+                x = projected.x();
+                y = projected.y();
+                globeHidesPoint = projected.globeHidesPoint();
+            } else {
+                q->screenCoordinates( coords, viewport, x, y, globeHidesPoint );
+            }
 
             // Initializing variables that store the values of the previous iteration
-            if ( !processingLastNode && itCoords == itBegin ) {
+            if ( !processingLastNode && index == 0 ) {
                 previousGlobeHidesPoint = globeHidesPoint;
-                itPreviousCoords = itCoords;
+                nodes.keepAsPrevious();
                 previousX = x;
                 previousY = y;
             }
@@ -405,7 +479,7 @@ bool AzimuthalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
 
             if ( isAtHorizon ) {
                 // Handle the "horizon case"
-                horizonCoords = findHorizon( *itPreviousCoords, *itCoords, viewport, f );
+                horizonCoords = findHorizon( nodes.previous(), coords, viewport, f );
 
                 if ( lineString.isClosed() ) {
                     if ( horizonPair ) {
@@ -441,8 +515,8 @@ bool AzimuthalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
 
                 if ( !isAtHorizon ) {
 
-                    tessellateLineSegment( *itPreviousCoords, previousX, previousY,
-                                           *itCoords, x, y,
+                    tessellateLineSegment( nodes.previous(), previousX, previousY,
+                                           coords, x, y,
                                            polygons, viewport,
                                            f, !lineString.isClosed() );
 
@@ -452,12 +526,12 @@ bool AzimuthalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
                     // current or previous point in the line.
                     if ( previousGlobeHidesPoint ) {
                         tessellateLineSegment( horizonCoords, horizonX, horizonY,
-                                               *itCoords, x, y,
+                                               coords, x, y,
                                                polygons, viewport,
                                                f, !lineString.isClosed() );
                     }
                     else {
-                        tessellateLineSegment( *itPreviousCoords, previousX, previousY,
+                        tessellateLineSegment( nodes.previous(), previousX, previousY,
                                                horizonCoords, horizonX, horizonY,
                                                polygons, viewport,
                                                f, !lineString.isClosed() );
@@ -484,7 +558,7 @@ bool AzimuthalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
             }
 
             previousGlobeHidesPoint = globeHidesPoint;
-            itPreviousCoords = itCoords;
+            nodes.keepAsPrevious();
             previousX = x;
             previousY = y;
         }
@@ -495,10 +569,10 @@ bool AzimuthalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
         if ( processingLastNode ) {
             break;
         }
-        ++itCoords;
+        ++index;
 
-        if ( itCoords == itEnd  && lineString.isClosed() ) {
-            itCoords = itBegin;
+        if ( index == size  && lineString.isClosed() ) {
+            index = 0;
             processingLastNode = true;
         }
     }
@@ -60,6 +60,36 @@ class AzimuthalProjection : public AbstractProjection
  protected:
     explicit AzimuthalProjection( AzimuthalProjectionPrivate* dd );
 
+    /**
+     * The batch screenCoordinates() of the azimuthal projections work on
+     * blocks of at most BatchSize points to keep their buffers on the stack.
+     */
+    enum { BatchSize = 256 };
+
+    /**
+     * Computes the orthographic coordinates @p x and @p y of the points relative
+     * to the center of the viewport on the unit sphere together with the cosine
+     * of their angular distance @p cosC to it.
+     */
+    static void orthographicCoordinates( const qreal *lon, const qreal *lat, int count,
+                                         const ViewportParams *viewport,
+                                         qreal *x, qreal *y, qreal *cosC );
+
+    /**
+     * Hides the points outside of the clipping radius and moves the others
+     * from the center of the viewport onto the screen.
+     */
+    void clipToScreen( int count, const ViewportParams *viewport,
+                       qreal *x, qreal *y, bool *visible, bool *globeHidesPoint ) const;
+
+    /**
+     * Moves the points from the center of the viewport onto the screen and
+     * hides the ones outside of it. The points hidden before, if requested,
+     * are the ones hidden by the globe.
+     */
+    static void moveToScreen( int count, const ViewportParams *viewport,
+                              qreal *x, qreal *y, bool *visible, bool *globeHidesPoint );
+
  private:
     Q_DECLARE_PRIVATE( AzimuthalProjection )
     Q_DISABLE_COPY( AzimuthalProjection )
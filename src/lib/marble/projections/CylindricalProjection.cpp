@@ -284,11 +284,14 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
     }
     polygons.append( polygon );
 
-    GeoDataLineString::ConstIterator itCoords = lineString.constBegin();
-    GeoDataLineString::ConstIterator itPreviousCoords = lineString.constBegin();
-
-    GeoDataLineString::ConstIterator itBegin = lineString.constBegin();
-    GeoDataLineString::ConstIterator itEnd = lineString.constEnd();
+    // Index based access lets packed line strings stay packed
+    LineStringNodes nodes( lineString );
+    const int size = lineString.size();
+    int index = 0;
+    if ( size > 0 ) {
+        nodes.at( 0 );
+        nodes.keepAsPrevious();
+    }
 
     bool processingLastNode = false;
 
@@ -299,25 +302,41 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
     const bool isLong = lineString.size() > 10;
     const int maximumDetail = levelForResolution(viewport->angularResolution());
     // The first node of optimized linestrings has a non-zero detail value.
-    const bool hasDetail = itBegin->detail() != 0;
+    const bool hasDetail = size > 0 && lineString.detailAt( 0 ) != 0;
+    // Long line strings without detail values use the ones of their simplification.
+    const bool hasSignificance = !hasDetail && lineString.usesSignificance();
 
     bool isStraight = lineString.latLonAltBox().height() == 0 || lineString.latLonAltBox().width() == 0;
 
     Q_Q( const CylindricalProjection );
     bool const isClosed = lineString.isClosed();
-    while ( itCoords != itEnd )
+
+    // Without detail levels or significance most nodes get drawn, so project them at once
+    ProjectedNodes projected;
+    const bool isProjected = !hasDetail && !hasSignificance
+                             && projected.project( q, lineString, viewport, isLong && !noFilter );
+
+    while ( index < size )
     {
         // Optimization for line strings with a big amount of nodes
-        bool skipNode = (hasDetail ? itCoords->detail() > maximumDetail
-                : isLong && !processingLastNode && itCoords != itBegin &&
-                !viewport->resolves( *itPreviousCoords, *itCoords ) );
+        bool skipNode = (hasDetail ? lineString.detailAt( index ) > maximumDetail
+                : hasSignificance ? lineString.significanceAt( index ) > maximumDetail
+                : isProjected ? !projected.select( index )
+                : isLong && !processingLastNode && index != 0 &&
+                !viewport->resolves( nodes.previous(), nodes.at( index ) ) );
 
         if ( !skipNode || noFilter) {
-            q->screenCoordinates( *itCoords, viewport, x, y );
+            const GeoDataCoordinates &coords = nodes.at( index );
+            if ( isProjected ) {
+                x = projected.x();
+                y = projected.y();
+            } else {
+                q->screenCoordinates( coords, viewport, x, y );
+            }
 
             // Initializing variables that store the values of the previous iteration
-            if ( !processingLastNode && itCoords == itBegin ) {
-                itPreviousCoords = itCoords;
+            if ( !processingLastNode && index == 0 ) {
+                nodes.keepAsPrevious();
                 previousX = x;
                 previousY = y;
             }
@@ -326,8 +345,8 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
             // segments of a linestring. If you are about to learn how the code of
             // this class works you can safely ignore this section for a start.
             if ( tessellate && !isStraight) {
-                mirrorCount = tessellateLineSegment( *itPreviousCoords, previousX, previousY,
-                                           *itCoords, x, y,
+                mirrorCount = tessellateLineSegment( nodes.previous(), previousX, previousY,
+                                           coords, x, y,
                                            polygons, viewport,
                                            f, mirrorCount, distance );
             }
@@ -336,10 +355,10 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
                 // special case for polys which cross dateline but have no Tesselation Flag
                 // the expected rendering is a screen coordinates straight line between
                 // points, but in projections with repeatX things are not smooth
-                mirrorCount = crossDateLine( *itPreviousCoords, *itCoords, x, y, polygons, mirrorCount, distance );
+                mirrorCount = crossDateLine( nodes.previous(), coords, x, y, polygons, mirrorCount, distance );
             }
 
-            itPreviousCoords = itCoords;
+            nodes.keepAsPrevious();
             previousX = x;
             previousY = y;
         }
@@ -350,10 +369,10 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
         if ( processingLastNode ) {
             break;
         }
-        ++itCoords;
+        ++index;
 
-        if (isClosed && itCoords == itEnd) {
-            itCoords = itBegin;
+        if (isClosed && index == size) {
+            index = 0;
             processingLastNode = true;
         }
     }
@@ -77,6 +77,41 @@ bool EquirectProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
                   || ( 0 <= x + 4 * radius && x + 4 * radius < width ) ) );
 }
 
+void EquirectProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                            int count, const ViewportParams *viewport,
+                                            qreal *x, qreal *y, bool *visible,
+                                            bool *globeHidesPoint ) const
+{
+    Q_UNUSED( altitude );
+
+    // Convenience variables
+    const int  radius = viewport->radius();
+    const int  width  = viewport->width();
+    const int  height = viewport->height();
+    const qreal  rad2Pixel = 2.0 * radius / M_PI;
+    const qreal  centerX = (qreal)(width)  / 2.0 - rad2Pixel * viewport->centerLongitude();
+    const qreal  centerY = (qreal)(height) / 2.0 + rad2Pixel * viewport->centerLatitude();
+    const qreal  xRepeatDistance = 4 * radius;
+
+    for ( int i = 0; i < count; ++i ) {
+        x[i] = centerX + rad2Pixel * lon[i];
+        y[i] = centerY - rad2Pixel * lat[i];
+
+        // The point is visible if one of its repetitions is inside the screen area
+        visible[i] = ( 0 <= y[i] ) & ( y[i] < height )
+                   & ( ( ( 0 <= x[i] ) & ( x[i] < width ) )
+                     | ( ( 0 <= x[i] - xRepeatDistance ) & ( x[i] - xRepeatDistance < width ) )
+                     | ( ( 0 <= x[i] + xRepeatDistance ) & ( x[i] + xRepeatDistance < width ) ) );
+    }
+
+    // On flat projections the planet never obscures the points
+    if ( globeHidesPoint ) {
+        for ( int i = 0; i < count; ++i ) {
+            globeHidesPoint[i] = false;
+        }
+    }
+}
+
 bool EquirectProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                             const ViewportParams *viewport,
                                             qreal *x, qreal &y,
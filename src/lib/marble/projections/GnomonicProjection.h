@@ -70,6 +70,11 @@ class GnomonicProjection : public AzimuthalProjection
                             const QSizeF& size,
                             bool &globeHidesPoint ) const override;
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count, const ViewportParams *viewport,
+                            qreal *x, qreal *y, bool *visible,
+                            bool *globeHidesPoint = nullptr ) const override;
+
     using AbstractProjection::screenCoordinates;
 
     /**
@@ -118,6 +118,36 @@ bool LambertAzimuthalProjection::screenCoordinates( const GeoDataCoordinates &co
     return !(x < 0 || x >= viewport->width() || y < 0 || y >= viewport->height());
 }
 
+void LambertAzimuthalProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                    int count, const ViewportParams *viewport,
+                                                    qreal *x, qreal *y, bool *visible,
+                                                    bool *globeHidesPoint ) const
+{
+    Q_UNUSED( altitude );
+
+    const qreal scale = viewport->radius() / qSqrt( 2 );
+    qreal cosC[BatchSize];
+
+    for ( int first = 0; first < count; first += BatchSize ) {
+        const int size = qMin<int>( BatchSize, count - first );
+        qreal *const blockX = x + first;
+        qreal *const blockY = y + first;
+        bool *const blockVisible = visible + first;
+
+        orthographicCoordinates( lon + first, lat + first, size, viewport, blockX, blockY, cosC );
+
+        for ( int i = 0; i < size; ++i ) {
+            const qreal k = qSqrt( 2 / ( 1 + cosC[i] ) );
+            blockX[i] *= k * scale;
+            blockY[i] *= k * scale;
+            blockVisible[i] = cosC[i] > 0;
+        }
+
+        clipToScreen( size, viewport, blockX, blockY, blockVisible,
+                      globeHidesPoint ? globeHidesPoint + first : nullptr );
+    }
+}
+
 bool LambertAzimuthalProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                              const ViewportParams *viewport,
                                              qreal *x, qreal &y,
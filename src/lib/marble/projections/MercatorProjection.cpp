@@ -100,6 +100,46 @@ bool MercatorProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
                   || ( 0 <= x + 4 * radius && x + 4 * radius < width ) ) );
 }
 
+void MercatorProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                            int count, const ViewportParams *viewport,
+                                            qreal *x, qreal *y, bool *visible,
+                                            bool *globeHidesPoint ) const
+{
+    Q_UNUSED( altitude );
+
+    // Convenience variables
+    const int  radius = viewport->radius();
+    const qreal  width  = (qreal)(viewport->width());
+    const qreal  height = (qreal)(viewport->height());
+    const qreal  rad2Pixel = 2 * radius / M_PI;
+    const qreal  centerX = width  / 2 - rad2Pixel * viewport->centerLongitude();
+    const qreal  centerY = height / 2 + rad2Pixel * gdInv( viewport->centerLatitude() );
+    const qreal  xRepeatDistance = 4 * radius;
+    const qreal  minLatitude = minLat();
+    const qreal  maxLatitude = maxLat();
+
+    for ( int i = 0; i < count; ++i ) {
+        const qreal pointLat = qBound( minLatitude, lat[i], maxLatitude );
+        const bool isLatValid = pointLat == lat[i];
+
+        x[i] = centerX + rad2Pixel * lon[i];
+        y[i] = centerY - rad2Pixel * gdInv( pointLat );
+
+        // The point is visible if one of its repetitions is inside the screen area
+        visible[i] = isLatValid & ( 0 <= y[i] ) & ( y[i] < height )
+                   & ( ( ( 0 <= x[i] ) & ( x[i] < width ) )
+                     | ( ( 0 <= x[i] - xRepeatDistance ) & ( x[i] - xRepeatDistance < width ) )
+                     | ( ( 0 <= x[i] + xRepeatDistance ) & ( x[i] + xRepeatDistance < width ) ) );
+    }
+
+    // On flat projections the planet never obscures the points
+    if ( globeHidesPoint ) {
+        for ( int i = 0; i < count; ++i ) {
+            globeHidesPoint[i] = false;
+        }
+    }
+}
+
 bool MercatorProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                             const ViewportParams *viewport,
                                             qreal *x, qreal &y, int &pointRepeatNum,
@@ -79,6 +79,11 @@ class MercatorProjection : public CylindricalProjection
                             const QSizeF& size,
                             bool &globeHidesPoint ) const override;
 
+    void screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                            int count, const ViewportParams *viewport,
+                            qreal *x, qreal *y, bool *visible,
+                            bool *globeHidesPoint = nullptr ) const override;
+
     using CylindricalProjection::screenCoordinates;
 
    /**
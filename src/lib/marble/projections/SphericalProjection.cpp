@@ -124,6 +124,46 @@ bool SphericalProjection::screenCoordinates( const GeoDataCoordinates &coordinat
     return true;
 }
 
+void SphericalProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                             int count, const ViewportParams *viewport,
+                                             qreal *x, qreal *y, bool *visible,
+                                             bool *globeHidesPoint ) const
+{
+    const matrix &m = viewport->planetAxisMatrix();
+    const qreal radius = viewport->radius();
+    const qreal radius2 = radius * radius;
+    const qreal width = viewport->width();
+    const qreal height = viewport->height();
+
+    for ( int i = 0; i < count; ++i ) {
+        // Rotate the unit vector of the point like Quaternion::rotateAroundAxis()
+        const qreal cosLat = cos( lat[i] );
+        const qreal qx = cosLat * sin( lon[i] );
+        const qreal qy = sin( lat[i] );
+        const qreal qz = cosLat * cos( lon[i] );
+
+        const qreal rx = m[0][0] * qx + m[1][0] * qy + m[2][0] * qz;
+        const qreal ry = m[0][1] * qx + m[1][1] * qy + m[2][1] * qz;
+        const qreal rz = m[0][2] * qx + m[1][2] * qy + m[2][2] * qz;
+
+        const qreal pointAltitude = altitude ? altitude[i] : 0.0;
+        const qreal pixelAltitude = radius / EARTH_RADIUS * ( pointAltitude + EARTH_RADIUS );
+        const qreal earthCenteredX = pixelAltitude * rx;
+        const qreal earthCenteredY = pixelAltitude * ry;
+
+        // Placemarks at the other side of the earth and satellites behind it are hidden
+        const bool behindGlobe = earthCenteredX * earthCenteredX + earthCenteredY * earthCenteredY < radius2;
+        const bool hidden = ( rz < 0 ) & ( ( pointAltitude < 10000 ) | behindGlobe );
+
+        x[i] = width  / 2 + earthCenteredX;
+        y[i] = height / 2 - earthCenteredY;
+        visible[i] = !hidden & ( x[i] >= 0 ) & ( x[i] < width ) & ( y[i] >= 0 ) & ( y[i] < height );
+        if ( globeHidesPoint ) {
+            globeHidesPoint[i] = hidden;
+        }
+    }
+}
+
 bool SphericalProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                              const ViewportParams *viewport,
                                              qreal *x, qreal &y,
@@ -148,6 +148,45 @@ bool VerticalPerspectiveProjection::screenCoordinates( const GeoDataCoordinates
     return !(x < 0 || x >= viewport->width() || y < 0 || y >= viewport->height());
 }
 
+void VerticalPerspectiveProjection::screenCoordinates( const qreal *lon, const qreal *lat, const qreal *altitude,
+                                                       int count, const ViewportParams *viewport,
+                                                       qreal *x, qreal *y, bool *visible,
+                                                       bool *globeHidesPoint ) const
+{
+    Q_D(const VerticalPerspectiveProjection);
+    d->calculateConstants(viewport->radius());
+    const qreal P = d->m_P;
+    const qreal altitudeToPixel = d->m_altitudeToPixel;
+    const qreal radius = viewport->radius();
+    const qreal radius2 = radius * radius;
+    qreal cosC[BatchSize];
+
+    for ( int first = 0; first < count; first += BatchSize ) {
+        const int size = qMin<int>( BatchSize, count - first );
+        qreal *const blockX = x + first;
+        qreal *const blockY = y + first;
+        bool *const blockVisible = visible + first;
+
+        orthographicCoordinates( lon + first, lat + first, size, viewport, blockX, blockY, cosC );
+
+        for ( int i = 0; i < size; ++i ) {
+            const qreal pointAltitude = altitude ? altitude[first + i] : 0.0;
+            const qreal k = (P - 1) / (P - cosC[i]);
+            const qreal pixelAltitude = (pointAltitude + EARTH_RADIUS) * altitudeToPixel;
+            blockX[i] *= k * pixelAltitude;
+            blockY[i] *= k * pixelAltitude;
+
+            // Placemarks below 10km altitude and satellites on the Earth's backside are hidden
+            const bool backside = cosC[i] < 1/P;
+            const bool behindGlobe = blockX[i] * blockX[i] + blockY[i] * blockY[i] < radius2;
+            blockVisible[i] = !( backside & ( ( pointAltitude < 10000 ) | behindGlobe ) );
+        }
+
+        moveToScreen( size, viewport, blockX, blockY, blockVisible,
+                      globeHidesPoint ? globeHidesPoint + first : nullptr );
+    }
+}
+
 bool VerticalPerspectiveProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                              const ViewportParams *viewport,
                                              qreal *x, qreal &y,
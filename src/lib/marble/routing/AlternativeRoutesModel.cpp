@@ -13,14 +13,77 @@
 #include "GeoDataPlacemark.h"
 
 #include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPolygonF>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QTimer>
-#include <QPainter>
+#include <qmath.h>
 
 namespace Marble {
 
+namespace
+{
+
+/**
+  * The edges of a route in a grid of cells, to find the edges near a point
+  * without looking at all of them
+  */
+class EdgeGrid
+{
+public:
+    /**
+      * Creates the grid for a polygon inside the square from (0, 0) to
+      * (size, size), with cells two units wide
+      */
+    EdgeGrid( const QPolygonF &polygon, int size );
+
+    /**
+      * Returns the distance of the point to the nearest edge, or maximum if
+      * no edge is nearer. Maximum must not exceed the size of a cell.
+      */
+    qreal distance( const QPointF &point, qreal maximum ) const;
+
+private:
+    int cell( qreal coordinate ) const;
+
+    const QPolygonF &m_polygon;
+    QVector<QVector<int> > m_cells;
+    int m_size;
+    qreal m_cellSize;
+};
+
+}
+
 class Q_DECL_HIDDEN AlternativeRoutesModel::Private
 {
 public:
+    /**
+      * The waypoints of a route in radian and their bounding box, copied
+      * for comparing the route in the similarity thread
+      */
+    struct Shape {
+        QPolygonF points;
+        GeoDataLatLonBox box;
+    };
+
+    /**
+      * The similarities of a new route to the routes of the model at the
+      * time it was added
+      */
+    struct ComparedRoute {
+        GeoDataDocument* document;
+        int generation;
+        QVector<const GeoDataDocument*> routes;
+        QVector<qreal> similarities;
+    };
+
+    class SimilarityJob;
+
+    // The size of the grid the routes are compared in
+    enum { Resolution = 64 };
+
     Private();
 
     /**
@@ -33,37 +96,21 @@ public:
       * be treated as totally different (e.g. different route requests), two routes with a similarity
       * of 1 are considered equal. Otherwise the routes overlap to an extent indicated by the
       * similarity value -- the higher, the more they do overlap.
-      * @note: The direction of routes is important; reversed routes are not considered equal
+      * @note: The direction of routes is not taken into account
       */
     static qreal similarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB );
 
-    /**
-      * Returns the distance between the given polygon and the given point
-      */
-    static qreal distance( const GeoDataLineString &wayPoints, const GeoDataCoordinates &position );
-
-    /**
-      * Returns the bearing of the great circle path defined by the coordinates one and two
-      * Based on https://www.movable-type.co.uk/scripts/latlong.html
-      */
-    static qreal bearing( const GeoDataCoordinates &one, const GeoDataCoordinates &two );
+    static qreal similarity( const Shape &routeA, const Shape &routeB );
 
-    /**
-      * Returns the distance between the given point and the line segment (not line) defined
-      * by the two coordinates lineA and lineB
-      */
-    static qreal distance( const GeoDataCoordinates &satellite, const GeoDataCoordinates &lineA, const GeoDataCoordinates &lineB );
+    static Shape shape( const GeoDataLineString &lineString );
 
     /**
-      * Returns the point reached when traveling the given distance from start with the given direction
+      * Returns the length of the part of the polygon near the edges in the grid. Parts
+      * further away than one cell of the resolution do not count, nearer ones partially.
       */
-    static GeoDataCoordinates coordinates( const GeoDataCoordinates &start, qreal distance, qreal bearing );
+    static qreal sharedLength( const QPolygonF &polygon, const EdgeGrid &grid );
 
-    /**
-      * Returns the similarity between routeA and routeB. This method is not symmetric, i.e. in
-      * general unidirectionalSimilarity(a,b) != unidirectionalSimilarity(b,a)
-      */
-    static qreal unidirectionalSimilarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB );
+    static qreal length( const QPolygonF &polygon );
 
     /**
       * (Primitive) scoring for routes
@@ -77,9 +124,7 @@ public:
 
     static const GeoDataLineString* waypoints( const GeoDataDocument* document );
 
-    static int nonZero( const QImage &image );
-
-    static QPolygonF polygon( const GeoDataLineString &lineString, qreal x, qreal y, qreal sx, qreal sy );
+    static QPolygonF polygon( const QPolygonF &points, qreal x, qreal y, qreal sx, qreal sy );
 
     /** The currently shown alternative routes (model data) */
     QVector<GeoDataDocument*> m_routes;
@@ -91,137 +136,226 @@ public:
     QElapsedTimer m_responseTime;
 
     int m_currentIndex;
-};
 
+    /** Compares new routes with the existing ones, one after the other */
+    QThreadPool m_similarityPool;
 
-AlternativeRoutesModel::Private::Private() :
-        m_currentIndex( -1 )
+    /** Routes compared in the similarity thread, waiting to be added */
+    QVector<ComparedRoute> m_comparedRoutes;
+    QMutex m_comparedRoutesMutex;
+
+    /** Increased when the model is cleared, to drop routes compared before */
+    int m_generation;
+};
+
+class AlternativeRoutesModel::Private::SimilarityJob : public QRunnable
 {
-    // nothing to do
-}
+public:
+    SimilarityJob( AlternativeRoutesModel *model, const ComparedRoute &route, const Shape &shape, const QVector<Shape> &shapes );
+
+    void run() override;
+
+private:
+    AlternativeRoutesModel *const m_model;
+    ComparedRoute m_route;
+    const Shape m_shape;
+    const QVector<Shape> m_shapes;
+};
 
-int AlternativeRoutesModel::Private::nonZero( const QImage &image )
+AlternativeRoutesModel::Private::SimilarityJob::SimilarityJob( AlternativeRoutesModel *model, const ComparedRoute &route,
+                                                               const Shape &shape, const QVector<Shape> &shapes ) :
+    m_model( model ),
+    m_route( route ),
+    m_shape( shape ),
+    m_shapes( shapes )
 {
-  QRgb const black = qRgb( 0, 0, 0 );
-  int count = 0;
-  for ( int y = 0; y < image.height(); ++y ) {
-      QRgb* destLine = (QRgb*) image.scanLine( y );
-      for ( int x = 0; x < image.width(); ++x ) {
-          count += destLine[x] == black ? 0 : 1;
-      }
-  }
-  return count;
 }
 
-QPolygonF AlternativeRoutesModel::Private::polygon( const GeoDataLineString &lineString, qreal x, qreal y, qreal sx, qreal sy )
+void AlternativeRoutesModel::Private::SimilarityJob::run()
 {
-    QPolygonF poly;
-    for ( int i = 0; i < lineString.size(); ++i ) {
-        poly << QPointF( qAbs( ( lineString)[i].longitude() - x ) * sx,
-                         qAbs( ( lineString)[i].latitude()  - y ) * sy );
+    for ( const Shape &shape: m_shapes ) {
+        m_route.similarities << Private::similarity( m_shape, shape );
     }
-    return poly;
+
+    {
+        QMutexLocker locker( &m_model->d->m_comparedRoutesMutex );
+        m_model->d->m_comparedRoutes << m_route;
+    }
+
+    QMetaObject::invokeMethod( m_model, "addComparedRoutes", Qt::QueuedConnection );
 }
 
-bool AlternativeRoutesModel::Private::filter( const GeoDataDocument* document ) const
+EdgeGrid::EdgeGrid( const QPolygonF &polygon, int size ) :
+    m_polygon( polygon ),
+    m_size( qMax( 1, size / 2 ) ),
+    m_cellSize( 2.0 )
 {
-    for ( int i=0; i<m_routes.size(); ++i ) {
-        qreal similarity = Private::similarity( document, m_routes.at( i ) );
-        if ( similarity > 0.8 ) {
-            return true;
+    // Each edge goes into the cells of its bounding rectangle. The polygon
+    // is inside the grid, so that are at most all cells for long edges.
+    m_cells.resize( m_size * m_size );
+    for ( int i = 1; i < polygon.size(); ++i ) {
+        const int left = cell( qMin( polygon[i-1].x(), polygon[i].x() ) );
+        const int right = cell( qMax( polygon[i-1].x(), polygon[i].x() ) );
+        const int top = cell( qMin( polygon[i-1].y(), polygon[i].y() ) );
+        const int bottom = cell( qMax( polygon[i-1].y(), polygon[i].y() ) );
+        for ( int y = top; y <= bottom; ++y ) {
+            for ( int x = left; x <= right; ++x ) {
+                m_cells[y * m_size + x] << i;
+            }
         }
     }
-
-    return false;
 }
 
-qreal AlternativeRoutesModel::Private::similarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB )
+int EdgeGrid::cell( qreal coordinate ) const
 {
-    return qMax<qreal>( unidirectionalSimilarity( routeA, routeB ),
-                        unidirectionalSimilarity( routeB, routeA ) );
+    return qBound( 0, int( coordinate / m_cellSize ), m_size - 1 );
 }
 
-qreal AlternativeRoutesModel::Private::distance( const GeoDataLineString &wayPoints, const GeoDataCoordinates &position )
+qreal EdgeGrid::distance( const QPointF &point, qreal maximum ) const
 {
-    Q_ASSERT( !wayPoints.isEmpty() );
-    qreal minDistance = 0;
-    for ( int i = 1; i < wayPoints.size(); ++i ) {
-        qreal dist = distance( position, wayPoints.at( i-1 ), wayPoints.at( i ) );
-        if ( minDistance <= 0 || dist < minDistance ) {
-            minDistance = dist;
+    Q_ASSERT( maximum <= m_cellSize );
+
+    // Edges nearer than a cell are in the neighboring cells
+    qreal result = maximum * maximum;
+    const int column = cell( point.x() );
+    const int row = cell( point.y() );
+    for ( int y = qMax( 0, row - 1 ); y <= qMin( m_size - 1, row + 1 ); ++y ) {
+        for ( int x = qMax( 0, column - 1 ); x <= qMin( m_size - 1, column + 1 ); ++x ) {
+            for ( int i: m_cells[y * m_size + x] ) {
+                const QPointF a = m_polygon[i-1];
+                const QPointF edge = m_polygon[i] - a;
+                const qreal length = QPointF::dotProduct( edge, edge );
+                qreal t = length > 0.0 ? QPointF::dotProduct( point - a, edge ) / length : 0.0;
+                t = qBound<qreal>( 0.0, t, 1.0 );
+                const QPointF delta = point - a - t * edge;
+                result = qMin( result, QPointF::dotProduct( delta, delta ) );
+            }
         }
     }
-
-    return minDistance;
+    return qSqrt( result );
 }
 
-qreal AlternativeRoutesModel::Private::bearing( const GeoDataCoordinates &one, const GeoDataCoordinates &two )
+AlternativeRoutesModel::Private::Private() :
+        m_currentIndex( -1 ),
+        m_generation( 0 )
 {
-    qreal delta = two.longitude() - one.longitude();
-    qreal lat1 = one.latitude();
-    qreal lat2 = two.latitude();
-    return fmod( atan2( sin ( delta ) * cos ( lat2 ),
-                 cos( lat1 ) * sin( lat2 ) - sin( lat1 ) * cos( lat2 ) * cos ( delta ) ), 2 * M_PI );
+    m_similarityPool.setMaxThreadCount( 1 );
 }
 
-GeoDataCoordinates AlternativeRoutesModel::Private::coordinates( const GeoDataCoordinates &start, qreal distance, qreal bearing )
+QPolygonF AlternativeRoutesModel::Private::polygon( const QPolygonF &points, qreal x, qreal y, qreal sx, qreal sy )
 {
-    qreal lat1 = start.latitude();
-    qreal lon1 = start.longitude();
-    qreal lat2 = asin( sin( lat1 ) * cos( distance ) + cos( lat1 ) * sin( distance ) * cos( bearing ) );
-    qreal lon2 = lon1 + atan2( sin( bearing ) * sin( distance ) * cos( lat1 ), cos( distance ) - sin( lat1 ) * sin( lat2 ) );
-    return GeoDataCoordinates( lon2, lat2 );
+    QPolygonF poly;
+    poly.reserve( points.size() );
+    for ( const QPointF &point: points ) {
+        qreal lon = point.x() - x;
+        if ( lon < 0.0 ) {
+            // east of the date line in a box crossing it
+            lon += 2 * M_PI;
+        }
+        poly << QPointF( lon * sx, ( y - point.y() ) * sy );
+    }
+    return poly;
 }
 
-qreal AlternativeRoutesModel::Private::distance( const GeoDataCoordinates &satellite, const GeoDataCoordinates &lineA, const GeoDataCoordinates &lineB )
+AlternativeRoutesModel::Private::Shape AlternativeRoutesModel::Private::shape( const GeoDataLineString &lineString )
 {
-    const qreal dist = lineA.sphericalDistanceTo(satellite);
-    qreal bearA = bearing( lineA, satellite );
-    qreal bearB = bearing( lineA, lineB );
-    qreal result = asin( sin ( dist ) * sin( bearB - bearA ) );
-    Q_ASSERT(qMax<qreal>(satellite.sphericalDistanceTo(lineA), satellite.sphericalDistanceTo(lineB)) >= qAbs<qreal>(result));
+    Shape result;
+    result.points.reserve( lineString.size() );
+    for ( int i = 0; i < lineString.size(); ++i ) {
+        result.points << QPointF( lineString.longitudeAt( i ), lineString.latitudeAt( i ) );
+    }
+    result.box = GeoDataLatLonBox::fromLineString( lineString );
+    return result;
+}
 
-    result = acos( cos( dist ) / cos( result ) );
-    /** @todo: This is a naive approach. Look into the maths. */
-    const qreal final = qMin<qreal>(satellite.sphericalDistanceTo(lineA), satellite.sphericalDistanceTo(lineB));
-    if ( result >= 0 && result <= lineA.sphericalDistanceTo(lineB)) {
-        GeoDataCoordinates nearest = coordinates( lineA, result, bearB );
-        return qMin<qreal>(final, satellite.sphericalDistanceTo(nearest));
-    } else {
-        return final;
+bool AlternativeRoutesModel::Private::filter( const GeoDataDocument* document ) const
+{
+    for ( int i=0; i<m_routes.size(); ++i ) {
+        qreal similarity = Private::similarity( document, m_routes.at( i ) );
+        if ( similarity > 0.8 ) {
+            return true;
+        }
     }
+
+    return false;
 }
 
-qreal AlternativeRoutesModel::Private::unidirectionalSimilarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB )
+qreal AlternativeRoutesModel::Private::similarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB )
 {
     const GeoDataLineString* waypointsA = waypoints( routeA );
     const GeoDataLineString* waypointsB = waypoints( routeB );
-    if ( !waypointsA || !waypointsB )
-    {
+    if ( !waypointsA || !waypointsB ) {
         return 0.0;
     }
 
-    QImage image( 64, 64, QImage::Format_ARGB32_Premultiplied );
-    image.fill( qRgb( 0, 0, 0 ) );
-    GeoDataLatLonBox box = GeoDataLatLonBox::fromLineString( *waypointsA );
-    box = box.united( GeoDataLatLonBox::fromLineString( *waypointsB ) );
+    return similarity( shape( *waypointsA ), shape( *waypointsB ) );
+}
+
+qreal AlternativeRoutesModel::Private::similarity( const Shape &routeA, const Shape &routeB )
+{
+    // The routes are compared in a grid over their bounding box. The part
+    // of a route not shared with the other one is as long as the other one
+    // minus the part it shares, so that with lengths measured in cells
+    //   similarity = max( length(A), length(B) ) / length(A united with B)
+    // is the share of the cells of both routes the longer one covers.
+    if ( routeA.points.size() < 2 || routeB.points.size() < 2 ) {
+        return 0.0;
+    }
+    const GeoDataLatLonBox box = routeA.box.united( routeB.box );
     if ( !box.width() || !box.height() ) {
-      return 0.0;
+        return 0.0;
     }
 
-    qreal const sw = image.width() / box.width();
-    qreal const sh = image.height() / box.height();
-
-    QPainter painter( &image );
-    painter.setPen( QColor( Qt::white ) );
+    qreal const sw = Resolution / box.width();
+    qreal const sh = Resolution / box.height();
+    const QPolygonF polygonA = polygon( routeA.points, box.west(), box.north(), sw, sh );
+    const QPolygonF polygonB = polygon( routeB.points, box.west(), box.north(), sw, sh );
+    const qreal lengthA = length( polygonA );
+    const qreal lengthB = length( polygonB );
+    const qreal sharedA = sharedLength( polygonA, EdgeGrid( polygonB, Resolution ) );
+    const qreal sharedB = sharedLength( polygonB, EdgeGrid( polygonA, Resolution ) );
+
+    const qreal unitedA = lengthA + lengthB - sharedB;
+    const qreal unitedB = lengthA + lengthB - sharedA;
+    qreal result = 0.0;
+    if ( unitedA > 0.0 ) {
+        result = lengthA / unitedA;
+    }
+    if ( unitedB > 0.0 ) {
+        result = qMax( result, lengthB / unitedB );
+    }
+    return qBound<qreal>( 0.0, result, 1.0 );
+}
 
-    painter.drawPoints( Private::polygon( *waypointsA, box.west(), box.north(), sw, sh ) );
-    int const countA = Private::nonZero( image );
+qreal AlternativeRoutesModel::Private::length( const QPolygonF &polygon )
+{
+    qreal result = 0.0;
+    for ( int i = 1; i < polygon.size(); ++i ) {
+        const QPointF edge = polygon[i] - polygon[i-1];
+        result += qSqrt( QPointF::dotProduct( edge, edge ) );
+    }
+    return result;
+}
 
-    painter.drawPoints( Private::polygon( *waypointsB, box.west(), box.north(), sw, sh ) );
-    int const countB = Private::nonZero( image );
-    Q_ASSERT( countA <= countB );
-    return countB ? 1.0 - qreal( countB - countA ) / countB : 0;
+qreal AlternativeRoutesModel::Private::sharedLength( const QPolygonF &polygon, const EdgeGrid &grid )
+{
+    // Samples every half cell along the polygon. Samples nearer to the
+    // grid's edges count more, like a point drawn into a bitmap is more
+    // likely to hit a pixel of a nearer line.
+    const qreal step = 0.5;
+    qreal result = 0.0;
+    qreal offset = step / 2;
+    for ( int i = 1; i < polygon.size(); ++i ) {
+        const QPointF a = polygon[i-1];
+        const QPointF edge = polygon[i] - a;
+        const qreal edgeLength = qSqrt( QPointF::dotProduct( edge, edge ) );
+        for ( ; offset < edgeLength; offset += step ) {
+            const qreal distance = grid.distance( a + edge * ( offset / edgeLength ), 1.0 );
+            result += step * ( 1.0 - distance );
+        }
+        offset -= edgeLength;
+    }
+    return result;
 }
 
 bool AlternativeRoutesModel::Private::higherScore( const GeoDataDocument* one, const GeoDataDocument* two )
@@ -299,7 +433,12 @@ AlternativeRoutesModel::AlternativeRoutesModel( QObject *parent ) :
 
 AlternativeRoutesModel::~AlternativeRoutesModel()
 {
+    d->m_similarityPool.waitForDone();
     clear();
+    // routes compared after the last addComparedRoutes() call
+    for ( const Private::ComparedRoute &compared: d->m_comparedRoutes ) {
+        delete compared.document;
+    }
     delete d;
 }
 
@@ -376,17 +515,23 @@ void AlternativeRoutesModel::addRoute( GeoDataDocument* document, WritePolicy po
             }
         }
 
-        for ( int i=0; i<d->m_routes.size(); ++i ) {
-            qreal similarity = Private::similarity( document, d->m_routes.at( i ) );
-            if ( similarity > 0.8 ) {
-                if ( Private::higherScore( document, d->m_routes.at( i ) ) ) {
-                    d->m_routes[i] = document;
-                    QModelIndex changed = index( i );
-                    emit dataChanged( changed, changed );
+        const GeoDataLineString* lineString = Private::waypoints( document );
+        if ( lineString && !d->m_routes.isEmpty() ) {
+            // Comparing long routes takes a while, so that happens in the
+            // similarity thread and addComparedRoutes() adds the route
+            Private::ComparedRoute compared;
+            compared.document = document;
+            compared.generation = d->m_generation;
+            QVector<Private::Shape> shapes;
+            for ( const GeoDataDocument* route: d->m_routes ) {
+                const GeoDataLineString* routeLineString = Private::waypoints( route );
+                if ( routeLineString ) {
+                    compared.routes << route;
+                    shapes << Private::shape( *routeLineString );
                 }
-
-                return;
             }
+            d->m_similarityPool.start( new Private::SimilarityJob( this, compared, Private::shape( *lineString ), shapes ) );
+            return;
         }
     }
 
@@ -396,11 +541,60 @@ void AlternativeRoutesModel::addRoute( GeoDataDocument* document, WritePolicy po
     endInsertRows();
 }
 
+void AlternativeRoutesModel::addComparedRoutes()
+{
+    QVector<Private::ComparedRoute> comparedRoutes;
+    {
+        QMutexLocker locker( &d->m_comparedRoutesMutex );
+        comparedRoutes.swap( d->m_comparedRoutes );
+    }
+
+    for ( const Private::ComparedRoute &compared: comparedRoutes ) {
+        GeoDataDocument* document = compared.document;
+        if ( compared.generation != d->m_generation ) {
+            delete document;
+            continue;
+        }
+
+        int similar = -1;
+        for ( int i=0; i<compared.routes.size() && similar < 0; ++i ) {
+            if ( compared.similarities[i] > 0.8 ) {
+                similar = d->m_routes.indexOf( const_cast<GeoDataDocument*>( compared.routes[i] ) );
+            }
+        }
+
+        // Routes added while this one was compared
+        for ( int i=0; i<d->m_routes.size() && similar < 0; ++i ) {
+            if ( !compared.routes.contains( d->m_routes.at( i ) ) && Private::similarity( document, d->m_routes.at( i ) ) > 0.8 ) {
+                similar = i;
+            }
+        }
+
+        if ( similar >= 0 ) {
+            if ( Private::higherScore( document, d->m_routes.at( similar ) ) ) {
+                d->m_routes[similar] = document;
+                QModelIndex changed = index( similar );
+                emit dataChanged( changed, changed );
+            }
+        } else {
+            const int affected = d->m_routes.size();
+            beginInsertRows( QModelIndex(), affected, affected );
+            d->m_routes.push_back( document );
+            endInsertRows();
+        }
+    }
+}
+
 const GeoDataLineString* AlternativeRoutesModel::waypoints( const GeoDataDocument* document )
 {
     return Private::waypoints( document );
 }
 
+qreal AlternativeRoutesModel::similarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB )
+{
+    return Private::similarity( Private::shape( routeA ), Private::shape( routeB ) );
+}
+
 void AlternativeRoutesModel::setCurrentRoute( int index )
 {
     if ( index >= 0 && index < rowCount() && d->m_currentIndex != index ) {
@@ -422,6 +616,8 @@ const GeoDataDocument *AlternativeRoutesModel::currentRoute() const
 
 void AlternativeRoutesModel::clear()
 {
+    // Routes still compared are dropped when they arrive
+    ++d->m_generation;
     beginResetModel();
     QVector<GeoDataDocument*> routes = d->m_routes;
     d->m_currentIndex = -1;
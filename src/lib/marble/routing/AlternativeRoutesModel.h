@@ -75,6 +75,13 @@ public:
     /** Returns the waypoints contained in the route as a linestring */
     static const GeoDataLineString* waypoints( const GeoDataDocument* document );
 
+    /**
+      * Returns how much the two routes overlap in the range of [0..1]. Routes above
+      * 0.8 are considered the same route by addRoute(). The direction of the routes
+      * is not taken into account.
+      */
+    static qreal similarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB );
+
 public Q_SLOTS:
     void setCurrentRoute( int index );
 
@@ -85,6 +92,8 @@ Q_SIGNALS:
 private Q_SLOTS:
     void addRestrainedRoutes();
 
+    void addComparedRoutes();
+
 private:
     class Private;
     Private *const d;
@@ -5,6 +5,8 @@
 
 #include "Route.h"
 
+#include "MarbleGlobal.h"
+
 namespace Marble
 {
 
@@ -97,28 +99,20 @@ GeoDataCoordinates Route::position() const
 void Route::updatePosition() const
 {
     if ( !m_segments.isEmpty() ) {
-        if ( m_closestSegmentIndex < 0 || m_closestSegmentIndex >= m_segments.size() ) {
-            m_closestSegmentIndex = 0;
-        }
-
-        qreal distance = m_segments[m_closestSegmentIndex].distanceTo( m_position, m_currentWaypoint, m_positionOnRoute );
-        QList<int> candidates;
-
-        for ( int i=0; i<m_segments.size(); ++i ) {
-            if ( i != m_closestSegmentIndex && m_segments[i].minimalDistanceTo( m_position ) <= distance ) {
-                candidates << i;
-            }
+        if ( m_segmentIndex.size() != m_segments.size() ) {
+            m_segmentIndex.setSegments( m_segments );
         }
 
+        // Map matching: search outward from the segment matched last, the
+        // index skips all segments which cannot be closer
         GeoDataCoordinates closest, interpolated;
-        for( int i: candidates ) {
-            qreal const dist = m_segments[i].distanceTo( m_position, closest, interpolated );
-            if ( distance < 0.0 || dist < distance ) {
-                distance = dist;
-                m_closestSegmentIndex = i;
-                m_positionOnRoute = interpolated;
-                m_currentWaypoint = closest;
-            }
+        auto const distance = [&]( int index ) {
+            return m_segments[index].distanceTo( m_position, closest, interpolated ) / EARTH_RADIUS;
+        };
+        int const index = m_segmentIndex.nearest( m_position, distance, 0, m_closestSegmentIndex );
+        if ( index >= 0 ) {
+            m_closestSegmentIndex = index;
+            m_segments[index].distanceTo( m_position, m_currentWaypoint, m_positionOnRoute );
         }
     }
 
@@ -6,6 +6,7 @@
 #ifndef MARBLE_ROUTE_H
 #define MARBLE_ROUTE_H
 
+#include "RouteIndex.h"
 #include "RouteSegment.h"
 #include "GeoDataLatLonBox.h"
 
@@ -56,6 +57,8 @@ private:
 
     QVector<RouteSegment> m_segments;
 
+    mutable RouteIndex m_segmentIndex;
+
     GeoDataLineString m_path;
 
     GeoDataLineString m_turnPoints;
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "RouteIndex.h"
+
+#include "GeoDataLineString.h"
+#include "RouteSegment.h"
+
+#include <qmath.h>
+
+namespace Marble
+{
+
+RouteIndex::RouteIndex() :
+    m_size( 0 )
+{
+    // nothing to do
+}
+
+void RouteIndex::setSegments( const QVector<RouteSegment> &segments )
+{
+    QVector<Box> parts;
+    parts.reserve( segments.size() );
+    for ( const RouteSegment &segment: segments ) {
+        // RouteSegment::distanceTo() interpolates linearly in longitude and
+        // latitude, so the box has to cover the whole lon/lat rectangle
+        // of the path, and does not wrap at the date line.
+        const GeoDataLineString &path = segment.path();
+        if ( path.isEmpty() ) {
+            parts << lonLatBox( -M_PI, M_PI, -M_PI / 2, M_PI / 2 );
+            continue;
+        }
+        qreal west = path.longitudeAt( 0 );
+        qreal east = west;
+        qreal south = path.latitudeAt( 0 );
+        qreal north = south;
+        for ( int i = 1; i < path.size(); ++i ) {
+            const qreal lon = path.longitudeAt( i );
+            const qreal lat = path.latitudeAt( i );
+            west = qMin( west, lon );
+            east = qMax( east, lon );
+            south = qMin( south, lat );
+            north = qMax( north, lat );
+        }
+        parts << lonLatBox( west, east, south, north );
+    }
+    build( parts );
+}
+
+void RouteIndex::setPoints( const GeoDataLineString &path )
+{
+    QVector<Box> parts;
+    parts.reserve( path.size() );
+    for ( int i = 0; i < path.size(); ++i ) {
+        parts << pointBox( path.longitudeAt( i ), path.latitudeAt( i ) );
+    }
+    build( parts );
+}
+
+void RouteIndex::clear()
+{
+    m_levels.clear();
+    m_size = 0;
+}
+
+int RouteIndex::size() const
+{
+    return m_size;
+}
+
+bool RouteIndex::isEmpty() const
+{
+    return m_size == 0;
+}
+
+void RouteIndex::build( const QVector<Box> &parts )
+{
+    clear();
+    m_size = parts.size();
+    if ( parts.isEmpty() ) {
+        return;
+    }
+
+    QVector<Box> leaves;
+    leaves.reserve( ( parts.size() + LeafSize - 1 ) / LeafSize );
+    for ( int i = 0; i < parts.size(); i += LeafSize ) {
+        Box box = parts[i];
+        const int end = qMin( i + LeafSize, int( parts.size() ) );
+        for ( int j = i + 1; j < end; ++j ) {
+            unite( box, parts[j] );
+        }
+        leaves << box;
+    }
+    m_levels << leaves;
+
+    while ( m_levels.last().size() > 1 ) {
+        const QVector<Box> &children = m_levels.last();
+        QVector<Box> nodes;
+        nodes.reserve( ( children.size() + 1 ) / 2 );
+        for ( int i = 0; i < children.size(); i += 2 ) {
+            Box box = children[i];
+            if ( i + 1 < children.size() ) {
+                unite( box, children[i + 1] );
+            }
+            nodes << box;
+        }
+        m_levels << nodes;
+    }
+}
+
+void RouteIndex::unitVector( qreal lon, qreal lat, qreal vector[3] )
+{
+    const qreal cosLat = qCos( lat );
+    vector[0] = cosLat * qCos( lon );
+    vector[1] = cosLat * qSin( lon );
+    vector[2] = qSin( lat );
+}
+
+RouteIndex::Box RouteIndex::pointBox( qreal lon, qreal lat )
+{
+    Box box;
+    unitVector( lon, lat, box.min );
+    for ( int i = 0; i < 3; ++i ) {
+        box.max[i] = box.min[i];
+    }
+    return box;
+}
+
+RouteIndex::Box RouteIndex::lonLatBox( qreal west, qreal east, qreal south, qreal north )
+{
+    // The extremes of cos(lon) and sin(lon) are at the ends of the
+    // longitude range unless it contains the angle of the extremum, the
+    // ones of cos(lat) at the ends unless the range contains the equator.
+    const qreal cosWest = qCos( west );
+    const qreal cosEast = qCos( east );
+    const qreal sinWest = qSin( west );
+    const qreal sinEast = qSin( east );
+    const qreal cosLonMin = ( west <= -M_PI || east >= M_PI ) ? -1.0 : qMin( cosWest, cosEast );
+    const qreal cosLonMax = ( west <= 0.0 && east >= 0.0 ) ? 1.0 : qMax( cosWest, cosEast );
+    const qreal sinLonMin = ( west <= -M_PI / 2 && east >= -M_PI / 2 ) ? -1.0 : qMin( sinWest, sinEast );
+    const qreal sinLonMax = ( west <= M_PI / 2 && east >= M_PI / 2 ) ? 1.0 : qMax( sinWest, sinEast );
+    const qreal cosLatMin = qMin( qCos( south ), qCos( north ) );
+    const qreal cosLatMax = ( south <= 0.0 && north >= 0.0 ) ? 1.0 : qMax( qCos( south ), qCos( north ) );
+
+    // cos(lat) is not negative, so the products are extreme at the
+    // extremes of their factors
+    Box box;
+    box.min[0] = qMin( qMin( cosLatMin * cosLonMin, cosLatMax * cosLonMin ),
+                       qMin( cosLatMin * cosLonMax, cosLatMax * cosLonMax ) );
+    box.max[0] = qMax( qMax( cosLatMin * cosLonMin, cosLatMax * cosLonMin ),
+                       qMax( cosLatMin * cosLonMax, cosLatMax * cosLonMax ) );
+    box.min[1] = qMin( qMin( cosLatMin * sinLonMin, cosLatMax * sinLonMin ),
+                       qMin( cosLatMin * sinLonMax, cosLatMax * sinLonMax ) );
+    box.max[1] = qMax( qMax( cosLatMin * sinLonMin, cosLatMax * sinLonMin ),
+                       qMax( cosLatMin * sinLonMax, cosLatMax * sinLonMax ) );
+    box.min[2] = qSin( south );
+    box.max[2] = qSin( north );
+    return box;
+}
+
+void RouteIndex::unite( Box &box, const Box &other )
+{
+    for ( int i = 0; i < 3; ++i ) {
+        box.min[i] = qMin( box.min[i], other.min[i] );
+        box.max[i] = qMax( box.max[i], other.max[i] );
+    }
+}
+
+qreal RouteIndex::chordSquared( const Box &box, const qreal point[3] )
+{
+    qreal result = 0.0;
+    for ( int i = 0; i < 3; ++i ) {
+        const qreal delta = point[i] < box.min[i] ? box.min[i] - point[i]
+                          : point[i] > box.max[i] ? point[i] - box.max[i] : 0.0;
+        result += delta * delta;
+    }
+    return result;
+}
+
+qreal RouteIndex::chordSquared( qreal distance )
+{
+    // The chord of an angular distance on the unit sphere, with some room
+    // for rounding errors to keep parts of the same distance
+    const qreal chord = 2.0 * qSin( qMin<qreal>( distance, M_PI ) / 2.0 );
+    return chord * chord * ( 1.0 + 1e-9 ) + 1e-18;
+}
+
+}
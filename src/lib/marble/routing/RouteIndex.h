@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_ROUTEINDEX_H
+#define MARBLE_ROUTEINDEX_H
+
+#include "marble_export.h"
+
+#include "GeoDataCoordinates.h"
+
+#include <QVector>
+
+#include <limits>
+
+namespace Marble
+{
+
+class GeoDataLineString;
+class RouteSegment;
+
+/**
+ * @brief A spatial index over the parts of a route
+ *
+ * The parts are either the segments of a route or the points of its path.
+ * Consecutive parts of a route are close to each other, so the index is a
+ * bounding volume hierarchy over their order: each leaf covers a few
+ * consecutive parts and each node above the two nodes below it.
+ *
+ * The bounding volumes are boxes around the unit vectors of the parts. The
+ * distance to a box is a lower bound of the distance to all parts inside,
+ * also for parts crossing the date line or close to the poles, so nodes
+ * further away than the nearest part found so far can be skipped.
+ */
+class MARBLE_EXPORT RouteIndex
+{
+public:
+    RouteIndex();
+
+    /**
+     * Indexes the given segments. The bounds of a segment cover all points
+     * RouteSegment::distanceTo() measures the distance to.
+     */
+    void setSegments( const QVector<RouteSegment> &segments );
+
+    /**
+     * Indexes the points of the given path.
+     */
+    void setPoints( const GeoDataLineString &path );
+
+    void clear();
+
+    /**
+     * Returns the number of indexed parts.
+     */
+    int size() const;
+
+    bool isEmpty() const;
+
+    /**
+     * Returns the index of the part nearest to the given point, or -1 if
+     * there are no parts starting at index @p first. Of parts with the same
+     * distance, @p hint is returned, then the parts following it and then the
+     * ones before it, each nearest first. So where a route overlaps itself,
+     * like on the way to a dead end and back, the match follows the route.
+     *
+     * @param distance a function returning the angular distance of the
+     * point to the part with the given index in radian
+     * @param first the index of the first part to consider
+     * @param hint the index of a part which is likely near the point, like
+     * the one matched for the previous position. Searching starts there.
+     */
+    template<class Distance>
+    int nearest( const GeoDataCoordinates &point, const Distance &distance,
+                 int first = 0, int hint = -1 ) const;
+
+private:
+    // The number of parts covered by a leaf
+    enum { LeafSize = 8 };
+
+    struct Box {
+        qreal min[3];
+        qreal max[3];
+    };
+
+    template<class Distance>
+    struct Search {
+        qreal point[3];
+        const Distance &distance;
+        int first;
+        int hint;
+        int index;
+        qreal minimum;
+        qreal chordSquared;
+    };
+
+    static void unitVector( qreal lon, qreal lat, qreal vector[3] );
+    static Box pointBox( qreal lon, qreal lat );
+    static Box lonLatBox( qreal west, qreal east, qreal south, qreal north );
+    static void unite( Box &box, const Box &other );
+    static qreal chordSquared( const Box &box, const qreal point[3] );
+    static qreal chordSquared( qreal distance );
+
+    void build( const QVector<Box> &parts );
+
+    // Orders equally near parts, see nearest()
+    int tieRank( int part, int hint ) const;
+
+    template<class Distance>
+    void visit( Search<Distance> &search, int part ) const;
+
+    template<class Distance>
+    void search( Search<Distance> &search, int level, int node ) const;
+
+    // The boxes of the leaves come first, the root is the last level
+    QVector<QVector<Box> > m_levels;
+
+    int m_size;
+};
+
+template<class Distance>
+int RouteIndex::nearest( const GeoDataCoordinates &point, const Distance &distance,
+                         int first, int hint ) const
+{
+    if ( first < 0 ) {
+        first = 0;
+    }
+    if ( first >= m_size ) {
+        return -1;
+    }
+
+    Search<Distance> search = { { 0.0, 0.0, 0.0 }, distance, first, hint, -1,
+                                std::numeric_limits<qreal>::max(),
+                                std::numeric_limits<qreal>::max() };
+    unitVector( point.longitude(), point.latitude(), search.point );
+
+    // The part matched last is usually still the nearest one, and a close
+    // first match lets the search skip most of the hierarchy.
+    if ( hint >= first && hint < m_size ) {
+        visit( search, hint );
+    }
+
+    const int root = m_levels.size() - 1;
+    for ( int node = 0; node < m_levels[root].size(); ++node ) {
+        this->search( search, root, node );
+    }
+
+    return search.index;
+}
+
+inline int RouteIndex::tieRank( int part, int hint ) const
+{
+    return part >= hint ? part - hint : m_size + hint - part;
+}
+
+template<class Distance>
+void RouteIndex::visit( Search<Distance> &search, int part ) const
+{
+    const qreal distance = search.distance( part );
+    if ( !( distance <= search.minimum ) ) {
+        return;
+    }
+
+    if ( distance < search.minimum || tieRank( part, search.hint ) < tieRank( search.index, search.hint ) ) {
+        search.index = part;
+        search.minimum = distance;
+        search.chordSquared = chordSquared( distance );
+    }
+}
+
+template<class Distance>
+void RouteIndex::search( Search<Distance> &search, int level, int node ) const
+{
+    const int span = LeafSize << level;
+    const int begin = node * span;
+    const int end = qMin( begin + span, m_size );
+    if ( end <= search.first ) {
+        return;
+    }
+    if ( chordSquared( m_levels[level][node], search.point ) > search.chordSquared ) {
+        return;
+    }
+
+    if ( level == 0 ) {
+        for ( int part = qMax( begin, search.first ); part < end; ++part ) {
+            visit( search, part );
+        }
+        return;
+    }
+
+    // Continue with the nearer child first to find a close part early
+    const QVector<Box> &children = m_levels[level - 1];
+    const int left = 2 * node;
+    const int right = left + 1;
+    if ( right >= children.size() ) {
+        this->search( search, level - 1, left );
+    }
+    else if ( chordSquared( children[right], search.point ) < chordSquared( children[left], search.point ) ) {
+        this->search( search, level - 1, right );
+        this->search( search, level - 1, left );
+    }
+    else {
+        this->search( search, level - 1, left );
+        this->search( search, level - 1, right );
+    }
+}
+
+}
+
+#endif
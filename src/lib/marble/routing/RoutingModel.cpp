@@ -8,6 +8,7 @@
 #include "Planet.h"
 #include "PlanetFactory.h"
 #include "Route.h"
+#include "RouteIndex.h"
 #include "RouteRequest.h"
 #include "PositionTracking.h"
 #include "MarbleGlobal.h"
@@ -32,18 +33,29 @@ public:
 
     Route m_route;
 
+    // The points of the route path, for rightNeighbor()
+    RouteIndex m_pathIndex;
+
+    // The path points nearest to the via points of the route request
+    QVector<GeoDataCoordinates> m_viaPoints;
+    QVector<int> m_viaPointMapping;
+    int m_waypoint;
+
     PositionTracking *const m_positionTracking;
     RouteRequest* const m_request;
     QHash<int, QByteArray> m_roleNames;
     RouteDeviation m_deviation;
 
     void updateViaPoints( const GeoDataCoordinates &position );
+
+    void updateViaPointMapping( const RouteRequest *route );
 };
 
 RoutingModelPrivate::RoutingModelPrivate(PositionTracking *positionTracking, RouteRequest *request) :
     m_positionTracking(positionTracking),
     m_request(request),
-    m_deviation(Unknown)
+    m_deviation(Unknown),
+    m_waypoint(-1)
 {
     // nothing to do
 }
@@ -61,6 +73,37 @@ void RoutingModelPrivate::updateViaPoints( const GeoDataCoordinates &position )
     }
 }
 
+void RoutingModelPrivate::updateViaPointMapping( const RouteRequest *route )
+{
+    QVector<GeoDataCoordinates> viaPoints;
+    viaPoints.reserve( route->size() );
+    for ( int i=0; i<route->size(); ++i ) {
+        viaPoints << route->at( i );
+    }
+    if ( viaPoints == m_viaPoints && m_viaPointMapping.size() == viaPoints.size() ) {
+        return;
+    }
+    m_viaPoints = viaPoints;
+
+    const GeoDataLineString &points = m_route.path();
+    m_viaPointMapping.resize( viaPoints.size() );
+
+    // Force first mapping point to match the route start
+    m_viaPointMapping[0] = 0;
+
+    // Calculate the mapping between waypoints and via points
+    // Each via point maps to the nearest waypoint after the previous one
+    // to avoid getting stuck in local minima
+    for ( int j=1; j<viaPoints.size()-1; ++j ) {
+        const GeoDataCoordinates &viaPoint = viaPoints[j];
+        auto const distance = [&]( int i ) { return points.at( i ).sphericalDistanceTo( viaPoint ); };
+        m_viaPointMapping[j] = qMax( m_viaPointMapping[j-1], m_pathIndex.nearest( viaPoint, distance, m_viaPointMapping[j-1] ) );
+    }
+
+    // Force last mapping point to match the route destination
+    m_viaPointMapping[viaPoints.size()-1] = points.size()-1;
+}
+
 RoutingModel::RoutingModel(RouteRequest *request, PositionTracking *positionTracking, QObject *parent) :
     QAbstractListModel(parent),
     d(new RoutingModelPrivate(positionTracking, request))
@@ -149,6 +192,10 @@ void RoutingModel::setRoute( const Route &route )
 {
     d->m_route = route;
     d->m_deviation = RoutingModelPrivate::Unknown;
+    d->m_pathIndex.setPoints( route.path() );
+    d->m_viaPoints.clear();
+    d->m_viaPointMapping.clear();
+    d->m_waypoint = -1;
 
     beginResetModel();
     endResetModel();
@@ -207,6 +254,10 @@ void RoutingModel::exportGpx( QIODevice *device ) const
 void RoutingModel::clear()
 {
     d->m_route = Route();
+    d->m_pathIndex.clear();
+    d->m_viaPoints.clear();
+    d->m_viaPointMapping.clear();
+    d->m_waypoint = -1;
     beginResetModel();
     endResetModel();
     emit currentRouteChanged();
@@ -221,45 +272,21 @@ int RoutingModel::rightNeighbor( const GeoDataCoordinates &position, RouteReques
         return route->size() - 1;
     }
 
-    // Generate an ordered list of all waypoints
-    GeoDataLineString points = d->m_route.path();
-    QMap<int,int> mapping;
-
-    // Force first mapping point to match the route start
-    mapping[0] = 0;
-
-    // Calculate the mapping between waypoints and via points
-    // Need two for loops to avoid getting stuck in local minima
-    for ( int j=1; j<route->size()-1; ++j ) {
-        qreal minDistance = -1.0;
-        for ( int i=mapping[j-1]; i<points.size(); ++i ) {
-            const qreal distance = points[i].sphericalDistanceTo(route->at(j));
-            if (minDistance < 0.0 || distance < minDistance ) {
-                mapping[j] = i;
-                minDistance = distance;
-            }
-        }
+    // The index of the path points is built in setRoute()
+    const GeoDataLineString &points = d->m_route.path();
+    if ( points.isEmpty() ) {
+        return route->size()-1;
     }
+    d->updateViaPointMapping( route );
 
     // Determine waypoint with minimum distance to the provided position
-    qreal minWaypointDistance = -1.0;
-    int waypoint=0;
-    for ( int i=0; i<points.size(); ++i ) {
-        const qreal waypointDistance = points[i].sphericalDistanceTo(position);
-        if ( minWaypointDistance < 0.0 || waypointDistance < minWaypointDistance ) {
-            minWaypointDistance = waypointDistance;
-            waypoint = i;
-        }
-    }
-
-    // Force last mapping point to match the route destination
-    mapping[route->size()-1] = points.size()-1;
+    auto const distance = [&]( int i ) { return points.at( i ).sphericalDistanceTo( position ); };
+    int const waypoint = d->m_pathIndex.nearest( position, distance, 0, d->m_waypoint );
+    d->m_waypoint = waypoint;
 
     // Determine neighbor based on the mapping
-    QMap<int, int>::const_iterator iter = mapping.constBegin();
-    for ( ; iter != mapping.constEnd(); ++iter ) {
-        if ( iter.value() > waypoint ) {
-            int index = iter.key();
+    for ( int index=0; index<d->m_viaPointMapping.size(); ++index ) {
+        if ( d->m_viaPointMapping[index] > waypoint ) {
             Q_ASSERT( index >= 0 && index <= route->size() );
             return index;
         }
@@ -13,12 +13,48 @@
 #include <QFile>
 #include <QDataStream>
 #include <QSet>
+#include <QtEndian>
+
+#include <cstring>
 
 namespace Marble
 {
 
 const quint32 MarbleMagicNumber = 0x31415926;
 
+// Version 16 is laid out to be read in place from a memory mapping, see
+// tools/kml2cache. Magic number and version are big endian like in older
+// versions, all other values are little endian:
+//   header   quint32 placemark count, quint32 string count
+//   records  placemark count * 64 bytes:
+//            double lon, lat, alt, area; qint64 population;
+//            quint32 name, role, description, country code, state (string indices);
+//            qint16 gmt; qint8 dst; quint8 reserved
+//   strings  string count * ( quint32 offset, quint32 length ) in UTF-16 code
+//            units into the UTF-16 characters which follow. Each distinct
+//            string is stored once, index 0 is the empty string.
+const qint32 MappedCacheVersion = 16;
+const int MappedHeaderSize = 16;
+const int MappedRecordSize = 64;
+
+namespace
+{
+
+inline quint32 readUInt32( const uchar *data )
+{
+    return qFromLittleEndian<quint32>( data );
+}
+
+inline double readDouble( const uchar *data )
+{
+    const quint64 bits = qFromLittleEndian<quint64>( data );
+    double value;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+}
+
 CacheRunner::CacheRunner(QObject *parent) :
     ParsingRunner(parent)
 {
@@ -55,6 +91,23 @@ GeoDataDocument* CacheRunner::parseFile( const QString &fileName, DocumentRole r
         mDebug() << error;
         return nullptr;
     }
+
+    if ( version > MappedCacheVersion ) {
+        error = QStringLiteral("Bad cache file %1: Version %2 is too new, need %3 or older").arg(fileName).arg(version).arg(MappedCacheVersion);
+        mDebug() << error;
+        return nullptr;
+    }
+
+    if ( version == MappedCacheVersion ) {
+        GeoDataDocument *document = parseMappedFile( file, role, error );
+        if ( !document ) {
+            error = QStringLiteral("Bad cache file %1: %2").arg(fileName, error);
+            mDebug() << error;
+            return nullptr;
+        }
+        document->setFileName( fileName );
+        return document;
+    }
     /*
       if (version > 002) {
       qDebug( "Bad file - too new!" );
@@ -114,6 +167,97 @@ GeoDataDocument* CacheRunner::parseFile( const QString &fileName, DocumentRole r
     return document;
 }
 
+GeoDataDocument* CacheRunner::parseMappedFile( QFile &file, DocumentRole role, QString& error )
+{
+    // The mapping saves copying the file, the records are decoded in place.
+    const qint64 size = file.size();
+    QByteArray buffer;
+    const uchar *data = file.map( 0, size );
+    if ( !data ) {
+        file.seek( 0 );
+        buffer = file.readAll();
+        data = reinterpret_cast<const uchar *>( buffer.constData() );
+    }
+
+    if ( size < MappedHeaderSize ) {
+        error = QStringLiteral("Truncated header");
+        return nullptr;
+    }
+
+    const quint32 placemarkCount = readUInt32( data + 8 );
+    const quint32 stringCount = readUInt32( data + 12 );
+    const qint64 stringIndexOffset = MappedHeaderSize + qint64( placemarkCount ) * MappedRecordSize;
+    const qint64 charactersOffset = stringIndexOffset + qint64( stringCount ) * 8;
+    if ( stringCount == 0 || charactersOffset > size ) {
+        error = QStringLiteral("Truncated placemark records");
+        return nullptr;
+    }
+
+    // Decoding every distinct string once replaces the string pool of the
+    // older versions, the placemarks share the decoded strings.
+    const qint64 characterCount = ( size - charactersOffset ) / 2;
+    const uchar *const characters = data + charactersOffset;
+    QVector<QString> strings( stringCount );
+    for ( quint32 i = 0; i < stringCount; ++i ) {
+        const quint32 offset = readUInt32( data + stringIndexOffset + 8 * i );
+        const quint32 length = readUInt32( data + stringIndexOffset + 8 * i + 4 );
+        if ( qint64( offset ) + length > characterCount ) {
+            error = QStringLiteral("String %1 out of range").arg(i);
+            return nullptr;
+        }
+
+        QString &string = strings[i];
+        string.resize( length );
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        std::memcpy( string.data(), characters + 2 * qint64( offset ), 2 * length );
+#else
+        QChar *const chars = string.data();
+        for ( quint32 j = 0; j < length; ++j ) {
+            chars[j] = QChar( qFromLittleEndian<quint16>( characters + 2 * ( qint64( offset ) + j ) ) );
+        }
+#endif
+    }
+
+    // All placemarks are created here rather than on demand: search, routing
+    // and the MarblePlacemarkModel proxy work on the GeoDataPlacemark objects
+    // of the document, so only the QDataStream decoding is saved.
+    GeoDataDocument *document = new GeoDataDocument();
+    document->setDocumentRole( role );
+
+    const QString gmtId = QStringLiteral("gmt");
+    const QString dstId = QStringLiteral("dst");
+
+    for ( quint32 i = 0; i < placemarkCount; ++i ) {
+        const uchar *const record = data + MappedHeaderSize + qint64( i ) * MappedRecordSize;
+
+        quint32 stringIndices[5];
+        for ( int j = 0; j < 5; ++j ) {
+            stringIndices[j] = readUInt32( record + 40 + 4 * j );
+            if ( stringIndices[j] >= stringCount ) {
+                error = QStringLiteral("Placemark %1 refers to unknown string").arg(i);
+                delete document;
+                return nullptr;
+            }
+        }
+
+        GeoDataPlacemark *mark = new GeoDataPlacemark;
+        mark->setName( strings[stringIndices[0]] );
+        mark->setCoordinate( readDouble( record ), readDouble( record + 8 ), readDouble( record + 16 ) );
+        mark->setRole( strings[stringIndices[1]] );
+        mark->setDescription( strings[stringIndices[2]] );
+        mark->setCountryCode( strings[stringIndices[3]] );
+        mark->setState( strings[stringIndices[4]] );
+        mark->setArea( readDouble( record + 24 ) );
+        mark->setPopulation( qFromLittleEndian<qint64>( record + 32 ) );
+        mark->extendedData().addValue(GeoDataData(gmtId, int(qFromLittleEndian<qint16>( record + 60 ))));
+        mark->extendedData().addValue(GeoDataData(dstId, int(qint8( record[62] ))));
+
+        document->append( mark );
+    }
+
+    return document;
+}
+
 }
 
 #include "moc_CacheRunner.cpp"
@@ -7,6 +7,8 @@
 
 #include "ParsingRunner.h"
 
+class QFile;
+
 namespace Marble
 {
 
@@ -18,6 +20,8 @@ public:
     ~CacheRunner() override;
     GeoDataDocument* parseFile( const QString &fileName, DocumentRole role, QString& error ) override;
 
+private:
+    static GeoDataDocument* parseMappedFile( QFile &file, DocumentRole role, QString& error );
 };
 
 }
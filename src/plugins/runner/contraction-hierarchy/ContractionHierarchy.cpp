@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "ContractionHierarchy.h"
+
+#include "MarbleDebug.h"
+
+#include <QHash>
+#include <qmath.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace Marble
+{
+
+namespace
+{
+
+struct Label {
+    quint32 distance;
+    quint32 parent;
+    const ContractionHierarchy::Edge *edge;
+};
+
+struct Arc {
+    quint32 from;
+    quint32 to;
+    const ContractionHierarchy::Edge *edge;
+};
+
+// The distance of a node and the node, nearest first
+typedef QPair<quint32, quint32> QueueEntry;
+typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > Queue;
+
+struct Search {
+    QHash<quint32, Label> labels;
+    Queue queue;
+    quint16 flag;
+};
+
+}
+
+ContractionHierarchy::ContractionHierarchy() :
+    m_header( nullptr ),
+    m_nodes( nullptr ),
+    m_firstEdges( nullptr ),
+    m_edges( nullptr ),
+    m_stringOffsets( nullptr ),
+    m_stringData( nullptr )
+{
+    // nothing to do
+}
+
+ContractionHierarchy::~ContractionHierarchy()
+{
+    unload();
+}
+
+void ContractionHierarchy::unload()
+{
+    m_header = nullptr;
+    m_nodes = nullptr;
+    m_firstEdges = nullptr;
+    m_edges = nullptr;
+    m_stringOffsets = nullptr;
+    m_stringData = nullptr;
+    // closing the file unmaps it
+    m_file.close();
+}
+
+bool ContractionHierarchy::load( const QString &fileName )
+{
+    unload();
+    m_file.setFileName( fileName );
+    if ( !m_file.open( QIODevice::ReadOnly ) ) {
+        mDebug() << "Cannot open contraction hierarchy" << fileName;
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    if ( size < qint64( sizeof( Header ) ) ) {
+        mDebug() << "Contraction hierarchy" << fileName << "is truncated";
+        unload();
+        return false;
+    }
+
+    const uchar *data = m_file.map( 0, size );
+    if ( !data ) {
+        mDebug() << "Cannot map contraction hierarchy" << fileName;
+        unload();
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header *>( data );
+    if ( std::memcmp( header->magic, "MARBLECH", sizeof( header->magic ) ) != 0 || header->version != Version ) {
+        mDebug() << fileName << "is no contraction hierarchy of version" << Version;
+        unload();
+        return false;
+    }
+
+    const qint64 nodeCount = header->nodeCount;
+    const qint64 stringCount = header->stringCount;
+    const qint64 nodesOffset = sizeof( Header );
+    const qint64 firstEdgesOffset = nodesOffset + nodeCount * sizeof( Node );
+    const qint64 edgesOffset = firstEdgesOffset + ( nodeCount + 1 ) * sizeof( quint32 );
+    const qint64 stringOffsetsOffset = edgesOffset + qint64( header->edgeCount ) * sizeof( Edge );
+    const qint64 stringDataOffset = stringOffsetsOffset + ( stringCount + 1 ) * sizeof( quint32 );
+    if ( size < stringDataOffset + header->stringDataSize ) {
+        mDebug() << "Contraction hierarchy" << fileName << "is truncated";
+        unload();
+        return false;
+    }
+
+    m_header = header;
+    m_nodes = reinterpret_cast<const Node *>( data + nodesOffset );
+    m_firstEdges = reinterpret_cast<const quint32 *>( data + firstEdgesOffset );
+    m_edges = reinterpret_cast<const Edge *>( data + edgesOffset );
+    m_stringOffsets = reinterpret_cast<const quint32 *>( data + stringOffsetsOffset );
+    m_stringData = reinterpret_cast<const char *>( data + stringDataOffset );
+
+    if ( m_firstEdges[nodeCount] != header->edgeCount || m_stringOffsets[stringCount] != header->stringDataSize ) {
+        mDebug() << "Contraction hierarchy" << fileName << "is corrupt";
+        unload();
+        return false;
+    }
+
+    return true;
+}
+
+bool ContractionHierarchy::isValid() const
+{
+    return m_header != nullptr;
+}
+
+int ContractionHierarchy::nodeCount() const
+{
+    return m_header ? int( m_header->nodeCount ) : 0;
+}
+
+GeoDataCoordinates ContractionHierarchy::coordinates( quint32 node ) const
+{
+    Q_ASSERT( node < m_header->nodeCount );
+    return GeoDataCoordinates( m_nodes[node].longitude * 1e-7, m_nodes[node].latitude * 1e-7,
+                               0.0, GeoDataCoordinates::Degree );
+}
+
+bool ContractionHierarchy::isBranching( quint32 node ) const
+{
+    Q_ASSERT( node < m_header->nodeCount );
+    return m_nodes[node].flags & Branching;
+}
+
+QString ContractionHierarchy::string( quint32 index ) const
+{
+    if ( !m_header || index >= m_header->stringCount ) {
+        return QString();
+    }
+    const quint32 begin = m_stringOffsets[index];
+    return QString::fromUtf8( m_stringData + begin, m_stringOffsets[index + 1] - begin );
+}
+
+quint32 ContractionHierarchy::nearestNode( const GeoDataCoordinates &coordinates ) const
+{
+    if ( nodeCount() == 0 ) {
+        return NoNode;
+    }
+
+    // The nodes are sorted by latitude, so the search starts at the latitude
+    // of the coordinates and moves north and south until the difference in
+    // latitude alone exceeds the distance of the nearest node found.
+    const qreal lon = coordinates.longitude( GeoDataCoordinates::Degree );
+    const qreal lat = coordinates.latitude( GeoDataCoordinates::Degree );
+    const qreal cosLat = qCos( coordinates.latitude() );
+    const Node *end = m_nodes + m_header->nodeCount;
+    const qint32 latitude = qRound( lat * 1e7 );
+    const Node *start = std::lower_bound( m_nodes, end, latitude, []( const Node &node, qint32 value ) {
+        return node.latitude < value;
+    } );
+
+    quint32 result = NoNode;
+    qreal minimum = std::numeric_limits<qreal>::max();
+    auto const visit = [&]( const Node *node ) {
+        const qreal deltaLat = node->latitude * 1e-7 - lat;
+        if ( deltaLat * deltaLat >= minimum ) {
+            return false;
+        }
+        qreal deltaLon = qAbs( node->longitude * 1e-7 - lon );
+        if ( deltaLon > 180.0 ) {
+            deltaLon = 360.0 - deltaLon;
+        }
+        deltaLon *= cosLat;
+        const qreal distance = deltaLat * deltaLat + deltaLon * deltaLon;
+        if ( distance < minimum ) {
+            minimum = distance;
+            result = quint32( node - m_nodes );
+        }
+        return true;
+    };
+
+    for ( const Node *node = start; node != end && visit( node ); ++node ) {
+        // moving north
+    }
+    for ( const Node *node = start; node != m_nodes && visit( node - 1 ); --node ) {
+        // moving south
+    }
+
+    return result;
+}
+
+qint64 ContractionHierarchy::route( quint32 source, quint32 target, QVector<Step> &steps ) const
+{
+    if ( !m_header || source >= m_header->nodeCount || target >= m_header->nodeCount ) {
+        return -1;
+    }
+    if ( source == target ) {
+        return 0;
+    }
+
+    // A Dijkstra search upwards from the source and one upwards in the
+    // reversed graph from the target. Each direction continues until its
+    // nearest unsettled node is further away than the best path via a node
+    // reached by both.
+    Search searches[2];
+    searches[0].flag = Forward;
+    searches[1].flag = Backward;
+    const Label sourceLabel = { 0, source, nullptr };
+    searches[0].labels.insert( source, sourceLabel );
+    searches[0].queue.push( QueueEntry( 0, source ) );
+    const Label targetLabel = { 0, target, nullptr };
+    searches[1].labels.insert( target, targetLabel );
+    searches[1].queue.push( QueueEntry( 0, target ) );
+
+    qint64 best = std::numeric_limits<qint64>::max();
+    quint32 meeting = NoNode;
+    while ( true ) {
+        int direction = -1;
+        for ( int i = 0; i < 2; ++i ) {
+            const Queue &queue = searches[i].queue;
+            if ( !queue.empty() && queue.top().first < best
+                 && ( direction < 0 || queue.top().first < searches[direction].queue.top().first ) ) {
+                direction = i;
+            }
+        }
+        if ( direction < 0 ) {
+            break;
+        }
+
+        Search &search = searches[direction];
+        const Search &other = searches[1 - direction];
+        const QueueEntry entry = search.queue.top();
+        search.queue.pop();
+        const quint32 node = entry.second;
+        if ( entry.first > search.labels.value( node ).distance ) {
+            continue;
+        }
+
+        const auto reached = other.labels.constFind( node );
+        if ( reached != other.labels.constEnd() && qint64( entry.first ) + reached->distance < best ) {
+            best = qint64( entry.first ) + reached->distance;
+            meeting = node;
+        }
+
+        for ( quint32 i = m_firstEdges[node]; i < m_firstEdges[node + 1]; ++i ) {
+            const Edge &edge = m_edges[i];
+            if ( !( edge.flags & search.flag ) ) {
+                continue;
+            }
+            const quint32 distance = entry.first + edge.weight;
+            auto label = search.labels.find( edge.target );
+            if ( label == search.labels.end() ) {
+                const Label reachedLabel = { distance, node, &edge };
+                search.labels.insert( edge.target, reachedLabel );
+            } else if ( distance < label->distance ) {
+                label->distance = distance;
+                label->parent = node;
+                label->edge = &edge;
+            } else {
+                continue;
+            }
+            search.queue.push( QueueEntry( distance, edge.target ) );
+        }
+    }
+
+    if ( meeting == NoNode ) {
+        return -1;
+    }
+
+    // The edges from the source up to the meeting node and down to the target
+    QVector<Arc> arcs;
+    for ( quint32 node = meeting; node != source; ) {
+        const Label &label = searches[0].labels[node];
+        const Arc arc = { label.parent, node, label.edge };
+        arcs << arc;
+        node = label.parent;
+    }
+    std::reverse( arcs.begin(), arcs.end() );
+    for ( quint32 node = meeting; node != target; ) {
+        const Label &label = searches[1].labels[node];
+        const Arc arc = { node, label.parent, label.edge };
+        arcs << arc;
+        node = label.parent;
+    }
+
+    for ( const Arc &arc: arcs ) {
+        unpack( arc.from, arc.to, arc.edge, steps );
+    }
+
+    return best;
+}
+
+const ContractionHierarchy::Edge *ContractionHierarchy::findEdge( quint32 node, quint32 target, quint16 flag ) const
+{
+    const Edge *result = nullptr;
+    for ( quint32 i = m_firstEdges[node]; i < m_firstEdges[node + 1]; ++i ) {
+        const Edge &edge = m_edges[i];
+        if ( edge.target == target && ( edge.flags & flag ) && ( !result || edge.weight < result->weight ) ) {
+            result = &edge;
+        }
+    }
+    return result;
+}
+
+void ContractionHierarchy::unpack( quint32 from, quint32 to, const Edge *edge, QVector<Step> &steps ) const
+{
+    // A shortcut from a to b via m replaces the edges a->m and m->b. Both
+    // are stored with m, which has a lower rank than a and b.
+    QVector<Arc> stack;
+    const Arc arc = { from, to, edge };
+    stack << arc;
+    while ( !stack.isEmpty() ) {
+        const Arc current = stack.takeLast();
+        if ( current.edge->middle == NoNode ) {
+            const Step step = { current.to, current.edge->weight, current.edge->name, current.edge->type };
+            steps << step;
+            continue;
+        }
+
+        const quint32 middle = current.edge->middle;
+        const Edge *first = findEdge( middle, current.from, Backward );
+        const Edge *second = findEdge( middle, current.to, Forward );
+        Q_ASSERT( first && second );
+        if ( !first || !second ) {
+            mDebug() << "Cannot unpack shortcut from" << current.from << "to" << current.to;
+            continue;
+        }
+        const Arc secondArc = { middle, current.to, second };
+        const Arc firstArc = { current.from, middle, first };
+        stack << secondArc << firstArc;
+    }
+}
+
+}
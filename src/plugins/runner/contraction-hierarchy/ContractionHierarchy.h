@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_CONTRACTIONHIERARCHY_H
+#define MARBLE_CONTRACTIONHIERARCHY_H
+
+#include "GeoDataCoordinates.h"
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+namespace Marble
+{
+
+/**
+ * @brief A road network prepared for fast shortest path queries
+ *
+ * In a contraction hierarchy each node has a rank. Each edge connects a
+ * node to one of higher rank and is stored with the lower ranked node. A
+ * shortcut replaces the two edges via a node of lower rank than both of its
+ * ends, so a bidirectional Dijkstra search only has to go upwards in the
+ * hierarchy.
+ *
+ * The hierarchy is read from a file written by ContractionHierarchyBuilder,
+ * which is memory-mapped and used without copying. The file has this
+ * layout, with native byte order and all sections aligned to four bytes:
+ *   - Header
+ *   - nodeCount Node records, sorted by latitude
+ *   - nodeCount + 1 indices of the first Edge of each node
+ *   - edgeCount Edge records
+ *   - stringCount + 1 offsets of the strings in the string data
+ *   - the UTF-8 string data of road names and road types
+ */
+class ContractionHierarchy
+{
+public:
+    enum {
+        Version = 1
+    };
+
+    enum : quint32 {
+        NoNode = 0xffffffff
+    };
+
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 nodeCount;
+        quint32 edgeCount;
+        quint32 stringCount;
+        quint32 stringDataSize;
+        quint32 reserved;
+    };
+
+    enum NodeFlag {
+        Branching = 0x1   ///< More than two roads meet at the node
+    };
+
+    struct Node {
+        qint32 latitude;   ///< in 1e-7 degree
+        qint32 longitude;  ///< in 1e-7 degree
+        quint32 flags;
+    };
+
+    enum EdgeFlag {
+        Forward = 0x1,     ///< The edge leads from its node to its target
+        Backward = 0x2     ///< The edge leads from its target to its node
+    };
+
+    struct Edge {
+        quint32 target;
+        quint32 weight;    ///< travel time in 1/10 seconds
+        quint32 middle;    ///< the node a shortcut skips, NoNode for roads
+        quint32 name;      ///< string index of the road name
+        quint16 type;      ///< string index of the road type
+        quint16 flags;
+    };
+
+    /**
+     * One road passed by a path, ending at node.
+     */
+    struct Step {
+        quint32 node;
+        quint32 weight;
+        quint32 name;
+        quint16 type;
+    };
+
+    ContractionHierarchy();
+
+    ~ContractionHierarchy();
+
+    /**
+     * Maps the given file. Returns false if it is no valid hierarchy file.
+     */
+    bool load( const QString &fileName );
+
+    bool isValid() const;
+
+    int nodeCount() const;
+
+    GeoDataCoordinates coordinates( quint32 node ) const;
+
+    bool isBranching( quint32 node ) const;
+
+    QString string( quint32 index ) const;
+
+    /**
+     * Returns the node nearest to the given coordinates, or NoNode if the
+     * hierarchy is empty.
+     */
+    quint32 nearestNode( const GeoDataCoordinates &coordinates ) const;
+
+    /**
+     * Appends the roads of the fastest path between the nodes to steps and
+     * returns its travel time in 1/10 seconds. Returns -1 if there is no
+     * path. The hierarchy can be queried from several threads at once.
+     */
+    qint64 route( quint32 source, quint32 target, QVector<Step> &steps ) const;
+
+private:
+    void unload();
+
+    const Edge *findEdge( quint32 node, quint32 target, quint16 flag ) const;
+
+    void unpack( quint32 from, quint32 to, const Edge *edge, QVector<Step> &steps ) const;
+
+    QFile m_file;
+    const Header *m_header;
+    const Node *m_nodes;
+    const quint32 *m_firstEdges;
+    const Edge *m_edges;
+    const quint32 *m_stringOffsets;
+    const char *m_stringData;
+};
+
+}
+
+#endif
@@ -0,0 +1,510 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "ContractionHierarchyBuilder.h"
+
+#include "ContractionHierarchy.h"
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "MarbleDebug.h"
+#include "MarbleGlobal.h"
+#include "osm/OsmPlacemarkData.h"
+
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace Marble
+{
+
+Q_STATIC_ASSERT( sizeof( ContractionHierarchy::Header ) == 32 );
+Q_STATIC_ASSERT( sizeof( ContractionHierarchy::Node ) == 12 );
+Q_STATIC_ASSERT( sizeof( ContractionHierarchy::Edge ) == 20 );
+
+namespace
+{
+
+// The witness search gives up after settling this many nodes. A missed
+// witness only adds a shortcut that is not needed.
+const int MaxSettledNodes = 500;
+
+const quint32 Unreached = std::numeric_limits<quint32>::max();
+
+template<class Entry>
+using MinimumQueue = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> >;
+
+}
+
+ContractionHierarchyBuilder::ContractionHierarchyBuilder( RoutingProfile::TransportType transportType ) :
+    m_transportType( transportType )
+{
+    intern( QString(), m_typeIds, m_types );
+    intern( QString(), m_nameIds, m_names );
+}
+
+int ContractionHierarchyBuilder::speed( const OsmPlacemarkData &osmData, RoutingProfile::TransportType transportType )
+{
+    static const QHash<QString, int> roadSpeeds = {
+        { QStringLiteral( "motorway" ), 110 },
+        { QStringLiteral( "motorway_link" ), 60 },
+        { QStringLiteral( "trunk" ), 90 },
+        { QStringLiteral( "trunk_link" ), 50 },
+        { QStringLiteral( "primary" ), 70 },
+        { QStringLiteral( "primary_link" ), 50 },
+        { QStringLiteral( "secondary" ), 60 },
+        { QStringLiteral( "secondary_link" ), 50 },
+        { QStringLiteral( "tertiary" ), 50 },
+        { QStringLiteral( "tertiary_link" ), 40 },
+        { QStringLiteral( "unclassified" ), 40 },
+        { QStringLiteral( "road" ), 30 },
+        { QStringLiteral( "residential" ), 30 },
+        { QStringLiteral( "service" ), 20 },
+        { QStringLiteral( "living_street" ), 10 }
+    };
+
+    const QString highway = osmData.tagValue( QStringLiteral( "highway" ) );
+    const QString access = osmData.tagValue( QStringLiteral( "access" ) );
+    const bool restricted = access == QLatin1String( "no" ) || access == QLatin1String( "private" );
+    const bool motorway = highway.startsWith( QLatin1String( "motorway" ) );
+    const bool trunk = highway.startsWith( QLatin1String( "trunk" ) );
+
+    switch ( transportType ) {
+    case RoutingProfile::Motorcar: {
+        const int speed = roadSpeeds.value( highway );
+        if ( speed == 0 || osmData.containsTag( QStringLiteral( "motor_vehicle" ), QStringLiteral( "no" ) )
+             || osmData.containsTag( QStringLiteral( "motorcar" ), QStringLiteral( "no" ) ) ) {
+            return 0;
+        }
+        if ( restricted && !osmData.containsTag( QStringLiteral( "motor_vehicle" ), QStringLiteral( "yes" ) )
+             && !osmData.containsTag( QStringLiteral( "motorcar" ), QStringLiteral( "yes" ) ) ) {
+            return 0;
+        }
+        // a speed limit like "50" or "30 mph"
+        const QString maxspeed = osmData.tagValue( QStringLiteral( "maxspeed" ) );
+        bool ok = false;
+        const int limit = maxspeed.section( QLatin1Char( ' ' ), 0, 0 ).toInt( &ok );
+        if ( ok && limit > 0 ) {
+            return maxspeed.endsWith( QLatin1String( "mph" ) ) ? qRound( limit * 1.609 ) : limit;
+        }
+        return speed;
+    }
+    case RoutingProfile::Bicycle: {
+        const QString bicycle = osmData.tagValue( QStringLiteral( "bicycle" ) );
+        const bool allowed = bicycle == QLatin1String( "yes" ) || bicycle == QLatin1String( "designated" )
+                          || bicycle == QLatin1String( "permissive" );
+        if ( bicycle == QLatin1String( "no" ) || ( restricted && !allowed ) || motorway ) {
+            return 0;
+        }
+        if ( highway == QLatin1String( "cycleway" ) ) {
+            return 18;
+        }
+        if ( highway == QLatin1String( "path" ) || highway == QLatin1String( "track" )
+             || highway == QLatin1String( "bridleway" ) ) {
+            return 12;
+        }
+        if ( highway == QLatin1String( "footway" ) || highway == QLatin1String( "pedestrian" ) ) {
+            return allowed ? 10 : 0;
+        }
+        return roadSpeeds.contains( highway ) ? 16 : 0;
+    }
+    case RoutingProfile::Pedestrian: {
+        const QString foot = osmData.tagValue( QStringLiteral( "foot" ) );
+        const bool allowed = foot == QLatin1String( "yes" ) || foot == QLatin1String( "designated" )
+                          || foot == QLatin1String( "permissive" );
+        if ( foot == QLatin1String( "no" ) || ( restricted && !allowed ) || ( ( motorway || trunk ) && !allowed ) ) {
+            return 0;
+        }
+        const bool footway = highway == QLatin1String( "footway" ) || highway == QLatin1String( "pedestrian" )
+                          || highway == QLatin1String( "path" ) || highway == QLatin1String( "steps" )
+                          || highway == QLatin1String( "track" ) || highway == QLatin1String( "cycleway" )
+                          || highway == QLatin1String( "bridleway" );
+        return footway || roadSpeeds.contains( highway ) ? 5 : 0;
+    }
+    }
+
+    return 0;
+}
+
+quint32 ContractionHierarchyBuilder::weight( qreal meters, int speed )
+{
+    Q_ASSERT( speed > 0 );
+    return qMax<quint32>( 1, quint32( qRound( meters * 36.0 / speed ) ) );
+}
+
+void ContractionHierarchyBuilder::addDocument( const GeoDataDocument *document )
+{
+    for ( const GeoDataPlacemark *placemark: document->placemarkList() ) {
+        const GeoDataLineString *road = geodata_cast<GeoDataLineString>( placemark->geometry() );
+        if ( !road || road->size() < 2 ) {
+            continue;
+        }
+        const OsmPlacemarkData &osmData = placemark->osmData();
+        const int roadSpeed = speed( osmData, m_transportType );
+        if ( roadSpeed == 0 ) {
+            continue;
+        }
+
+        bool forward = true;
+        bool backward = true;
+        const QString oneway = osmData.tagValue( QStringLiteral( "oneway" ) );
+        const bool roundabout = osmData.containsTag( QStringLiteral( "junction" ), QStringLiteral( "roundabout" ) );
+        if ( m_transportType == RoutingProfile::Pedestrian
+             || ( m_transportType == RoutingProfile::Bicycle
+                  && osmData.containsTag( QStringLiteral( "oneway:bicycle" ), QStringLiteral( "no" ) ) ) ) {
+            // both ways
+        } else if ( oneway == QLatin1String( "-1" ) ) {
+            forward = false;
+        } else if ( oneway == QLatin1String( "yes" ) || oneway == QLatin1String( "true" ) || oneway == QLatin1String( "1" )
+                    || ( oneway != QLatin1String( "no" )
+                         && ( roundabout || osmData.containsTag( QStringLiteral( "highway" ), QStringLiteral( "motorway" ) ) ) ) ) {
+            backward = false;
+        }
+
+        // The instructions of the runner know roundabouts by their type
+        const QString type = roundabout ? QStringLiteral( "roundabout" ) : osmData.tagValue( QStringLiteral( "highway" ) );
+        const quint16 typeId = quint16( intern( type, m_typeIds, m_types ) );
+        const quint32 nameId = intern( placemark->name(), m_nameIds, m_names );
+
+        quint32 previous = ContractionHierarchy::NoNode;
+        for ( int i = 0; i < road->size(); ++i ) {
+            const GeoDataCoordinates &coordinates = road->at( i );
+            const quint32 current = node( osmData.nodeReference( coordinates ).id(),
+                                          qRound( coordinates.latitude( GeoDataCoordinates::Degree ) * 1e7 ),
+                                          qRound( coordinates.longitude( GeoDataCoordinates::Degree ) * 1e7 ) );
+            if ( previous != ContractionHierarchy::NoNode && previous != current ) {
+                const quint32 arcWeight = weight( road->at( i - 1 ).sphericalDistanceTo( coordinates ) * EARTH_RADIUS, roadSpeed );
+                if ( forward ) {
+                    const Arc out = { current, arcWeight, ContractionHierarchy::NoNode, nameId, typeId, ContractionHierarchy::Forward };
+                    const Arc in = { previous, arcWeight, ContractionHierarchy::NoNode, nameId, typeId, ContractionHierarchy::Backward };
+                    addArc( previous, out );
+                    addArc( current, in );
+                }
+                if ( backward ) {
+                    const Arc out = { previous, arcWeight, ContractionHierarchy::NoNode, nameId, typeId, ContractionHierarchy::Forward };
+                    const Arc in = { current, arcWeight, ContractionHierarchy::NoNode, nameId, typeId, ContractionHierarchy::Backward };
+                    addArc( current, out );
+                    addArc( previous, in );
+                }
+            }
+            previous = current;
+        }
+    }
+}
+
+quint32 ContractionHierarchyBuilder::node( qint64 osmId, qint32 latitude, qint32 longitude )
+{
+    const QPair<qint32, qint32> position( latitude, longitude );
+    if ( osmId != 0 ) {
+        auto iter = m_nodeIds.constFind( osmId );
+        if ( iter != m_nodeIds.constEnd() ) {
+            return iter.value();
+        }
+    } else {
+        auto iter = m_positionIds.constFind( position );
+        if ( iter != m_positionIds.constEnd() ) {
+            return iter.value();
+        }
+    }
+
+    const quint32 id = quint32( m_nodes.size() );
+    if ( osmId != 0 ) {
+        m_nodeIds.insert( osmId, id );
+    } else {
+        m_positionIds.insert( position, id );
+    }
+    m_nodes << position;
+    m_arcs.resize( m_nodes.size() );
+    return id;
+}
+
+quint32 ContractionHierarchyBuilder::intern( const QString &string, QHash<QString, quint32> &ids, QVector<QString> &strings )
+{
+    auto iter = ids.constFind( string );
+    if ( iter != ids.constEnd() ) {
+        return iter.value();
+    }
+
+    const quint32 id = quint32( strings.size() );
+    ids.insert( string, id );
+    strings << string;
+    return id;
+}
+
+void ContractionHierarchyBuilder::addArc( quint32 from, const Arc &arc )
+{
+    // Of parallel arcs only the fastest one is kept
+    for ( Arc &existing: m_arcs[from] ) {
+        if ( existing.target == arc.target && existing.flags == arc.flags ) {
+            if ( arc.weight < existing.weight ) {
+                existing = arc;
+            }
+            return;
+        }
+    }
+    m_arcs[from] << arc;
+}
+
+void ContractionHierarchyBuilder::sortNodes()
+{
+    // ContractionHierarchy::nearestNode() expects the nodes by latitude
+    QVector<quint32> order( m_nodes.size() );
+    for ( int i = 0; i < order.size(); ++i ) {
+        order[i] = quint32( i );
+    }
+    std::sort( order.begin(), order.end(), [this]( quint32 a, quint32 b ) {
+        return m_nodes[a] < m_nodes[b];
+    } );
+
+    QVector<quint32> ids( m_nodes.size() );
+    QVector<QPair<qint32, qint32> > nodes( m_nodes.size() );
+    QVector<QVector<Arc> > arcs( m_nodes.size() );
+    for ( int i = 0; i < order.size(); ++i ) {
+        ids[order[i]] = quint32( i );
+    }
+    for ( int i = 0; i < order.size(); ++i ) {
+        nodes[i] = m_nodes[order[i]];
+        arcs[i] = m_arcs[order[i]];
+        for ( Arc &arc: arcs[i] ) {
+            arc.target = ids[arc.target];
+        }
+    }
+
+    m_nodes = nodes;
+    m_arcs = arcs;
+    m_nodeIds.clear();
+    m_positionIds.clear();
+}
+
+void ContractionHierarchyBuilder::witnessSearch( quint32 source, quint32 excluded, quint32 limit )
+{
+    for ( quint32 node: m_reached ) {
+        m_distances[node] = Unreached;
+    }
+    m_reached.clear();
+
+    typedef QPair<quint32, quint32> Entry;
+    MinimumQueue<Entry> queue;
+    m_distances[source] = 0;
+    m_reached << source;
+    queue.push( Entry( 0, source ) );
+    int settled = 0;
+    while ( !queue.empty() ) {
+        const Entry entry = queue.top();
+        queue.pop();
+        if ( entry.first > m_distances[entry.second] ) {
+            continue;
+        }
+        if ( entry.first > limit || ++settled > MaxSettledNodes ) {
+            break;
+        }
+        for ( const Arc &arc: m_arcs.at( entry.second ) ) {
+            if ( !( arc.flags & ContractionHierarchy::Forward ) || arc.target == excluded ) {
+                continue;
+            }
+            const quint32 distance = entry.first + arc.weight;
+            if ( distance < m_distances[arc.target] ) {
+                if ( m_distances[arc.target] == Unreached ) {
+                    m_reached << arc.target;
+                }
+                m_distances[arc.target] = distance;
+                queue.push( Entry( distance, arc.target ) );
+            }
+        }
+    }
+}
+
+int ContractionHierarchyBuilder::shortcuts( quint32 node, bool insert )
+{
+    // A path u -> node -> w needs a shortcut unless there is another path
+    // from u to w which is not longer
+    const QVector<Arc> &arcs = m_arcs.at( node );
+    quint32 maximum = 0;
+    for ( const Arc &arc: arcs ) {
+        if ( arc.flags & ContractionHierarchy::Forward ) {
+            maximum = qMax( maximum, arc.weight );
+        }
+    }
+
+    int count = 0;
+    for ( const Arc &in: arcs ) {
+        if ( !( in.flags & ContractionHierarchy::Backward ) ) {
+            continue;
+        }
+        witnessSearch( in.target, node, in.weight + maximum );
+        for ( const Arc &out: arcs ) {
+            if ( !( out.flags & ContractionHierarchy::Forward ) || out.target == in.target ) {
+                continue;
+            }
+            const quint32 via = in.weight + out.weight;
+            if ( m_distances[out.target] <= via ) {
+                continue;
+            }
+            ++count;
+            if ( insert ) {
+                const Arc forward = { out.target, via, node, 0, 0, ContractionHierarchy::Forward };
+                const Arc backward = { in.target, via, node, 0, 0, ContractionHierarchy::Backward };
+                addArc( in.target, forward );
+                addArc( out.target, backward );
+            }
+        }
+    }
+    return count;
+}
+
+int ContractionHierarchyBuilder::priority( quint32 node )
+{
+    // The edge difference keeps the number of arcs low, the deleted
+    // neighbors spread the contraction evenly over the network
+    return shortcuts( node, false ) - m_arcs.at( node ).size() + m_deletedNeighbors[node];
+}
+
+void ContractionHierarchyBuilder::contract()
+{
+    const int count = m_nodes.size();
+    m_contracted.fill( false, count );
+    m_deletedNeighbors.fill( 0, count );
+    m_distances.fill( Unreached, count );
+    m_reached.clear();
+
+    // The nodes are contracted by their priority, which is updated lazily:
+    // an outdated entry of the queue is skipped.
+    typedef QPair<int, quint32> Entry;
+    MinimumQueue<Entry> queue;
+    QVector<int> priorities( count );
+    for ( int i = 0; i < count; ++i ) {
+        priorities[i] = priority( i );
+        queue.push( Entry( priorities[i], i ) );
+    }
+
+    QVector<QVector<Arc> > upward( count );
+    while ( !queue.empty() ) {
+        const Entry entry = queue.top();
+        queue.pop();
+        const quint32 node = entry.second;
+        if ( m_contracted[node] || entry.first != priorities[node] ) {
+            continue;
+        }
+        priorities[node] = priority( node );
+        if ( !queue.empty() && priorities[node] > queue.top().first ) {
+            queue.push( Entry( priorities[node], node ) );
+            continue;
+        }
+
+        shortcuts( node, true );
+        m_contracted[node] = true;
+        upward[node] = m_arcs[node];
+        m_arcs[node].clear();
+
+        QVector<quint32> neighbors;
+        for ( const Arc &arc: upward[node] ) {
+            if ( !neighbors.contains( arc.target ) ) {
+                neighbors << arc.target;
+            }
+        }
+        for ( quint32 neighbor: neighbors ) {
+            QVector<Arc> &arcs = m_arcs[neighbor];
+            arcs.erase( std::remove_if( arcs.begin(), arcs.end(), [node]( const Arc &arc ) {
+                return arc.target == node;
+            } ), arcs.end() );
+            ++m_deletedNeighbors[neighbor];
+        }
+        for ( quint32 neighbor: neighbors ) {
+            priorities[neighbor] = priority( neighbor );
+            queue.push( Entry( priorities[neighbor], neighbor ) );
+        }
+    }
+
+    m_arcs = upward;
+}
+
+bool ContractionHierarchyBuilder::write( const QString &fileName )
+{
+    sortNodes();
+
+    const int nodeCount = m_nodes.size();
+    QVector<ContractionHierarchy::Node> nodes( nodeCount );
+    for ( int i = 0; i < nodeCount; ++i ) {
+        QVector<quint32> neighbors;
+        for ( const Arc &arc: m_arcs.at( i ) ) {
+            if ( !neighbors.contains( arc.target ) ) {
+                neighbors << arc.target;
+            }
+        }
+        nodes[i].latitude = m_nodes[i].first;
+        nodes[i].longitude = m_nodes[i].second;
+        nodes[i].flags = neighbors.size() > 2 ? ContractionHierarchy::Branching : 0;
+    }
+
+    contract();
+
+    // The types come first in the strings, so they fit into 16 bit
+    const quint32 typeCount = quint32( m_types.size() );
+    QVector<quint32> firstEdges;
+    firstEdges.reserve( nodeCount + 1 );
+    QVector<ContractionHierarchy::Edge> edges;
+    for ( int i = 0; i < nodeCount; ++i ) {
+        firstEdges << quint32( edges.size() );
+        const int first = edges.size();
+        for ( const Arc &arc: m_arcs.at( i ) ) {
+            const ContractionHierarchy::Edge edge = { arc.target, arc.weight, arc.middle,
+                                                      typeCount + arc.name, arc.type, arc.flags };
+            // an arc of the same length both ways is stored once
+            bool merged = false;
+            for ( int j = first; j < edges.size() && !merged; ++j ) {
+                ContractionHierarchy::Edge &existing = edges[j];
+                if ( existing.target == edge.target && existing.weight == edge.weight && existing.middle == edge.middle
+                     && existing.name == edge.name && existing.type == edge.type ) {
+                    existing.flags |= edge.flags;
+                    merged = true;
+                }
+            }
+            if ( !merged ) {
+                edges << edge;
+            }
+        }
+    }
+    firstEdges << quint32( edges.size() );
+
+    QVector<quint32> stringOffsets;
+    QByteArray stringData;
+    for ( const QVector<QString> *strings: { &m_types, &m_names } ) {
+        for ( const QString &string: *strings ) {
+            stringOffsets << quint32( stringData.size() );
+            stringData += string.toUtf8();
+        }
+    }
+    stringOffsets << quint32( stringData.size() );
+
+    ContractionHierarchy::Header header;
+    std::memcpy( header.magic, "MARBLECH", sizeof( header.magic ) );
+    header.version = ContractionHierarchy::Version;
+    header.nodeCount = quint32( nodeCount );
+    header.edgeCount = quint32( edges.size() );
+    header.stringCount = quint32( stringOffsets.size() - 1 );
+    header.stringDataSize = quint32( stringData.size() );
+    header.reserved = 0;
+
+    QSaveFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << "Cannot write contraction hierarchy" << fileName;
+        return false;
+    }
+    file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    file.write( reinterpret_cast<const char *>( nodes.constData() ), nodes.size() * sizeof( ContractionHierarchy::Node ) );
+    file.write( reinterpret_cast<const char *>( firstEdges.constData() ), firstEdges.size() * sizeof( quint32 ) );
+    file.write( reinterpret_cast<const char *>( edges.constData() ), edges.size() * sizeof( ContractionHierarchy::Edge ) );
+    file.write( reinterpret_cast<const char *>( stringOffsets.constData() ), stringOffsets.size() * sizeof( quint32 ) );
+    file.write( stringData );
+    return file.commit();
+}
+
+}
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_CONTRACTIONHIERARCHYBUILDER_H
+#define MARBLE_CONTRACTIONHIERARCHYBUILDER_H
+
+#include "routing/RoutingProfile.h"
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+namespace Marble
+{
+
+class GeoDataDocument;
+class OsmPlacemarkData;
+
+/**
+ * @brief Creates the ContractionHierarchy of a road network for one transport type
+ *
+ * The roads are the ways with a highway tag of OSM documents, as read by
+ * OsmParser. Roads sharing an OSM node are connected, while nodes at the
+ * same position, like on a bridge over a road, are kept apart. Nodes without
+ * an OSM id are identified by their position. The weight of a road is
+ * its travel time at the speed the transport type has on it.
+ */
+class ContractionHierarchyBuilder
+{
+public:
+    explicit ContractionHierarchyBuilder( RoutingProfile::TransportType transportType );
+
+    /**
+     * Adds the roads of the given document to the network.
+     */
+    void addDocument( const GeoDataDocument *document );
+
+    /**
+     * Contracts the network and writes the hierarchy to the given file.
+     * Returns false if the file cannot be written. No roads can be added
+     * afterwards.
+     */
+    bool write( const QString &fileName );
+
+    /**
+     * Returns the speed in km/h the transport type has on the way with the
+     * given tags, or 0 if it must not use the way.
+     */
+    static int speed( const OsmPlacemarkData &osmData, RoutingProfile::TransportType transportType );
+
+    /**
+     * Returns the time in 1/10 seconds to travel the given distance in
+     * meters at the given speed in km/h.
+     */
+    static quint32 weight( qreal meters, int speed );
+
+private:
+    struct Arc {
+        quint32 target;
+        quint32 weight;
+        quint32 middle;
+        quint32 name;
+        quint16 type;
+        quint16 flags;
+    };
+
+    quint32 node( qint64 osmId, qint32 latitude, qint32 longitude );
+
+    static quint32 intern( const QString &string, QHash<QString, quint32> &ids, QVector<QString> &strings );
+
+    void sortNodes();
+
+    void addArc( quint32 from, const Arc &arc );
+
+    void contract();
+
+    int shortcuts( quint32 node, bool insert );
+
+    void witnessSearch( quint32 source, quint32 excluded, quint32 limit );
+
+    int priority( quint32 node );
+
+    RoutingProfile::TransportType m_transportType;
+
+    // the nodes as latitude and longitude in 1e-7 degree, by OSM id or,
+    // lacking that, by position
+    QHash<qint64, quint32> m_nodeIds;
+    QHash<QPair<qint32, qint32>, quint32> m_positionIds;
+    QVector<QPair<qint32, qint32> > m_nodes;
+
+    // the road types and road names, the empty string first
+    QHash<QString, quint32> m_typeIds;
+    QVector<QString> m_types;
+    QHash<QString, quint32> m_nameIds;
+    QVector<QString> m_names;
+
+    // The arcs of the uncontracted nodes while contracting, then the
+    // arcs of each node to the nodes of higher rank
+    QVector<QVector<Arc> > m_arcs;
+
+    QVector<bool> m_contracted;
+    QVector<int> m_deletedNeighbors;
+
+    // the state of the witness search
+    QVector<quint32> m_distances;
+    QVector<quint32> m_reached;
+};
+
+}
+
+#endif
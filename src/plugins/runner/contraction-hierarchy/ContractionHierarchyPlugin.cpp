@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "ContractionHierarchyPlugin.h"
+#include "ContractionHierarchyRunner.h"
+
+#include <QDir>
+
+namespace Marble
+{
+
+ContractionHierarchyPlugin::ContractionHierarchyPlugin( QObject *parent ) :
+    RoutingRunnerPlugin( parent )
+{
+    setSupportedCelestialBodies(QStringList(QStringLiteral("earth")));
+    setCanWorkOffline( true );
+}
+
+QString ContractionHierarchyPlugin::name() const
+{
+    return tr( "Contraction Hierarchy Routing" );
+}
+
+QString ContractionHierarchyPlugin::guiString() const
+{
+    return tr( "Offline (OSM files)" );
+}
+
+QString ContractionHierarchyPlugin::nameId() const
+{
+    return QStringLiteral("contraction-hierarchy");
+}
+
+QString ContractionHierarchyPlugin::version() const
+{
+    return QStringLiteral("1.0");
+}
+
+QString ContractionHierarchyPlugin::description() const
+{
+    return tr( "Calculates routes offline on OpenStreetMap files" );
+}
+
+QString ContractionHierarchyPlugin::copyrightYears() const
+{
+    return QStringLiteral("2026");
+}
+
+QVector<PluginAuthor> ContractionHierarchyPlugin::pluginAuthors() const
+{
+    return QVector<PluginAuthor>()
+            << PluginAuthor(QStringLiteral("Marble Developers"), QStringLiteral("marble-devel@kde.org"));
+}
+
+RoutingRunner *ContractionHierarchyPlugin::newRunner() const
+{
+    return new ContractionHierarchyRunner;
+}
+
+bool ContractionHierarchyPlugin::supportsTemplate(RoutingProfilesModel::ProfileTemplate profileTemplate) const
+{
+    return
+        (profileTemplate == RoutingProfilesModel::CarFastestTemplate) ||
+        (profileTemplate == RoutingProfilesModel::BicycleTemplate)    ||
+        (profileTemplate == RoutingProfilesModel::PedestrianTemplate);
+}
+
+bool ContractionHierarchyPlugin::canWork() const
+{
+    QDir mapDir = QDir(ContractionHierarchyRunner::mapDirectory());
+    return mapDir.exists();
+}
+
+}
+
+#include "moc_ContractionHierarchyPlugin.cpp"
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_CONTRACTIONHIERARCHYPLUGIN_H
+#define MARBLE_CONTRACTIONHIERARCHYPLUGIN_H
+
+#include "RoutingRunnerPlugin.h"
+
+namespace Marble
+{
+
+class ContractionHierarchyPlugin : public RoutingRunnerPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "org.kde.marble.ContractionHierarchyPlugin")
+    Q_INTERFACES( Marble::RoutingRunnerPlugin )
+
+public:
+    explicit ContractionHierarchyPlugin( QObject *parent = nullptr );
+
+    QString name() const override;
+
+    QString guiString() const override;
+
+    QString nameId() const override;
+
+    QString version() const override;
+
+    QString description() const override;
+
+    QString copyrightYears() const override;
+
+    QVector<PluginAuthor> pluginAuthors() const override;
+
+    RoutingRunner *newRunner() const override;
+
+    bool supportsTemplate(RoutingProfilesModel::ProfileTemplate profileTemplate) const override;
+
+    bool canWork() const override;
+};
+
+}
+
+#endif
@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "ContractionHierarchyRunner.h"
+
+#include "ContractionHierarchy.h"
+#include "ContractionHierarchyBuilder.h"
+#include "OsmParser.h"
+
+#include "MarbleDebug.h"
+#include "MarbleDirs.h"
+#include "routing/RouteRequest.h"
+#include "routing/instructions/InstructionTransformation.h"
+#include "GeoDataDocument.h"
+#include "GeoDataData.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataLineString.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QTime>
+
+namespace Marble
+{
+
+namespace
+{
+
+struct CachedHierarchy {
+    QSharedPointer<const ContractionHierarchy> hierarchy;
+    QDateTime lastModified;
+};
+
+QMutex s_cacheMutex;
+QHash<int, CachedHierarchy> s_cache;
+// the transport types whose hierarchy is being created
+QSet<int> s_building;
+// the newest OSM file of failed creations, not repeated until the files change
+QHash<int, QDateTime> s_failed;
+
+// Creating a hierarchy takes long and much memory, so one at a time
+Q_GLOBAL_STATIC( QThreadPool, s_buildPool )
+
+QString hierarchyFile( RoutingProfile::TransportType transportType )
+{
+    switch ( transportType ) {
+    case RoutingProfile::Motorcar:
+        return QStringLiteral( "motorcar.ch" );
+    case RoutingProfile::Bicycle:
+        return QStringLiteral( "bicycle.ch" );
+    case RoutingProfile::Pedestrian:
+        return QStringLiteral( "pedestrian.ch" );
+    }
+    return QString();
+}
+
+/**
+ * Creates the hierarchy of a transport type from the OSM files in the
+ * background, so that route requests do not wait for it.
+ */
+class BuildJob : public QRunnable
+{
+public:
+    BuildJob( RoutingProfile::TransportType transportType, const QString &fileName,
+              const QFileInfoList &sources, const QDateTime &newest ) :
+        m_transportType( transportType ),
+        m_fileName( fileName ),
+        m_sources( sources ),
+        m_newest( newest )
+    {
+    }
+
+    void run() override
+    {
+        mDebug() << "Creating contraction hierarchy" << m_fileName;
+        ContractionHierarchyBuilder builder( m_transportType );
+        for ( const QFileInfo &source: m_sources ) {
+            QString error;
+            GeoDataDocument *document = OsmParser::parse( source.absoluteFilePath(), error );
+            if ( document ) {
+                builder.addDocument( document );
+                delete document;
+            } else {
+                mDebug() << "Cannot parse" << source.absoluteFilePath() << error;
+            }
+        }
+
+        const bool written = builder.write( m_fileName );
+        if ( !written ) {
+            mDebug() << "Cannot write contraction hierarchy" << m_fileName;
+        }
+
+        QMutexLocker locker( &s_cacheMutex );
+        s_building.remove( m_transportType );
+        if ( written ) {
+            s_failed.remove( m_transportType );
+        } else {
+            s_failed.insert( m_transportType, m_newest );
+        }
+    }
+
+private:
+    const RoutingProfile::TransportType m_transportType;
+    const QString m_fileName;
+    const QFileInfoList m_sources;
+    const QDateTime m_newest;
+};
+
+/**
+ * Returns the hierarchy of the transport type. If it does not exist or is
+ * older than the OSM files, it is created in the background; meanwhile an
+ * outdated hierarchy is still returned, a missing one is null. The
+ * hierarchies are shared by all runners and mapped only once.
+ */
+QSharedPointer<const ContractionHierarchy> hierarchy( RoutingProfile::TransportType transportType )
+{
+    QMutexLocker locker( &s_cacheMutex );
+
+    const QDir directory( ContractionHierarchyRunner::mapDirectory() );
+    const QString fileName = directory.filePath( hierarchyFile( transportType ) );
+    QFileInfo file( fileName );
+    if ( !s_building.contains( transportType ) ) {
+        const QFileInfoList sources = directory.entryInfoList( QStringList() << QStringLiteral( "*.osm" )
+                                                               << QStringLiteral( "*.pbf" ) << QStringLiteral( "*.o5m" ),
+                                                               QDir::Files );
+        QDateTime newest;
+        for ( const QFileInfo &source: sources ) {
+            if ( !newest.isValid() || source.lastModified() > newest ) {
+                newest = source.lastModified();
+            }
+        }
+
+        if ( !sources.isEmpty() && ( !file.exists() || file.lastModified() < newest )
+             && s_failed.value( transportType ) != newest ) {
+            s_building.insert( transportType );
+            s_buildPool()->setMaxThreadCount( 1 );
+            s_buildPool()->start( new BuildJob( transportType, fileName, sources, newest ) );
+        }
+    }
+
+    const auto cached = s_cache.constFind( transportType );
+    if ( cached != s_cache.constEnd() && cached->lastModified == file.lastModified() ) {
+        return cached->hierarchy;
+    }
+
+    QSharedPointer<ContractionHierarchy> result( new ContractionHierarchy );
+    if ( !file.exists() || !result->load( fileName ) ) {
+        s_cache.remove( transportType );
+        return QSharedPointer<const ContractionHierarchy>();
+    }
+
+    const CachedHierarchy entry = { result, file.lastModified() };
+    s_cache.insert( transportType, entry );
+    return result;
+}
+
+}
+
+ContractionHierarchyRunner::ContractionHierarchyRunner( QObject *parent ) :
+    RoutingRunner( parent )
+{
+    // nothing to do
+}
+
+QString ContractionHierarchyRunner::mapDirectory()
+{
+    return MarbleDirs::localPath() + QLatin1String( "/maps/earth/contraction-hierarchy/" );
+}
+
+void ContractionHierarchyRunner::retrieveRoute( const RouteRequest *route )
+{
+    const QSharedPointer<const ContractionHierarchy> graph = hierarchy( route->routingProfile().transportType() );
+    if ( !graph ) {
+        mDebug() << "No contraction hierarchy yet, it is created from the OSM files in" << mapDirectory();
+    }
+    if ( !graph || graph->nodeCount() == 0 || route->size() < 2 ) {
+        emit routeCalculated( nullptr );
+        return;
+    }
+
+    // The legs between the via points, each from the node nearest to one
+    // via point to the node nearest to the next one
+    GeoDataLineString* geometry = new GeoDataLineString;
+    RoutingWaypoints waypoints;
+    qint64 weight = 0;
+    quint32 node = graph->nearestNode( route->at( 0 ) );
+    geometry->append( graph->coordinates( node ) );
+    ContractionHierarchy::Step last = { node, 0, 0, 0 };
+    for ( int i = 1; i < route->size(); ++i ) {
+        const quint32 target = graph->nearestNode( route->at( i ) );
+        QVector<ContractionHierarchy::Step> steps;
+        const qint64 legWeight = graph->route( node, target, steps );
+        if ( legWeight < 0 ) {
+            mDebug() << "No route from" << route->at( i - 1 ).toString() << "to" << route->at( i ).toString();
+            delete geometry;
+            emit routeCalculated( nullptr );
+            return;
+        }
+        weight += legWeight;
+
+        for ( const ContractionHierarchy::Step &step: steps ) {
+            const GeoDataCoordinates coordinates = graph->coordinates( node );
+            const RoutingPoint point( coordinates.longitude( GeoDataCoordinates::Degree ),
+                                      coordinates.latitude( GeoDataCoordinates::Degree ) );
+            const QString type = graph->string( step.type );
+            RoutingWaypoint::JunctionType junction = RoutingWaypoint::None;
+            if ( graph->isBranching( node ) ) {
+                junction = type == QLatin1String( "roundabout" ) ? RoutingWaypoint::Roundabout : RoutingWaypoint::Other;
+            }
+            waypoints.push_back( RoutingWaypoint( point, junction, "", type, -1, graph->string( step.name ) ) );
+            geometry->append( graph->coordinates( step.node ) );
+            node = step.node;
+            last = step;
+        }
+    }
+
+    const GeoDataCoordinates destination = graph->coordinates( node );
+    const RoutingPoint point( destination.longitude( GeoDataCoordinates::Degree ),
+                              destination.latitude( GeoDataCoordinates::Degree ) );
+    waypoints.push_back( RoutingWaypoint( point, RoutingWaypoint::None, "", graph->string( last.type ),
+                                          -1, graph->string( last.name ) ) );
+
+    GeoDataDocument* result = new GeoDataDocument;
+    GeoDataPlacemark* routePlacemark = new GeoDataPlacemark;
+    routePlacemark->setName(QStringLiteral("Route"));
+    routePlacemark->setGeometry( geometry );
+    const QTime time = QTime( 0, 0, 0 ).addSecs( int( ( weight + 5 ) / 10 ) );
+    const qreal length = geometry->length( EARTH_RADIUS );
+    routePlacemark->setExtendedData( routeData( length, time ) );
+    result->append( routePlacemark );
+
+    const RoutingInstructions directions = InstructionTransformation::process( waypoints );
+    for ( int i = 0; i < directions.size(); ++i ) {
+        GeoDataPlacemark* placemark = new GeoDataPlacemark( directions[i].instructionText() );
+        GeoDataExtendedData extendedData;
+        GeoDataData turnType;
+        turnType.setName(QStringLiteral("turnType"));
+        turnType.setValue( QVariant::fromValue( int( directions[i].turnType() ) ) );
+        extendedData.addValue( turnType );
+        GeoDataData roadName;
+        roadName.setName(QStringLiteral("roadName"));
+        roadName.setValue( directions[i].roadName() );
+        extendedData.addValue( roadName );
+        placemark->setExtendedData( extendedData );
+        Q_ASSERT( !directions[i].points().isEmpty() );
+        GeoDataLineString* instructionGeometry = new GeoDataLineString;
+        const QVector<RoutingWaypoint> items = directions[i].points();
+        for ( int j = 0; j < items.size(); ++j ) {
+            const RoutingPoint point = items[j].point();
+            instructionGeometry->append( GeoDataCoordinates( point.lon(), point.lat(), 0.0, GeoDataCoordinates::Degree ) );
+        }
+        placemark->setGeometry( instructionGeometry );
+        result->append( placemark );
+    }
+
+    result->setName( nameString( "CH", length, time ) );
+    emit routeCalculated( result );
+}
+
+}
+
+#include "moc_ContractionHierarchyRunner.cpp"
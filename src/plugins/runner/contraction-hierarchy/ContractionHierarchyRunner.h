@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#ifndef MARBLE_CONTRACTIONHIERARCHYRUNNER_H
+#define MARBLE_CONTRACTIONHIERARCHYRUNNER_H
+
+#include "RoutingRunner.h"
+
+namespace Marble
+{
+
+/**
+ * @brief Calculates routes in-process on contraction hierarchies
+ *
+ * The hierarchies are created from the OSM files in mapDirectory(), one
+ * for each transport type, and updated when the OSM files change. This
+ * happens in the background; until a hierarchy exists, no routes are found.
+ */
+class ContractionHierarchyRunner : public RoutingRunner
+{
+    Q_OBJECT
+public:
+    explicit ContractionHierarchyRunner( QObject *parent = nullptr );
+
+    // Overriding MarbleAbstractRunner
+    void retrieveRoute( const RouteRequest *request ) override;
+
+    /**
+     * Returns the directory with the OSM files and the hierarchies.
+     */
+    static QString mapDirectory();
+};
+
+}
+
+#endif
@@ -3,16 +3,25 @@
 // SPDX-FileCopyrightText: 2011 Thibaut Gridel <tgridel@free.fr>
 
 #include "GeoDataDocument.h"
+#include "GeoDataFeature.h"
+#include "GeoDataStyleMap.h"
 #include "KmlParser.h"
 #include "KmlElementDictionary.h"
 
 namespace Marble {
 
 KmlParser::KmlParser()
-    : GeoParser( 0 )
+    : GeoParser( 0 ),
+      m_chunkSize( 0 )
 {
 }
 
+void KmlParser::setChunkHandler(int chunkSize, const ChunkHandler &handler)
+{
+    m_chunkSize = handler ? qMax(0, chunkSize) : 0;
+    m_chunkHandler = handler;
+}
+
 KmlParser::~KmlParser()
 {
 }
@@ -40,4 +49,47 @@ GeoDocument* KmlParser::createDocument() const
     return new GeoDataDocument;
 }
 
+void KmlParser::elementParsed(const GeoStackItem& item)
+{
+    if (m_chunkSize == 0 || !m_document) {
+        return;
+    }
+
+    GeoDataDocument *document = static_cast<GeoDataDocument*>(m_document);
+    if (document->size() < m_chunkSize) {
+        return;
+    }
+
+    // Only hand out features when a top level feature was just closed, all
+    // children of the document are complete then
+    const GeoDataFeature *feature = dynamic_cast<const GeoDataFeature*>(item.associatedNode());
+    if (!feature || feature->parent() != document) {
+        return;
+    }
+
+    // Shared styles are moved, so that each one is handed out once. The other
+    // properties of the root document are complete only at its end, they
+    // are taken from the remaining document, see FileManager.
+    GeoDataDocument *chunk = new GeoDataDocument;
+    chunk->setName(document->name());
+    for (const GeoDataStyle::Ptr &style: document->styles()) {
+        if (style) {
+            chunk->addStyle(style);
+            document->removeStyle(style->id());
+        }
+    }
+    for (const GeoDataStyleMap &styleMap: document->styleMaps()) {
+        chunk->addStyleMap(styleMap);
+        document->removeStyleMap(styleMap.id());
+    }
+
+    const QVector<GeoDataFeature*> features = document->featureList();
+    document->remove(0, features.size());
+    for (GeoDataFeature *child: features) {
+        chunk->append(child);
+    }
+
+    m_chunkHandler(chunk);
+}
+
 }
@@ -7,20 +7,40 @@
 
 #include "GeoParser.h"
 
+#include <functional>
+
 namespace Marble {
 
+class GeoDataDocument;
+
 class KmlParser : public GeoParser
 {
 public:
+    typedef std::function<void(GeoDataDocument *chunk)> ChunkHandler;
+
     KmlParser();
     ~KmlParser() override;
 
+    /**
+     * Streams the document while it is read: once at least @p chunkSize top
+     * level features are complete, they are moved into a new document together
+     * with the shared styles parsed so far and passed to @p handler, which takes
+     * ownership. The document returned by releaseDocument() keeps the remaining
+     * features. A chunk size of 0 disables streaming.
+     */
+    void setChunkHandler(int chunkSize, const ChunkHandler &handler);
+
 private:
     bool isValidElement(const QString& tagName) const override;
     bool isValidRootElement() override;
 
     GeoDocument* createDocument() const override;
 
+    void elementParsed(const GeoStackItem& item) override;
+
+    int m_chunkSize;
+    ChunkHandler m_chunkHandler;
+
 };
 
 }
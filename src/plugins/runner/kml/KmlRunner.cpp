@@ -63,6 +63,13 @@ GeoDataDocument *KmlRunner::parseFile(const QString &fileName, DocumentRole role
     }
 
     KmlParser parser;
+    if (chunkSize() > 0) {
+        parser.setChunkHandler(chunkSize(), [this, &fileName, role](GeoDataDocument *chunk) {
+            chunk->setDocumentRole(role);
+            chunk->setFileName(fileName);
+            emit featuresParsed(chunk);
+        });
+    }
     if (!parser.read(device)) {
         error = parser.errorString();
         mDebug() << error;
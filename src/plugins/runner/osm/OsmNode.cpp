@@ -28,6 +28,14 @@ void OsmNode::setCoordinates(const GeoDataCoordinates &coordinates)
     m_coordinates = coordinates;
 }
 
+void OsmNode::merge(const OsmNode &other)
+{
+    m_coordinates = other.m_coordinates;
+    for (auto iter = other.m_osmData.tagsBegin(), end = other.m_osmData.tagsEnd(); iter != end; ++iter) {
+        m_osmData.addTag(iter.key(), iter.value());
+    }
+}
+
 GeoDataPlacemark *OsmNode::create() const
 {
     GeoDataPlacemark::GeoDataVisualCategory const category = StyleBuilder::determineVisualCategory(m_osmData);
@@ -23,6 +23,12 @@ public:
     void parseCoordinates(const QXmlStreamAttributes &attributes);
     void setCoordinates(const GeoDataCoordinates &coordinates);
 
+    /**
+     * Takes over a later occurrence of the same node: its coordinates replace
+     * the current ones, its tags are added.
+     */
+    void merge(const OsmNode &other);
+
     const GeoDataCoordinates & coordinates() const;
     const OsmPlacemarkData & osmData() const;
 
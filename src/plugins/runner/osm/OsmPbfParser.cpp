@@ -12,6 +12,10 @@
 #endif
 
 #include <QDebug>
+#include <QQueue>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 #include <QtEndian>
 
 #include <zlib.h>
@@ -21,17 +25,148 @@
 
 using namespace Marble;
 
+class OsmPbfParser::DecodeJob : public QRunnable
+{
+public:
+    DecodeJob(OsmPbfParser *parser, const RawBlob &blob, Block *block) :
+        m_parser(parser),
+        m_blob(blob),
+        m_block(block)
+    {
+    }
+
+    void run() override
+    {
+#ifdef HAVE_PROTOBUF
+        parseBlob(m_blob, m_parser->decodeContext(), m_block->nodes, m_block->ways, m_block->relations);
+#endif
+        m_parser->finishBlock(m_block);
+    }
+
+private:
+    OsmPbfParser *const m_parser;
+    const RawBlob m_blob;
+    Block *const m_block;
+};
+
+OsmPbfParser::OsmPbfParser() :
+    m_threadCount(QThreadPool::globalInstance()->maxThreadCount())
+{
+}
+
+OsmPbfParser::~OsmPbfParser()
+{
+    qDeleteAll(m_contexts);
+}
+
+void OsmPbfParser::setThreadCount(int threadCount)
+{
+    m_threadCount = qMax(1, threadCount);
+}
+
+int OsmPbfParser::threadCount() const
+{
+    return m_threadCount;
+}
+
 void OsmPbfParser::parse(const uint8_t *data, std::size_t len)
 {
 #ifdef HAVE_PROTOBUF
     const uint8_t *it = data;
     const uint8_t *end = data + len;
-    while (parseBlob(it, end));
+    RawBlob blob;
+
+    if (m_threadCount <= 1) {
+        DecodeContext &context = decodeContext();
+        while (nextBlob(it, end, blob)) {
+            if (blob.data) {
+                parseBlob(blob, context, m_nodes, m_ways, m_relations);
+            }
+        }
+    } else {
+        // Keep enough blobs in flight to saturate the pool, but not the whole file in memory
+        QThreadPool pool;
+        pool.setMaxThreadCount(m_threadCount);
+        const int maxPendingBlocks = 2 * m_threadCount;
+        QQueue<Block*> pendingBlocks;
+        bool hasMoreBlobs = true;
+        forever {
+            while (hasMoreBlobs && pendingBlocks.size() < maxPendingBlocks) {
+                hasMoreBlobs = nextBlob(it, end, blob);
+                if (hasMoreBlobs && blob.data) {
+                    Block *block = new Block;
+                    pendingBlocks.enqueue(block);
+                    pool.start(new DecodeJob(this, blob, block));
+                }
+            }
+            if (pendingBlocks.isEmpty()) {
+                break;
+            }
+
+            Block *block = pendingBlocks.dequeue();
+            m_mutex.lock();
+            while (!block->done) {
+                m_blockDone.wait(&m_mutex);
+            }
+            m_mutex.unlock();
+
+            mergeBlock(*block);
+            delete block;
+        }
+        pool.waitForDone();
+    }
+
+    // The string pools are only needed to share strings while parsing
+    qDeleteAll(m_contexts);
+    m_contexts.clear();
 #endif
 }
 
+OsmPbfParser::DecodeContext &OsmPbfParser::decodeContext()
+{
+    QMutexLocker locker(&m_mutex);
+    DecodeContext *&context = m_contexts[QThread::currentThread()];
+    if (!context) {
+        context = new DecodeContext;
+    }
+    return *context;
+}
+
+void OsmPbfParser::finishBlock(Block *block)
+{
+    QMutexLocker locker(&m_mutex);
+    block->done = true;
+    m_blockDone.wakeAll();
+}
+
+template<typename Elements>
+static void mergeElements(Elements &elements, Elements &blockElements)
+{
+    if (elements.isEmpty()) {
+        elements.swap(blockElements);
+        return;
+    }
+
+    // Elements are usually unique, repeated ones are merged like when decoding sequentially
+    for (auto iter = blockElements.begin(), end = blockElements.end(); iter != end; ++iter) {
+        auto existing = elements.find(iter.key());
+        if (existing == elements.end()) {
+            elements.insert(iter.key(), std::move(iter.value()));
+        } else {
+            existing.value().merge(iter.value());
+        }
+    }
+}
+
+void OsmPbfParser::mergeBlock(Block &block)
+{
+    mergeElements(m_nodes, block.nodes);
+    mergeElements(m_ways, block.ways);
+    mergeElements(m_relations, block.relations);
+}
+
 #ifdef HAVE_PROTOBUF
-bool OsmPbfParser::parseBlob(const uint8_t *&it, const uint8_t *end)
+bool OsmPbfParser::nextBlob(const uint8_t *&it, const uint8_t *end, RawBlob &blob) const
 {
     if (std::distance(it, end) < (int)sizeof(int32_t)) {
         return false;
@@ -51,82 +186,98 @@ bool OsmPbfParser::parseBlob(const uint8_t *&it, const uint8_t *end)
     }
     it += blobHeaderSize;
 
-    OSMPBF::Blob blob;
-    if (std::distance(it, end) < blobHeader.datasize() || !blob.ParseFromArray(it, blobHeader.datasize())) {
+    if (blobHeader.datasize() < 0 || std::distance(it, end) < blobHeader.datasize()) {
         return false;
     }
 
+    // Other blobs like the OSMHeader are skipped
+    blob.data = std::strcmp(blobHeader.type().c_str(), "OSMData") == 0 ? it : nullptr;
+    blob.size = blobHeader.datasize();
+    it += blobHeader.datasize();
+    return true;
+}
+
+void OsmPbfParser::parseBlob(const RawBlob &rawBlob, DecodeContext &context, OsmNodes &nodes, OsmWays &ways, OsmRelations &relations)
+{
+    OSMPBF::Blob blob;
+    if (!blob.ParseFromArray(rawBlob.data, rawBlob.size)) {
+        return;
+    }
+
     const uint8_t *dataBegin = nullptr;
     if (blob.has_raw()) {
         dataBegin = reinterpret_cast<const uint8_t*>(blob.raw().data());
     } else if (blob.has_zlib_data()) {
-        m_zlibBuffer.resize(blob.raw_size());
+        context.zlibBuffer.resize(blob.raw_size());
         z_stream zStream;
         zStream.next_in = (uint8_t*)blob.zlib_data().data();
         zStream.avail_in = blob.zlib_data().size();
-        zStream.next_out = (uint8_t*)m_zlibBuffer.data();
+        zStream.next_out = (uint8_t*)context.zlibBuffer.data();
         zStream.avail_out = blob.raw_size();
         zStream.zalloc = nullptr;
         zStream.zfree = nullptr;
         zStream.opaque = nullptr;
         auto result = inflateInit(&zStream);
         if (result != Z_OK) {
-            return false;
+            return;
         }
         result = inflate(&zStream, Z_FINISH);
+        inflateEnd(&zStream);
         if (result != Z_STREAM_END) {
-            return false;
+            return;
         }
-        result = inflateEnd( &zStream );
-        dataBegin = reinterpret_cast<const uint8_t*>(m_zlibBuffer.constData());
+        dataBegin = reinterpret_cast<const uint8_t*>(context.zlibBuffer.constData());
     } else {
-        return false;
-    }
-    if (std::strcmp(blobHeader.type().c_str(), "OSMData") == 0) {
-        parsePrimitiveBlock(dataBegin, blob.raw_size());
+        return;
     }
 
-    m_zlibBuffer.clear();
-    it += blobHeader.datasize();
-    return true;
+    parsePrimitiveBlock(dataBegin, blob.raw_size(), context, nodes, ways, relations);
 }
 
-void OsmPbfParser::parsePrimitiveBlock(const uint8_t *data, std::size_t len)
+void OsmPbfParser::parsePrimitiveBlock(const uint8_t *data, std::size_t len, DecodeContext &context,
+                                       OsmNodes &nodes, OsmWays &ways, OsmRelations &relations)
 {
     OSMPBF::PrimitiveBlock block;
     if (!block.ParseFromArray(data, len)) {
         return;
     }
 
+    // Convert each string of the block only once
+    const auto &stringTable = block.stringtable();
+    context.strings.resize(stringTable.s_size());
+    for (int i = 0; i < stringTable.s_size(); ++i) {
+        context.strings[i] = *context.stringPool.insert(QString::fromUtf8(stringTable.s(i).data()));
+    }
+
     for (int i = 0; i < block.primitivegroup_size(); ++i) {
         const auto &group = block.primitivegroup(i);
 
         if (group.nodes_size()) {
             qWarning() << "non-dense nodes - not implemented yet!";
         } else if (group.has_dense()) {
-            parseDenseNodes(block, group);
+            parseDenseNodes(group, context.strings, nodes);
         } else if (group.ways_size()) {
-            parseWays(block, group);
+            parseWays(group, context.strings, ways);
         } else if (group.relations_size()) {
-            parseRelations(block, group);
+            parseRelations(group, context.strings, relations);
         }
     }
 }
 
-void OsmPbfParser::parseDenseNodes(const OSMPBF::PrimitiveBlock &block, const OSMPBF::PrimitiveGroup &group)
+void OsmPbfParser::parseDenseNodes(const OSMPBF::PrimitiveGroup &group, const QVector<QString> &strings, OsmNodes &nodes)
 {
     int64_t idDelta = 0;
     int64_t latDelta = 0;
     int64_t lonDelta = 0;
     int tagIdx = 0;
 
-    const auto dense = group.dense();
+    const auto &dense = group.dense();
     for (int i = 0; i < dense.id_size(); ++i) {
         idDelta += dense.id(i);
         latDelta += dense.lat(i);
         lonDelta += dense.lon(i);
 
-        auto &node = m_nodes[idDelta];
+        auto &node = nodes[idDelta];
         node.osmData().setId(idDelta);
         node.setCoordinates(GeoDataCoordinates(lonDelta * 1.0e-7, latDelta * 1.0e-7, 0.0, GeoDataCoordinates::Degree));
 
@@ -136,18 +287,16 @@ void OsmPbfParser::parseDenseNodes(const OSMPBF::PrimitiveBlock &block, const OS
                 break;
             }
             const auto valIdx = dense.keys_vals(tagIdx++);
-            const QString keyString = *m_stringPool.insert(QString::fromUtf8(block.stringtable().s(keyIdx).data()));
-            const QString valueString = *m_stringPool.insert(QString::fromUtf8(block.stringtable().s(valIdx).data()));
-            node.osmData().addTag(keyString, valueString);
+            node.osmData().addTag(strings.value(keyIdx), strings.value(valIdx));
         }
     }
 }
 
-void OsmPbfParser::parseWays(const OSMPBF::PrimitiveBlock &block, const OSMPBF::PrimitiveGroup &group)
+void OsmPbfParser::parseWays(const OSMPBF::PrimitiveGroup &group, const QVector<QString> &strings, OsmWays &ways)
 {
     for (int i = 0; i < group.ways_size(); ++i) {
         const auto &w = group.ways(i);
-        auto &way = m_ways[w.id()];
+        auto &way = ways[w.id()];
         way.osmData().setId(w.id());
 
         int64_t idDelta = 0;
@@ -157,25 +306,23 @@ void OsmPbfParser::parseWays(const OSMPBF::PrimitiveBlock &block, const OSMPBF::
         }
 
         for (int j = 0; j < w.keys_size(); ++j) {
-            const QString keyString = *m_stringPool.insert(QString::fromUtf8(block.stringtable().s(w.keys(j)).data()));
-            const QString valueString = *m_stringPool.insert(QString::fromUtf8(block.stringtable().s(w.vals(j)).data()));
-            way.osmData().addTag(keyString, valueString);
+            way.osmData().addTag(strings.value(w.keys(j)), strings.value(w.vals(j)));
         }
     }
 }
 
-void OsmPbfParser::parseRelations(const OSMPBF::PrimitiveBlock &block, const OSMPBF::PrimitiveGroup &group)
+void OsmPbfParser::parseRelations(const OSMPBF::PrimitiveGroup &group, const QVector<QString> &strings, OsmRelations &relations)
 {
     for (int i = 0; i < group.relations_size(); ++i) {
         const auto &r = group.relations(i);
 
-        auto &rel = m_relations[r.id()];
+        auto &rel = relations[r.id()];
         rel.osmData().setId(r.id());
 
         int64_t idDelta = 0;
         for (int j = 0; j < r.memids_size(); ++j) {
             idDelta += r.memids(j);
-            const QString role = *m_stringPool.insert(QString::fromUtf8(block.stringtable().s(r.roles_sid(j)).data()));
+            const QString role = strings.value(r.roles_sid(j));
             QString typeName;
             const auto type = r.types(j);
             switch (type) {
@@ -187,9 +334,7 @@ void OsmPbfParser::parseRelations(const OSMPBF::PrimitiveBlock &block, const OSM
         }
 
         for (int j = 0; j < r.keys_size(); ++j) {
-            const QString keyString = *m_stringPool.insert(QString::fromUtf8(block.stringtable().s(r.keys(j)).data()));
-            const QString valueString = *m_stringPool.insert(QString::fromUtf8(block.stringtable().s(r.vals(j)).data()));
-            rel.osmData().addTag(keyString, valueString);
+            rel.osmData().addTag(strings.value(r.keys(j)), strings.value(r.vals(j)));
         }
     }
 }
@@ -11,6 +11,15 @@
 #include "OsmWay.h"
 #include "OsmRelation.h"
 
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QVector>
+#include <QWaitCondition>
+
+class QThread;
+
 namespace OSMPBF {
 class PrimitiveBlock;
 class PrimitiveGroup;
@@ -18,24 +27,73 @@ class PrimitiveGroup;
 
 namespace Marble {
 
+/**
+ * Parser for OSM PBF files.
+ *
+ * The file is split into blobs on the calling thread, the blobs are inflated and
+ * decoded on a thread pool. Each blob is decoded into its own maps, which are merged
+ * in file order, so the result does not depend on the number of threads.
+ */
 class OsmPbfParser
 {
 public:
+    OsmPbfParser();
+    ~OsmPbfParser();
+
     void parse(const uint8_t *data, std::size_t len);
 
+    /**
+     * Sets the maximum number of threads used for decoding. With one thread, the
+     * file is decoded on the calling thread. Defaults to the maximum thread count
+     * of the global thread pool.
+     */
+    void setThreadCount(int threadCount);
+    int threadCount() const;
+
     OsmNodes m_nodes;
     OsmWays m_ways;
     OsmRelations m_relations;
 
 private:
-    bool parseBlob(const uint8_t *&it, const uint8_t *end);
-    void parsePrimitiveBlock(const uint8_t *data, std::size_t len);
-    void parseDenseNodes(const OSMPBF::PrimitiveBlock &block,  const OSMPBF::PrimitiveGroup &group);
-    void parseWays(const OSMPBF::PrimitiveBlock &block, const OSMPBF::PrimitiveGroup &group);
-    void parseRelations(const OSMPBF::PrimitiveBlock &block, const OSMPBF::PrimitiveGroup &group);
-
-    QByteArray m_zlibBuffer;
-    QSet<QString> m_stringPool;
+    class DecodeJob;
+
+    // An OSMData blob in the file, still serialized
+    struct RawBlob {
+        const uint8_t *data;
+        int size;
+    };
+
+    // The decoded content of one blob
+    struct Block {
+        OsmNodes nodes;
+        OsmWays ways;
+        OsmRelations relations;
+        bool done = false;
+    };
+
+    // State of a decoding thread
+    struct DecodeContext {
+        QByteArray zlibBuffer;
+        QSet<QString> stringPool;
+        QVector<QString> strings; // string table of the current block
+    };
+
+    bool nextBlob(const uint8_t *&it, const uint8_t *end, RawBlob &blob) const;
+    DecodeContext &decodeContext();
+    void finishBlock(Block *block);
+    void mergeBlock(Block &block);
+
+    static void parseBlob(const RawBlob &blob, DecodeContext &context, OsmNodes &nodes, OsmWays &ways, OsmRelations &relations);
+    static void parsePrimitiveBlock(const uint8_t *data, std::size_t len, DecodeContext &context,
+                                    OsmNodes &nodes, OsmWays &ways, OsmRelations &relations);
+    static void parseDenseNodes(const OSMPBF::PrimitiveGroup &group, const QVector<QString> &strings, OsmNodes &nodes);
+    static void parseWays(const OSMPBF::PrimitiveGroup &group, const QVector<QString> &strings, OsmWays &ways);
+    static void parseRelations(const OSMPBF::PrimitiveGroup &group, const QVector<QString> &strings, OsmRelations &relations);
+
+    int m_threadCount;
+    QMutex m_mutex;
+    QWaitCondition m_blockDone;
+    QHash<QThread*, DecodeContext*> m_contexts;
 };
 
 }
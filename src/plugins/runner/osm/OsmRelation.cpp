@@ -47,6 +47,14 @@ void OsmRelation::addMember(qint64 reference, const QString &role, const QString
     m_members << member;
 }
 
+void OsmRelation::merge(const OsmRelation &other)
+{
+    m_members << other.m_members;
+    for (auto iter = other.m_osmData.tagsBegin(), end = other.m_osmData.tagsEnd(); iter != end; ++iter) {
+        m_osmData.addTag(iter.key(), iter.value());
+    }
+}
+
 void OsmRelation::createMultipolygon(GeoDataDocument *document, OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedNodes, QSet<qint64> &usedWays) const
 {
     if (!m_osmData.containsTag(QStringLiteral("type"), QStringLiteral("multipolygon"))) {
@@ -25,6 +25,12 @@ public:
     OsmPlacemarkData & osmData();
     void parseMember(const QXmlStreamAttributes &attributes);
     void addMember(qint64 reference, const QString &role, const QString &type);
+
+    /**
+     * Takes over a later occurrence of the same relation: its members are
+     * appended, its tags are added.
+     */
+    void merge(const OsmRelation &other);
     void createMultipolygon(GeoDataDocument* document, OsmWays &ways, const OsmNodes &nodes, QSet<qint64> &usedNodes, QSet<qint64> &usedWays) const;
     void createRelation(GeoDataDocument* document, const QHash<qint64, GeoDataPlacemark*>& wayPlacemarks) const;
 
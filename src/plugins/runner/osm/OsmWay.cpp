@@ -19,6 +19,10 @@ namespace Marble {
 QSet<StyleBuilder::OsmTag> OsmWay::s_areaTags;
 QSet<StyleBuilder::OsmTag> OsmWay::s_buildingTags;
 
+// Long ways like coast lines and borders are only projected, so their nodes
+// are kept in the compact storage that the projections read directly
+const int PackedNodeCount = 256;
+
 GeoDataPlacemark *OsmWay::create(const OsmNodes &nodes, QSet<qint64> &usedNodes) const
 {
     OsmPlacemarkData osmData = m_osmData;
@@ -68,7 +72,11 @@ GeoDataPlacemark *OsmWay::create(const OsmNodes &nodes, QSet<qint64> &usedNodes)
             usedNodes << nodeId;
         }
 
-        geometry = new GeoDataLineString(lineString.optimized());
+        GeoDataLineString *const optimized = new GeoDataLineString(lineString.optimized());
+        if (optimized->size() >= PackedNodeCount) {
+            optimized->setStorage(GeoDataLineString::PackedStorage);
+        }
+        geometry = optimized;
     }
 
     Q_ASSERT(geometry != nullptr);
@@ -110,6 +118,14 @@ void OsmWay::addReference(qint64 id)
     m_references << id;
 }
 
+void OsmWay::merge(const OsmWay &other)
+{
+    m_references << other.m_references;
+    for (auto iter = other.m_osmData.tagsBegin(), end = other.m_osmData.tagsEnd(); iter != end; ++iter) {
+        m_osmData.addTag(iter.key(), iter.value());
+    }
+}
+
 bool OsmWay::isArea() const
 {
     // @TODO A single OSM way can be both closed and non-closed, e.g. landuse=grass with barrier=fence.
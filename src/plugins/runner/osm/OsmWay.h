@@ -24,6 +24,12 @@ public:
     OsmPlacemarkData & osmData();
     void addReference(qint64 id);
 
+    /**
+     * Takes over a later occurrence of the same way: its node references are
+     * appended, its tags are added.
+     */
+    void merge(const OsmWay &other);
+
     const OsmPlacemarkData & osmData() const;
     const QVector<qint64> &references() const;
 
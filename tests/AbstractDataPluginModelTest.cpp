@@ -8,9 +8,11 @@
 #include "AbstractDataPluginModel.h"
 
 #include "AbstractDataPluginItem.h"
+#include "MarbleGlobal.h"
 #include "MarbleModel.h"
 #include "ViewportParams.h"
 
+#include <QRandomGenerator>
 #include <QTimer>
 #include <QSignalSpy>
 
@@ -87,7 +89,24 @@ private Q_SLOTS:
 
     void itemsVersusSetSticky();
 
+    void itemsVersusViewport();
+
+    void itemsVersusCollisions();
+
+    void itemsVersusCollisionsAfterSort();
+
+    void itemsVersusCollisionsOfNewItem();
+
+    void findItemVersusSetId();
+
+    void evictItems();
+
+    void benchmarkItems_data();
+    void benchmarkItems();
+
  private:
+    static TestDataPluginItem *createItem( const QString &id, qreal lon, qreal lat );
+
     const MarbleModel m_marbleModel;
     static const ViewportParams fullViewport;
 };
@@ -336,6 +355,186 @@ void AbstractDataPluginModelTest::itemsVersusSetSticky()
     QVERIFY( !model.items( &fullViewport, 1 ).contains( item ) );
 }
 
+TestDataPluginItem *AbstractDataPluginModelTest::createItem( const QString &id, qreal lon, qreal lat )
+{
+    TestDataPluginItem *item = new TestDataPluginItem;
+    item->setId( id );
+    item->setInitialized( true );
+    item->setCoordinate( GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree ) );
+    return item;
+}
+
+void AbstractDataPluginModelTest::itemsVersusViewport()
+{
+    const ViewportParams zoomedViewport( Equirectangular, 10 * DEG2RAD, 10 * DEG2RAD, 10000, QSize( 230, 230 ) );
+
+    TestDataPluginItem *const inside = createItem( "inside", 10, 10 );
+    TestDataPluginItem *const outside = createItem( "outside", -100, 40 );
+    TestDataPluginItem *const moving = createItem( "moving", 120, -30 );
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemsToList( QList<AbstractDataPluginItem*>() << inside << outside << moving );
+
+    QList<AbstractDataPluginItem*> items = model.items( &zoomedViewport, 10 );
+    QVERIFY( items.contains( inside ) );
+    QVERIFY( !items.contains( outside ) );
+    QVERIFY( !items.contains( moving ) );
+
+    // Items announce changes of their position with updated()
+    moving->setCoordinate( GeoDataCoordinates( 10.1, 10.1, 0.0, GeoDataCoordinates::Degree ) );
+    emit moving->updated();
+    items = model.items( &zoomedViewport, 10 );
+    QVERIFY( items.contains( inside ) );
+    QVERIFY( items.contains( moving ) );
+    QVERIFY( !items.contains( outside ) );
+}
+
+void AbstractDataPluginModelTest::itemsVersusCollisions()
+{
+    TestDataPluginItem *const first = createItem( "first", 0, 0 );
+    TestDataPluginItem *const second = createItem( "second", 0.5, 0 );
+    TestDataPluginItem *const third = createItem( "third", 30, 0 );
+    for ( TestDataPluginItem *item: { first, second, third } ) {
+        item->setSize( QSizeF( 20, 20 ) );
+    }
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemsToList( QList<AbstractDataPluginItem*>() << first << second << third );
+
+    // The first two items overlap on the screen, the lower one is hidden
+    const QList<AbstractDataPluginItem*> items = model.items( &fullViewport, 10 );
+    QCOMPARE( items.size(), 2 );
+    QVERIFY( items.contains( third ) );
+    QCOMPARE( items.contains( first ), !items.contains( second ) );
+}
+
+void AbstractDataPluginModelTest::itemsVersusCollisionsAfterSort()
+{
+    TestDataPluginItem *const first = createItem( "first", 0, 0 );
+    TestDataPluginItem *const second = createItem( "second", 0.5, 0 );
+    for ( TestDataPluginItem *item: { first, second } ) {
+        item->setSize( QSizeF( 20, 20 ) );
+    }
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemsToList( QList<AbstractDataPluginItem*>() << first << second );
+
+    QList<AbstractDataPluginItem*> items = model.items( &fullViewport, 10 );
+    QCOMPARE( items.size(), 1 );
+    TestDataPluginItem *const hidden = items.contains( first ) ? second : first;
+
+    // A sticky item takes precedence over a displayed one it overlaps
+    hidden->setSticky( true );
+    items = model.items( &fullViewport, 10 );
+    QCOMPARE( items.size(), 1 );
+    QVERIFY( items.contains( hidden ) );
+}
+
+void AbstractDataPluginModelTest::itemsVersusCollisionsOfNewItem()
+{
+    TestDataPluginItem *const one = createItem( "one", 0, 0 );
+    TestDataPluginItem *const other = createItem( "other", 0.5, 0 );
+    for ( TestDataPluginItem *item: { one, other } ) {
+        item->setSize( QSizeF( 20, 20 ) );
+    }
+    // items are ordered by their address, so the later one is sorted in front
+    TestDataPluginItem *const displayed = qMax( one, other );
+    TestDataPluginItem *const later = qMin( one, other );
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemToList( displayed );
+    QList<AbstractDataPluginItem*> items = model.items( &fullViewport, 10 );
+    QCOMPARE( items.size(), 1 );
+    QVERIFY( items.contains( displayed ) );
+
+    // An item that is already shown keeps its place against new ones it overlaps
+    model.addItemsToList( QList<AbstractDataPluginItem*>() << later );
+    items = model.items( &fullViewport, 10 );
+    QCOMPARE( items.size(), 1 );
+    QVERIFY( items.contains( displayed ) );
+}
+
+void AbstractDataPluginModelTest::findItemVersusSetId()
+{
+    TestDataPluginItem *const item = createItem( "foo", 0, 0 );
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemToList( item );
+    QCOMPARE( model.findItem( "foo" ), item );
+
+    item->setId( "bar" );
+    QCOMPARE( model.findItem( "foo" ), static_cast<AbstractDataPluginItem *>( nullptr ) );
+    QCOMPARE( model.findItem( "bar" ), item );
+}
+
+void AbstractDataPluginModelTest::evictItems()
+{
+    const ViewportParams zoomedViewport( Equirectangular, 10 * DEG2RAD, 10 * DEG2RAD, 10000, QSize( 230, 230 ) );
+
+    QPointer<TestDataPluginItem> inside( createItem( "inside", 10, 10 ) );
+    QPointer<TestDataPluginItem> near( createItem( "near", 11, 11 ) );
+    QPointer<TestDataPluginItem> far( createItem( "far", -100, 40 ) );
+    QPointer<TestDataPluginItem> favorite( createItem( "favorite", -100, 41 ) );
+    favorite->setFavorite( true );
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.setMaximumItemCount( 1 );
+    model.addItemsToList( QList<AbstractDataPluginItem*>() << inside << near << far << favorite );
+    QVERIFY( model.items( &zoomedViewport, 10 ).contains( inside ) );
+
+    QMetaObject::invokeMethod( &model, "handleChangedViewport" );
+    QTRY_VERIFY( far.isNull() );
+    QVERIFY( !model.itemExists( "far" ) );
+    QVERIFY( !inside.isNull() );
+    QVERIFY( !near.isNull() );
+    QVERIFY( !favorite.isNull() );
+    QVERIFY( model.itemExists( "near" ) );
+
+    // Removed items can be added again
+    model.addItemToList( createItem( "far", -100, 40 ) );
+    QVERIFY( model.itemExists( "far" ) );
+}
+
+void AbstractDataPluginModelTest::benchmarkItems_data()
+{
+    QTest::addColumn<qreal>( "lon" );
+    QTest::addColumn<qreal>( "lat" );
+    QTest::addColumn<int>( "radius" );
+
+    addRow() << 0.0 << 0.0 << 100;
+    addRow() << 10.0 << 50.0 << 2000;
+    addRow() << 10.0 << 50.0 << 20000;
+}
+
+void AbstractDataPluginModelTest::benchmarkItems()
+{
+    QFETCH( qreal, lon );
+    QFETCH( qreal, lat );
+    QFETCH( int, radius );
+
+    // 100k items with labels all over the world
+    QRandomGenerator random( 42 );
+    QList<AbstractDataPluginItem*> items;
+    for ( int i = 0; i < 100000; ++i ) {
+        TestDataPluginItem *const item = createItem( QString::number( i ),
+                                                     random.generateDouble() * 360.0 - 180.0,
+                                                     random.generateDouble() * 170.0 - 85.0 );
+        item->setSize( QSizeF( 40, 16 ) );
+        items << item;
+    }
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.setMaximumItemCount( items.size() );
+    model.addItemsToList( items );
+
+    const ViewportParams viewport( Equirectangular, lon * DEG2RAD, lat * DEG2RAD, radius, QSize( 1000, 800 ) );
+    int count = 0;
+    QBENCHMARK {
+        count = model.items( &viewport, 100 ).size();
+    }
+    QVERIFY( count > 0 );
+}
+
 QTEST_MAIN( AbstractDataPluginModelTest )
 
 #include "AbstractDataPluginModelTest.moc"
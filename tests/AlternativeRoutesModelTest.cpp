@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "AlternativeRoutesModel.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QTest>
+#include <qmath.h>
+
+namespace Marble
+{
+
+namespace
+{
+
+// Distance of the points of the routes in radian
+const qreal step = 0.0001;
+
+}
+
+/**
+ * Compares the similarity of routes with the one AlternativeRoutesModel
+ * measured before by drawing the routes into a bitmap.
+ */
+class AlternativeRoutesModelTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void similarity_data();
+    void similarity();
+    void ranking();
+    void addRoute();
+    void clearPending();
+
+    void benchmarkSimilarity_data();
+    void benchmarkSimilarity();
+
+ private:
+    static GeoDataLineString walk( int size, qreal lon, qreal lat, qreal heading, quint32 seed, qreal distance = step );
+    static GeoDataLineString detour( const GeoDataLineString &route, qreal share );
+    static GeoDataLineString offset( const GeoDataLineString &route, qreal distance );
+    static GeoDataDocument* document( const GeoDataLineString &route );
+    static qreal bitmapSimilarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB );
+    static qreal unidirectionalBitmapSimilarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB );
+};
+
+GeoDataLineString AlternativeRoutesModelTest::walk( int size, qreal lon, qreal lat, qreal heading, quint32 seed, qreal distance )
+{
+    // a road winding along
+    QRandomGenerator random( seed );
+    GeoDataLineString route;
+    route.reserve( size + 1 );
+    route << GeoDataCoordinates( lon, lat );
+    for ( int i = 0; i < size; ++i ) {
+        heading += ( random.generateDouble() - 0.5 ) * 0.15;
+        lon += distance * qCos( heading );
+        lat += distance * qSin( heading );
+        route << GeoDataCoordinates( lon, lat );
+    }
+    return route;
+}
+
+GeoDataLineString AlternativeRoutesModelTest::detour( const GeoDataLineString &route, qreal share )
+{
+    // leaves the route after a fifth, then returns to it in a straight line
+    const int start = route.size() / 5;
+    const int length = int( route.size() * share );
+    const int end = qMin( route.size() - 1, start + length );
+    const qreal dx = route[1].longitude() - route[0].longitude();
+    const qreal dy = route[1].latitude() - route[0].latitude();
+    const qreal distance = qSqrt( dx * dx + dy * dy );
+    const GeoDataLineString away = walk( length, route[start].longitude(), route[start].latitude(), 1.2, 5, distance );
+
+    GeoDataLineString result;
+    for ( int i = 0; i < start; ++i ) {
+        result << route[i];
+    }
+    for ( int i = 0; i < away.size(); ++i ) {
+        result << away[i];
+    }
+    const GeoDataCoordinates last = away.last();
+    for ( int i = 1; i <= 50; ++i ) {
+        const qreal t = i / 50.0;
+        result << GeoDataCoordinates( last.longitude() + ( route[end].longitude() - last.longitude() ) * t,
+                                      last.latitude() + ( route[end].latitude() - last.latitude() ) * t );
+    }
+    for ( int i = end + 1; i < route.size(); ++i ) {
+        result << route[i];
+    }
+    return result;
+}
+
+GeoDataLineString AlternativeRoutesModelTest::offset( const GeoDataLineString &route, qreal distance )
+{
+    GeoDataLineString result;
+    for ( int i = 0; i < route.size(); ++i ) {
+        result << GeoDataCoordinates( route[i].longitude(), route[i].latitude() + distance );
+    }
+    return result;
+}
+
+GeoDataDocument* AlternativeRoutesModelTest::document( const GeoDataLineString &route )
+{
+    GeoDataDocument* result = new GeoDataDocument;
+    GeoDataPlacemark* placemark = new GeoDataPlacemark;
+    placemark->setName( QStringLiteral( "Route" ) );
+    placemark->setGeometry( new GeoDataLineString( route ) );
+    result->append( placemark );
+    return result;
+}
+
+qreal AlternativeRoutesModelTest::bitmapSimilarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB )
+{
+    return qMax<qreal>( unidirectionalBitmapSimilarity( routeA, routeB ),
+                        unidirectionalBitmapSimilarity( routeB, routeA ) );
+}
+
+qreal AlternativeRoutesModelTest::unidirectionalBitmapSimilarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB )
+{
+    // How AlternativeRoutesModel compared routes before
+    QImage image( 64, 64, QImage::Format_ARGB32_Premultiplied );
+    image.fill( qRgb( 0, 0, 0 ) );
+    GeoDataLatLonBox box = GeoDataLatLonBox::fromLineString( routeA );
+    box = box.united( GeoDataLatLonBox::fromLineString( routeB ) );
+    if ( !box.width() || !box.height() ) {
+        return 0.0;
+    }
+
+    qreal const sw = image.width() / box.width();
+    qreal const sh = image.height() / box.height();
+
+    QPainter painter( &image );
+    painter.setPen( QColor( Qt::white ) );
+
+    const auto polygon = [&]( const GeoDataLineString &lineString ) {
+        QPolygonF poly;
+        for ( int i = 0; i < lineString.size(); ++i ) {
+            poly << QPointF( qAbs( lineString[i].longitude() - box.west() ) * sw,
+                             qAbs( lineString[i].latitude() - box.north() ) * sh );
+        }
+        return poly;
+    };
+    const auto nonZero = [&]() {
+        int count = 0;
+        for ( int y = 0; y < image.height(); ++y ) {
+            const QRgb* line = reinterpret_cast<const QRgb*>( image.constScanLine( y ) );
+            for ( int x = 0; x < image.width(); ++x ) {
+                count += line[x] == qRgb( 0, 0, 0 ) ? 0 : 1;
+            }
+        }
+        return count;
+    };
+
+    painter.drawPoints( polygon( routeA ) );
+    int const countA = nonZero();
+    painter.drawPoints( polygon( routeB ) );
+    int const countB = nonZero();
+    return countB ? 1.0 - qreal( countB - countA ) / countB : 0;
+}
+
+void AlternativeRoutesModelTest::similarity_data()
+{
+    QTest::addColumn<GeoDataLineString>( "routeA" );
+    QTest::addColumn<GeoDataLineString>( "routeB" );
+
+    const GeoDataLineString route = walk( 600, 0.1, 0.8, 0.3, 1 );
+    GeoDataLineString reversed;
+    for ( int i = route.size() - 1; i >= 0; --i ) {
+        reversed << route[i];
+    }
+    GeoDataLineString subset;
+    for ( int i = 100; i < 400; ++i ) {
+        subset << route[i];
+    }
+
+    QTest::newRow( "same" ) << route << route;
+    QTest::newRow( "reversed" ) << route << reversed;
+    QTest::newRow( "detour 10%" ) << route << detour( route, 0.1 );
+    QTest::newRow( "detour 30%" ) << route << detour( route, 0.3 );
+    QTest::newRow( "detour 50%" ) << route << detour( route, 0.5 );
+    QTest::newRow( "detour 80%" ) << route << detour( route, 0.8 );
+    QTest::newRow( "offset 0.2" ) << route << offset( route, 0.2 * step );
+    QTest::newRow( "offset 1" ) << route << offset( route, step );
+    QTest::newRow( "offset 3" ) << route << offset( route, 3 * step );
+    QTest::newRow( "offset 10" ) << route << offset( route, 10 * step );
+    QTest::newRow( "different" ) << route << walk( 600, 0.1, 0.8, -0.5, 9 );
+    QTest::newRow( "subset" ) << route << subset;
+}
+
+void AlternativeRoutesModelTest::similarity()
+{
+    QFETCH( GeoDataLineString, routeA );
+    QFETCH( GeoDataLineString, routeB );
+
+    const qreal expected = bitmapSimilarity( routeA, routeB );
+    const qreal result = AlternativeRoutesModel::similarity( routeA, routeB );
+    QVERIFY2( qAbs( result - expected ) < 0.1,
+              qPrintable( QStringLiteral( "%1 instead of %2" ).arg( result ).arg( expected ) ) );
+    QCOMPARE( AlternativeRoutesModel::similarity( routeB, routeA ), result );
+    QVERIFY( result >= 0.0 && result <= 1.0 );
+}
+
+void AlternativeRoutesModelTest::ranking()
+{
+    // Routes clearly more similar in the bitmap are more similar as well
+    const GeoDataLineString route = walk( 600, 0.1, 0.8, 0.3, 1 );
+    QVector<GeoDataLineString> alternatives;
+    for ( qreal share: { 0.1, 0.3, 0.5, 0.8 } ) {
+        alternatives << detour( route, share );
+    }
+    for ( qreal distance: { 0.2, 1.0, 3.0, 10.0 } ) {
+        alternatives << offset( route, distance * step );
+    }
+    for ( quint32 seed = 10; seed < 14; ++seed ) {
+        alternatives << walk( 600, 0.1, 0.8, 0.3 + ( seed - 10 ) * 0.2, seed );
+    }
+
+    QVector<qreal> expected;
+    QVector<qreal> result;
+    for ( const GeoDataLineString &alternative: alternatives ) {
+        expected << bitmapSimilarity( route, alternative );
+        result << AlternativeRoutesModel::similarity( route, alternative );
+    }
+
+    for ( int i = 0; i < alternatives.size(); ++i ) {
+        for ( int j = 0; j < alternatives.size(); ++j ) {
+            if ( expected[i] > expected[j] + 0.1 ) {
+                QVERIFY2( result[i] > result[j], qPrintable( QStringLiteral( "%1 %2" ).arg( i ).arg( j ) ) );
+            }
+        }
+    }
+}
+
+void AlternativeRoutesModelTest::addRoute()
+{
+    const GeoDataLineString route = walk( 600, 0.1, 0.8, 0.3, 1 );
+    const GeoDataLineString other = walk( 600, 0.1, 0.8, -0.5, 9 );
+
+    AlternativeRoutesModel model;
+    model.addRoute( document( route ) );
+    QCOMPARE( model.rowCount(), 1 );
+
+    // The same route is dropped, a different one added after comparing
+    model.addRoute( document( route ) );
+    model.addRoute( document( other ) );
+    QTRY_COMPARE( model.rowCount(), 2 );
+    QCOMPARE( *AlternativeRoutesModel::waypoints( model.route( 1 ) ), other );
+
+    const GeoDataLineString third = walk( 600, 0.1, 0.8, 1.5, 11 );
+    model.addRoute( document( detour( route, 0.1 ) ) );
+    model.addRoute( document( third ) );
+    QTRY_COMPARE( model.rowCount(), 3 );
+    QCOMPARE( *AlternativeRoutesModel::waypoints( model.route( 2 ) ), third );
+
+    model.addRoute( document( route ), AlternativeRoutesModel::Instant );
+    QCOMPARE( model.rowCount(), 4 );
+}
+
+void AlternativeRoutesModelTest::clearPending()
+{
+    const GeoDataLineString route = walk( 600, 0.1, 0.8, 0.3, 1 );
+    const GeoDataLineString other = walk( 600, 0.1, 0.8, -0.5, 9 );
+
+    AlternativeRoutesModel model;
+    model.addRoute( document( route ) );
+    model.addRoute( document( other ) );
+    model.clear();
+    QCOMPARE( model.rowCount(), 0 );
+
+    // The route compared before does not show up in the new routes
+    model.addRoute( document( route ) );
+    QCOMPARE( model.rowCount(), 1 );
+    QTest::qWait( 200 );
+    QCOMPARE( model.rowCount(), 1 );
+}
+
+void AlternativeRoutesModelTest::benchmarkSimilarity_data()
+{
+    QTest::addColumn<bool>( "bitmap" );
+    QTest::addColumn<int>( "size" );
+
+    for ( int size: { 1000, 10000, 100000 } ) {
+        QTest::newRow( qPrintable( QStringLiteral( "bitmap %1" ).arg( size ) ) ) << true << size;
+        QTest::newRow( qPrintable( QStringLiteral( "vector %1" ).arg( size ) ) ) << false << size;
+    }
+}
+
+void AlternativeRoutesModelTest::benchmarkSimilarity()
+{
+    QFETCH( bool, bitmap );
+    QFETCH( int, size );
+
+    // the same extent for all sizes, a tenth of a radian
+    const GeoDataLineString route = walk( size, 0.1, 0.8, 0.3, 1, 0.1 / size );
+    const GeoDataLineString alternative = detour( route, 0.3 );
+
+    qreal result = 0.0;
+    if ( bitmap ) {
+        QBENCHMARK {
+            result = bitmapSimilarity( route, alternative );
+        }
+    } else {
+        QBENCHMARK {
+            result = AlternativeRoutesModel::similarity( route, alternative );
+        }
+    }
+    QVERIFY( result > 0.0 );
+}
+
+}
+
+QTEST_MAIN( Marble::AlternativeRoutesModelTest )
+
+#include "AlternativeRoutesModelTest.moc"
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoDataCoordinates.h"
+#include "MarbleGlobal.h"
+#include "ViewportParams.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+
+Q_DECLARE_METATYPE( Marble::Projection )
+
+namespace Marble
+{
+
+/**
+ * Compares the batch screen coordinates of all projections with the ones of single points.
+ */
+class BatchProjectionTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void screenCoordinates_data();
+    void screenCoordinates();
+    void emptyBatch();
+
+    void benchmarkScreenCoordinates_data();
+    void benchmarkScreenCoordinates();
+
+ private:
+    static void createPoints( int count, QVector<qreal> &lon, QVector<qreal> &lat, QVector<qreal> &altitude );
+};
+
+void BatchProjectionTest::createPoints( int count, QVector<qreal> &lon, QVector<qreal> &lat, QVector<qreal> &altitude )
+{
+    QRandomGenerator random( 42 );
+    lon.resize( count );
+    lat.resize( count );
+    altitude.resize( count );
+    for ( int i = 0; i < count; ++i ) {
+        lon[i] = ( random.generateDouble() * 2 - 1 ) * M_PI;
+        lat[i] = ( random.generateDouble() - 0.5 ) * M_PI;
+        // mostly placemarks on the ground, some satellites
+        altitude[i] = i % 10 == 0 ? random.generateDouble() * 40000000 : 0.0;
+    }
+}
+
+void BatchProjectionTest::screenCoordinates_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+    QTest::addColumn<qreal>( "centerLon" );
+    QTest::addColumn<qreal>( "centerLat" );
+    QTest::addColumn<int>( "radius" );
+
+    const QVector<QPair<Projection, const char *> > projections = {
+        { Spherical, "spherical" },
+        { Equirectangular, "equirectangular" },
+        { Mercator, "mercator" },
+        { Gnomonic, "gnomonic" },
+        { Stereographic, "stereographic" },
+        { LambertAzimuthal, "lambert azimuthal" },
+        { AzimuthalEquidistant, "azimuthal equidistant" },
+        { VerticalPerspective, "vertical perspective" }
+    };
+
+    for ( const auto &projection: projections ) {
+        QTest::addRow( "%s world", projection.second ) << projection.first << 0.0 << 0.0 << 100;
+        QTest::addRow( "%s europe", projection.second ) << projection.first << 10 * DEG2RAD << 50 * DEG2RAD << 2000;
+        QTest::addRow( "%s date line", projection.second ) << projection.first << 179 * DEG2RAD << -40 * DEG2RAD << 500;
+        QTest::addRow( "%s pole", projection.second ) << projection.first << -60 * DEG2RAD << 89 * DEG2RAD << 800;
+    }
+}
+
+void BatchProjectionTest::screenCoordinates()
+{
+    QFETCH( Projection, projection );
+    QFETCH( qreal, centerLon );
+    QFETCH( qreal, centerLat );
+    QFETCH( int, radius );
+
+    const ViewportParams viewport( projection, centerLon, centerLat, radius, QSize( 800, 600 ) );
+
+    const int count = 10000;
+    QVector<qreal> lon;
+    QVector<qreal> lat;
+    QVector<qreal> altitude;
+    createPoints( count, lon, lat, altitude );
+
+    QVector<qreal> x( count );
+    QVector<qreal> y( count );
+    QVector<bool> visible( count );
+    QVector<bool> hidden( count );
+    viewport.screenCoordinates( lon.constData(), lat.constData(), altitude.constData(), count,
+                                x.data(), y.data(), visible.data(), hidden.data() );
+
+    int visibleCount = 0;
+    for ( int i = 0; i < count; ++i ) {
+        qreal expectedX = 0;
+        qreal expectedY = 0;
+        bool expectedHidden = false;
+        const bool expectedVisible = viewport.screenCoordinates( GeoDataCoordinates( lon[i], lat[i], altitude[i] ),
+                                                                 expectedX, expectedY, expectedHidden );
+        QCOMPARE( visible[i], expectedVisible );
+        QCOMPARE( hidden[i], expectedHidden );
+        if ( expectedVisible ) {
+            QVERIFY( qAbs( x[i] - expectedX ) < 1e-6 );
+            QVERIFY( qAbs( y[i] - expectedY ) < 1e-6 );
+            ++visibleCount;
+        }
+    }
+    QVERIFY( visibleCount > 0 );
+
+    // without altitudes all points are on the ground
+    viewport.screenCoordinates( lon.constData(), lat.constData(), nullptr, count,
+                                x.data(), y.data(), visible.data() );
+    for ( int i = 0; i < count; ++i ) {
+        qreal expectedX = 0;
+        qreal expectedY = 0;
+        const bool expectedVisible = viewport.screenCoordinates( lon[i], lat[i], expectedX, expectedY );
+        QCOMPARE( visible[i], expectedVisible );
+        if ( expectedVisible ) {
+            QVERIFY( qAbs( x[i] - expectedX ) < 1e-6 );
+            QVERIFY( qAbs( y[i] - expectedY ) < 1e-6 );
+        }
+    }
+}
+
+void BatchProjectionTest::emptyBatch()
+{
+    const ViewportParams viewport( Spherical, 0, 0, 100, QSize( 800, 600 ) );
+    viewport.screenCoordinates( nullptr, nullptr, nullptr, 0, nullptr, nullptr, nullptr );
+}
+
+void BatchProjectionTest::benchmarkScreenCoordinates_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+    QTest::addColumn<bool>( "batch" );
+
+    QTest::newRow( "spherical single" ) << Spherical << false;
+    QTest::newRow( "spherical batch" ) << Spherical << true;
+    QTest::newRow( "equirectangular single" ) << Equirectangular << false;
+    QTest::newRow( "equirectangular batch" ) << Equirectangular << true;
+    QTest::newRow( "mercator single" ) << Mercator << false;
+    QTest::newRow( "mercator batch" ) << Mercator << true;
+    QTest::newRow( "gnomonic single" ) << Gnomonic << false;
+    QTest::newRow( "gnomonic batch" ) << Gnomonic << true;
+    QTest::newRow( "stereographic single" ) << Stereographic << false;
+    QTest::newRow( "stereographic batch" ) << Stereographic << true;
+    QTest::newRow( "lambert azimuthal single" ) << LambertAzimuthal << false;
+    QTest::newRow( "lambert azimuthal batch" ) << LambertAzimuthal << true;
+    QTest::newRow( "azimuthal equidistant single" ) << AzimuthalEquidistant << false;
+    QTest::newRow( "azimuthal equidistant batch" ) << AzimuthalEquidistant << true;
+    QTest::newRow( "vertical perspective single" ) << VerticalPerspective << false;
+    QTest::newRow( "vertical perspective batch" ) << VerticalPerspective << true;
+}
+
+void BatchProjectionTest::benchmarkScreenCoordinates()
+{
+    QFETCH( Projection, projection );
+    QFETCH( bool, batch );
+
+    const ViewportParams viewport( projection, 10 * DEG2RAD, 50 * DEG2RAD, 1000, QSize( 1920, 1080 ) );
+
+    // about the placemarks of a world wide city layer
+    const int count = 200000;
+    QVector<qreal> lon;
+    QVector<qreal> lat;
+    QVector<qreal> altitude;
+    createPoints( count, lon, lat, altitude );
+
+    QVector<qreal> x( count );
+    QVector<qreal> y( count );
+    QVector<bool> visible( count );
+
+    if ( batch ) {
+        QBENCHMARK {
+            viewport.screenCoordinates( lon.constData(), lat.constData(), altitude.constData(), count,
+                                        x.data(), y.data(), visible.data() );
+        }
+    } else {
+        GeoDataCoordinates coordinates;
+        QBENCHMARK {
+            for ( int i = 0; i < count; ++i ) {
+                coordinates.set( lon[i], lat[i], altitude[i] );
+                visible[i] = viewport.screenCoordinates( coordinates, x[i], y[i] );
+            }
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::BatchProjectionTest )
+
+#include "BatchProjectionTest.moc"
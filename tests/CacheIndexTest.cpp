@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "CacheIndex.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+namespace Marble
+{
+
+class CacheIndexTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void leastRecentlyUsed();
+    void persistence();
+    void truncatedJournal();
+
+    void benchmarkLoad();
+    void benchmarkEviction();
+
+ private:
+    static QString tileFileName( int i );
+    QString journalFileName( const QString &name ) const;
+
+    QTemporaryDir m_directory;
+};
+
+void CacheIndexTest::initTestCase()
+{
+    QVERIFY( m_directory.isValid() );
+}
+
+QString CacheIndexTest::tileFileName( int i )
+{
+    return QString( "maps/earth/openstreetmap/%1/%2/%3.png" ).arg( 10 + i % 8 ).arg( i / 1000 ).arg( i % 1000 );
+}
+
+QString CacheIndexTest::journalFileName( const QString &name ) const
+{
+    return m_directory.path() + QLatin1Char( '/' ) + name;
+}
+
+void CacheIndexTest::leastRecentlyUsed()
+{
+    CacheIndex index( journalFileName( "lru.journal" ) );
+    QVERIFY( !index.load() );
+    QCOMPARE( index.oldest(), QString() );
+
+    index.insert( "a", 10 );
+    index.insert( "b", 20 );
+    index.insert( "c", 30 );
+    QCOMPARE( index.count(), 3 );
+    QCOMPARE( index.totalSize(), quint64( 60 ) );
+    QCOMPARE( index.oldest(), QString( "a" ) );
+
+    index.touch( "a" );
+    QCOMPARE( index.oldest(), QString( "b" ) );
+
+    index.insert( "b", 5 );
+    QCOMPARE( index.oldest(), QString( "c" ) );
+    QCOMPARE( index.totalSize(), quint64( 45 ) );
+
+    index.touch( "unknown" );
+    QCOMPARE( index.count(), 3 );
+
+    index.remove( "c" );
+    QCOMPARE( index.oldest(), QString( "a" ) );
+    QCOMPARE( index.size( "a" ), quint64( 10 ) );
+    QCOMPARE( index.size( "c" ), quint64( 0 ) );
+    QCOMPARE( index.totalSize(), quint64( 15 ) );
+}
+
+void CacheIndexTest::persistence()
+{
+    const QString fileName = journalFileName( "persistence.journal" );
+
+    {
+        CacheIndex index( fileName );
+        QVERIFY( !index.load() );
+        index.insert( "a", 10 );
+        index.insert( "b", 20 );
+
+        // entries are journaled once the index has been written
+        index.compact();
+        index.insert( "c", 30 );
+        index.touch( "a" );
+        index.remove( "b" );
+    }
+
+    CacheIndex index( fileName );
+    QVERIFY( index.load() );
+    QCOMPARE( index.count(), 2 );
+    QCOMPARE( index.totalSize(), quint64( 40 ) );
+    QCOMPARE( index.oldest(), QString( "c" ) );
+    QVERIFY( !index.contains( "b" ) );
+}
+
+void CacheIndexTest::truncatedJournal()
+{
+    const QString fileName = journalFileName( "truncated.journal" );
+
+    {
+        CacheIndex index( fileName );
+        index.compact();
+        index.insert( "a", 10 );
+        index.insert( "b", 20 );
+    }
+
+    QFile file( fileName );
+    QVERIFY( file.resize( file.size() - 3 ) );
+
+    {
+        CacheIndex index( fileName );
+        QVERIFY( index.load() );
+        QCOMPARE( index.count(), 1 );
+        index.insert( "c", 30 );
+    }
+
+    CacheIndex index( fileName );
+    QVERIFY( index.load() );
+    QCOMPARE( index.count(), 2 );
+    QCOMPARE( index.totalSize(), quint64( 40 ) );
+}
+
+void CacheIndexTest::benchmarkLoad()
+{
+    const QString fileName = journalFileName( "million.journal" );
+
+    {
+        CacheIndex index( fileName );
+        for ( int i = 0; i < 1000000; ++i ) {
+            index.insert( tileFileName( i ), 15000 );
+        }
+        index.compact();
+    }
+
+    QBENCHMARK_ONCE {
+        CacheIndex index( fileName );
+        QVERIFY( index.load() );
+        QCOMPARE( index.count(), 1000000 );
+    }
+}
+
+void CacheIndexTest::benchmarkEviction()
+{
+    CacheIndex index( journalFileName( "million.journal" ) );
+    QVERIFY( index.load() );
+
+    QBENCHMARK_ONCE {
+        // touch a tenth of the tiles, then evict another tenth of them
+        for ( int i = 0; i < 1000000; i += 10 ) {
+            index.touch( tileFileName( i ) );
+        }
+        for ( int i = 0; i < 100000; ++i ) {
+            index.remove( index.oldest() );
+        }
+    }
+
+    QCOMPARE( index.count(), 900000 );
+    QVERIFY( index.contains( tileFileName( 0 ) ) );
+}
+
+}
+
+QTEST_MAIN( Marble::CacheIndexTest )
+
+#include "CacheIndexTest.moc"
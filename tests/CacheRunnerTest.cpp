@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoDataData.h"
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataPlacemark.h"
+#include "MarbleDirs.h"
+#include "ParsingRunnerManager.h"
+#include "PluginManager.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+namespace Marble
+{
+
+/**
+ * Writes placemark caches in the stream based version 13 and the memory
+ * mapped version 16 written by kml2cache, and reads them back.
+ */
+class CacheRunnerTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void parse_data();
+    void parse();
+    void truncated();
+    void tooNew();
+    void shippedCache();
+
+    void benchmarkParse_data();
+    void benchmarkParse();
+
+ private:
+    QString writeCache( const QString &name, int version, int count ) const;
+    static QString placemarkName( int i );
+
+    QTemporaryDir m_directory;
+    PluginManager m_pluginManager;
+};
+
+void CacheRunnerTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+    QVERIFY( m_directory.isValid() );
+}
+
+QString CacheRunnerTest::placemarkName( int i )
+{
+    return QString( "City %1" ).arg( i );
+}
+
+QString CacheRunnerTest::writeCache( const QString &name, int version, int count ) const
+{
+    const QString fileName = m_directory.path() + QLatin1Char( '/' ) + name + QLatin1String( ".cache" );
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        return QString();
+    }
+
+    QDataStream out( &file );
+    out << quint32( 0x31415926 ) << qint32( version );
+    out.setVersion( QDataStream::Qt_4_2 );
+
+    const QString role = QStringLiteral( "PPLA" );
+    if ( version < 16 ) {
+        for ( int i = 0; i < count; ++i ) {
+            out << placemarkName( i ) << double( 0.001 * i ) << double( 0.5 ) << double( i )
+                << role << QString() << QStringLiteral( "DE" ) << QString()
+                << double( 1.5 ) << qint64( 1000 * i ) << qint16( 60 ) << qint8( i % 2 );
+        }
+        return fileName;
+    }
+
+    // strings: empty, role, country code, names
+    QVector<QString> strings = { QString(), role, QStringLiteral( "DE" ) };
+    out.setByteOrder( QDataStream::LittleEndian );
+    out << quint32( count ) << quint32( strings.size() + count );
+    for ( int i = 0; i < count; ++i ) {
+        out << double( 0.001 * i ) << double( 0.5 ) << double( i ) << double( 1.5 ) << qint64( 1000 * i )
+            << quint32( strings.size() + i ) << quint32( 1 ) << quint32( 0 ) << quint32( 2 ) << quint32( 0 )
+            << qint16( 60 ) << qint8( i % 2 ) << quint8( 0 );
+    }
+    for ( int i = 0; i < count; ++i ) {
+        strings << placemarkName( i );
+    }
+
+    quint32 offset = 0;
+    for ( const QString &string: strings ) {
+        out << offset << quint32( string.size() );
+        offset += string.size();
+    }
+    for ( const QString &string: strings ) {
+        for ( const QChar character: string ) {
+            out << quint16( character.unicode() );
+        }
+    }
+
+    return fileName;
+}
+
+void CacheRunnerTest::parse_data()
+{
+    QTest::addColumn<int>( "version" );
+
+    QTest::newRow( "stream" ) << 13;
+    QTest::newRow( "mapped" ) << 16;
+}
+
+void CacheRunnerTest::parse()
+{
+    QFETCH( int, version );
+
+    const QString fileName = writeCache( QString( "parse%1" ).arg( version ), version, 3 );
+    QVERIFY( !fileName.isEmpty() );
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    GeoDataDocument *document = runnerManager.openFile( fileName );
+    QVERIFY( document );
+    QCOMPARE( document->placemarkList().size(), 3 );
+
+    const GeoDataPlacemark *placemark = document->placemarkList().at( 2 );
+    QCOMPARE( placemark->name(), placemarkName( 2 ) );
+    QCOMPARE( placemark->coordinate().longitude(), qreal( 0.002 ) );
+    QCOMPARE( placemark->coordinate().altitude(), qreal( 2 ) );
+    QCOMPARE( placemark->role(), QString( "PPLA" ) );
+    QCOMPARE( placemark->countryCode(), QString( "DE" ) );
+    QVERIFY( placemark->description().isEmpty() );
+    QCOMPARE( placemark->area(), qreal( 1.5 ) );
+    QCOMPARE( placemark->population(), qint64( 2000 ) );
+    QCOMPARE( placemark->extendedData().value( "gmt" ).value().toInt(), 60 );
+    QCOMPARE( placemark->extendedData().value( "dst" ).value().toInt(), 0 );
+
+    delete document;
+}
+
+void CacheRunnerTest::truncated()
+{
+    const QString fileName = writeCache( "truncated", 16, 3 );
+    QFile file( fileName );
+    QVERIFY( file.resize( file.size() - 4 ) );
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    QVERIFY( !runnerManager.openFile( fileName ) );
+}
+
+void CacheRunnerTest::tooNew()
+{
+    const QString fileName = writeCache( "tooNew", 17, 3 );
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    QVERIFY( !runnerManager.openFile( fileName ) );
+}
+
+void CacheRunnerTest::shippedCache()
+{
+    const QString fileName = MarbleDirs::path( "placemarks/baseplacemarks.cache" );
+    if ( fileName.isEmpty() ) {
+        QSKIP( "The placemark caches are not installed" );
+    }
+
+    // the caches in data/ are written in the memory mapped version
+    QFile file( fileName );
+    QVERIFY( file.open( QIODevice::ReadOnly ) );
+    QDataStream in( &file );
+    quint32 magic;
+    qint32 version;
+    in >> magic >> version;
+    QCOMPARE( magic, quint32( 0x31415926 ) );
+    QCOMPARE( version, 16 );
+    file.close();
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    GeoDataDocument *document = runnerManager.openFile( fileName );
+    QVERIFY( document );
+    QVERIFY( !document->placemarkList().isEmpty() );
+    delete document;
+}
+
+void CacheRunnerTest::benchmarkParse_data()
+{
+    parse_data();
+}
+
+void CacheRunnerTest::benchmarkParse()
+{
+    QFETCH( int, version );
+
+    // about the size of the world wide city placemarks
+    const QString fileName = writeCache( QString( "benchmark%1" ).arg( version ), version, 200000 );
+    QVERIFY( !fileName.isEmpty() );
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    QBENCHMARK {
+        GeoDataDocument *document = runnerManager.openFile( fileName );
+        QVERIFY( document );
+        QCOMPARE( document->placemarkList().size(), 200000 );
+        delete document;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::CacheRunnerTest )
+
+#include "CacheRunnerTest.moc"
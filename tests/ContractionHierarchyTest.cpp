@@ -0,0 +1,446 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "ContractionHierarchy.h"
+#include "ContractionHierarchyBuilder.h"
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "MarbleGlobal.h"
+#include "osm/OsmPlacemarkData.h"
+
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+Q_DECLARE_METATYPE( Marble::RoutingProfile::TransportType )
+
+namespace Marble
+{
+
+/**
+ * Compares the routes of contraction hierarchies with the ones of a plain
+ * Dijkstra search on the road network.
+ */
+class ContractionHierarchyTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void speed_data();
+    void speed();
+    void transportTypes();
+    void bridge();
+    void shortestPaths_data();
+    void shortestPaths();
+
+    void benchmarkQuery_data();
+    void benchmarkQuery();
+
+ private:
+    // the arcs leaving each node as target and weight
+    typedef QVector<QVector<QPair<int, quint32> > > Graph;
+
+    static GeoDataPlacemark *createRoad( const GeoDataLineString &path, const QStringList &tags );
+    static GeoDataDocument *createGrid( int size );
+    static Graph createGraph( const GeoDataDocument *document, RoutingProfile::TransportType transportType,
+                              QVector<GeoDataCoordinates> &nodes );
+    static qint64 dijkstra( const Graph &graph, int source, int target );
+    static bool createHierarchy( const GeoDataDocument *document, RoutingProfile::TransportType transportType,
+                                 const QString &fileName, ContractionHierarchy &hierarchy );
+
+    QTemporaryDir m_directory;
+};
+
+GeoDataPlacemark *ContractionHierarchyTest::createRoad( const GeoDataLineString &path, const QStringList &tags )
+{
+    // tags are given as key, value, key, value, ...
+    OsmPlacemarkData osmData;
+    for ( int i = 0; i + 1 < tags.size(); i += 2 ) {
+        osmData.addTag( tags[i], tags[i + 1] );
+    }
+    GeoDataPlacemark *placemark = new GeoDataPlacemark( osmData.tagValue( QStringLiteral( "name" ) ) );
+    placemark->setGeometry( new GeoDataLineString( path ) );
+    placemark->setOsmData( osmData );
+    return placemark;
+}
+
+GeoDataDocument *ContractionHierarchyTest::createGrid( int size )
+{
+    // A town of rows and columns of streets about 100 meters apart. Some
+    // rows are one way streets, some columns are footways, and one is a
+    // motorway.
+    QRandomGenerator random( 42 );
+    QVector<GeoDataCoordinates> nodes;
+    nodes.reserve( size * size );
+    for ( int i = 0; i < size; ++i ) {
+        for ( int j = 0; j < size; ++j ) {
+            const qreal lat = 50.0 + 0.001 * i + 0.0002 * ( random.generateDouble() - 0.5 );
+            const qreal lon = 10.0 + 0.0015 * j + 0.0003 * ( random.generateDouble() - 0.5 );
+            nodes << GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+        }
+    }
+
+    GeoDataDocument *document = new GeoDataDocument;
+    for ( int i = 0; i < size; ++i ) {
+        GeoDataLineString row;
+        for ( int j = 0; j < size; ++j ) {
+            row << nodes[i * size + j];
+        }
+        QStringList tags;
+        tags << QStringLiteral( "highway" ) << ( i % 5 == 0 ? QStringLiteral( "primary" ) : QStringLiteral( "residential" ) );
+        tags << QStringLiteral( "name" ) << QStringLiteral( "Row %1" ).arg( i );
+        if ( i % 3 == 1 ) {
+            tags << QStringLiteral( "oneway" ) << QStringLiteral( "yes" );
+        } else if ( i % 7 == 2 ) {
+            tags << QStringLiteral( "oneway" ) << QStringLiteral( "-1" );
+        }
+        document->append( createRoad( row, tags ) );
+    }
+
+    for ( int j = 0; j < size; ++j ) {
+        GeoDataLineString column;
+        for ( int i = 0; i < size; ++i ) {
+            column << nodes[i * size + j];
+        }
+        QStringList tags;
+        tags << QStringLiteral( "name" ) << QStringLiteral( "Column %1" ).arg( j );
+        if ( j == 2 ) {
+            tags << QStringLiteral( "highway" ) << QStringLiteral( "motorway" );
+        } else if ( j % 4 == 3 ) {
+            tags << QStringLiteral( "highway" ) << QStringLiteral( "footway" );
+        } else if ( j % 6 == 5 ) {
+            tags << QStringLiteral( "highway" ) << QStringLiteral( "tertiary" ) << QStringLiteral( "maxspeed" ) << QStringLiteral( "30" );
+        } else {
+            tags << QStringLiteral( "highway" ) << QStringLiteral( "residential" );
+        }
+        document->append( createRoad( column, tags ) );
+    }
+
+    return document;
+}
+
+ContractionHierarchyTest::Graph ContractionHierarchyTest::createGraph( const GeoDataDocument *document,
+                                                                      RoutingProfile::TransportType transportType,
+                                                                      QVector<GeoDataCoordinates> &nodes )
+{
+    // the one way streets of createGrid() and the transport types using them
+    const bool oneways = transportType != RoutingProfile::Pedestrian;
+
+    Graph graph;
+    QHash<QPair<qint32, qint32>, int> ids;
+    auto const node = [&]( const GeoDataCoordinates &coordinates ) {
+        const QPair<qint32, qint32> key( qRound( coordinates.latitude( GeoDataCoordinates::Degree ) * 1e7 ),
+                                         qRound( coordinates.longitude( GeoDataCoordinates::Degree ) * 1e7 ) );
+        if ( !ids.contains( key ) ) {
+            ids.insert( key, nodes.size() );
+            nodes << coordinates;
+            graph.resize( nodes.size() );
+        }
+        return ids.value( key );
+    };
+
+    for ( const GeoDataPlacemark *placemark: document->placemarkList() ) {
+        const GeoDataLineString *road = geodata_cast<GeoDataLineString>( placemark->geometry() );
+        const OsmPlacemarkData &osmData = placemark->osmData();
+        const int speed = ContractionHierarchyBuilder::speed( osmData, transportType );
+        const QString oneway = osmData.tagValue( QStringLiteral( "oneway" ) );
+        const bool forward = !oneways || oneway != QLatin1String( "-1" );
+        const bool backward = !oneways || ( oneway.isEmpty() && !osmData.containsTag( QStringLiteral( "highway" ), QStringLiteral( "motorway" ) ) );
+        for ( int i = 1; i < road->size(); ++i ) {
+            const int from = node( road->at( i - 1 ) );
+            const int to = node( road->at( i ) );
+            if ( speed == 0 ) {
+                continue;
+            }
+            const quint32 weight = ContractionHierarchyBuilder::weight( road->at( i - 1 ).sphericalDistanceTo( road->at( i ) ) * EARTH_RADIUS, speed );
+            if ( forward ) {
+                graph[from] << qMakePair( to, weight );
+            }
+            if ( backward ) {
+                graph[to] << qMakePair( from, weight );
+            }
+        }
+    }
+    return graph;
+}
+
+qint64 ContractionHierarchyTest::dijkstra( const Graph &graph, int source, int target )
+{
+    typedef QPair<qint64, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    QVector<qint64> distances( graph.size(), std::numeric_limits<qint64>::max() );
+    distances[source] = 0;
+    queue.push( Entry( 0, source ) );
+    while ( !queue.empty() ) {
+        const Entry entry = queue.top();
+        queue.pop();
+        if ( entry.second == target ) {
+            return entry.first;
+        }
+        if ( entry.first > distances[entry.second] ) {
+            continue;
+        }
+        for ( const QPair<int, quint32> &arc: graph[entry.second] ) {
+            const qint64 distance = entry.first + arc.second;
+            if ( distance < distances[arc.first] ) {
+                distances[arc.first] = distance;
+                queue.push( Entry( distance, arc.first ) );
+            }
+        }
+    }
+    return -1;
+}
+
+bool ContractionHierarchyTest::createHierarchy( const GeoDataDocument *document, RoutingProfile::TransportType transportType,
+                                                const QString &fileName, ContractionHierarchy &hierarchy )
+{
+    ContractionHierarchyBuilder builder( transportType );
+    builder.addDocument( document );
+    return builder.write( fileName ) && hierarchy.load( fileName );
+}
+
+void ContractionHierarchyTest::speed_data()
+{
+    QTest::addColumn<QStringList>( "tags" );
+    QTest::addColumn<int>( "motorcar" );
+    QTest::addColumn<int>( "bicycle" );
+    QTest::addColumn<int>( "pedestrian" );
+
+    QTest::newRow( "motorway" ) << ( QStringList() << "highway" << "motorway" ) << 110 << 0 << 0;
+    QTest::newRow( "trunk" ) << ( QStringList() << "highway" << "trunk" ) << 90 << 16 << 0;
+    QTest::newRow( "residential" ) << ( QStringList() << "highway" << "residential" ) << 30 << 16 << 5;
+    QTest::newRow( "speed limit" ) << ( QStringList() << "highway" << "primary" << "maxspeed" << "50" ) << 50 << 16 << 5;
+    QTest::newRow( "speed limit in mph" ) << ( QStringList() << "highway" << "primary" << "maxspeed" << "30 mph" ) << 48 << 16 << 5;
+    QTest::newRow( "cycleway" ) << ( QStringList() << "highway" << "cycleway" ) << 0 << 18 << 5;
+    QTest::newRow( "footway" ) << ( QStringList() << "highway" << "footway" ) << 0 << 0 << 5;
+    QTest::newRow( "footway for bicycles" ) << ( QStringList() << "highway" << "footway" << "bicycle" << "yes" ) << 0 << 10 << 5;
+    QTest::newRow( "steps" ) << ( QStringList() << "highway" << "steps" ) << 0 << 0 << 5;
+    QTest::newRow( "private" ) << ( QStringList() << "highway" << "service" << "access" << "private" ) << 0 << 0 << 0;
+    QTest::newRow( "no cars" ) << ( QStringList() << "highway" << "tertiary" << "motor_vehicle" << "no" ) << 0 << 16 << 5;
+    QTest::newRow( "building" ) << ( QStringList() << "building" << "yes" ) << 0 << 0 << 0;
+}
+
+void ContractionHierarchyTest::speed()
+{
+    QFETCH( QStringList, tags );
+    QFETCH( int, motorcar );
+    QFETCH( int, bicycle );
+    QFETCH( int, pedestrian );
+
+    OsmPlacemarkData osmData;
+    for ( int i = 0; i + 1 < tags.size(); i += 2 ) {
+        osmData.addTag( tags[i], tags[i + 1] );
+    }
+    QCOMPARE( ContractionHierarchyBuilder::speed( osmData, RoutingProfile::Motorcar ), motorcar );
+    QCOMPARE( ContractionHierarchyBuilder::speed( osmData, RoutingProfile::Bicycle ), bicycle );
+    QCOMPARE( ContractionHierarchyBuilder::speed( osmData, RoutingProfile::Pedestrian ), pedestrian );
+}
+
+void ContractionHierarchyTest::transportTypes()
+{
+    QVERIFY( m_directory.isValid() );
+    const GeoDataCoordinates a( 10.0, 50.0, 0.0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates b( 10.01, 50.0, 0.0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates c( 10.0, 50.01, 0.0, GeoDataCoordinates::Degree );
+    GeoDataDocument document;
+    document.append( createRoad( GeoDataLineString() << a << b, QStringList() << "highway" << "motorway" ) );
+    document.append( createRoad( GeoDataLineString() << a << c, QStringList() << "highway" << "residential" << "oneway" << "yes" ) );
+
+    ContractionHierarchy car;
+    QVERIFY( createHierarchy( &document, RoutingProfile::Motorcar, m_directory.filePath( "motorcar.ch" ), car ) );
+    QCOMPARE( car.nodeCount(), 3 );
+    QVector<ContractionHierarchy::Step> steps;
+    const quint32 carA = car.nearestNode( a );
+    const quint32 carB = car.nearestNode( b );
+    const quint32 carC = car.nearestNode( c );
+    QCOMPARE( car.route( carA, carB, steps ), qint64( ContractionHierarchyBuilder::weight( a.sphericalDistanceTo( b ) * EARTH_RADIUS, 110 ) ) );
+    QCOMPARE( steps.size(), 1 );
+    QCOMPARE( steps[0].node, carB );
+    QCOMPARE( car.string( steps[0].type ), QStringLiteral( "motorway" ) );
+    // motorways and one way streets are one way
+    QCOMPARE( car.route( carB, carA, steps ), qint64( -1 ) );
+    QVERIFY( car.route( carA, carC, steps ) > 0 );
+    QCOMPARE( car.route( carC, carA, steps ), qint64( -1 ) );
+    QCOMPARE( car.route( carB, carB, steps ), qint64( 0 ) );
+
+    // pedestrians must not walk on motorways, but in both ways of one way streets
+    ContractionHierarchy pedestrian;
+    QVERIFY( createHierarchy( &document, RoutingProfile::Pedestrian, m_directory.filePath( "pedestrian.ch" ), pedestrian ) );
+    QCOMPARE( pedestrian.nodeCount(), 2 );
+    QCOMPARE( pedestrian.nearestNode( b ), pedestrian.nearestNode( a ) );
+    QVERIFY( pedestrian.route( pedestrian.nearestNode( c ), pedestrian.nearestNode( a ), steps ) > 0 );
+
+    // without roads there are no nodes
+    GeoDataDocument empty;
+    ContractionHierarchy bicycle;
+    QVERIFY( createHierarchy( &empty, RoutingProfile::Bicycle, m_directory.filePath( "bicycle.ch" ), bicycle ) );
+    QCOMPARE( bicycle.nodeCount(), 0 );
+    QCOMPARE( bicycle.nearestNode( a ), quint32( ContractionHierarchy::NoNode ) );
+
+    QVERIFY( !bicycle.load( m_directory.filePath( "missing.ch" ) ) );
+    QVERIFY( !bicycle.isValid() );
+}
+
+void ContractionHierarchyTest::bridge()
+{
+    // a road on a bridge over another one, their middle nodes share the position
+    const GeoDataCoordinates west( 10.0, 50.005, 0.0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates east( 10.01, 50.005, 0.0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates south( 10.005, 50.0, 0.0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates north( 10.005, 50.01, 0.0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates middle( 10.005, 50.005, 0.0, GeoDataCoordinates::Degree );
+
+    GeoDataDocument document;
+    const QVector<GeoDataLineString> roads = {
+        GeoDataLineString() << west << middle << east,
+        GeoDataLineString() << south << middle << north
+    };
+    for ( int i = 0; i < roads.size(); ++i ) {
+        GeoDataPlacemark *road = createRoad( roads[i], QStringList() << "highway" << "residential" );
+        for ( int j = 0; j < roads[i].size(); ++j ) {
+            OsmPlacemarkData node;
+            node.setId( 10 * ( i + 1 ) + j );
+            road->osmData().addNodeReference( roads[i].at( j ), node );
+        }
+        document.append( road );
+    }
+
+    ContractionHierarchy hierarchy;
+    QVERIFY( createHierarchy( &document, RoutingProfile::Motorcar, m_directory.filePath( "bridge.ch" ), hierarchy ) );
+    QCOMPARE( hierarchy.nodeCount(), 6 );
+    QVector<ContractionHierarchy::Step> steps;
+    QVERIFY( hierarchy.route( hierarchy.nearestNode( west ), hierarchy.nearestNode( east ), steps ) > 0 );
+    QVERIFY( hierarchy.route( hierarchy.nearestNode( south ), hierarchy.nearestNode( north ), steps ) > 0 );
+    QCOMPARE( hierarchy.route( hierarchy.nearestNode( west ), hierarchy.nearestNode( north ), steps ), qint64( -1 ) );
+}
+
+void ContractionHierarchyTest::shortestPaths_data()
+{
+    QTest::addColumn<RoutingProfile::TransportType>( "transportType" );
+
+    QTest::newRow( "motorcar" ) << RoutingProfile::Motorcar;
+    QTest::newRow( "bicycle" ) << RoutingProfile::Bicycle;
+    QTest::newRow( "pedestrian" ) << RoutingProfile::Pedestrian;
+}
+
+void ContractionHierarchyTest::shortestPaths()
+{
+    QFETCH( RoutingProfile::TransportType, transportType );
+
+    QScopedPointer<GeoDataDocument> document( createGrid( 40 ) );
+    QVector<GeoDataCoordinates> nodes;
+    const Graph graph = createGraph( document.data(), transportType, nodes );
+
+    ContractionHierarchy hierarchy;
+    QVERIFY( m_directory.isValid() );
+    QVERIFY( createHierarchy( document.data(), transportType, m_directory.filePath( "grid.ch" ), hierarchy ) );
+
+    // the hierarchy has the nodes of the roads usable by the transport type
+    QVector<bool> used( graph.size(), false );
+    for ( int i = 0; i < graph.size(); ++i ) {
+        for ( const QPair<int, quint32> &arc: graph[i] ) {
+            used[i] = true;
+            used[arc.first] = true;
+        }
+    }
+    QVector<int> usable;
+    for ( int i = 0; i < used.size(); ++i ) {
+        if ( used[i] ) {
+            usable << i;
+        }
+    }
+    QCOMPARE( hierarchy.nodeCount(), usable.size() );
+
+    QRandomGenerator random( 7 );
+    for ( int i = 0; i < 300; ++i ) {
+        const int source = usable[random.bounded( usable.size() )];
+        const int target = usable[random.bounded( usable.size() )];
+        const quint32 from = hierarchy.nearestNode( nodes[source] );
+        const quint32 to = hierarchy.nearestNode( nodes[target] );
+        QVERIFY( hierarchy.coordinates( from ).sphericalDistanceTo( nodes[source] ) * EARTH_RADIUS < 0.1 );
+        QVERIFY( hierarchy.coordinates( to ).sphericalDistanceTo( nodes[target] ) * EARTH_RADIUS < 0.1 );
+
+        QVector<ContractionHierarchy::Step> steps;
+        const qint64 weight = hierarchy.route( from, to, steps );
+        QCOMPARE( weight, dijkstra( graph, source, target ) );
+        if ( weight <= 0 ) {
+            continue;
+        }
+
+        // the unpacked path consists of roads and ends at the target
+        qint64 sum = 0;
+        GeoDataCoordinates previous = hierarchy.coordinates( from );
+        for ( const ContractionHierarchy::Step &step: steps ) {
+            const GeoDataCoordinates current = hierarchy.coordinates( step.node );
+            const qreal distance = previous.sphericalDistanceTo( current ) * EARTH_RADIUS;
+            QVERIFY( distance > 50.0 && distance < 200.0 );
+            QVERIFY( !hierarchy.string( step.type ).isEmpty() );
+            sum += step.weight;
+            previous = current;
+        }
+        QCOMPARE( steps.last().node, to );
+        QCOMPARE( sum, weight );
+    }
+}
+
+void ContractionHierarchyTest::benchmarkQuery_data()
+{
+    QTest::addColumn<bool>( "contracted" );
+
+    QTest::newRow( "dijkstra" ) << false;
+    QTest::newRow( "contraction hierarchy" ) << true;
+}
+
+void ContractionHierarchyTest::benchmarkQuery()
+{
+    QFETCH( bool, contracted );
+
+    // a city of 40000 crossings
+    QScopedPointer<GeoDataDocument> document( createGrid( 200 ) );
+    QVector<GeoDataCoordinates> nodes;
+    const Graph graph = createGraph( document.data(), RoutingProfile::Motorcar, nodes );
+
+    ContractionHierarchy hierarchy;
+    QVERIFY( m_directory.isValid() );
+    QVERIFY( createHierarchy( document.data(), RoutingProfile::Motorcar, m_directory.filePath( "benchmark.ch" ), hierarchy ) );
+
+    QRandomGenerator random( 7 );
+    QVector<QPair<int, int> > queries;
+    for ( int i = 0; i < 100; ++i ) {
+        queries << qMakePair( random.bounded( nodes.size() ), random.bounded( nodes.size() ) );
+    }
+
+    if ( contracted ) {
+        QVector<QPair<quint32, quint32> > hierarchyQueries;
+        for ( const QPair<int, int> &query: queries ) {
+            hierarchyQueries << qMakePair( hierarchy.nearestNode( nodes[query.first] ), hierarchy.nearestNode( nodes[query.second] ) );
+        }
+        QBENCHMARK {
+            for ( const QPair<quint32, quint32> &query: hierarchyQueries ) {
+                QVector<ContractionHierarchy::Step> steps;
+                hierarchy.route( query.first, query.second, steps );
+            }
+        }
+    } else {
+        QBENCHMARK {
+            for ( const QPair<int, int> &query: queries ) {
+                dijkstra( graph, query.first, query.second );
+            }
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ContractionHierarchyTest )
+
+#include "ContractionHierarchyTest.moc"
@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "FileManager.h"
+#include "GeoDataData.h"
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataSnippet.h"
+#include "GeoDataTreeModel.h"
+#include "MarbleDirs.h"
+#include "PluginManager.h"
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTest>
+
+namespace Marble
+{
+
+class FileManagerTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void addFiles_data();
+    void addFiles();
+    void removeQueuedFile();
+    void streamLargeFile();
+    void streamRootProperties();
+
+    void benchmarkAddFiles_data();
+    void benchmarkAddFiles();
+
+ private:
+    QString writeKml( const QString &name, int placemarks ) const;
+    static bool waitForFiles( const FileManager &fileManager );
+
+    QTemporaryDir m_directory;
+    PluginManager m_pluginManager;
+};
+
+void FileManagerTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+    QVERIFY( m_directory.isValid() );
+}
+
+QString FileManagerTest::writeKml( const QString &name, int placemarks ) const
+{
+    const QString fileName = m_directory.path() + QLatin1Char( '/' ) + name + QLatin1String( ".kml" );
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        return QString();
+    }
+
+    file.write( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>\n" );
+    for ( int i = 0; i < placemarks; ++i ) {
+        file.write( QString( "<Placemark><name>%1 %2</name><Point><coordinates>%3,%4</coordinates></Point></Placemark>\n" )
+                    .arg( name ).arg( i ).arg( -170.0 + 340.0 * i / placemarks ).arg( 40.0 + i % 10 ).toUtf8() );
+    }
+    file.write( "</Document></kml>\n" );
+    return fileName;
+}
+
+bool FileManagerTest::waitForFiles( const FileManager &fileManager )
+{
+    for ( int i = 0; i < 3000 && fileManager.pendingFiles() > 0; ++i ) {
+        QTest::qWait( 10 );
+    }
+    return fileManager.pendingFiles() == 0;
+}
+
+void FileManagerTest::addFiles_data()
+{
+    QTest::addColumn<int>( "loaders" );
+
+    QTest::newRow( "one loader" ) << 1;
+    QTest::newRow( "two loaders" ) << 2;
+    QTest::newRow( "eight loaders" ) << 8;
+}
+
+void FileManagerTest::addFiles()
+{
+    QFETCH( int, loaders );
+
+    const int files = 12;
+    QStringList fileNames;
+    for ( int i = 0; i < files; ++i ) {
+        fileNames << writeKml( QString( "add%1_%2" ).arg( loaders ).arg( i ), 10 );
+        QVERIFY( !fileNames.last().isEmpty() );
+    }
+
+    GeoDataTreeModel treeModel;
+    FileManager fileManager( &treeModel, &m_pluginManager );
+    fileManager.setMaximumLoaderCount( loaders );
+    QCOMPARE( fileManager.maximumLoaderCount(), loaders );
+
+    QSignalSpy fileAddedSpy( &fileManager, SIGNAL(fileAdded(QString)) );
+    QSignalSpy centeredSpy( &fileManager, SIGNAL(centeredDocument(GeoDataLatLonBox)) );
+    QSignalSpy rowsInsertedSpy( &treeModel, SIGNAL(rowsInserted(QModelIndex,int,int)) );
+
+    // the rows inserted per batch and the files announced after each insertion
+    QVector<int> insertedRows;
+    QVector<int> addedFiles;
+    int maximumRunningLoaders = 0;
+    connect( &treeModel, &GeoDataTreeModel::rowsInserted, this, [&]( const QModelIndex &parent, int first, int last ) {
+        QVERIFY( !parent.isValid() );
+        insertedRows << last - first + 1;
+        addedFiles << 0;
+    } );
+    connect( &fileManager, &FileManager::fileAdded, this, [&]() {
+        QVERIFY( !addedFiles.isEmpty() );
+        ++addedFiles.last();
+        maximumRunningLoaders = qMax( maximumRunningLoaders, fileManager.runningLoaderCount() );
+    } );
+
+    for ( const QString &fileName: fileNames ) {
+        fileManager.addFile( fileName, "test", GeoDataStyle::Ptr(), UserDocument, 0, true );
+    }
+    // adding a file twice is ignored while it is loading
+    fileManager.addFile( fileNames.first(), "test", GeoDataStyle::Ptr(), UserDocument, 0, true );
+    QCOMPARE( fileManager.pendingFiles(), files );
+    QCOMPARE( fileManager.runningLoaderCount(), qMin( loaders, files ) );
+
+    for ( int i = 0; i < 3000 && fileManager.pendingFiles() > 0; ++i ) {
+        maximumRunningLoaders = qMax( maximumRunningLoaders, fileManager.runningLoaderCount() );
+        QTest::qWait( 10 );
+    }
+    QCOMPARE( fileManager.pendingFiles(), 0 );
+    QCOMPARE( fileManager.runningLoaderCount(), 0 );
+    QCOMPARE( fileAddedSpy.count(), files );
+    QCOMPARE( centeredSpy.count(), 1 );
+    QCOMPARE( treeModel.rowCount(), files );
+    QCOMPARE( fileManager.size(), files );
+
+    // the loaders never exceed the limit
+    QCOMPARE( maximumRunningLoaders, qMin( loaders, files ) );
+
+    // finished documents are inserted in batches of one or more files, one insertion per batch
+    QCOMPARE( rowsInsertedSpy.count(), insertedRows.size() );
+    QCOMPARE( addedFiles, insertedRows );
+    int insertedFiles = 0;
+    for ( int rows: insertedRows ) {
+        QVERIFY( rows > 0 );
+        insertedFiles += rows;
+    }
+    QCOMPARE( insertedFiles, files );
+
+    for ( const QString &fileName: fileNames ) {
+        const GeoDataDocument *document = fileManager.at( fileName );
+        QVERIFY( document );
+        QCOMPARE( document->property(), QString( "test" ) );
+        QCOMPARE( document->size(), 10 );
+    }
+}
+
+void FileManagerTest::removeQueuedFile()
+{
+    const QString first = writeKml( "first", 1000 );
+    const QString second = writeKml( "second", 10 );
+
+    GeoDataTreeModel treeModel;
+    FileManager fileManager( &treeModel, &m_pluginManager );
+    fileManager.setMaximumLoaderCount( 1 );
+
+    fileManager.addFile( first, "test", GeoDataStyle::Ptr(), UserDocument );
+    fileManager.addFile( second, "test", GeoDataStyle::Ptr(), UserDocument );
+    QCOMPARE( fileManager.pendingFiles(), 2 );
+
+    fileManager.removeFile( second );
+    QCOMPARE( fileManager.pendingFiles(), 1 );
+
+    QVERIFY( waitForFiles( fileManager ) );
+    QCOMPARE( treeModel.rowCount(), 1 );
+    QVERIFY( fileManager.at( first ) );
+    QVERIFY( !fileManager.at( second ) );
+}
+
+void FileManagerTest::streamLargeFile()
+{
+    // large enough to be loaded in several chunks
+    const QString fileName = writeKml( "large", 2500 );
+
+    GeoDataTreeModel treeModel;
+    FileManager fileManager( &treeModel, &m_pluginManager );
+    QSignalSpy fileAddedSpy( &fileManager, SIGNAL(fileAdded(QString)) );
+    QSignalSpy rowsInsertedSpy( &treeModel, SIGNAL(rowsInserted(QModelIndex,int,int)) );
+
+    fileManager.addFile( fileName, "test", GeoDataStyle::Ptr(), UserDocument );
+    QVERIFY( waitForFiles( fileManager ) );
+
+    QCOMPARE( fileAddedSpy.count(), 1 );
+    QVERIFY( rowsInsertedSpy.count() > 1 );
+    QCOMPARE( treeModel.rowCount(), 1 );
+
+    const GeoDataDocument *document = fileManager.at( fileName );
+    QVERIFY( document );
+    QCOMPARE( document->size(), 2500 );
+    QCOMPARE( document->property(), QString( "test" ) );
+}
+
+void FileManagerTest::streamRootProperties()
+{
+    // The properties of the root document around the streamed features,
+    // including a name and a style only known at the end of the file
+    const QString fileName = m_directory.path() + QLatin1String( "/properties.kml" );
+    QFile file( fileName );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    file.write( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>\n"
+                "<description>Ships of the fleet</description>\n"
+                "<Snippet>Fleet snippet</Snippet>\n"
+                "<ExtendedData><Data name=\"operator\"><value>Marble</value></Data></ExtendedData>\n"
+                "<Style id=\"ship\"><IconStyle><scale>2</scale></IconStyle></Style>\n" );
+    for ( int i = 0; i < 2500; ++i ) {
+        file.write( QString( "<Placemark><name>Ship %1</name><styleUrl>#ship</styleUrl>"
+                             "<Point><coordinates>%2,50</coordinates></Point></Placemark>\n" )
+                    .arg( i ).arg( -170.0 + 340.0 * i / 2500 ).toUtf8() );
+    }
+    file.write( "<Style id=\"late\"><IconStyle><scale>3</scale></IconStyle></Style>\n"
+                "<name>Fleet</name>\n"
+                "</Document></kml>\n" );
+    file.close();
+
+    GeoDataTreeModel treeModel;
+    FileManager fileManager( &treeModel, &m_pluginManager );
+    fileManager.addFile( fileName, "test", GeoDataStyle::Ptr(), UserDocument );
+    QVERIFY( waitForFiles( fileManager ) );
+
+    const GeoDataDocument *document = fileManager.at( fileName );
+    QVERIFY( document );
+    QCOMPARE( document->size(), 2500 );
+    QCOMPARE( document->name(), QString( "Fleet" ) );
+    QCOMPARE( document->description(), QString( "Ships of the fleet" ) );
+    QCOMPARE( document->snippet().text(), QString( "Fleet snippet" ) );
+    QCOMPARE( document->extendedData().value( "operator" ).value().toString(), QString( "Marble" ) );
+    QVERIFY( document->style( "ship" ) );
+    QVERIFY( document->style( "late" ) );
+    QCOMPARE( document->property(), QString( "test" ) );
+}
+
+void FileManagerTest::benchmarkAddFiles_data()
+{
+    addFiles_data();
+    QTest::newRow( "ideal thread count" ) << QThread::idealThreadCount();
+}
+
+void FileManagerTest::benchmarkAddFiles()
+{
+    QFETCH( int, loaders );
+
+    // a typical set of map theme and user files
+    QStringList fileNames;
+    for ( int i = 0; i < 16; ++i ) {
+        fileNames << writeKml( QString( "benchmark%1_%2" ).arg( loaders ).arg( i ), 5000 );
+        QVERIFY( !fileNames.last().isEmpty() );
+    }
+
+    QBENCHMARK {
+        GeoDataTreeModel treeModel;
+        FileManager fileManager( &treeModel, &m_pluginManager );
+        fileManager.setMaximumLoaderCount( loaders );
+        for ( const QString &fileName: fileNames ) {
+            fileManager.addFile( fileName, "benchmark", GeoDataStyle::Ptr(), UserDocument );
+        }
+        QVERIFY( waitForFiles( fileManager ) );
+        QCOMPARE( treeModel.rowCount(), fileNames.size() );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::FileManagerTest )
+
+#include "FileManagerTest.moc"
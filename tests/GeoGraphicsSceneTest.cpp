@@ -0,0 +1,319 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoGraphicsScene.h"
+#include "GeoGraphicsItem.h"
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataPlacemark.h"
+#include "TileCoordsPyramid.h"
+#include "TileId.h"
+
+#include <QRandomGenerator>
+#include <QRect>
+#include <QSet>
+#include <QTest>
+
+namespace Marble
+{
+
+class BoxGraphicsItem : public GeoGraphicsItem
+{
+ public:
+    BoxGraphicsItem( const GeoDataFeature *feature, const GeoDataLatLonBox &box, int minZoomLevel ) :
+        GeoGraphicsItem( feature ),
+        m_box( box, 0, 0 )
+    {
+        setMinZoomLevel( minZoomLevel );
+    }
+
+    const GeoDataLatLonAltBox &latLonAltBox() const override { return m_box; }
+
+    void paint( GeoPainter *, const ViewportParams *, const QString &, int ) override {}
+
+ private:
+    const GeoDataLatLonAltBox m_box;
+};
+
+/**
+ * The tiled hash GeoGraphicsScene used before, as a reference for the benchmarks.
+ */
+class TiledItemHash
+{
+ public:
+    void addItem( GeoGraphicsItem *item )
+    {
+        int zoomLevel;
+        qreal north, south, east, west;
+        item->latLonAltBox().boundaries( north, south, east, west );
+        for ( zoomLevel = item->minZoomLevel(); zoomLevel >= 0; zoomLevel-- ) {
+            if ( TileId::fromCoordinates( GeoDataCoordinates( west, north, 0 ), zoomLevel ) ==
+                 TileId::fromCoordinates( GeoDataCoordinates( east, south, 0 ), zoomLevel ) )
+                break;
+        }
+        m_tiledItems[TileId::fromCoordinates( GeoDataCoordinates( west, north, 0 ), zoomLevel )] << item;
+    }
+
+    QList<GeoGraphicsItem *> items( const GeoDataLatLonBox &box, int zoomLevel ) const
+    {
+        QList<GeoGraphicsItem *> result;
+        qreal north, south, east, west;
+        box.boundaries( north, south, east, west );
+
+        QRect rect;
+        TileId key = TileId::fromCoordinates( GeoDataCoordinates( west, north, 0 ), zoomLevel );
+        rect.setLeft( key.x() );
+        rect.setTop( key.y() );
+        key = TileId::fromCoordinates( GeoDataCoordinates( east, south, 0 ), zoomLevel );
+        rect.setRight( key.x() );
+        rect.setBottom( key.y() );
+
+        TileCoordsPyramid pyramid( 0, zoomLevel );
+        pyramid.setBottomLevelCoords( rect );
+        for ( int level = pyramid.topLevel(); level <= pyramid.bottomLevel(); ++level ) {
+            int x1, y1, x2, y2;
+            pyramid.coords( level ).getCoords( &x1, &y1, &x2, &y2 );
+            for ( int x = x1; x <= x2; ++x ) {
+                for ( int y = y1; y <= y2; ++y ) {
+                    const bool isBorder = x == x1 || x == x2 || y == y1 || y == y2;
+                    for ( GeoGraphicsItem *item: m_tiledItems.value( TileId( 0, level, x, y ) ) ) {
+                        if ( item->minZoomLevel() <= zoomLevel && item->visible() ) {
+                            if ( !isBorder || item->latLonAltBox().intersects( box ) ) {
+                                result.push_back( item );
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        return result;
+    }
+
+ private:
+    QHash<TileId, QVector<GeoGraphicsItem *> > m_tiledItems;
+};
+
+class GeoGraphicsSceneTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    GeoGraphicsSceneTest();
+    ~GeoGraphicsSceneTest() override;
+
+ private Q_SLOTS:
+    void items();
+    void removeItem();
+    void crossingDateLine();
+
+    void benchmarkItems_data();
+    void benchmarkItems();
+
+ private:
+    /**
+     * Creates items like those of an OSM city, or spread over the whole world.
+     */
+    QVector<GeoGraphicsItem *> createItems( int count, bool city );
+    static QSet<GeoGraphicsItem *> expectedItems( const QVector<GeoGraphicsItem *> &items,
+                                                  const GeoDataLatLonBox &box, int zoomLevel );
+    static GeoDataLatLonBox cityViewport( QRandomGenerator &random );
+    static QSet<GeoGraphicsItem *> toSet( const QList<GeoGraphicsItem *> &items );
+
+    QRandomGenerator m_random;
+    QVector<GeoDataPlacemark *> m_placemarks;
+};
+
+GeoGraphicsSceneTest::GeoGraphicsSceneTest() :
+    m_random( 42 )
+{
+}
+
+GeoGraphicsSceneTest::~GeoGraphicsSceneTest()
+{
+    qDeleteAll( m_placemarks );
+}
+
+QVector<GeoGraphicsItem *> GeoGraphicsSceneTest::createItems( int count, bool city )
+{
+    QVector<GeoGraphicsItem *> items;
+    items.reserve( count );
+    for ( int i = 0; i < count; ++i ) {
+        GeoDataPlacemark *const placemark = new GeoDataPlacemark;
+        m_placemarks << placemark;
+
+        qreal west, north, width, height;
+        if ( city ) {
+            // buildings and streets in a 0.2 by 0.2 degree area, a few larger areas
+            west = 13.3 + m_random.bounded( 0.2 );
+            north = 52.6 - m_random.bounded( 0.2 );
+            width = m_random.bounded( i % 100 == 0 ? 0.1 : 0.002 );
+            height = m_random.bounded( i % 100 == 0 ? 0.1 : 0.002 );
+        } else {
+            west = m_random.bounded( 360.0 ) - 180;
+            north = m_random.bounded( 170.0 ) - 85;
+            width = m_random.bounded( i % 10 == 0 ? 30.0 : 1.0 );
+            height = m_random.bounded( i % 10 == 0 ? 30.0 : 1.0 );
+        }
+
+        qreal east = west + width;
+        if ( east > 180 ) {
+            east -= 360;
+        }
+        const GeoDataLatLonBox box( north, qMax<qreal>( north - height, -90 ), east, west, GeoDataCoordinates::Degree );
+        items << new BoxGraphicsItem( placemark, box, city ? 11 + i % 7 : i % 10 );
+    }
+
+    return items;
+}
+
+QSet<GeoGraphicsItem *> GeoGraphicsSceneTest::expectedItems( const QVector<GeoGraphicsItem *> &items,
+                                                             const GeoDataLatLonBox &box, int zoomLevel )
+{
+    QSet<GeoGraphicsItem *> result;
+    for ( GeoGraphicsItem *item: items ) {
+        if ( item->minZoomLevel() <= zoomLevel && item->latLonAltBox().intersects( box ) ) {
+            result << item;
+        }
+    }
+
+    return result;
+}
+
+GeoDataLatLonBox GeoGraphicsSceneTest::cityViewport( QRandomGenerator &random )
+{
+    const qreal west = 13.3 + random.bounded( 0.18 );
+    const qreal north = 52.6 - random.bounded( 0.18 );
+    return GeoDataLatLonBox( north, north - 0.01, west + 0.02, west, GeoDataCoordinates::Degree );
+}
+
+QSet<GeoGraphicsItem *> GeoGraphicsSceneTest::toSet( const QList<GeoGraphicsItem *> &items )
+{
+    return QSet<GeoGraphicsItem *>( items.constBegin(), items.constEnd() );
+}
+
+void GeoGraphicsSceneTest::items()
+{
+    GeoGraphicsScene scene;
+    const QVector<GeoGraphicsItem *> worldItems = createItems( 2000, false );
+    const QVector<GeoGraphicsItem *> cityItems = createItems( 2000, true );
+    scene.addItems( worldItems );
+    for ( GeoGraphicsItem *item: cityItems ) {
+        scene.addItem( item );
+    }
+    const QVector<GeoGraphicsItem *> allItems = worldItems + cityItems;
+
+    for ( int i = 0; i < 100; ++i ) {
+        const qreal west = m_random.bounded( 360.0 ) - 180;
+        const qreal north = m_random.bounded( 180.0 ) - 90;
+        const qreal size = m_random.bounded( i % 2 ? 1.0 : 60.0 );
+        const GeoDataLatLonBox box( north, qMax<qreal>( north - size, -90 ), qMin<qreal>( west + size, 180 ), west,
+                                    GeoDataCoordinates::Degree );
+        const int zoomLevel = i % 18;
+
+        const QList<GeoGraphicsItem *> result = scene.items( box, zoomLevel );
+        QCOMPARE( toSet( result ), expectedItems( allItems, box, zoomLevel ) );
+        QCOMPARE( toSet( result ).size(), result.size() );
+    }
+
+    for ( int i = 0; i < 100; ++i ) {
+        const GeoDataLatLonBox box = cityViewport( m_random );
+        QCOMPARE( toSet( scene.items( box, 17 ) ), expectedItems( allItems, box, 17 ) );
+    }
+}
+
+void GeoGraphicsSceneTest::removeItem()
+{
+    GeoGraphicsScene scene;
+    QVector<GeoGraphicsItem *> items = createItems( 1000, true );
+    scene.addItems( items );
+
+    // features with several items, like multi geometries
+    GeoDataPlacemark placemark;
+    QVector<GeoGraphicsItem *> multiItems;
+    multiItems << new BoxGraphicsItem( &placemark, GeoDataLatLonBox( 52.5, 52.4, 13.4, 13.3, GeoDataCoordinates::Degree ), 0 );
+    multiItems << new BoxGraphicsItem( &placemark, GeoDataLatLonBox( 10, -10, 10, -10, GeoDataCoordinates::Degree ), 0 );
+    scene.addItems( multiItems );
+
+    const GeoDataLatLonBox world( 90, -90, 180, -180, GeoDataCoordinates::Degree );
+    QCOMPARE( scene.items( world, 17 ).size(), 1002 );
+
+    scene.removeItem( &placemark );
+    for ( int i = 0; i < 1000; i += 2 ) {
+        scene.removeItem( items[i]->feature() );
+        items[i] = nullptr;
+    }
+    items.removeAll( nullptr );
+
+    QCOMPARE( toSet( scene.items( world, 17 ) ), expectedItems( items, world, 17 ) );
+    for ( int i = 0; i < 20; ++i ) {
+        const GeoDataLatLonBox box = cityViewport( m_random );
+        QCOMPARE( toSet( scene.items( box, 15 ) ), expectedItems( items, box, 15 ) );
+    }
+
+    scene.clear();
+    QVERIFY( scene.items( world, 17 ).isEmpty() );
+}
+
+void GeoGraphicsSceneTest::crossingDateLine()
+{
+    GeoDataPlacemark placemark;
+    GeoGraphicsScene scene;
+    GeoGraphicsItem *const crossing = new BoxGraphicsItem( &placemark, GeoDataLatLonBox( 10, -10, -170, 170, GeoDataCoordinates::Degree ), 0 );
+    GeoGraphicsItem *const east = new BoxGraphicsItem( &placemark, GeoDataLatLonBox( 10, -10, 179, 175, GeoDataCoordinates::Degree ), 0 );
+    GeoGraphicsItem *const west = new BoxGraphicsItem( &placemark, GeoDataLatLonBox( 10, -10, -175, -179, GeoDataCoordinates::Degree ), 0 );
+    scene.addItem( crossing );
+    scene.addItem( east );
+    scene.addItem( west );
+
+    const QList<GeoGraphicsItem *> result = scene.items( GeoDataLatLonBox( 5, -5, -178, 178, GeoDataCoordinates::Degree ), 0 );
+    QCOMPARE( result.size(), 3 );
+    QCOMPARE( toSet( result ), QSet<GeoGraphicsItem *>() << crossing << east << west );
+
+    QCOMPARE( scene.items( GeoDataLatLonBox( 5, -5, -171, -172, GeoDataCoordinates::Degree ), 0 ),
+              QList<GeoGraphicsItem *>() << crossing );
+}
+
+void GeoGraphicsSceneTest::benchmarkItems_data()
+{
+    QTest::addColumn<bool>( "tiledHash" );
+
+    QTest::newRow( "GeoGraphicsScene" ) << false;
+    QTest::newRow( "tiled hash" ) << true;
+}
+
+void GeoGraphicsSceneTest::benchmarkItems()
+{
+    QFETCH( bool, tiledHash );
+
+    GeoGraphicsScene scene;
+    TiledItemHash hash;
+    const QVector<GeoGraphicsItem *> items = createItems( 200000, true );
+    if ( tiledHash ) {
+        for ( GeoGraphicsItem *item: items ) {
+            hash.addItem( item );
+        }
+    }
+    scene.addItems( items ); // owns the items
+
+    QRandomGenerator random( 17 );
+    QVector<GeoDataLatLonBox> viewports;
+    for ( int i = 0; i < 100; ++i ) {
+        viewports << cityViewport( random );
+    }
+
+    int count = 0;
+    QBENCHMARK {
+        for ( const GeoDataLatLonBox &viewport: viewports ) {
+            count += tiledHash ? hash.items( viewport, 17 ).size() : scene.items( viewport, 17 ).size();
+        }
+    }
+    QVERIFY( count > 0 );
+}
+
+}
+
+QTEST_MAIN( Marble::GeoGraphicsSceneTest )
+
+#include "GeoGraphicsSceneTest.moc"
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataLineStyle.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTreeModel.h"
+#include "GeoPainter.h"
+#include "GeometryLayer.h"
+#include "MarbleGlobal.h"
+#include "StyleBuilder.h"
+#include "ViewportParams.h"
+
+#include <QImage>
+#include <QSet>
+#include <QTest>
+
+namespace Marble
+{
+
+class GeometryLayerTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void panExposesItems();
+    void restyleSortsItems();
+    void addAndRemoveTile();
+
+ private:
+    static GeoDataPlacemark *createPlacemark( qreal west, qreal south, qreal east, qreal north,
+                                              const GeoDataStyle::Ptr &style );
+    static void render( GeometryLayer *layer, ViewportParams *viewport );
+    static int itemCount( const GeometryLayer &layer );
+};
+
+GeoDataPlacemark *GeometryLayerTest::createPlacemark( qreal west, qreal south, qreal east, qreal north,
+                                                      const GeoDataStyle::Ptr &style )
+{
+    GeoDataLineString *lineString = new GeoDataLineString;
+    *lineString << GeoDataCoordinates( west, south, 0.0, GeoDataCoordinates::Degree )
+                << GeoDataCoordinates( east, north, 0.0, GeoDataCoordinates::Degree );
+
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    placemark->setGeometry( lineString );
+    placemark->setStyle( style );
+    return placemark;
+}
+
+void GeometryLayerTest::render( GeometryLayer *layer, ViewportParams *viewport )
+{
+    QImage image( viewport->size(), QImage::Format_ARGB32_Premultiplied );
+    image.fill( Qt::transparent );
+    GeoPainter painter( &image, viewport );
+    layer->render( &painter, viewport );
+}
+
+int GeometryLayerTest::itemCount( const GeometryLayer &layer )
+{
+    // "Geometries: %1 Zoom: %2"
+    return layer.runtimeTrace().section( QLatin1Char( ' ' ), 1, 1 ).toInt();
+}
+
+void GeometryLayerTest::panExposesItems()
+{
+    GeoDataStyle::Ptr style( new GeoDataStyle );
+    GeoDataDocument *document = new GeoDataDocument;
+    // short lines along the equator, every half degree
+    for ( int i = -120; i < 120; ++i ) {
+        document->append( createPlacemark( 0.5 * i - 0.1, 0.0, 0.5 * i + 0.1, 0.0, style ) );
+    }
+
+    StyleBuilder styleBuilder;
+    GeoDataTreeModel treeModel;
+    GeometryLayer layer( &treeModel, &styleBuilder );
+    layer.setTileLevel( 5 );
+    treeModel.addDocument( document );
+
+    ViewportParams viewport( Equirectangular, 0.0, 0.0, 1000, QSize( 800, 600 ) );
+    render( &layer, &viewport );
+    render( &layer, &viewport );
+    const int count = itemCount( layer );
+    QVERIFY( count > 0 );
+
+    // a pan below the tolerance of the cached box, the exposed strip contains new lines
+    viewport.centerOn( 2.0 * DEG2RAD, 0.0 );
+    render( &layer, &viewport );
+
+    GeometryLayer panned( &treeModel, &styleBuilder );
+    panned.setTileLevel( 5 );
+    render( &panned, &viewport );
+    QCOMPARE( itemCount( layer ), itemCount( panned ) );
+
+    // a line only in the exposed strip is found at its position
+    qreal x, y;
+    QVERIFY( viewport.screenCoordinates( 24.0 * DEG2RAD, 0.0, x, y ) );
+    QVERIFY( x < viewport.width() );
+    const QVector<const GeoDataFeature *> features = layer.whichFeatureAt( QPoint( qRound( x ), qRound( y ) ), &viewport );
+    QCOMPARE( features.size(), 1 );
+
+    treeModel.removeDocument( document );
+    delete document;
+}
+
+void GeometryLayerTest::restyleSortsItems()
+{
+    QVector<GeoDataStyle::Ptr> styles;
+    for ( int i = 0; i < 3; ++i ) {
+        GeoDataStyle::Ptr style( new GeoDataStyle );
+        style->lineStyle().setWidth( 2 + i );
+        styles << style;
+    }
+
+    // lines crossing at the center of the view, so that all of them are found there
+    const int lines = 60;
+    GeoDataDocument *document = new GeoDataDocument;
+    QVector<GeoDataPlacemark *> placemarks;
+    for ( int i = 0; i < lines; ++i ) {
+        const qreal slope = -1.0 + 2.0 * i / lines;
+        placemarks << createPlacemark( -1.0, -slope, 1.0, slope, styles[i % 3] );
+        document->append( placemarks.last() );
+    }
+
+    StyleBuilder styleBuilder;
+    GeoDataTreeModel treeModel;
+    GeometryLayer layer( &treeModel, &styleBuilder );
+    // beyond the maximum zoom level of the styles, so that changing it keeps the cached items
+    layer.setTileLevel( styleBuilder.maximumZoomLevel() + 1 );
+    treeModel.addDocument( document );
+
+    ViewportParams viewport( Equirectangular, 0.0, 0.0, 1000, QSize( 800, 600 ) );
+    render( &layer, &viewport );
+    render( &layer, &viewport );
+
+    // mixes the groups of lines sharing a style
+    for ( int i = 0; i < lines; ++i ) {
+        placemarks[i]->setStyle( styles[i / 20] );
+    }
+    layer.setTileLevel( styleBuilder.maximumZoomLevel() + 2 );
+    render( &layer, &viewport );
+    render( &layer, &viewport );
+
+    // lines of the same style are painted one after another
+    const QPoint center( viewport.width() / 2, viewport.height() / 2 );
+    const QVector<const GeoDataFeature *> features = layer.whichFeatureAt( center, &viewport );
+    QCOMPARE( features.size(), lines );
+    QSet<const GeoDataStyle *> finished;
+    const GeoDataStyle *current = nullptr;
+    for ( const GeoDataFeature *feature: features ) {
+        const GeoDataStyle *style = static_cast<const GeoDataPlacemark *>( feature )->customStyle().data();
+        if ( style != current ) {
+            QVERIFY( !finished.contains( style ) );
+            finished << current;
+            current = style;
+        }
+    }
+
+    treeModel.removeDocument( document );
+    delete document;
+}
+
+
+void GeometryLayerTest::addAndRemoveTile()
+{
+    QVector<GeoDataStyle::Ptr> styles;
+    for ( int i = 0; i < 3; ++i ) {
+        GeoDataStyle::Ptr style( new GeoDataStyle );
+        style->lineStyle().setWidth( 2 + i );
+        styles << style;
+    }
+
+    // lines crossing at the center of the view
+    GeoDataDocument *document = new GeoDataDocument;
+    for ( int i = 0; i < 30; ++i ) {
+        const qreal slope = -1.0 + 2.0 * i / 30;
+        document->append( createPlacemark( -1.0, -slope, 1.0, slope, styles[i % 3] ) );
+    }
+
+    StyleBuilder styleBuilder;
+    GeoDataTreeModel treeModel;
+    GeometryLayer layer( &treeModel, &styleBuilder );
+    layer.setTileLevel( 5 );
+    treeModel.addDocument( document );
+
+    ViewportParams viewport( Equirectangular, 0.0, 0.0, 1000, QSize( 800, 600 ) );
+    render( &layer, &viewport );
+    render( &layer, &viewport );
+
+    const QPoint center( viewport.width() / 2, viewport.height() / 2 );
+    const QVector<const GeoDataFeature *> features = layer.whichFeatureAt( center, &viewport );
+    QCOMPARE( features.size(), 30 );
+
+    // a tile loaded while panning, with lines next to the crossing ones
+    GeoDataDocument *tile = new GeoDataDocument;
+    for ( int i = 0; i < 10; ++i ) {
+        tile->append( createPlacemark( 5.0, 0.5 * i, 6.0, 0.5 * i, styles[i % 3] ) );
+    }
+    treeModel.addDocument( tile );
+    render( &layer, &viewport );
+    render( &layer, &viewport );
+
+    qreal x, y;
+    QVERIFY( viewport.screenCoordinates( 5.5 * DEG2RAD, 0.0, x, y ) );
+    const QPoint tilePosition( qRound( x ), qRound( y ) );
+    QCOMPARE( layer.whichFeatureAt( tilePosition, &viewport ).size(), 1 );
+    QVERIFY( layer.hasFeatureAt( tilePosition, &viewport ) );
+    QCOMPARE( layer.whichFeatureAt( center, &viewport ), features );
+
+    // the unloaded tile leaves the paint fragments of the other items in place
+    treeModel.removeDocument( tile );
+    delete tile;
+    QVERIFY( !layer.hasFeatureAt( tilePosition, &viewport ) );
+    QCOMPARE( layer.whichFeatureAt( center, &viewport ), features );
+
+    render( &layer, &viewport );
+    QVERIFY( layer.whichFeatureAt( tilePosition, &viewport ).isEmpty() );
+    QCOMPARE( layer.whichFeatureAt( center, &viewport ), features );
+
+    treeModel.removeDocument( document );
+    delete document;
+}
+
+}
+
+QTEST_MAIN( Marble::GeometryLayerTest )
+
+#include "GeometryLayerTest.moc"
@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "MarbleDirs.h"
+#include "ParsingRunnerManager.h"
+#include "PluginManager.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QTemporaryDir>
+#include <QTest>
+
+namespace Marble
+{
+
+/**
+ * Parses KML files with and without streaming top level features in chunks.
+ */
+class KmlStreamingTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void stream_data();
+    void stream();
+
+    void benchmarkTimeToFirstFeature_data();
+    void benchmarkTimeToFirstFeature();
+    void benchmarkPeakMemory_data();
+    void benchmarkPeakMemory();
+
+ private:
+    QString writeKml( const QString &name, int placemarks ) const;
+    static QString placemarkName( int i );
+    static qint64 peakResidentSetSize();
+    static void resetPeakResidentSetSize();
+
+    QTemporaryDir m_directory;
+    PluginManager m_pluginManager;
+};
+
+void KmlStreamingTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+    QVERIFY( m_directory.isValid() );
+}
+
+QString KmlStreamingTest::placemarkName( int i )
+{
+    return QString( "Vessel %1" ).arg( i );
+}
+
+QString KmlStreamingTest::writeKml( const QString &name, int placemarks ) const
+{
+    const QString fileName = m_directory.path() + QLatin1Char( '/' ) + name + QLatin1String( ".kml" );
+    QFile file( fileName );
+    if ( file.exists() ) {
+        return fileName;  // shared by the benchmark rows
+    }
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        return QString();
+    }
+
+    file.write( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>\n"
+                "<name>Vessels</name>\n"
+                "<Style id=\"track\"><LineStyle><color>ff0000ff</color></LineStyle></Style>\n" );
+    for ( int i = 0; i < placemarks; ++i ) {
+        QString coordinates;
+        for ( int j = 0; j < 10; ++j ) {
+            coordinates += QString( "%1,%2 " ).arg( -170.0 + 340.0 * i / placemarks + 0.01 * j ).arg( 40.0 + 0.01 * j );
+        }
+        file.write( QString( "<Placemark><name>%1</name><styleUrl>#track</styleUrl>"
+                             "<LineString><coordinates>%2</coordinates></LineString></Placemark>\n" )
+                    .arg( placemarkName( i ) ).arg( coordinates ).toUtf8() );
+    }
+    file.write( "</Document></kml>\n" );
+    return fileName;
+}
+
+qint64 KmlStreamingTest::peakResidentSetSize()
+{
+#ifdef Q_OS_LINUX
+    QFile status( "/proc/self/status" );
+    if ( status.open( QIODevice::ReadOnly ) ) {
+        for ( const QByteArray &line: status.readAll().split( '\n' ) ) {
+            if ( line.startsWith( "VmHWM:" ) ) {
+                return line.mid( 6 ).trimmed().split( ' ' ).first().toLongLong() * 1024;
+            }
+        }
+    }
+#endif
+    return -1;
+}
+
+void KmlStreamingTest::resetPeakResidentSetSize()
+{
+#ifdef Q_OS_LINUX
+    QFile clearRefs( "/proc/self/clear_refs" );
+    if ( clearRefs.open( QIODevice::WriteOnly ) ) {
+        clearRefs.write( "5" );
+    }
+#endif
+}
+
+void KmlStreamingTest::stream_data()
+{
+    QTest::addColumn<int>( "chunkSize" );
+
+    QTest::newRow( "whole document" ) << 0;
+    QTest::newRow( "chunks of 1" ) << 1;
+    QTest::newRow( "chunks of 100" ) << 100;
+    QTest::newRow( "chunks of 1000" ) << 1000;
+}
+
+void KmlStreamingTest::stream()
+{
+    QFETCH( int, chunkSize );
+
+    const int placemarks = 2500;
+    const QString fileName = writeKml( QString( "stream%1" ).arg( chunkSize ), placemarks );
+    QVERIFY( !fileName.isEmpty() );
+
+    QMutex mutex;
+    QVector<GeoDataDocument *> chunks;
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    runnerManager.setChunkSize( chunkSize );
+    connect( &runnerManager, &ParsingRunnerManager::featuresParsed, &runnerManager, [&]( GeoDataDocument *chunk ) {
+        QMutexLocker locker( &mutex );
+        chunks << chunk;
+    }, Qt::DirectConnection );
+
+    GeoDataDocument *document = runnerManager.openFile( fileName );
+    QVERIFY( document );
+    QCOMPARE( document->name(), QString( "Vessels" ) );
+
+    if ( chunkSize == 0 ) {
+        QVERIFY( chunks.isEmpty() );
+    } else {
+        QVERIFY( chunks.size() >= placemarks / chunkSize - 1 );
+    }
+
+    // all placemarks arrive exactly once and in document order
+    QVector<GeoDataPlacemark *> parsed;
+    for ( GeoDataDocument *chunk: chunks ) {
+        QVERIFY( chunk->size() >= chunkSize );
+        QCOMPARE( chunk->name(), QString( "Vessels" ) );
+        parsed << chunk->placemarkList();
+    }
+
+    // shared styles are handed out once, with the first features
+    if ( chunkSize == 0 ) {
+        QVERIFY( document->style( "track" ) );
+    } else {
+        QVERIFY( chunks.first()->style( "track" ) );
+        for ( int i = 1; i < chunks.size(); ++i ) {
+            QVERIFY( chunks[i]->styles().isEmpty() );
+        }
+        QVERIFY( document->styles().isEmpty() );
+    }
+    parsed << document->placemarkList();
+    QCOMPARE( parsed.size(), placemarks );
+    for ( int i = 0; i < placemarks; ++i ) {
+        QCOMPARE( parsed[i]->name(), placemarkName( i ) );
+    }
+
+    qDeleteAll( chunks );
+    delete document;
+}
+
+void KmlStreamingTest::benchmarkTimeToFirstFeature_data()
+{
+    QTest::addColumn<int>( "chunkSize" );
+
+    QTest::newRow( "whole document" ) << 0;
+    QTest::newRow( "streaming" ) << 1000;
+}
+
+void KmlStreamingTest::benchmarkTimeToFirstFeature()
+{
+    QFETCH( int, chunkSize );
+
+    // a large file of vessel tracks
+    const QString fileName = writeKml( "benchmark", 200000 );
+    QVERIFY( !fileName.isEmpty() );
+
+    QMutex mutex;
+    QVector<GeoDataDocument *> chunks;
+    qint64 firstFeature = -1;
+    QElapsedTimer timer;
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    runnerManager.setChunkSize( chunkSize );
+    connect( &runnerManager, &ParsingRunnerManager::featuresParsed, &runnerManager, [&]( GeoDataDocument *chunk ) {
+        QMutexLocker locker( &mutex );
+        if ( chunks.isEmpty() ) {
+            firstFeature = timer.elapsed();
+        }
+        chunks << chunk;
+    }, Qt::DirectConnection );
+
+    timer.start();
+    GeoDataDocument *document = runnerManager.openFile( fileName, UserDocument, 600000 );
+    QVERIFY( document );
+    if ( firstFeature < 0 ) {
+        firstFeature = timer.elapsed();
+    }
+
+    QTest::setBenchmarkResult( firstFeature, QTest::WalltimeMilliseconds );
+    qDeleteAll( chunks );
+    delete document;
+}
+
+void KmlStreamingTest::benchmarkPeakMemory_data()
+{
+    benchmarkTimeToFirstFeature_data();
+}
+
+void KmlStreamingTest::benchmarkPeakMemory()
+{
+    QFETCH( int, chunkSize );
+
+    const QString fileName = writeKml( "benchmark", 200000 );
+    QVERIFY( !fileName.isEmpty() );
+
+    // Consumers like the FileManager keep the chunks, so only the transient
+    // memory of parsing the file differs
+    QMutex mutex;
+    QVector<GeoDataDocument *> chunks;
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    runnerManager.setChunkSize( chunkSize );
+    connect( &runnerManager, &ParsingRunnerManager::featuresParsed, &runnerManager, [&]( GeoDataDocument *chunk ) {
+        QMutexLocker locker( &mutex );
+        chunks << chunk;
+    }, Qt::DirectConnection );
+
+    resetPeakResidentSetSize();
+    GeoDataDocument *document = runnerManager.openFile( fileName, UserDocument, 600000 );
+    QVERIFY( document );
+
+    const qint64 peak = peakResidentSetSize();
+    qDeleteAll( chunks );
+    delete document;
+
+    if ( peak < 0 ) {
+        QSKIP( "Peak memory usage is only available on Linux" );
+    }
+    QTest::setBenchmarkResult( peak, QTest::BytesAllocated );
+}
+
+}
+
+QTEST_MAIN( Marble::KmlStreamingTest )
+
+#include "KmlStreamingTest.moc"
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "MbTilesStorage.h"
+#include "MbTilesStoragePolicy.h"
+#include "TestUtils.h"
+
+#include <QTemporaryDir>
+#include <QThread>
+
+namespace Marble
+{
+
+class MbTilesStorageTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void parseTileFileName_data();
+    void parseTileFileName();
+
+    void storeTile();
+    void storagePolicy();
+    void sharedBetweenThreads();
+
+ private:
+    QTemporaryDir m_directory;
+};
+
+void MbTilesStorageTest::initTestCase()
+{
+    QVERIFY( m_directory.isValid() );
+}
+
+void MbTilesStorageTest::parseTileFileName_data()
+{
+    QTest::addColumn<QString>( "tileFileName" );
+    QTest::addColumn<bool>( "valid" );
+    QTest::addColumn<QString>( "databaseFileName" );
+    QTest::addColumn<int>( "zoomLevel" );
+    QTest::addColumn<int>( "x" );
+    QTest::addColumn<int>( "y" );
+
+    addRow() << "maps/earth/osm.mbtiles/12/345/678" << true << "maps/earth/osm.mbtiles" << 12 << 345 << 678;
+    addRow() << "/tmp/a.mbtiles/0/0/0" << true << "/tmp/a.mbtiles" << 0 << 0 << 0;
+    addRow() << "maps/earth/osm/12/345/678.png" << false << QString() << 0 << 0 << 0;
+    addRow() << "maps/earth/osm.mbtiles/12/345" << false << QString() << 0 << 0 << 0;
+    addRow() << "maps/earth/osm.mbtiles/12/345/678.png" << false << QString() << 0 << 0 << 0;
+}
+
+void MbTilesStorageTest::parseTileFileName()
+{
+    QFETCH( QString, tileFileName );
+    QFETCH( bool, valid );
+
+    QString databaseFileName;
+    int zoomLevel = 0;
+    int x = 0;
+    int y = 0;
+    QCOMPARE( MbTilesStorage::parseTileFileName( tileFileName, databaseFileName, zoomLevel, x, y ), valid );
+
+    if ( valid ) {
+        QTEST( databaseFileName, "databaseFileName" );
+        QTEST( zoomLevel, "zoomLevel" );
+        QTEST( x, "x" );
+        QTEST( y, "y" );
+    }
+}
+
+void MbTilesStorageTest::storeTile()
+{
+    MbTilesStorage storage( m_directory.path() + QLatin1String( "/maps/earth/test.mbtiles" ) );
+    QVERIFY( !storage.hasTile( 3, 1, 2 ) );
+    QVERIFY( storage.tileData( 3, 1, 2 ).isEmpty() );
+
+    QVERIFY( storage.storeTile( 3, 1, 2, "tile data" ) );
+    QVERIFY( storage.storeTile( 5, 1, 2, "more tile data" ) );
+
+    QDateTime lastModified;
+    QVERIFY( storage.hasTile( 3, 1, 2, &lastModified ) );
+    QVERIFY( lastModified.isValid() );
+    QVERIFY( qAbs( lastModified.secsTo( QDateTime::currentDateTime() ) ) < 60 );
+    QCOMPARE( storage.tileData( 3, 1, 2 ), QByteArray( "tile data" ) );
+    QVERIFY( !storage.hasTile( 3, 2, 1 ) );
+
+    QCOMPARE( storage.removeTiles( 4 ), qint64( 14 ) );
+    QVERIFY( storage.hasTile( 3, 1, 2 ) );
+    QVERIFY( !storage.hasTile( 5, 1, 2 ) );
+}
+
+void MbTilesStorageTest::storagePolicy()
+{
+    MbTilesStoragePolicy policy( m_directory.path() );
+
+    const QString fileName = QStringLiteral( "maps/earth/policy.mbtiles/4/3/2" );
+    QVERIFY( !policy.fileExists( fileName ) );
+    QVERIFY( policy.updateFile( fileName, "data" ) );
+    QVERIFY( policy.fileExists( fileName ) );
+
+    QVERIFY( !policy.updateFile( QStringLiteral( "maps/earth/policy/4/3/2.png" ), "data" ) );
+    QVERIFY( !policy.lastErrorMessage().isEmpty() );
+
+    MbTilesStorage storage( m_directory.path() + QLatin1String( "/maps/earth/policy.mbtiles" ) );
+    QCOMPARE( storage.tileData( 4, 3, 2 ), QByteArray( "data" ) );
+}
+
+void MbTilesStorageTest::sharedBetweenThreads()
+{
+    MbTilesStorage storage( m_directory.path() + QLatin1String( "/maps/earth/shared.mbtiles" ) );
+    QVERIFY( storage.storeTile( 2, 1, 0, "main thread" ) );
+
+    // the instance has been used by this thread, the other one needs its own connection
+    QByteArray data;
+    bool stored = false;
+    QThread *const thread = QThread::create( [&]() {
+        data = storage.tileData( 2, 1, 0 );
+        stored = storage.storeTile( 2, 0, 1, "other thread" );
+    } );
+    thread->start();
+    QVERIFY( thread->wait( 10000 ) );
+    delete thread;
+
+    QCOMPARE( data, QByteArray( "main thread" ) );
+    QVERIFY( stored );
+    QCOMPARE( storage.tileData( 2, 0, 1 ), QByteArray( "other thread" ) );
+}
+
+}
+
+QTEST_MAIN( Marble::MbTilesStorageTest )
+
+#include "MbTilesStorageTest.moc"
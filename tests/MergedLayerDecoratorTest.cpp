@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoSceneTextureTileDataset.h"
+#include "HttpDownloadManager.h"
+#include "MarbleClock.h"
+#include "MarbleDirs.h"
+#include "MergedLayerDecorator.h"
+#include "Planet.h"
+#include "PlanetFactory.h"
+#include "StackedTile.h"
+#include "SunLocator.h"
+#include "TileId.h"
+#include "TileLoader.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QTest>
+
+namespace Marble
+{
+
+/**
+ * Checks when the decorator reuses the texture tiles before sun shading.
+ */
+class MergedLayerDecoratorTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    MergedLayerDecoratorTest();
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void reloadAfterSunMoved();
+    void updatedTile();
+    void disabledCache();
+
+ private:
+    bool writeTile( Qt::GlobalColor color ) const;
+    QRgb loadTile( MergedLayerDecorator *decorator ) const;
+
+    QTemporaryDir m_directory;
+    MarbleClock m_clock;
+    Planet m_planet;
+    SunLocator m_sunLocator;
+    GeoSceneTextureTileDataset m_textureLayer;
+    const TileId m_tileId;
+};
+
+MergedLayerDecoratorTest::MergedLayerDecoratorTest() :
+    m_clock(),
+    m_planet( PlanetFactory::construct( QStringLiteral( "earth" ) ) ),
+    m_sunLocator( &m_clock, &m_planet ),
+    m_textureLayer( QStringLiteral( "unshaded" ) ),
+    m_tileId( 0, 0, 0, 0 )
+{
+}
+
+void MergedLayerDecoratorTest::initTestCase()
+{
+    QVERIFY( m_directory.isValid() );
+    MarbleDirs::setMarbleDataPath( m_directory.path() );
+
+    m_textureLayer.setSourceDir( QStringLiteral( "earth/unshadedtiletest" ) );
+    m_textureLayer.setFileFormat( QStringLiteral( "PNG" ) );
+    m_textureLayer.setLevelZeroColumns( 1 );
+    m_textureLayer.setLevelZeroRows( 1 );
+    m_textureLayer.setTileSize( QSize( 16, 16 ) );
+    m_textureLayer.setMaximumTileLevel( 0 );
+
+    m_clock.setDateTime( QDateTime( QDate( 2020, 6, 1 ), QTime( 10, 30 ), Qt::UTC ) );
+    m_sunLocator.update();
+}
+
+bool MergedLayerDecoratorTest::writeTile( Qt::GlobalColor color ) const
+{
+    const QString fileName = m_directory.path() + QLatin1String( "/maps/" ) + m_textureLayer.relativeTileFileName( m_tileId );
+    QImage image( m_textureLayer.tileSize(), QImage::Format_RGB32 );
+    image.fill( color );
+    return QDir().mkpath( QFileInfo( fileName ).path() ) && image.save( fileName );
+}
+
+QRgb MergedLayerDecoratorTest::loadTile( MergedLayerDecorator *decorator ) const
+{
+    QScopedPointer<StackedTile> tile( decorator->loadTile( m_tileId ) );
+    return tile->resultImage()->pixel( 8, 8 );
+}
+
+void MergedLayerDecoratorTest::reloadAfterSunMoved()
+{
+    HttpDownloadManager downloadManager( nullptr );
+    TileLoader tileLoader( &downloadManager, nullptr );
+    MergedLayerDecorator decorator( &tileLoader, &m_sunLocator );
+    decorator.setShowSunShading( true );
+    decorator.setTextureLayers( QVector<const GeoSceneTextureTileDataset *>() << &m_textureLayer );
+
+    QVERIFY( writeTile( Qt::red ) );
+    QVERIFY( qRed( loadTile( &decorator ) ) > 0 );
+
+    // other loads than the one after the sun moved take the current tile
+    QVERIFY( writeTile( Qt::blue ) );
+    QVERIFY( qBlue( loadTile( &decorator ) ) > 0 );
+
+    // the sun moved, only the shading is repeated
+    decorator.updateSunPosition();
+    QVERIFY( writeTile( Qt::green ) );
+    QVERIFY( qBlue( loadTile( &decorator ) ) > 0 );
+
+    // but only once
+    QVERIFY( qGreen( loadTile( &decorator ) ) > 0 );
+}
+
+void MergedLayerDecoratorTest::updatedTile()
+{
+    HttpDownloadManager downloadManager( nullptr );
+    TileLoader tileLoader( &downloadManager, nullptr );
+    MergedLayerDecorator decorator( &tileLoader, &m_sunLocator );
+    decorator.setShowSunShading( true );
+    decorator.setTextureLayers( QVector<const GeoSceneTextureTileDataset *>() << &m_textureLayer );
+
+    QVERIFY( writeTile( Qt::red ) );
+    QVERIFY( qRed( loadTile( &decorator ) ) > 0 );
+
+    // a tile updated while not being displayed, like a finished download
+    QVERIFY( writeTile( Qt::blue ) );
+    decorator.removeUnshadedTile( m_tileId );
+    decorator.updateSunPosition();
+    QVERIFY( qBlue( loadTile( &decorator ) ) > 0 );
+}
+
+void MergedLayerDecoratorTest::disabledCache()
+{
+    HttpDownloadManager downloadManager( nullptr );
+    TileLoader tileLoader( &downloadManager, nullptr );
+    MergedLayerDecorator decorator( &tileLoader, &m_sunLocator );
+    decorator.setShowSunShading( true );
+    decorator.setTextureLayers( QVector<const GeoSceneTextureTileDataset *>() << &m_textureLayer );
+    decorator.setUnshadedTileCacheLimit( 0 );
+    QCOMPARE( decorator.unshadedTileCacheLimit(), quint64( 0 ) );
+
+    QVERIFY( writeTile( Qt::red ) );
+    QVERIFY( qRed( loadTile( &decorator ) ) > 0 );
+
+    decorator.updateSunPosition();
+    QVERIFY( writeTile( Qt::blue ) );
+    QVERIFY( qBlue( loadTile( &decorator ) ) > 0 );
+}
+
+}
+
+QTEST_MAIN( Marble::MergedLayerDecoratorTest )
+
+#include "MergedLayerDecoratorTest.moc"
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataRelation.h"
+#include "MarbleDirs.h"
+#include "ParsingRunnerManager.h"
+#include "PluginManager.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QTest>
+
+namespace Marble
+{
+
+/**
+ * Loads OSM PBF files with and without parallel decoding: a small file checked in
+ * with the tests and, for benchmarking, the one given by the MARBLE_OSM_PBF_SAMPLE
+ * environment variable, for example a regional extract.
+ */
+class OsmPbfParserTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void duplicateElements_data();
+    void duplicateElements();
+
+    void benchmarkParsing_data();
+    void benchmarkParsing();
+
+ private:
+    static int placemarkCount( const GeoDataContainer *container );
+    static void addThreadCounts();
+
+    PluginManager m_pluginManager;
+    QString m_fileName;
+    int m_maxThreadCount;
+    int m_placemarkCount;
+};
+
+void OsmPbfParserTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    m_fileName = qEnvironmentVariable( "MARBLE_OSM_PBF_SAMPLE" );
+    m_maxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    m_placemarkCount = -1;
+}
+
+void OsmPbfParserTest::cleanupTestCase()
+{
+    QThreadPool::globalInstance()->setMaxThreadCount( m_maxThreadCount );
+}
+
+int OsmPbfParserTest::placemarkCount( const GeoDataContainer *container )
+{
+    int count = container->placemarkList().size();
+    for ( const GeoDataFolder *folder: container->folderList() ) {
+        count += placemarkCount( folder );
+    }
+
+    return count;
+}
+
+void OsmPbfParserTest::addThreadCounts()
+{
+    QTest::addColumn<int>( "threadCount" );
+
+    // the parser decodes with as many threads as the global thread pool allows
+    QTest::newRow( "sequential" ) << 1;
+    QTest::newRow( "parallel" ) << qMax( 2, QThread::idealThreadCount() );
+}
+
+void OsmPbfParserTest::duplicateElements_data()
+{
+    addThreadCounts();
+}
+
+void OsmPbfParserTest::duplicateElements()
+{
+    QFETCH( int, threadCount );
+
+    // The second data block repeats a node, a way and a relation of the first
+    // one with other tags, like overlapping extracts
+    QThreadPool::globalInstance()->setMaxThreadCount( threadCount );
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    GeoDataDocument *document = runnerManager.openFile( QStringLiteral( TESTSRCDIR "/data/duplicates.osm.pbf" ) );
+    QVERIFY( document );
+
+    const GeoDataPlacemark *node = nullptr;
+    const GeoDataPlacemark *way = nullptr;
+    const GeoDataRelation *relation = nullptr;
+    for ( const GeoDataFeature *feature: document->featureList() ) {
+        if ( const GeoDataPlacemark *placemark = geodata_cast<GeoDataPlacemark>( feature ) ) {
+            if ( placemark->osmData().id() == 1 ) {
+                node = placemark;
+            } else if ( placemark->osmData().id() == 100 ) {
+                way = placemark;
+            }
+        } else if ( const GeoDataRelation *candidate = geodata_cast<GeoDataRelation>( feature ) ) {
+            relation = candidate;
+        }
+    }
+
+    // the tags of both occurrences are kept, the later ones win
+    QVERIFY( node );
+    QCOMPARE( node->name(), QString( "Beta" ) );
+    QCOMPARE( node->osmData().tagValue( "amenity" ), QString( "cafe" ) );
+    QCOMPARE( node->coordinate().longitude( GeoDataCoordinates::Degree ), 10.0005 );
+
+    QVERIFY( way );
+    QCOMPARE( way->name(), QString( "Main Street" ) );
+    QCOMPARE( way->osmData().tagValue( "highway" ), QString( "residential" ) );
+    const GeoDataLineString *lineString = geodata_cast<GeoDataLineString>( way->geometry() );
+    QVERIFY( lineString );
+    QCOMPARE( lineString->size(), 2 );
+
+    QVERIFY( relation );
+    QCOMPARE( relation->name(), QString( "Bus 1" ) );
+    QCOMPARE( relation->osmData().tagValue( "route" ), QString( "bus" ) );
+    QCOMPARE( relation->members().size(), 1 );
+
+    delete document;
+}
+
+void OsmPbfParserTest::benchmarkParsing_data()
+{
+    addThreadCounts();
+}
+
+void OsmPbfParserTest::benchmarkParsing()
+{
+    QFETCH( int, threadCount );
+
+    if ( m_fileName.isEmpty() ) {
+        QSKIP( "Set MARBLE_OSM_PBF_SAMPLE to an .osm.pbf file to run the benchmark" );
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount( threadCount );
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+
+    QElapsedTimer timer;
+    timer.start();
+    GeoDataDocument *document = nullptr;
+    QBENCHMARK_ONCE {
+        document = runnerManager.openFile( m_fileName, UserDocument, 3600 * 1000 );
+    }
+    const qint64 elapsed = qMax<qint64>( 1, timer.elapsed() );
+    QVERIFY( document );
+
+    qDebug() << "Parsed" << QFileInfo( m_fileName ).size() / 1024.0 / elapsed * 1000.0 / 1024.0 << "MiB/s with"
+             << threadCount << "threads";
+
+    // the result does not depend on the number of threads
+    const int count = placemarkCount( document );
+    if ( m_placemarkCount < 0 ) {
+        m_placemarkCount = count;
+    }
+    QCOMPARE( count, m_placemarkCount );
+
+    delete document;
+}
+
+}
+
+QTEST_MAIN( Marble::OsmPbfParserTest )
+
+#include "OsmPbfParserTest.moc"
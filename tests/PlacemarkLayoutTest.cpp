@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoDataPlacemark.h"
+#include "MarbleClock.h"
+#include "MarbleDirs.h"
+#include "MarblePlacemarkModel.h"
+#include "PlacemarkLayout.h"
+#include "StyleBuilder.h"
+#include "ViewportParams.h"
+#include "VisiblePlacemark.h"
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QItemSelectionModel>
+#include <QTest>
+
+namespace Marble
+{
+
+/**
+ * A flat model handing out placemarks like MarblePlacemarkModel.
+ */
+class PlacemarkListModel : public QAbstractListModel
+{
+ public:
+    void append( const QVector<GeoDataPlacemark *> &placemarks )
+    {
+        beginInsertRows( QModelIndex(), m_placemarks.size(), m_placemarks.size() + placemarks.size() - 1 );
+        m_placemarks << placemarks;
+        endInsertRows();
+    }
+
+    int rowCount( const QModelIndex &parent = QModelIndex() ) const override
+    {
+        return parent.isValid() ? 0 : m_placemarks.size();
+    }
+
+    QVariant data( const QModelIndex &index, int role ) const override
+    {
+        if ( role != MarblePlacemarkModel::ObjectPointerRole ) {
+            return QVariant();
+        }
+        return QVariant::fromValue<GeoDataObject *>( m_placemarks.at( index.row() ) );
+    }
+
+ private:
+    QVector<GeoDataPlacemark *> m_placemarks;
+};
+
+class PlacemarkLayoutTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void layout_data();
+    void layout();
+    void selection();
+    void pan();
+    void zoom();
+
+    void benchmarkLayout_data();
+    void benchmarkLayout();
+
+ private:
+    static QVector<GeoDataPlacemark *> createCities( int count );
+
+    QVector<GeoDataPlacemark *> m_placemarks;
+    PlacemarkListModel m_model;
+    MarbleClock m_clock;
+    StyleBuilder m_styleBuilder;
+};
+
+QVector<GeoDataPlacemark *> PlacemarkLayoutTest::createCities( int count )
+{
+    // Deterministic, roughly uniformly spread cities with populations
+    // following a power law like the world wide city placemarks
+    QVector<GeoDataPlacemark *> placemarks;
+    placemarks.reserve( count );
+    quint32 random = 1;
+    for ( int i = 0; i < count; ++i ) {
+        random = random * 1664525 + 1013904223;
+        const qreal lon = -180.0 + 360.0 * ( random >> 8 ) / ( 1 << 24 );
+        random = random * 1664525 + 1013904223;
+        const qreal lat = -60.0 + 130.0 * ( random >> 8 ) / ( 1 << 24 );
+        const qint64 population = 10000000 / ( i + 1 ) + 1000;
+
+        GeoDataPlacemark *placemark = new GeoDataPlacemark( QString( "City %1" ).arg( i ) );
+        placemark->setCoordinate( lon, lat, 0.0, GeoDataCoordinates::Degree );
+        placemark->setVisualCategory( population > 1000000 ? GeoDataPlacemark::LargeCity
+                                      : population > 100000 ? GeoDataPlacemark::BigCity
+                                      : population > 10000 ? GeoDataPlacemark::MediumCity
+                                      : GeoDataPlacemark::SmallCity );
+        placemark->setPopularity( population );
+        placemark->setZoomLevel( qBound( 1, 2 + i / 2000, 12 ) );
+        placemarks << placemark;
+    }
+    return placemarks;
+}
+
+void PlacemarkLayoutTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+
+    // about the number of populated places of the world wide data set
+    m_placemarks = createCities( 200000 );
+    m_model.append( m_placemarks );
+}
+
+void PlacemarkLayoutTest::cleanupTestCase()
+{
+    qDeleteAll( m_placemarks );
+}
+
+void PlacemarkLayoutTest::layout_data()
+{
+    QTest::addColumn<qreal>( "lon" );
+    QTest::addColumn<qreal>( "lat" );
+    QTest::addColumn<int>( "radius" );
+    QTest::addColumn<int>( "tileLevel" );
+
+    QTest::newRow( "world" ) << 0.0 << 0.0 << 300 << 2;
+    QTest::newRow( "continent" ) << 10.0 << 50.0 << 2000 << 5;
+    QTest::newRow( "region" ) << 10.0 << 50.0 << 20000 << 8;
+}
+
+void PlacemarkLayoutTest::layout()
+{
+    QFETCH( qreal, lon );
+    QFETCH( qreal, lat );
+    QFETCH( int, radius );
+    QFETCH( int, tileLevel );
+
+    QItemSelectionModel selectionModel( &m_model );
+    PlacemarkLayout layout( &m_model, &selectionModel, &m_clock, &m_styleBuilder );
+    layout.setShowCities( true );
+    layout.addPlacemarks( QModelIndex(), 0, m_model.rowCount() - 1 );
+
+    const ViewportParams viewport( Equirectangular, lon * DEG2RAD, lat * DEG2RAD, radius, QSize( 1920, 1080 ) );
+    const QVector<VisiblePlacemark *> placemarks = layout.generateLayout( &viewport, tileLevel );
+    QVERIFY( !placemarks.isEmpty() );
+
+    // labels and symbols must not overlap, and they are laid out in
+    // decreasing importance
+    for ( int i = 0; i < placemarks.size(); ++i ) {
+        for ( int j = i + 1; j < placemarks.size(); ++j ) {
+            QVERIFY( !placemarks[i]->boundingBox().intersects( placemarks[j]->boundingBox() ) );
+        }
+        if ( i > 0 ) {
+            QVERIFY( GeoDataPlacemark::placemarkLayoutOrderCompare( placemarks[i - 1]->placemark(),
+                                                                    placemarks[i]->placemark() ) );
+        }
+    }
+}
+
+void PlacemarkLayoutTest::selection()
+{
+    QItemSelectionModel selectionModel( &m_model );
+    PlacemarkLayout layout( &m_model, &selectionModel, &m_clock, &m_styleBuilder );
+    layout.setShowCities( true );
+    layout.addPlacemarks( QModelIndex(), 0, m_model.rowCount() - 1 );
+
+    // a small city in the view of the continent row
+    int row = m_placemarks.size() - 1;
+    for ( ; row >= 0; --row ) {
+        const GeoDataCoordinates coordinates = m_placemarks[row]->coordinate();
+        if ( qAbs( coordinates.longitude( GeoDataCoordinates::Degree ) - 10.0 ) < 5.0
+             && qAbs( coordinates.latitude( GeoDataCoordinates::Degree ) - 50.0 ) < 5.0 ) {
+            break;
+        }
+    }
+    QVERIFY( row >= 0 );
+    selectionModel.select( m_model.index( row ), QItemSelectionModel::Select );
+
+    const ViewportParams viewport( Equirectangular, 10.0 * DEG2RAD, 50.0 * DEG2RAD, 2000, QSize( 1920, 1080 ) );
+    const QVector<VisiblePlacemark *> placemarks = layout.generateLayout( &viewport, 5 );
+    QVERIFY( !placemarks.isEmpty() );
+    QCOMPARE( placemarks.first()->placemark(), m_placemarks[row] );
+    QVERIFY( placemarks.first()->selected() );
+
+    for ( int i = 1; i < placemarks.size(); ++i ) {
+        QVERIFY( placemarks[i]->placemark() != m_placemarks[row] );
+        QVERIFY( !placemarks[i]->selected() );
+    }
+}
+
+void PlacemarkLayoutTest::pan()
+{
+    QItemSelectionModel selectionModel( &m_model );
+    PlacemarkLayout layout( &m_model, &selectionModel, &m_clock, &m_styleBuilder );
+    layout.setShowCities( true );
+    layout.addPlacemarks( QModelIndex(), 0, m_model.rowCount() - 1 );
+    QVERIFY( layout.isIncrementalLayout() );
+
+    ViewportParams viewport( Equirectangular, 10.0 * DEG2RAD, 50.0 * DEG2RAD, 2000, QSize( 1920, 1080 ) );
+    QHash<const GeoDataPlacemark *, QPointF> labelOffsets;
+    for ( const VisiblePlacemark *mark: layout.generateLayout( &viewport, 5 ) ) {
+        if ( !mark->labelRect().isNull() ) {
+            labelOffsets.insert( mark->placemark(), mark->labelRect().topLeft() - mark->symbolPosition() );
+        }
+    }
+    QVERIFY( !labelOffsets.isEmpty() );
+
+    // a few pixels
+    viewport.centerOn( 10.2 * DEG2RAD, 50.1 * DEG2RAD );
+    QHash<const GeoDataPlacemark *, QPointF> movedLabelOffsets;
+    for ( const VisiblePlacemark *mark: layout.generateLayout( &viewport, 5 ) ) {
+        movedLabelOffsets.insert( mark->placemark(), mark->labelRect().topLeft() - mark->symbolPosition() );
+    }
+
+    // placemarks well inside the view keep their labels where they were
+    const QRectF inside = QRectF( QPointF( 0, 0 ), QSizeF( viewport.size() ) ).adjusted( 200, 200, -200, -200 );
+    int kept = 0;
+    for ( auto it = labelOffsets.constBegin(); it != labelOffsets.constEnd(); ++it ) {
+        qreal x = 0;
+        qreal y = 0;
+        viewport.screenCoordinates( it.key()->coordinate(), x, y );
+        if ( inside.contains( x, y ) ) {
+            QVERIFY( movedLabelOffsets.contains( it.key() ) );
+            QCOMPARE( movedLabelOffsets.value( it.key() ), it.value() );
+            ++kept;
+        }
+    }
+    QVERIFY( kept > 0 );
+}
+
+void PlacemarkLayoutTest::zoom()
+{
+    QItemSelectionModel selectionModel( &m_model );
+    PlacemarkLayout layout( &m_model, &selectionModel, &m_clock, &m_styleBuilder );
+    layout.setShowCities( true );
+    layout.addPlacemarks( QModelIndex(), 0, m_model.rowCount() - 1 );
+
+    ViewportParams viewport( Equirectangular, 10.0 * DEG2RAD, 50.0 * DEG2RAD, 2000, QSize( 1920, 1080 ) );
+    layout.generateLayout( &viewport, 5 );
+
+    // zooming causes a full layout
+    viewport.setRadius( 2400 );
+    QVector<const GeoDataPlacemark *> placemarks;
+    for ( const VisiblePlacemark *mark: layout.generateLayout( &viewport, 5 ) ) {
+        placemarks << mark->placemark();
+    }
+
+    PlacemarkLayout referenceLayout( &m_model, &selectionModel, &m_clock, &m_styleBuilder );
+    referenceLayout.setShowCities( true );
+    referenceLayout.setIncrementalLayout( false );
+    referenceLayout.addPlacemarks( QModelIndex(), 0, m_model.rowCount() - 1 );
+    QVector<const GeoDataPlacemark *> referencePlacemarks;
+    for ( const VisiblePlacemark *mark: referenceLayout.generateLayout( &viewport, 5 ) ) {
+        referencePlacemarks << mark->placemark();
+    }
+
+    QCOMPARE( placemarks, referencePlacemarks );
+}
+
+void PlacemarkLayoutTest::benchmarkLayout_data()
+{
+    QTest::addColumn<qreal>( "lon" );
+    QTest::addColumn<qreal>( "lat" );
+    QTest::addColumn<int>( "radius" );
+    QTest::addColumn<int>( "tileLevel" );
+    QTest::addColumn<bool>( "incremental" );
+
+    QTest::newRow( "world" ) << 0.0 << 0.0 << 300 << 2 << false;
+    QTest::newRow( "world incremental" ) << 0.0 << 0.0 << 300 << 2 << true;
+    QTest::newRow( "continent" ) << 10.0 << 50.0 << 2000 << 5 << false;
+    QTest::newRow( "continent incremental" ) << 10.0 << 50.0 << 2000 << 5 << true;
+    QTest::newRow( "region" ) << 10.0 << 50.0 << 20000 << 8 << false;
+    QTest::newRow( "region incremental" ) << 10.0 << 50.0 << 20000 << 8 << true;
+}
+
+void PlacemarkLayoutTest::benchmarkLayout()
+{
+    QFETCH( qreal, lon );
+    QFETCH( qreal, lat );
+    QFETCH( int, radius );
+    QFETCH( int, tileLevel );
+    QFETCH( bool, incremental );
+
+    QItemSelectionModel selectionModel( &m_model );
+    PlacemarkLayout layout( &m_model, &selectionModel, &m_clock, &m_styleBuilder );
+    layout.setShowCities( true );
+    layout.setIncrementalLayout( incremental );
+    layout.addPlacemarks( QModelIndex(), 0, m_model.rowCount() - 1 );
+
+    ViewportParams viewport( Equirectangular, lon * DEG2RAD, lat * DEG2RAD, radius, QSize( 1920, 1080 ) );
+    layout.generateLayout( &viewport, tileLevel );
+
+    // pan back and forth by a few pixels
+    int step = 0;
+    QBENCHMARK {
+        const qreal offset = 5.0 / radius * ( step % 2 );
+        viewport.centerOn( lon * DEG2RAD + offset, lat * DEG2RAD );
+        layout.generateLayout( &viewport, tileLevel );
+        ++step;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::PlacemarkLayoutTest )
+
+#include "PlacemarkLayoutTest.moc"
@@ -0,0 +1,310 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoDataLineString.h"
+#include "MarbleGlobal.h"
+#include "Route.h"
+#include "RouteIndex.h"
+#include "RouteSegment.h"
+
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTest>
+#include <QXmlStreamReader>
+#include <qmath.h>
+
+namespace Marble
+{
+
+/**
+ * Compares the nearest segments and points found with the RouteIndex with
+ * the ones of a linear scan over the route.
+ */
+class RouteIndexTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void nearestSegment_data();
+    void nearestSegment();
+    void nearestPoint();
+    void outAndBack();
+    void emptyIndex();
+
+    void benchmarkUpdatePosition_data();
+    void benchmarkUpdatePosition();
+
+ private:
+    static GeoDataLineString createPath( int size, qreal lon, qreal lat, qreal step );
+    static GeoDataLineString readGpx( const QString &fileName );
+    static Route createRoute( const GeoDataLineString &path, int segmentSize );
+    static GeoDataCoordinates nearby( const GeoDataCoordinates &point, qreal distance, QRandomGenerator &random );
+    static int linearScan( const Route &route, const GeoDataCoordinates &position, int current );
+};
+
+GeoDataLineString RouteIndexTest::createPath( int size, qreal lon, qreal lat, qreal step )
+{
+    // a road winding along, step is the distance of the points in radian
+    QRandomGenerator random( 42 );
+    GeoDataLineString path;
+    path.reserve( size );
+    qreal heading = 0.0;
+    for ( int i = 0; i < size; ++i ) {
+        path << GeoDataCoordinates( lon, lat );
+        heading += ( random.generateDouble() - 0.5 ) * 0.2;
+        lon += step * qCos( heading ) / qMax<qreal>( 0.01, qCos( lat ) );
+        lat = qBound<qreal>( -M_PI / 2, lat + step * qSin( heading ), M_PI / 2 );
+        GeoDataCoordinates::normalizeLonLat( lon, lat );
+    }
+    return path;
+}
+
+GeoDataLineString RouteIndexTest::readGpx( const QString &fileName )
+{
+    GeoDataLineString track;
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return track;
+    }
+
+    QXmlStreamReader reader( &file );
+    while ( !reader.atEnd() ) {
+        if ( reader.readNext() == QXmlStreamReader::StartElement && reader.name() == QLatin1String( "trkpt" ) ) {
+            const qreal lon = reader.attributes().value( QLatin1String( "lon" ) ).toDouble();
+            const qreal lat = reader.attributes().value( QLatin1String( "lat" ) ).toDouble();
+            track << GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+        }
+    }
+    return track;
+}
+
+Route RouteIndexTest::createRoute( const GeoDataLineString &path, int segmentSize )
+{
+    Route route;
+    for ( int i = 0; i + 1 < path.size(); i += segmentSize ) {
+        RouteSegment segment;
+        segment.setPath( path.mid( i, segmentSize + 1 ) );
+        route.addRouteSegment( segment );
+    }
+    return route;
+}
+
+GeoDataCoordinates RouteIndexTest::nearby( const GeoDataCoordinates &point, qreal distance, QRandomGenerator &random )
+{
+    // a GPS fix off by up to the given distance in meters
+    const qreal angle = random.generateDouble() * 2 * M_PI;
+    const qreal offset = random.generateDouble() * distance / EARTH_RADIUS;
+    qreal lon = point.longitude() + offset * qCos( angle ) / qMax<qreal>( 0.01, qCos( point.latitude() ) );
+    qreal lat = qBound<qreal>( -M_PI / 2, point.latitude() + offset * qSin( angle ), M_PI / 2 );
+    GeoDataCoordinates::normalizeLonLat( lon, lat );
+    return GeoDataCoordinates( lon, lat );
+}
+
+int RouteIndexTest::linearScan( const Route &route, const GeoDataCoordinates &position, int current )
+{
+    // Route::updatePosition() before the index
+    if ( current < 0 || current >= route.size() ) {
+        current = 0;
+    }
+
+    GeoDataCoordinates closest, interpolated;
+    qreal distance = route.at( current ).distanceTo( position, closest, interpolated );
+    QList<int> candidates;
+    for ( int i = 0; i < route.size(); ++i ) {
+        if ( i != current && route.at( i ).minimalDistanceTo( position ) <= distance ) {
+            candidates << i;
+        }
+    }
+
+    for ( int i: candidates ) {
+        const qreal dist = route.at( i ).distanceTo( position, closest, interpolated );
+        if ( dist < distance ) {
+            distance = dist;
+            current = i;
+        }
+    }
+    return current;
+}
+
+void RouteIndexTest::nearestSegment_data()
+{
+    QTest::addColumn<qreal>( "lon" );
+    QTest::addColumn<qreal>( "lat" );
+    QTest::addColumn<qreal>( "step" );
+    QTest::addColumn<qreal>( "deviation" );
+
+    QTest::newRow( "on route" ) << 10 * DEG2RAD << 50 * DEG2RAD << 1e-5 << 30.0;
+    QTest::newRow( "off route" ) << 10 * DEG2RAD << 50 * DEG2RAD << 1e-5 << 5000.0;
+    QTest::newRow( "date line" ) << 179.9 * DEG2RAD << -40 * DEG2RAD << 1e-5 << 200.0;
+    QTest::newRow( "pole" ) << 0.0 << 89.9 * DEG2RAD << 1e-5 << 200.0;
+    QTest::newRow( "world" ) << 0.0 << 0.0 << 1e-2 << 500000.0;
+}
+
+void RouteIndexTest::nearestSegment()
+{
+    QFETCH( qreal, lon );
+    QFETCH( qreal, lat );
+    QFETCH( qreal, step );
+    QFETCH( qreal, deviation );
+
+    const GeoDataLineString path = createPath( 5000, lon, lat, step );
+    Route route = createRoute( path, 10 );
+    QVERIFY( route.size() > 400 );
+
+    QRandomGenerator random( 7 );
+    int previous = -1;
+    for ( int i = 0; i < path.size(); i += 7 ) {
+        const GeoDataCoordinates position = nearby( path.at( i ), deviation, random );
+        route.setPosition( position );
+        const RouteSegment &segment = route.currentSegment();
+        QVERIFY( segment.isValid() );
+
+        // the nearest segment, of equally near ones the previous match or the
+        // next one following it, else the nearest one before it
+        auto const rank = [&]( int j ) { return j >= previous ? j - previous : route.size() + previous - j; };
+        int expected = -1;
+        qreal minimum = -1.0;
+        GeoDataCoordinates closest, interpolated;
+        for ( int j = 0; j < route.size(); ++j ) {
+            const qreal distance = route.at( j ).distanceTo( position, closest, interpolated );
+            if ( expected < 0 || distance < minimum || ( distance == minimum && rank( j ) < rank( expected ) ) ) {
+                expected = j;
+                minimum = distance;
+            }
+        }
+        QCOMPARE( int( &segment - &route.at( 0 ) ), expected );
+        previous = expected;
+    }
+}
+
+void RouteIndexTest::nearestPoint()
+{
+    const GeoDataLineString path = createPath( 10000, 179.0 * DEG2RAD, 60 * DEG2RAD, 1e-4 );
+    RouteIndex index;
+    index.setPoints( path );
+    QCOMPARE( index.size(), path.size() );
+
+    QRandomGenerator random( 7 );
+    for ( int i = 0; i < 200; ++i ) {
+        const GeoDataCoordinates position = nearby( path.at( random.bounded( path.size() ) ), 20000.0, random );
+        const int first = random.bounded( path.size() );
+        auto const distance = [&]( int j ) { return path.at( j ).sphericalDistanceTo( position ); };
+
+        int expected = first;
+        for ( int j = first + 1; j < path.size(); ++j ) {
+            if ( distance( j ) < distance( expected ) ) {
+                expected = j;
+            }
+        }
+
+        QCOMPARE( index.nearest( position, distance, first ), expected );
+        QCOMPARE( index.nearest( position, distance, first, random.bounded( path.size() ) ), expected );
+    }
+
+    // parts before the first one are never returned
+    auto const distance = [&]( int j ) { return path.at( j ).sphericalDistanceTo( path.at( 0 ) ); };
+    QCOMPARE( index.nearest( path.at( 0 ), distance ), 0 );
+    QCOMPARE( index.nearest( path.at( 0 ), distance, path.size() - 1 ), path.size() - 1 );
+    QCOMPARE( index.nearest( path.at( 0 ), distance, path.size() ), -1 );
+}
+
+void RouteIndexTest::outAndBack()
+{
+    // A route to a dead end and back on the same road, so that each point
+    // is exactly as near to a segment of the way out as of the way back
+    const GeoDataLineString way = createPath( 201, 10 * DEG2RAD, 50 * DEG2RAD, 1e-5 );
+    GeoDataLineString path = way;
+    for ( int i = way.size() - 2; i >= 0; --i ) {
+        path << way.at( i );
+    }
+    const int segmentSize = 10;
+    Route route = createRoute( path, segmentSize );
+    QCOMPARE( route.size(), 40 );
+
+    // Around the dead end the segments of both ways are the same, so the
+    // match only moves to the way back after leaving them
+    const int turn = way.size() - 1;
+    for ( int i = 0; i < path.size(); ++i ) {
+        route.setPosition( path.at( i ) );
+        const int index = &route.currentSegment() - &route.at( 0 );
+        if ( i < turn - segmentSize || i > turn + segmentSize ) {
+            QVERIFY2( qAbs( index - i / segmentSize ) <= 1,
+                      QString( "point %1 matched segment %2" ).arg( i ).arg( index ).toLatin1().data() );
+        }
+    }
+}
+
+void RouteIndexTest::emptyIndex()
+{
+    RouteIndex index;
+    QVERIFY( index.isEmpty() );
+    auto const distance = []( int ) { return 0.0; };
+    QCOMPARE( index.nearest( GeoDataCoordinates(), distance ), -1 );
+
+    Route route;
+    route.setPosition( GeoDataCoordinates( 0.1, 0.2 ) );
+    QVERIFY( !route.currentSegment().isValid() );
+}
+
+void RouteIndexTest::benchmarkUpdatePosition_data()
+{
+    QTest::addColumn<QString>( "track" );
+    QTest::addColumn<bool>( "indexed" );
+
+    const QString recorded = QStringLiteral( MARBLE_SRC_DIR "/examples/gpx/mjolby.gpx" );
+    QTest::newRow( "recorded log, linear scan" ) << recorded << false;
+    QTest::newRow( "recorded log, index" ) << recorded << true;
+    QTest::newRow( "2000 km route, linear scan" ) << QString() << false;
+    QTest::newRow( "2000 km route, index" ) << QString() << true;
+}
+
+void RouteIndexTest::benchmarkUpdatePosition()
+{
+    QFETCH( QString, track );
+    QFETCH( bool, indexed );
+
+    // The route follows the track, and the GPS fixes of the track are
+    // replayed on it. Without a recorded log it is a truck route with a
+    // point every 50 meters and fixes at 1 Hz at 80 km/h.
+    GeoDataLineString path;
+    QVector<GeoDataCoordinates> fixes;
+    if ( track.isEmpty() ) {
+        path = createPath( 40000, 10 * DEG2RAD, 50 * DEG2RAD, 50.0 / EARTH_RADIUS );
+        QRandomGenerator random( 7 );
+        for ( qreal i = 0; i < path.size() - 1; i += 22.0 / 50.0 ) {
+            fixes << nearby( path.at( int( i ) ), 15.0, random );
+        }
+    } else {
+        path = readGpx( track );
+        QVERIFY( path.size() > 1000 );
+        for ( int i = 0; i < path.size(); ++i ) {
+            fixes << path.at( i );
+        }
+    }
+    const Route route = createRoute( path, 20 );
+
+    if ( indexed ) {
+        QBENCHMARK {
+            Route replay = route;
+            for ( const GeoDataCoordinates &fix: fixes ) {
+                replay.setPosition( fix );
+                replay.currentSegment();
+            }
+        }
+    } else {
+        QBENCHMARK {
+            int current = -1;
+            for ( const GeoDataCoordinates &fix: fixes ) {
+                current = linearScan( route, fix, current );
+            }
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::RouteIndexTest )
+
+#include "RouteIndexTest.moc"
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoPainter.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "ScanlineKernels.h"
+#include "TestUtils.h"
+
+#include <QImage>
+#include <QThreadPool>
+#include <QVector>
+
+namespace Marble
+{
+
+class ScanlineTextureMapperTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void fetchNearest_data();
+    void fetchNearest();
+
+    void fetchBilinear_data();
+    void fetchBilinear();
+
+    void benchmarkMapTexture_data();
+    void benchmarkMapTexture();
+
+ private:
+    QImage m_tile;
+};
+
+void ScanlineTextureMapperTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    m_tile = QImage( 256, 256, QImage::Format_RGB32 );
+    for ( int y = 0; y < m_tile.height(); ++y ) {
+        for ( int x = 0; x < m_tile.width(); ++x ) {
+            m_tile.setPixel( x, y, qRgb( x, y, ( x * 7 + y * 13 ) % 256 ) );
+        }
+    }
+}
+
+void ScanlineTextureMapperTest::cleanup()
+{
+    ScanlineKernels::setKind( ScanlineKernels::bestKind() );
+}
+
+void ScanlineTextureMapperTest::fetchNearest_data()
+{
+    QTest::addColumn<int>( "kind" );
+    QTest::addColumn<int>( "count" );
+
+    for ( int count = 1; count < 48; count += 5 ) {
+        QTest::newRow( QString( "sse2, %1" ).arg( count ).toLatin1().data() ) << int( ScanlineKernels::Sse2 ) << count;
+        QTest::newRow( QString( "avx2, %1" ).arg( count ).toLatin1().data() ) << int( ScanlineKernels::Avx2 ) << count;
+    }
+}
+
+void ScanlineTextureMapperTest::fetchNearest()
+{
+    QFETCH( int, kind );
+    QFETCH( int, count );
+
+    const QRgb *const bits = reinterpret_cast<const QRgb *>( m_tile.constBits() );
+    const int wordsPerLine = m_tile.bytesPerLine() / 4;
+
+    // diagonal run through the tile in 25.7 fixed point
+    const int posX = 3 * 128 + 17;
+    const int posY = 250 * 128;
+    const int stepX = 200 * 128 / 48;
+    const int stepY = -240 * 128 / 48;
+
+    QVector<QRgb> expected( count );
+    ScanlineKernels::setKind( ScanlineKernels::Scalar );
+    ScanlineKernels::fetchNearest( bits, wordsPerLine, posX, posY, stepX, stepY, expected.data(), count );
+
+    QVector<QRgb> actual( count );
+    ScanlineKernels::setKind( ScanlineKernels::Kind( kind ) );
+    ScanlineKernels::fetchNearest( bits, wordsPerLine, posX, posY, stepX, stepY, actual.data(), count );
+
+    QCOMPARE( actual, expected );
+}
+
+void ScanlineTextureMapperTest::fetchBilinear_data()
+{
+    fetchNearest_data();
+}
+
+void ScanlineTextureMapperTest::fetchBilinear()
+{
+    QFETCH( int, kind );
+    QFETCH( int, count );
+
+    const QRgb *const bits = reinterpret_cast<const QRgb *>( m_tile.constBits() );
+    const int wordsPerLine = m_tile.bytesPerLine() / 4;
+
+    // diagonal run through the tile in 24.8 fixed point
+    const int posX = 3 * 256 + 17;
+    const int posY = 250 * 256;
+    const int stepX = 200 * 256 / 48;
+    const int stepY = -240 * 256 / 48;
+
+    QVector<QRgb> actual( count );
+    ScanlineKernels::setKind( ScanlineKernels::Kind( kind ) );
+    ScanlineKernels::fetchBilinear( bits, wordsPerLine, posX, posY, stepX, stepY, actual.data(), count );
+
+    // compare against the floating point interpolation of the red and green
+    // channels, which are linear gradients in x and y direction
+    for ( int j = 0; j < count; ++j ) {
+        const qreal x = ( posX + ( j + 1 ) * stepX ) / 256.0;
+        const qreal y = ( posY + ( j + 1 ) * stepY ) / 256.0;
+        QVERIFY( qAbs( qRed( actual[j] ) - x ) <= 1.0 );
+        QVERIFY( qAbs( qGreen( actual[j] ) - y ) <= 1.0 );
+        QCOMPARE( qAlpha( actual[j] ), 255 );
+    }
+}
+
+void ScanlineTextureMapperTest::benchmarkMapTexture_data()
+{
+    QTest::addColumn<int>( "projection" );
+    QTest::addColumn<int>( "quality" );
+    QTest::addColumn<int>( "kind" );
+
+    const QStringList projections = QStringList() << "spherical" << "equirect" << "mercator";
+    const QStringList qualities = QStringList() << "outline" << "low" << "normal" << "high" << "print";
+    const QStringList kinds = QStringList() << "scalar" << "sse2" << "avx2";
+
+    const Projection projectionValues[] = { Spherical, Equirectangular, Mercator };
+
+    for ( int projection = 0; projection < projections.size(); ++projection ) {
+        for ( int quality = OutlineQuality; quality <= PrintQuality; ++quality ) {
+            for ( int kind = ScanlineKernels::Scalar; kind <= ScanlineKernels::Avx2; ++kind ) {
+                const QString name = QString( "%1, %2, %3" ).arg( projections[projection], qualities[quality], kinds[kind] );
+                QTest::newRow( name.toLatin1().data() ) << int( projectionValues[projection] ) << quality << kind;
+            }
+        }
+    }
+}
+
+void ScanlineTextureMapperTest::benchmarkMapTexture()
+{
+    QFETCH( int, projection );
+    QFETCH( int, quality );
+    QFETCH( int, kind );
+
+    if ( kind > ScanlineKernels::bestKind() ) {
+        QSKIP( "Kernel is not supported by this CPU" );
+    }
+
+    ScanlineKernels::setKind( ScanlineKernels::Kind( kind ) );
+
+    MarbleMap map;
+    map.setMapThemeId( "earth/bluemarble/bluemarble.dgml" );
+    map.setSize( 1920, 1080 );
+    map.setProjection( Projection( projection ) );
+    map.setRadius( 2000 );
+    map.setShowClouds( false );
+    map.setMapQualityForViewContext( MapQuality( quality ), Still );
+    map.setViewContext( Still );
+
+    QImage paintDevice( map.size(), QImage::Format_ARGB32_Premultiplied );
+    GeoPainter painter( &paintDevice, map.viewport(), map.mapQuality() );
+
+    // load the tiles before measuring
+    map.paint( painter, QRect() );
+
+    QBENCHMARK {
+        // moving the center forces the texture to be mapped again
+        map.rotateBy( 0.1, 0.0 );
+        map.paint( painter, QRect() );
+    }
+
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+}
+
+QTEST_MAIN( Marble::ScanlineTextureMapperTest )
+
+#include "ScanlineTextureMapperTest.moc"
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
+#include "ScreenPolygonCache.h"
+#include "ViewportParams.h"
+
+#include <QPolygonF>
+#include <QTest>
+#include <QtMath>
+
+Q_DECLARE_METATYPE( Marble::Projection )
+
+namespace Marble
+{
+
+class ScreenPolygonCacheTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void translate_data();
+    void translate();
+    void recreate();
+    void invisible();
+
+    void benchmarkPan_data();
+    void benchmarkPan();
+
+ private:
+    static GeoDataLineString createLineString( int size );
+    static bool fuzzyCompare( const QVector<QPolygonF *> &polygons, const GeoDataLineString &lineString,
+                              const ViewportParams &viewport );
+};
+
+GeoDataLineString ScreenPolygonCacheTest::createLineString( int size )
+{
+    // A river meandering eastwards through the views of the tests, from France to Poland
+    GeoDataLineString lineString( Tessellate );
+    for ( int i = 0; i < size; ++i ) {
+        const qreal t = qreal( i ) / size;
+        const qreal lon = 2.0 + 20.0 * t;
+        const qreal lat = 49.0 + 2.0 * t + 1.5 * qSin( 12 * M_PI * t );
+        lineString << GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+    }
+    return lineString;
+}
+
+bool ScreenPolygonCacheTest::fuzzyCompare( const QVector<QPolygonF *> &polygons, const GeoDataLineString &lineString,
+                                           const ViewportParams &viewport )
+{
+    QVector<QPolygonF *> expected;
+    viewport.screenCoordinates( lineString, expected );
+
+    bool equal = polygons.size() == expected.size();
+    for ( int i = 0; equal && i < polygons.size(); ++i ) {
+        equal = polygons[i]->size() == expected[i]->size();
+        for ( int j = 0; equal && j < polygons[i]->size(); ++j ) {
+            const QPointF difference = polygons[i]->at( j ) - expected[i]->at( j );
+            equal = qAbs( difference.x() ) < 1e-6 && qAbs( difference.y() ) < 1e-6;
+        }
+    }
+
+    qDeleteAll( expected );
+    return equal;
+}
+
+void ScreenPolygonCacheTest::translate_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+
+    QTest::newRow( "equirectangular" ) << Equirectangular;
+    QTest::newRow( "mercator" ) << Mercator;
+}
+
+void ScreenPolygonCacheTest::translate()
+{
+    QFETCH( Projection, projection );
+
+    const GeoDataLineString lineString = createLineString( 1000 );
+    ViewportParams viewport( projection, 10 * DEG2RAD, 50 * DEG2RAD, 2000, QSize( 800, 600 ) );
+
+    ScreenPolygonCache cache;
+    QVERIFY( !cache.update( lineString, &viewport, 8 ).isEmpty() );
+    QVERIFY( !cache.isTranslated() );
+    QVERIFY( fuzzyCompare( cache.polygons(), lineString, viewport ) );
+
+    viewport.centerOn( 12 * DEG2RAD, 52 * DEG2RAD );
+    QVERIFY( !cache.update( lineString, &viewport, 8 ).isEmpty() );
+    QVERIFY( cache.isTranslated() );
+    QVERIFY( fuzzyCompare( cache.polygons(), lineString, viewport ) );
+
+    viewport.centerOn( 0 * DEG2RAD, 45 * DEG2RAD );
+    QVERIFY( !cache.update( lineString, &viewport, 8 ).isEmpty() );
+    QVERIFY( cache.isTranslated() );
+    QVERIFY( fuzzyCompare( cache.polygons(), lineString, viewport ) );
+}
+
+void ScreenPolygonCacheTest::recreate()
+{
+    const GeoDataLineString lineString = createLineString( 100 );
+    ViewportParams viewport( Mercator, 10 * DEG2RAD, 50 * DEG2RAD, 2000, QSize( 800, 600 ) );
+
+    ScreenPolygonCache cache;
+    cache.update( lineString, &viewport, 8 );
+
+    // a new tile level starts a new epoch
+    cache.update( lineString, &viewport, 9 );
+    QVERIFY( !cache.isTranslated() );
+
+    // zooming is no translation
+    viewport.setRadius( 2500 );
+    cache.update( lineString, &viewport, 9 );
+    QVERIFY( !cache.isTranslated() );
+    QVERIFY( fuzzyCompare( cache.polygons(), lineString, viewport ) );
+
+    // neither is panning a globe
+    viewport.setProjection( Spherical );
+    cache.update( lineString, &viewport, 9 );
+    viewport.centerOn( 12 * DEG2RAD, 52 * DEG2RAD );
+    cache.update( lineString, &viewport, 9 );
+    QVERIFY( !cache.isTranslated() );
+    QVERIFY( fuzzyCompare( cache.polygons(), lineString, viewport ) );
+
+    // nor panning a map that repeats horizontally
+    viewport.setProjection( Equirectangular );
+    viewport.setRadius( 100 );
+    cache.update( lineString, &viewport, 9 );
+    viewport.centerOn( 20 * DEG2RAD, 52 * DEG2RAD );
+    cache.update( lineString, &viewport, 9 );
+    QVERIFY( !cache.isTranslated() );
+    QVERIFY( fuzzyCompare( cache.polygons(), lineString, viewport ) );
+
+    cache.clear();
+    QVERIFY( cache.polygons().isEmpty() );
+}
+
+void ScreenPolygonCacheTest::invisible()
+{
+    const GeoDataLineString lineString = createLineString( 100 );
+    ViewportParams viewport( Mercator, 10 * DEG2RAD, 50 * DEG2RAD, 2000, QSize( 800, 600 ) );
+
+    ScreenPolygonCache cache;
+    QVERIFY( !cache.update( lineString, &viewport, 8 ).isEmpty() );
+
+    viewport.centerOn( -100 * DEG2RAD, 40 * DEG2RAD );
+    QVERIFY( cache.update( lineString, &viewport, 8 ).isEmpty() );
+    QVERIFY( cache.polygons().isEmpty() );
+
+    // the polygons are released while the line string is not visible
+    viewport.centerOn( 5 * DEG2RAD, 48 * DEG2RAD );
+    QVERIFY( !cache.update( lineString, &viewport, 8 ).isEmpty() );
+    QVERIFY( !cache.isTranslated() );
+    QVERIFY( fuzzyCompare( cache.polygons(), lineString, viewport ) );
+}
+
+void ScreenPolygonCacheTest::benchmarkPan_data()
+{
+    translate_data();
+    QTest::newRow( "spherical" ) << Spherical;
+}
+
+void ScreenPolygonCacheTest::benchmarkPan()
+{
+    QFETCH( Projection, projection );
+
+    // Roughly a long river at street level zoom
+    const GeoDataLineString lineString = createLineString( 100000 );
+    ViewportParams viewport( projection, 10 * DEG2RAD, 50 * DEG2RAD, 20000, QSize( 1920, 1080 ) );
+
+    ScreenPolygonCache cache;
+    cache.update( lineString, &viewport, 14 );
+
+    int step = 0;
+    QBENCHMARK {
+        viewport.centerOn( ( 10 + 0.01 * ( step % 100 ) ) * DEG2RAD, 50 * DEG2RAD );
+        cache.update( lineString, &viewport, 14 );
+        ++step;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ScreenPolygonCacheTest )
+
+#include "ScreenPolygonCacheTest.moc"
@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "MarbleClock.h"
+#include "MarbleGlobal.h"
+#include "Planet.h"
+#include "PlanetFactory.h"
+#include "SunLocator.h"
+#include "SunShading.h"
+#include "TileId.h"
+#include "TileLoaderHelper.h"
+
+#include <QDateTime>
+#include <QImage>
+#include <QTest>
+
+#include <cmath>
+
+namespace Marble
+{
+
+class SunShadingTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    SunShadingTest();
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void shadeTile_data();
+    void shadeTile();
+
+    void benchmarkShadeTile_data();
+    void benchmarkShadeTile();
+
+ private:
+    /**
+     * The shading of the tile calculated per pixel, like before the kernels.
+     */
+    void shadeTileReference( QImage *tileImage, const QImage *nightImage, const TileId &id ) const;
+
+    static const int levelZeroColumns = 2;
+    static const int levelZeroRows = 1;
+
+    MarbleClock m_clock;
+    Planet m_planet;
+    SunLocator m_sunLocator;
+    QImage m_dayImage;
+    QImage m_nightImage;
+};
+
+SunShadingTest::SunShadingTest() :
+    m_clock(),
+    m_planet( PlanetFactory::construct( QStringLiteral( "earth" ) ) ),
+    m_sunLocator( &m_clock, &m_planet )
+{
+}
+
+void SunShadingTest::initTestCase()
+{
+    // the sun above the northern hemisphere, so that the terminator is curved
+    m_clock.setDateTime( QDateTime( QDate( 2020, 6, 1 ), QTime( 10, 30 ), Qt::UTC ) );
+    m_sunLocator.update();
+
+    m_dayImage = QImage( 256, 256, QImage::Format_ARGB32_Premultiplied );
+    m_nightImage = QImage( 256, 256, QImage::Format_RGB32 );
+    for ( int y = 0; y < m_dayImage.height(); ++y ) {
+        for ( int x = 0; x < m_dayImage.width(); ++x ) {
+            m_dayImage.setPixel( x, y, qRgb( x, y, ( x * 7 + y * 13 ) % 256 ) );
+            m_nightImage.setPixel( x, y, qRgb( ( x * 3 ) % 64, ( y * 5 ) % 64, 255 - y ) );
+        }
+    }
+}
+
+void SunShadingTest::cleanup()
+{
+    SunShading::setKind( SunShading::bestKind() );
+}
+
+void SunShadingTest::shadeTileReference( QImage *tileImage, const QImage *nightImage, const TileId &id ) const
+{
+    const int tileHeight = tileImage->height();
+    const int tileWidth = tileImage->width();
+    const qreal lonScale = 2 * M_PI / ( tileWidth * TileLoaderHelper::levelToColumn( levelZeroColumns, id.zoomLevel() ) );
+    const qreal latScale = -M_PI / ( tileHeight * TileLoaderHelper::levelToRow( levelZeroRows, id.zoomLevel() ) );
+    const qreal sunLat = DEG2RAD * m_sunLocator.getLat();
+
+    for ( int y = 0; y < tileHeight; ++y ) {
+        const qreal lat = latScale * ( id.y() * tileHeight + y ) - 0.5 * M_PI;
+        const qreal a = sin( ( lat + sunLat ) / 2.0 );
+        const qreal c = cos( lat ) * cos( -sunLat );
+
+        QRgb *scanLine = reinterpret_cast<QRgb *>( tileImage->scanLine( y ) );
+        for ( int x = 0; x < tileWidth; ++x, ++scanLine ) {
+            const qreal shade = m_sunLocator.shading( lonScale * ( id.x() * tileWidth + x ), a, c );
+            if ( nightImage ) {
+                SunLocator::shadePixelComposite( *scanLine, nightImage->pixel( x, y ), shade );
+            } else {
+                SunLocator::shadePixel( *scanLine, shade );
+            }
+        }
+    }
+}
+
+void SunShadingTest::shadeTile_data()
+{
+    QTest::addColumn<int>( "kind" );
+    QTest::addColumn<bool>( "cityLights" );
+    QTest::addColumn<int>( "level" );
+    QTest::addColumn<int>( "x" );
+    QTest::addColumn<int>( "y" );
+
+    const TileId ids[] = { TileId( 0, 0, 0, 0 ), TileId( 0, 0, 1, 0 ), TileId( 0, 3, 5, 2 ), TileId( 0, 5, 40, 9 ) };
+    for ( const TileId &id: ids ) {
+        const QString name = QString( "%1/%2/%3" ).arg( id.zoomLevel() ).arg( id.x() ).arg( id.y() );
+        QTest::newRow( QString( "scalar, plain, %1" ).arg( name ).toLatin1().data() ) << int( SunShading::Scalar ) << false << id.zoomLevel() << id.x() << id.y();
+        QTest::newRow( QString( "scalar, city lights, %1" ).arg( name ).toLatin1().data() ) << int( SunShading::Scalar ) << true << id.zoomLevel() << id.x() << id.y();
+        QTest::newRow( QString( "sse2, plain, %1" ).arg( name ).toLatin1().data() ) << int( SunShading::Sse2 ) << false << id.zoomLevel() << id.x() << id.y();
+        QTest::newRow( QString( "sse2, city lights, %1" ).arg( name ).toLatin1().data() ) << int( SunShading::Sse2 ) << true << id.zoomLevel() << id.x() << id.y();
+    }
+}
+
+void SunShadingTest::shadeTile()
+{
+    QFETCH( int, kind );
+    QFETCH( bool, cityLights );
+    QFETCH( int, level );
+    QFETCH( int, x );
+    QFETCH( int, y );
+
+    const TileId id( 0, level, x, y );
+
+    SunShading::setKind( SunShading::Kind( kind ) );
+    if ( SunShading::kind() != kind ) {
+        QSKIP( "kernel not supported by this CPU" );
+    }
+
+    const QImage *const nightImage = cityLights ? &m_nightImage : nullptr;
+
+    QImage expected = m_dayImage.copy();
+    shadeTileReference( &expected, nightImage, id );
+
+    QImage result = m_dayImage.copy();
+    SunShading::shadeTile( &result, nightImage, id, &m_sunLocator, levelZeroColumns, levelZeroRows );
+
+    // the kernels calculate the brightness in single precision
+    for ( int row = 0; row < result.height(); ++row ) {
+        for ( int column = 0; column < result.width(); ++column ) {
+            const QRgb actualPixel = result.pixel( column, row );
+            const QRgb expectedPixel = expected.pixel( column, row );
+            if ( qAbs( qRed( actualPixel ) - qRed( expectedPixel ) ) > 1
+                 || qAbs( qGreen( actualPixel ) - qGreen( expectedPixel ) ) > 1
+                 || qAbs( qBlue( actualPixel ) - qBlue( expectedPixel ) ) > 1 ) {
+                QFAIL( QString( "pixel %1, %2 is %3 instead of %4" )
+                       .arg( column ).arg( row )
+                       .arg( actualPixel, 8, 16, QLatin1Char( '0' ) )
+                       .arg( expectedPixel, 8, 16, QLatin1Char( '0' ) ).toLatin1().data() );
+            }
+        }
+    }
+}
+
+void SunShadingTest::benchmarkShadeTile_data()
+{
+    QTest::addColumn<int>( "kind" );
+    QTest::addColumn<bool>( "cityLights" );
+    QTest::addColumn<bool>( "perPixel" );
+
+    QTest::newRow( "per pixel, plain" ) << int( SunShading::Scalar ) << false << true;
+    QTest::newRow( "per pixel, city lights" ) << int( SunShading::Scalar ) << true << true;
+    QTest::newRow( "scalar, plain" ) << int( SunShading::Scalar ) << false << false;
+    QTest::newRow( "scalar, city lights" ) << int( SunShading::Scalar ) << true << false;
+    QTest::newRow( "sse2, plain" ) << int( SunShading::Sse2 ) << false << false;
+    QTest::newRow( "sse2, city lights" ) << int( SunShading::Sse2 ) << true << false;
+}
+
+void SunShadingTest::benchmarkShadeTile()
+{
+    QFETCH( int, kind );
+    QFETCH( bool, cityLights );
+    QFETCH( bool, perPixel );
+
+    SunShading::setKind( SunShading::Kind( kind ) );
+    if ( SunShading::kind() != kind ) {
+        QSKIP( "kernel not supported by this CPU" );
+    }
+
+    const QImage *const nightImage = cityLights ? &m_nightImage : nullptr;
+    const TileId id( 0, 0, 0, 0 );
+    QImage tileImage = m_dayImage.copy();
+
+    // one tile per iteration, the inverse is the number of tiles per second
+    QBENCHMARK {
+        if ( perPixel ) {
+            shadeTileReference( &tileImage, nightImage, id );
+        } else {
+            SunShading::shadeTile( &tileImage, nightImage, id, &m_sunLocator, levelZeroColumns, levelZeroRows );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::SunShadingTest )
+
+#include "SunShadingTest.moc"
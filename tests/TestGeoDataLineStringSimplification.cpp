@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "AbstractProjection.h"
+#include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
+#include "ViewportParams.h"
+
+#include <QPolygonF>
+#include <QRandomGenerator>
+#include <QTest>
+#include <qmath.h>
+
+namespace Marble
+{
+
+class TestGeoDataLineStringSimplification : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void spike_data();
+    void spike();
+    void straightLine();
+    void tolerance_data();
+    void tolerance();
+    void invalidation();
+    void projection();
+
+    void benchmarkSimplification();
+    void benchmarkProjection_data();
+    void benchmarkProjection();
+
+ private:
+    static GeoDataLineString createTrack( int size );
+    static qreal distance( const GeoDataLineString &lineString, int node, int first, int last );
+};
+
+GeoDataLineString TestGeoDataLineStringSimplification::createTrack( int size )
+{
+    // A GPS track: a random walk around Europe with a fix every few meters
+    QRandomGenerator random( 42 );
+    GeoDataLineString lineString;
+    lineString.reserve( size );
+    qreal lon = 10.0 * DEG2RAD;
+    qreal lat = 50.0 * DEG2RAD;
+    qreal heading = 0.0;
+    for ( int i = 0; i < size; ++i ) {
+        heading += ( random.generateDouble() - 0.5 ) * 0.3;
+        lon += 1e-6 * qCos( heading ) / qCos( lat );
+        lat += 1e-6 * qSin( heading );
+        lineString << GeoDataCoordinates( lon, lat );
+    }
+    return lineString;
+}
+
+qreal TestGeoDataLineStringSimplification::distance( const GeoDataLineString &lineString, int node, int first, int last )
+{
+    // The distance from the node to the segment between first and last in
+    // the planar approximation used by the simplification
+    const auto x = [&lineString]( int i ) { return lineString.longitudeAt( i ) * qCos( lineString.latitudeAt( i ) ); };
+    const qreal ax = x( first );
+    const qreal ay = lineString.latitudeAt( first );
+    const qreal dx = x( last ) - ax;
+    const qreal dy = lineString.latitudeAt( last ) - ay;
+    qreal px = x( node ) - ax;
+    qreal py = lineString.latitudeAt( node ) - ay;
+    const qreal length2 = dx * dx + dy * dy;
+    if ( length2 > 0 ) {
+        const qreal t = qBound( 0.0, ( px * dx + py * dy ) / length2, 1.0 );
+        px -= t * dx;
+        py -= t * dy;
+    }
+    return qSqrt( px * px + py * py );
+}
+
+void TestGeoDataLineStringSimplification::spike_data()
+{
+    QTest::addColumn<qreal>( "height" );
+    QTest::addColumn<int>( "level" );
+
+    // see GeoDataLineStringPrivate::levelForResolution()
+    QTest::newRow( "1 degree" ) << 1.0 << 1;
+    QTest::newRow( "0.1 degree" ) << 0.1 << 5;
+    QTest::newRow( "0.001 degree" ) << 0.001 << 11;
+    QTest::newRow( "flat" ) << 0.0 << 17;
+}
+
+void TestGeoDataLineStringSimplification::spike()
+{
+    QFETCH( qreal, height );
+    QFETCH( int, level );
+
+    // along the equator, where the planar approximation is exact
+    GeoDataLineString lineString;
+    for ( int i = 0; i < 1001; ++i ) {
+        lineString << GeoDataCoordinates( 0.01 * i, i == 500 ? height : 0.0, 0.0, GeoDataCoordinates::Degree );
+    }
+
+    QVERIFY( lineString.usesSignificance() );
+    QCOMPARE( lineString.significanceAt( 0 ), 1 );
+    QCOMPARE( lineString.significanceAt( 1000 ), 1 );
+    QCOMPARE( lineString.significanceAt( 500 ), level );
+}
+
+void TestGeoDataLineStringSimplification::straightLine()
+{
+    GeoDataLineString lineString;
+    for ( int i = 0; i < 1000; ++i ) {
+        lineString << GeoDataCoordinates( 0.001 * i, 0.0, 0.0, GeoDataCoordinates::Degree );
+    }
+
+    // only the end nodes are needed
+    QCOMPARE( lineString.significanceAt( 0 ), 1 );
+    QCOMPARE( lineString.significanceAt( 999 ), 1 );
+    for ( int i = 1; i < 999; ++i ) {
+        QCOMPARE( lineString.significanceAt( i ), 17 );
+    }
+
+    // short line strings and ones with detail levels are filtered as before
+    QVERIFY( !lineString.mid( 0, 100 ).usesSignificance() );
+    QVERIFY( !lineString.optimized().usesSignificance() );
+}
+
+void TestGeoDataLineStringSimplification::tolerance_data()
+{
+    QTest::addColumn<int>( "level" );
+
+    for ( int level = 1; level < 17; level += 3 ) {
+        QTest::addRow( "level %d", level ) << level;
+    }
+}
+
+void TestGeoDataLineStringSimplification::tolerance()
+{
+    QFETCH( int, level );
+
+    const GeoDataLineString lineString = createTrack( 20000 );
+
+    // Each filtered node is closer to the line between the nodes left and
+    // right of it than the resolution of the next level
+    const qreal tolerance[] = { 0.0655360, 0.0327680, 0.0163840, 0.0081920, 0.0040960, 0.0020480,
+                                0.0010240, 0.0005120, 0.0002560, 0.0001280, 0.0000640, 0.0000320,
+                                0.0000160, 0.0000080, 0.0000040, 0.0000020, 0.0000010, 0.0000005 };
+    int previous = 0;
+    int filtered = 0;
+    for ( int i = 1; i < lineString.size(); ++i ) {
+        if ( lineString.significanceAt( i ) > level ) {
+            continue;
+        }
+        for ( int j = previous + 1; j < i; ++j ) {
+            QVERIFY( distance( lineString, j, previous, i ) < tolerance[level + 1] );
+            ++filtered;
+        }
+        previous = i;
+    }
+    QCOMPARE( previous, lineString.size() - 1 );
+    QVERIFY( filtered > 0 );
+}
+
+void TestGeoDataLineStringSimplification::invalidation()
+{
+    GeoDataLineString lineString;
+    for ( int i = 0; i < 1000; ++i ) {
+        lineString << GeoDataCoordinates( 0.001 * i, 0.0, 0.0, GeoDataCoordinates::Degree );
+    }
+    QCOMPARE( lineString.significanceAt( 500 ), 17 );
+
+    // moving a node changes its significance
+    lineString[500].setLatitude( 1.0, GeoDataCoordinates::Degree );
+    QCOMPARE( lineString.significanceAt( 500 ), 1 );
+
+    // so does appending nodes
+    lineString << GeoDataCoordinates( 1.0, 0.0, 0.0, GeoDataCoordinates::Degree );
+    QVERIFY( lineString.significanceAt( 999 ) > 1 );
+    QCOMPARE( lineString.significanceAt( 1000 ), 1 );
+
+    // copies keep it
+    const GeoDataLineString copy = lineString;
+    QCOMPARE( copy.significanceAt( 500 ), 1 );
+}
+
+void TestGeoDataLineStringSimplification::projection()
+{
+    const GeoDataLineString lineString = createTrack( 100000 );
+    const GeoDataCoordinates center = lineString.at( lineString.size() / 2 );
+
+    // zoomed out the track gets a fraction of its nodes
+    const ViewportParams overview( Equirectangular, center.longitude(), center.latitude(), 20000, QSize( 800, 600 ) );
+    QVector<QPolygonF *> polygons;
+    overview.currentProjection()->screenCoordinates( lineString, &overview, polygons );
+    int points = 0;
+    for ( const QPolygonF *polygon: polygons ) {
+        points += polygon->size();
+    }
+    QVERIFY( points > 1 );
+    QVERIFY( points < lineString.size() / 10 );
+    qDeleteAll( polygons );
+
+    // at street level the nodes get drawn
+    const ViewportParams street( Equirectangular, center.longitude(), center.latitude(), 20000000, QSize( 800, 600 ) );
+    polygons.clear();
+    street.currentProjection()->screenCoordinates( lineString, &street, polygons );
+    points = 0;
+    for ( const QPolygonF *polygon: polygons ) {
+        points += polygon->size();
+    }
+    QVERIFY( points > lineString.size() / 10 );
+    qDeleteAll( polygons );
+}
+
+void TestGeoDataLineStringSimplification::benchmarkSimplification()
+{
+    // a long day of GPS logging
+    const GeoDataLineString lineString = createTrack( 2000000 );
+
+    QBENCHMARK_ONCE {
+        lineString.updateSignificance();
+    }
+}
+
+void TestGeoDataLineStringSimplification::benchmarkProjection_data()
+{
+    QTest::addColumn<bool>( "simplified" );
+
+    QTest::newRow( "node distance" ) << false;
+    QTest::newRow( "significance" ) << true;
+}
+
+void TestGeoDataLineStringSimplification::benchmarkProjection()
+{
+    QFETCH( bool, simplified );
+
+    // Below the size for significance the nodes are filtered by their distance
+    const GeoDataLineString track = createTrack( 2000000 );
+    QVector<GeoDataLineString> lineStrings;
+    if ( simplified ) {
+        lineStrings << track;
+    } else {
+        for ( int i = 0; i < track.size(); i += 998 ) {
+            lineStrings << track.mid( i, 999 );
+        }
+    }
+    for ( const GeoDataLineString &lineString: lineStrings ) {
+        QCOMPARE( lineString.usesSignificance(), simplified );
+        lineString.updateSignificance();
+    }
+
+    // the whole track on the screen
+    const GeoDataCoordinates center = track.at( track.size() / 2 );
+    const ViewportParams viewport( Spherical, center.longitude(), center.latitude(), 20000, QSize( 1920, 1080 ) );
+    QBENCHMARK {
+        for ( const GeoDataLineString &lineString: lineStrings ) {
+            QVector<QPolygonF *> polygons;
+            viewport.currentProjection()->screenCoordinates( lineString, &viewport, polygons );
+            qDeleteAll( polygons );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::TestGeoDataLineStringSimplification )
+
+#include "TestGeoDataLineStringSimplification.moc"
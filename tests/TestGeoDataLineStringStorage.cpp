@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// SPDX-FileCopyrightText: 2026 Marble Developers
+//
+
+#include "AbstractProjection.h"
+#include "GeoDataCoordinates.h"
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataLinearRing.h"
+#include "GeoDataLineString.h"
+#include "ViewportParams.h"
+
+#include <QPolygonF>
+#include <QTest>
+#include <QThread>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+Q_DECLARE_METATYPE( Marble::GeoDataLineString::Storage )
+Q_DECLARE_METATYPE( Marble::Projection )
+
+namespace Marble
+{
+
+class TestGeoDataLineStringStorage : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void accessors_data();
+    void accessors();
+    void detach();
+    void concurrentReaders();
+    void projection_data();
+    void projection();
+
+    void benchmarkProjection_data();
+    void benchmarkProjection();
+    void benchmarkMemory_data();
+    void benchmarkMemory();
+
+ private:
+    static GeoDataLineString createLineString( int size, bool altitude );
+    static void addNodes( GeoDataLineString &lineString, int size, bool altitude );
+    static void addStorageRows();
+    static qint64 allocatedBytes();
+};
+
+void TestGeoDataLineStringStorage::addNodes( GeoDataLineString &lineString, int size, bool altitude )
+{
+    // A zigzag across Europe
+    lineString.reserve( size );
+    for ( int i = 0; i < size; ++i ) {
+        const qreal lon = -10.0 + 40.0 * i / size;
+        const qreal lat = 45.0 + ( i % 2 ? 0.5 : -0.5 ) + 10.0 * i / size;
+        lineString << GeoDataCoordinates( lon, lat, altitude ? i : 0.0, GeoDataCoordinates::Degree );
+    }
+}
+
+GeoDataLineString TestGeoDataLineStringStorage::createLineString( int size, bool altitude )
+{
+    GeoDataLineString lineString( Tessellate );
+    addNodes( lineString, size, altitude );
+    return lineString;
+}
+
+void TestGeoDataLineStringStorage::addStorageRows()
+{
+    QTest::addColumn<GeoDataLineString::Storage>( "storage" );
+
+    QTest::newRow( "coordinates" ) << GeoDataLineString::CoordinatesStorage;
+    QTest::newRow( "packed" ) << GeoDataLineString::PackedStorage;
+    QTest::newRow( "fixed point" ) << GeoDataLineString::FixedPointStorage;
+}
+
+qint64 TestGeoDataLineStringStorage::allocatedBytes()
+{
+#ifdef __GLIBC__
+    // the heap in use, unlike the resident set it drops when freeing small blocks
+    const struct mallinfo info = mallinfo();
+    return qint64( uint( info.uordblks ) ) + qint64( uint( info.hblkhd ) );
+#else
+    return -1;
+#endif
+}
+
+void TestGeoDataLineStringStorage::accessors_data()
+{
+    addStorageRows();
+}
+
+void TestGeoDataLineStringStorage::accessors()
+{
+    QFETCH( GeoDataLineString::Storage, storage );
+
+    // shallow copies share the storage, so create the nodes twice
+    const GeoDataLineString reference = createLineString( 100, true ).optimized();
+    GeoDataLineString lineString = createLineString( 100, true ).optimized();
+    lineString.setStorage( storage );
+    QCOMPARE( lineString.storage(), storage );
+    QCOMPARE( lineString.size(), reference.size() );
+
+    // 1e-7 degree in radian
+    const qreal precision = storage == GeoDataLineString::FixedPointStorage ? 2e-9 : 0.0;
+
+    GeoDataCoordinates coordinates;
+    for ( int i = 0; i < lineString.size(); ++i ) {
+        QVERIFY( qAbs( lineString.longitudeAt( i ) - reference.at( i ).longitude() ) <= precision );
+        QVERIFY( qAbs( lineString.latitudeAt( i ) - reference.at( i ).latitude() ) <= precision );
+        QCOMPARE( lineString.altitudeAt( i ), reference.at( i ).altitude() );
+        QCOMPARE( lineString.detailAt( i ), int( reference.at( i ).detail() ) );
+
+        lineString.readCoordinates( i, coordinates );
+        QVERIFY( qAbs( coordinates.longitude() - reference.at( i ).longitude() ) <= precision );
+        QCOMPARE( int( coordinates.detail() ), int( reference.at( i ).detail() ) );
+    }
+
+    const GeoDataLatLonAltBox box = lineString.latLonAltBox();
+    QVERIFY( qAbs( box.north() - reference.latLonAltBox().north() ) <= precision );
+    QVERIFY( qAbs( box.west() - reference.latLonAltBox().west() ) <= precision );
+    QCOMPARE( box.maxAltitude(), reference.latLonAltBox().maxAltitude() );
+    QCOMPARE( lineString.storage(), storage );
+
+    // const references leave the storage unchanged
+    const GeoDataLineString &constLineString = lineString;
+    QVERIFY( qAbs( constLineString.first().latitude() - reference.first().latitude() ) <= precision );
+    QCOMPARE( lineString.storage(), storage );
+
+    // handing out modifiable references unpacks the nodes
+    QVERIFY( qAbs( lineString.last().latitude() - reference.last().latitude() ) <= precision );
+    QCOMPARE( lineString.storage(), GeoDataLineString::CoordinatesStorage );
+    QCOMPARE( lineString.size(), reference.size() );
+    QCOMPARE( lineString.at( 1 ).detail(), reference.at( 1 ).detail() );
+}
+
+void TestGeoDataLineStringStorage::detach()
+{
+    GeoDataLineString lineString = createLineString( 10, false );
+    lineString.setStorage( GeoDataLineString::PackedStorage );
+
+    GeoDataLineString copy = lineString;
+    copy.append( GeoDataCoordinates( 1.0, 1.0 ) );
+
+    QCOMPARE( copy.size(), 11 );
+    QCOMPARE( copy.storage(), GeoDataLineString::CoordinatesStorage );
+    QCOMPARE( lineString.size(), 10 );
+    QCOMPARE( lineString.storage(), GeoDataLineString::PackedStorage );
+    QCOMPARE( copy.mid( 0, 10 ), createLineString( 10, false ) );
+
+    // changing the storage of a shared copy detaches it
+    GeoDataLineString unpacked = lineString;
+    unpacked.setStorage( GeoDataLineString::CoordinatesStorage );
+    QCOMPARE( unpacked.storage(), GeoDataLineString::CoordinatesStorage );
+    QCOMPARE( lineString.storage(), GeoDataLineString::PackedStorage );
+}
+
+void TestGeoDataLineStringStorage::concurrentReaders()
+{
+    GeoDataLineString lineString = createLineString( 5000, false );
+    qreal expected = 0.0;
+    for ( const GeoDataCoordinates &coordinates: lineString ) {
+        expected += coordinates.longitude();
+    }
+    lineString.setStorage( GeoDataLineString::PackedStorage );
+
+    // like the render and the parsing threads, which share a packed line string
+    const GeoDataLineString shared = lineString;
+    QVector<qreal> sums( 4, 0.0 );
+    QVector<int> significance( 4, 0 );
+    QVector<QThread *> threads;
+    for ( int i = 0; i < sums.size(); ++i ) {
+        threads << QThread::create( [&shared, &sums, &significance, i]() {
+            for ( const GeoDataCoordinates &coordinates: shared ) {
+                sums[i] += coordinates.longitude();
+            }
+            significance[i] = shared.significanceAt( shared.size() / 2 );
+        } );
+    }
+    for ( QThread *thread: threads ) {
+        thread->start();
+    }
+    for ( QThread *thread: threads ) {
+        QVERIFY( thread->wait( 10000 ) );
+    }
+    qDeleteAll( threads );
+
+    for ( int i = 0; i < sums.size(); ++i ) {
+        QCOMPARE( sums[i], expected );
+        QCOMPARE( significance[i], significance[0] );
+    }
+    QCOMPARE( lineString.storage(), GeoDataLineString::PackedStorage );
+}
+
+void TestGeoDataLineStringStorage::projection_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+    QTest::addColumn<bool>( "closed" );
+
+    QTest::newRow( "spherical" ) << Spherical << false;
+    QTest::newRow( "spherical ring" ) << Spherical << true;
+    QTest::newRow( "mercator" ) << Mercator << false;
+    QTest::newRow( "mercator ring" ) << Mercator << true;
+}
+
+void TestGeoDataLineStringStorage::projection()
+{
+    QFETCH( Projection, projection );
+    QFETCH( bool, closed );
+
+    const ViewportParams viewport( projection, 10 * DEG2RAD, 50 * DEG2RAD, 2000, QSize( 800, 600 ) );
+    GeoDataLineString line( Tessellate );
+    GeoDataLinearRing ring( Tessellate );
+    GeoDataLineString &reference = closed ? ring : line;
+    addNodes( reference, 1000, false );
+
+    // a shallow copy of the reference would share the storage
+    GeoDataLineString packedLine( Tessellate );
+    GeoDataLinearRing packedRing( Tessellate );
+    GeoDataLineString &lineString = closed ? packedRing : packedLine;
+    addNodes( lineString, 1000, false );
+    lineString.setStorage( GeoDataLineString::PackedStorage );
+
+    QVector<QPolygonF *> referencePolygons;
+    QVector<QPolygonF *> polygons;
+    viewport.currentProjection()->screenCoordinates( reference, &viewport, referencePolygons );
+    viewport.currentProjection()->screenCoordinates( lineString, &viewport, polygons );
+
+    QCOMPARE( lineString.storage(), GeoDataLineString::PackedStorage );
+    QCOMPARE( polygons.size(), referencePolygons.size() );
+    for ( int i = 0; i < polygons.size(); ++i ) {
+        QCOMPARE( *polygons[i], *referencePolygons[i] );
+    }
+
+    qDeleteAll( referencePolygons );
+    qDeleteAll( polygons );
+}
+
+void TestGeoDataLineStringStorage::benchmarkProjection_data()
+{
+    addStorageRows();
+}
+
+void TestGeoDataLineStringStorage::benchmarkProjection()
+{
+    QFETCH( GeoDataLineString::Storage, storage );
+
+    // Roughly the node count of the coast lines of a country sized OSM extract
+    const int size = 1000000;
+    GeoDataLineString lineString = createLineString( size, false );
+    lineString.setStorage( storage );
+
+    const ViewportParams viewport( Spherical, 10 * DEG2RAD, 50 * DEG2RAD, 20000, QSize( 1920, 1080 ) );
+    QBENCHMARK {
+        QVector<QPolygonF *> polygons;
+        viewport.currentProjection()->screenCoordinates( lineString, &viewport, polygons );
+        qDeleteAll( polygons );
+    }
+
+    QCOMPARE( lineString.storage(), storage );
+}
+
+void TestGeoDataLineStringStorage::benchmarkMemory_data()
+{
+    addStorageRows();
+}
+
+void TestGeoDataLineStringStorage::benchmarkMemory()
+{
+    QFETCH( GeoDataLineString::Storage, storage );
+
+    const qint64 before = allocatedBytes();
+    if ( before < 0 ) {
+        QSKIP( "Heap statistics are only available with glibc" );
+    }
+
+    // the nodes of the line string are created one by one, like by a parser
+    GeoDataLineString lineString = createLineString( 1000000, false );
+    lineString.setStorage( storage );
+    QTest::setBenchmarkResult( allocatedBytes() - before, QTest::BytesAllocated );
+
+    QCOMPARE( lineString.storage(), storage );
+}
+
+}
+
+QTEST_MAIN( Marble::TestGeoDataLineStringStorage )
+
+#include "TestGeoDataLineStringStorage.moc"
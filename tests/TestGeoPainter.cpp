@@ -3,6 +3,7 @@
 // SPDX-FileCopyrightText: 2009 Bastian Holst <bastianholst@gmx.de>
 //
 
+#include "ClipPainter.h"
 #include "GeoDataLatLonAltBox.h"
 #include "GeoDataLinearRing.h"
 #include "GeoPainter_p.h"
@@ -10,8 +11,13 @@
 #include "MarbleGlobal.h"
 #include "ViewportParams.h"
 
+#include <QImage>
 #include <QList>
+#include <QRandomGenerator>
 #include <QTest>
+#include <qmath.h>
+
+Q_DECLARE_METATYPE( Marble::ClipPainter::ClipAlgorithm )
 
 namespace Marble
 {
@@ -21,6 +27,21 @@ class TestGeoPainter : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void createLinearRingFromGeoRectTest();
+
+    void clipPolygon_data();
+    void clipPolygon();
+    void clipPolyline_data();
+    void clipPolyline();
+
+    void benchmarkClipPolygon_data();
+    void benchmarkClipPolygon();
+    void benchmarkClipPolyline_data();
+    void benchmarkClipPolyline();
+
+private:
+    static QImage render( const QPolygonF &polygon, bool closed, ClipPainter::ClipAlgorithm algorithm );
+    static int differentPixels( const QImage &first, const QImage &second );
+    static QPolygonF randomWalk( int size, qreal scale );
 };
 
 void TestGeoPainter::createLinearRingFromGeoRectTest()
@@ -41,6 +62,147 @@ void TestGeoPainter::createLinearRingFromGeoRectTest()
 //    }
 }
 
+QImage TestGeoPainter::render( const QPolygonF &polygon, bool closed, ClipPainter::ClipAlgorithm algorithm )
+{
+    QImage image( 200, 150, QImage::Format_RGB32 );
+    image.fill( Qt::white );
+
+    ClipPainter painter( &image, true );
+    painter.setClipAlgorithm( algorithm );
+    painter.setPen( QPen( Qt::black, 3 ) );
+    if ( closed ) {
+        painter.setBrush( Qt::red );
+        painter.drawPolygon( polygon );
+    } else {
+        painter.drawPolyline( polygon );
+    }
+    painter.end();
+
+    return image;
+}
+
+int TestGeoPainter::differentPixels( const QImage &first, const QImage &second )
+{
+    int count = 0;
+    for ( int y = 0; y < first.height(); ++y ) {
+        for ( int x = 0; x < first.width(); ++x ) {
+            if ( first.pixel( x, y ) != second.pixel( x, y ) ) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+QPolygonF TestGeoPainter::randomWalk( int size, qreal scale )
+{
+    // a coastline around the screen, mostly far off it when zoomed in
+    QRandomGenerator random( 42 );
+    QPolygonF polygon;
+    polygon.reserve( size );
+    for ( int i = 0; i < size; ++i ) {
+        const qreal angle = 2 * M_PI * i / size;
+        const qreal distance = scale * ( 0.8 + 0.4 * random.generateDouble() );
+        polygon << QPointF( 100 + distance * qCos( angle ), 75 + distance * qSin( angle ) );
+    }
+    return polygon;
+}
+
+void TestGeoPainter::clipPolygon_data()
+{
+    QTest::addColumn<QPolygonF>( "polygon" );
+
+    QTest::newRow( "inside" ) << QPolygonF( QVector<QPointF>{ { 20, 20 }, { 180, 30 }, { 100, 130 } } );
+    QTest::newRow( "outside" ) << QPolygonF( QVector<QPointF>{ { -500, -500 }, { -300, -500 }, { -400, -300 } } );
+    QTest::newRow( "left edge" ) << QPolygonF( QVector<QPointF>{ { -100, 20 }, { 150, 40 }, { -50, 130 } } );
+    QTest::newRow( "all edges" ) << QPolygonF( QVector<QPointF>{ { 100, -200 }, { 400, 75 }, { 100, 350 }, { -200, 75 } } );
+    QTest::newRow( "covering" ) << QPolygonF( QVector<QPointF>{ { -1e5, -1e5 }, { 1e5, -1e5 }, { 1e5, 1e5 }, { -1e5, 1e5 } } );
+    QTest::newRow( "corners" ) << QPolygonF( QVector<QPointF>{ { -50, -50 }, { 250, 200 }, { 250, -50 }, { -50, 200 } } );
+    QTest::newRow( "coastline" ) << randomWalk( 2000, 150 );
+}
+
+void TestGeoPainter::clipPolygon()
+{
+    QFETCH( QPolygonF, polygon );
+
+    const QImage sector = render( polygon, true, ClipPainter::SectorClipping );
+    const QImage fast = render( polygon, true, ClipPainter::FastClipping );
+
+    // the interpolated nodes may differ slightly, which changes the
+    // rasterization of a few pixels along the clipped edges
+    QVERIFY( differentPixels( sector, fast ) < sector.width() * sector.height() / 100 );
+}
+
+void TestGeoPainter::clipPolyline_data()
+{
+    QTest::addColumn<QPolygonF>( "polyline" );
+
+    QTest::newRow( "inside" ) << QPolygonF( QVector<QPointF>{ { 20, 20 }, { 180, 30 }, { 100, 130 } } );
+    QTest::newRow( "outside" ) << QPolygonF( QVector<QPointF>{ { -500, -500 }, { -300, -500 }, { -400, -300 } } );
+    QTest::newRow( "crossing" ) << QPolygonF( QVector<QPointF>{ { -100, 75 }, { 300, 75 } } );
+    QTest::newRow( "in and out" ) << QPolygonF( QVector<QPointF>{ { 100, 75 }, { 100, -100 }, { 150, -100 }, { 150, 75 }, { 400, 75 } } );
+    QTest::newRow( "passing corner" ) << QPolygonF( QVector<QPointF>{ { -50, 50 }, { 50, -50 } } );
+    QTest::newRow( "coastline" ) << randomWalk( 2000, 150 );
+}
+
+void TestGeoPainter::clipPolyline()
+{
+    QFETCH( QPolygonF, polyline );
+
+    const QImage sector = render( polyline, false, ClipPainter::SectorClipping );
+    const QImage fast = render( polyline, false, ClipPainter::FastClipping );
+
+    QVERIFY( differentPixels( sector, fast ) < sector.width() * sector.height() / 100 );
+}
+
+void TestGeoPainter::benchmarkClipPolygon_data()
+{
+    QTest::addColumn<ClipPainter::ClipAlgorithm>( "algorithm" );
+    QTest::addColumn<qreal>( "scale" );
+
+    QTest::newRow( "sector, on screen" ) << ClipPainter::SectorClipping << 60.0;
+    QTest::newRow( "fast, on screen" ) << ClipPainter::FastClipping << 60.0;
+    QTest::newRow( "sector, zoomed in" ) << ClipPainter::SectorClipping << 5000.0;
+    QTest::newRow( "fast, zoomed in" ) << ClipPainter::FastClipping << 5000.0;
+}
+
+void TestGeoPainter::benchmarkClipPolygon()
+{
+    QFETCH( ClipPainter::ClipAlgorithm, algorithm );
+    QFETCH( qreal, scale );
+
+    // a land polygon with a dense coastline
+    const QPolygonF polygon = randomWalk( 100000, scale );
+    QImage image( 200, 150, QImage::Format_RGB32 );
+    ClipPainter painter( &image, true );
+    painter.setClipAlgorithm( algorithm );
+    painter.setBrush( Qt::red );
+
+    QBENCHMARK {
+        painter.drawPolygon( polygon );
+    }
+}
+
+void TestGeoPainter::benchmarkClipPolyline_data()
+{
+    benchmarkClipPolygon_data();
+}
+
+void TestGeoPainter::benchmarkClipPolyline()
+{
+    QFETCH( ClipPainter::ClipAlgorithm, algorithm );
+    QFETCH( qreal, scale );
+
+    const QPolygonF polyline = randomWalk( 100000, scale );
+    QImage image( 200, 150, QImage::Format_RGB32 );
+    ClipPainter painter( &image, true );
+    painter.setClipAlgorithm( algorithm );
+
+    QBENCHMARK {
+        painter.drawPolyline( polyline );
+    }
+}
+
 }
 
 QTEST_MAIN( Marble::TestGeoPainter )
@@ -8,7 +8,6 @@
 
 #include <ParsingRunnerManager.h>
 #include <PluginManager.h>
-#include <MarbleClock.h>
 #include <GeoDataDocument.h>
 #include <GeoDataFolder.h>
 #include <GeoDataPlacemark.h>
@@ -17,16 +16,54 @@
 
 #include <QApplication>
 #include <QDebug>
-#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QtEndian>
 #include <iostream>
 #include <QDataStream>
 
+#include <cstring>
+
 using namespace std;
 using namespace Marble;
 
 const quint32 MarbleMagicNumber = 0x31415926;
 
-void savePlacemarks( QDataStream &out, const GeoDataContainer *container, MarbleClock* clock )
+// Memory mappable layout, keep in sync with CacheRunner
+const qint32 MappedCacheVersion = 16;
+const int MappedRecordSize = 64;
+
+void appendUInt32( QByteArray &data, quint32 value )
+{
+    char bytes[sizeof( value )];
+    qToLittleEndian( value, bytes );
+    data.append( bytes, sizeof( bytes ) );
+}
+
+void appendDouble( QByteArray &data, double value )
+{
+    quint64 bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    char bytes[sizeof( bits )];
+    qToLittleEndian( bits, bytes );
+    data.append( bytes, sizeof( bytes ) );
+}
+
+quint32 stringIndex( const QString &string, QHash<QString, quint32> &indices, QVector<QString> &strings )
+{
+    QHash<QString, quint32>::const_iterator it = indices.constFind( string );
+    if ( it != indices.constEnd() ) {
+        return it.value();
+    }
+
+    const quint32 index = strings.size();
+    indices.insert( string, index );
+    strings << string;
+    return index;
+}
+
+void savePlacemarks( QByteArray &records, QHash<QString, quint32> &indices, QVector<QString> &strings,
+                     const GeoDataContainer *container )
 {
     qreal lon;
     qreal lat;
@@ -36,32 +73,66 @@ void savePlacemarks( QDataStream &out, const GeoDataContainer *container, Marble
     QVector<GeoDataPlacemark*>::const_iterator it = placemarks.constBegin();
     QVector<GeoDataPlacemark*>::const_iterator const end = placemarks.constEnd();
     for (; it != end; ++it ) {
-        out << (*it)->name();
         (*it)->coordinate().geoCoordinates( lon, lat, alt );
 
         // Use double to provide a single cache file format across architectures
-        out << (double)(lon) << (double)(lat) << (double)(alt);
-        out << QString( (*it)->role() );
-        out << QString( (*it)->description() );
-        out << QString( (*it)->countryCode() );
-        out << QString( (*it)->state() );
-        out << (double) (*it)->area();
-        out << (qint64) (*it)->population();
-        out << ( qint16 ) ( (*it)->extendedData().value("gmt").value().toInt() );
-        out << ( qint8 ) ( (*it)->extendedData().value("dst").value().toInt() );
+        appendDouble( records, lon );
+        appendDouble( records, lat );
+        appendDouble( records, alt );
+        appendDouble( records, (*it)->area() );
+
+        char population[sizeof( qint64 )];
+        qToLittleEndian<qint64>( (*it)->population(), population );
+        records.append( population, sizeof( population ) );
+
+        appendUInt32( records, stringIndex( (*it)->name(), indices, strings ) );
+        appendUInt32( records, stringIndex( QString( (*it)->role() ), indices, strings ) );
+        appendUInt32( records, stringIndex( QString( (*it)->description() ), indices, strings ) );
+        appendUInt32( records, stringIndex( QString( (*it)->countryCode() ), indices, strings ) );
+        appendUInt32( records, stringIndex( QString( (*it)->state() ), indices, strings ) );
+
+        char gmt[sizeof( qint16 )];
+        qToLittleEndian<qint16>( (*it)->extendedData().value("gmt").value().toInt(), gmt );
+        records.append( gmt, sizeof( gmt ) );
+        records.append( char( qint8( (*it)->extendedData().value("dst").value().toInt() ) ) );
+        records.append( char( 0 ) );
     }
 
     const QVector<GeoDataFolder*> folders = container->folderList();
     QVector<GeoDataFolder*>::const_iterator cont = folders.constBegin();
     QVector<GeoDataFolder*>::const_iterator endcont = folders.constEnd();
     for (; cont != endcont; ++cont ) {
-            savePlacemarks( out, *cont, clock );
+            savePlacemarks( records, indices, strings, *cont );
     }
 }
 
 void saveFile( const QString& filename, GeoDataDocument* document )
 {
-    QFile file( filename );
+    QHash<QString, quint32> indices;
+    QVector<QString> strings;
+    stringIndex( QString(), indices, strings );
+
+    QByteArray records;
+    savePlacemarks( records, indices, strings, document );
+
+    QByteArray header;
+    appendUInt32( header, records.size() / MappedRecordSize );
+    appendUInt32( header, strings.size() );
+
+    QByteArray stringTable;
+    QByteArray characters;
+    for ( const QString &string: strings ) {
+        appendUInt32( stringTable, characters.size() / 2 );
+        appendUInt32( stringTable, string.size() );
+        for ( const QChar character: string ) {
+            char bytes[sizeof( quint16 )];
+            qToLittleEndian<quint16>( character.unicode(), bytes );
+            characters.append( bytes, sizeof( bytes ) );
+        }
+    }
+
+    // Readers map the file, so never modify it in place
+    QSaveFile file( filename );
     if ( !file.open( QIODevice::WriteOnly ) ) {
         qDebug() << Q_FUNC_INFO << "Can't open" << filename << "for writing";
         return;
@@ -69,13 +140,17 @@ void saveFile( const QString& filename, GeoDataDocument* document )
     QDataStream out( &file );
 
     // Write a header with a "magic number" and a version
-    // out << (quint32)0xA0B0C0D0;
     out << (quint32)MarbleMagicNumber;
-    out << (qint32)015;
+    out << (qint32)MappedCacheVersion;
 
-    out.setVersion( QDataStream::Qt_4_2 );
+    file.write( header );
+    file.write( records );
+    file.write( stringTable );
+    file.write( characters );
 
-    savePlacemarks( out, document, new MarbleClock );
+    if ( !file.commit() ) {
+        qDebug() << Q_FUNC_INFO << "Can't write" << filename;
+    }
 }
 
 int main(int argc, char** argv)